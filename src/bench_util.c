@@ -14,8 +14,345 @@
  * limitations under the License.
  */
 
+#define _GNU_SOURCE  // sched_setaffinity(), CPU_SET()
+#include <sched.h>   // sched_setaffinity()
+#include <stdarg.h>  // va_list
+#include <stdio.h>   // printf(), fopen()
+#include <stdlib.h>  // qsort(), realloc(), strtoul()
+#include <string.h>  // strcmp()
+#include <unistd.h>  // gethostname()
 #include "bench_util.h"
 
 unsigned long tdiff(timespec_t start, timespec_t end) {
     return (end.tv_sec - start.tv_sec) * NANO + (end.tv_nsec - start.tv_nsec);
 }
+
+#define BENCH_CSV_HEADER "bench,host,reps,median_ns,p99_ns,mean_ns,ops_per_sec,bytes_per_sec"
+
+typedef enum { FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV } bench_format;
+
+/** A benchmark result read from a baseline file. */
+typedef struct {
+    char name[128];
+    unsigned long median;
+} bench_baseline;
+
+/** The options from the command line, and what has been reported so far. */
+static struct {
+    bench_format format;
+    unsigned int threads;
+    unsigned int warmup;
+    unsigned int reps;
+    double tolerance;
+    FILE *save;
+    bench_baseline *baseline;
+    size_t baseline_count;
+    bool header_done;
+    bool regressed;
+    char host[64];
+} opts = {FORMAT_TEXT, 0, 1, 1, 10.0, NULL, NULL, 0, false, false, "unknown"};
+
+static void bench_fail(const char *what, const char *arg) {
+    fprintf(stderr, "%s: %s\n", what, arg);
+    exit(EXIT_FAILURE);
+}
+
+// Restrict this process, and the threads it starts afterwards, to the CPUs in a list such as "0-3,8"
+static void bench_pin(const char *list) {
+#ifdef __linux__
+    cpu_set_t set;
+    const char *s = list;
+    CPU_ZERO(&set);
+    while (*s != '\0') {
+        char *end;
+        unsigned long first = strtoul(s, &end, 10), last = first;
+        if (end == s) bench_fail("Bad CPU list", list);
+        if (*end == '-') {
+            s = end + 1;
+            last = strtoul(s, &end, 10);
+            if (end == s || last < first) bench_fail("Bad CPU list", list);
+        }
+        for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, &set);
+        }
+        s = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') bench_fail("Bad CPU list", list);
+    }
+    if (sched_setaffinity(0, sizeof set, &set) != 0) bench_fail("Could not pin to CPUs", list);
+#else
+    bench_fail("CPU pinning is not supported on this platform", list);
+#endif
+}
+
+// Read the names and medians from a file written with --save or --format csv
+static void bench_load_baseline(const char *path) {
+    char line[512];
+    size_t capacity = 0;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) bench_fail("Could not read the baseline", path);
+    while (fgets(line, sizeof line, f) != NULL) {
+        bench_baseline entry;
+        if (strncmp(line, "bench,", 6) == 0) continue;
+        if (sscanf(line, "%127[^,],%*[^,],%*u,%lu", entry.name, &entry.median) != 2) continue;
+        if (opts.baseline_count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            opts.baseline = realloc(opts.baseline, capacity * sizeof *opts.baseline);
+            if (opts.baseline == NULL) bench_fail("Out of memory reading the baseline", path);
+        }
+        opts.baseline[opts.baseline_count++] = entry;
+    }
+    fclose(f);
+}
+
+/**
+ * Read the harness options from the command line.
+ *
+ * The options are removed from @p argv, leaving the program name and the benchmark's own arguments. On a bad option
+ * this prints a message and exits.
+ *
+ * @param[in]     argc The number of arguments
+ * @param[in,out] argv The arguments
+ * @return The number of arguments left in @p argv
+ */
+int bench_init(int argc, char *argv[]) {
+    int kept = 1;
+
+    gethostname(opts.host, sizeof opts.host - 1);
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i], *arg = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strncmp(opt, "--", 2) != 0) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        if (arg == NULL) bench_fail("Missing value for option", opt);
+        i++;
+        if (strcmp(opt, "--format") == 0) {
+            if (strcmp(arg, "text") == 0) opts.format = FORMAT_TEXT;
+            else if (strcmp(arg, "json") == 0) opts.format = FORMAT_JSON;
+            else if (strcmp(arg, "csv") == 0) opts.format = FORMAT_CSV;
+            else bench_fail("Unknown format", arg);
+        } else if (strcmp(opt, "--threads") == 0) {
+            opts.threads = strtoul(arg, NULL, 10);
+        } else if (strcmp(opt, "--cpus") == 0) {
+            bench_pin(arg);
+        } else if (strcmp(opt, "--warmup") == 0) {
+            opts.warmup = strtoul(arg, NULL, 10);
+        } else if (strcmp(opt, "--reps") == 0) {
+            opts.reps = strtoul(arg, NULL, 10);
+        } else if (strcmp(opt, "--save") == 0) {
+            if ((opts.save = fopen(arg, "a")) == NULL) bench_fail("Could not write", arg);
+            fseek(opts.save, 0, SEEK_END);
+            if (ftell(opts.save) == 0) fprintf(opts.save, "%s\n", BENCH_CSV_HEADER);
+        } else if (strcmp(opt, "--baseline") == 0) {
+            bench_load_baseline(arg);
+        } else if (strcmp(opt, "--tolerance") == 0) {
+            opts.tolerance = strtod(arg, NULL);
+        } else {
+            bench_fail("Unknown option", opt);
+        }
+    }
+    argv[kept] = NULL;
+
+    return kept;
+}
+
+/**
+ * The number of threads for benchmarks of the parallel paths, for #new_thread_pool.
+ *
+ * @return The number from `--threads`, or zero, meaning one per CPU, if it was not given
+ */
+unsigned int bench_threads(void) {
+    return opts.threads;
+}
+
+/**
+ * Print a heading or other remark, which goes to standard error when the results are machine-readable.
+ *
+ * @param[in] fmt The `printf` format, followed by its arguments
+ */
+void bench_note(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(opts.format == FORMAT_TEXT ? stdout : stderr, fmt, ap);
+    va_end(ap);
+}
+
+/**
+ * Start a benchmark, to be run as:
+ *
+ * ```
+ * bench_begin(&b, max_seconds);
+ * while (bench_more(&b)) {
+ *     bench_start(&b);
+ *     // The operation to be timed
+ *     bench_stop(&b);
+ * }
+ * result = bench_end(&b, 1, 0);
+ * ```
+ *
+ * The first `--warmup` repetitions are not timed. After that, repetitions continue for at least @p max_seconds and
+ * at least `--reps` times.
+ *
+ * @param[out] b           The benchmark
+ * @param[in]  max_seconds The time to keep repeating for
+ */
+void bench_begin(bench_t *b, int max_seconds) {
+    b->samples = NULL;
+    b->count = 0;
+    b->capacity = 0;
+    b->total = 0;
+    b->budget = max_seconds * NANO;
+    b->warmup = opts.warmup;
+}
+
+/**
+ * Whether to run another repetition.
+ *
+ * @param[in] b The benchmark
+ * @return `true` if there should be another repetition
+ */
+bool bench_more(const bench_t *b) {
+    return b->warmup > 0 || b->count < opts.reps || b->total < b->budget;
+}
+
+/**
+ * Start timing a repetition.
+ *
+ * @param[in,out] b The benchmark
+ */
+void bench_start(bench_t *b) {
+    clock_gettime(CLOCK_MONOTONIC, &b->t0);
+}
+
+/**
+ * Stop timing a repetition, and record it unless it was a warm-up.
+ *
+ * @param[in,out] b The benchmark
+ */
+void bench_stop(bench_t *b) {
+    timespec_t t1;
+    unsigned long t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    t = tdiff(b->t0, t1);
+    if (b->warmup > 0) {
+        b->warmup--;
+        return;
+    }
+    if (b->count == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 64;
+        b->samples = realloc(b->samples, b->capacity * sizeof *b->samples);
+        if (b->samples == NULL) bench_fail("Out of memory", "benchmark samples");
+    }
+    b->samples[b->count++] = t;
+    b->total += t;
+}
+
+static int compare_samples(const void *a, const void *b) {
+    unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Finish a benchmark and summarise its repetitions.
+ *
+ * @param[in,out] b     The benchmark, whose samples are freed
+ * @param[in]     items The number of items each repetition processes, for times per item
+ * @param[in]     bytes The number of bytes each repetition processes, or zero
+ * @return The summary, per item
+ */
+bench_result bench_end(bench_t *b, uint64_t items, uint64_t bytes) {
+    bench_result r = {b->count, 0, 0, 0, 0, 0};
+    unsigned long median;
+
+    if (b->count > 0) {
+        qsort(b->samples, b->count, sizeof *b->samples, compare_samples);
+        median = b->count % 2 ? b->samples[b->count / 2]
+                              : (b->samples[b->count / 2 - 1] + b->samples[b->count / 2]) / 2;
+        if (median == 0) median = 1;
+        r.median = median / items;
+        r.p99 = b->samples[(b->count * 99 + 99) / 100 - 1] / items;
+        r.mean = b->total / b->count / items;
+        r.ops_per_sec = (double)items * NANO / median;
+        r.bytes_per_sec = (double)bytes * NANO / median;
+    }
+
+    free(b->samples);
+    b->samples = NULL;
+    return r;
+}
+
+static void bench_csv(FILE *f, const char *name, bench_result r) {
+    fprintf(f, "%s,%s,%lu,%lu,%lu,%lu,%.1f,%.1f\n", name, opts.host, r.reps, r.median, r.p99, r.mean, r.ops_per_sec,
+            r.bytes_per_sec);
+}
+
+/**
+ * Print the result of a benchmark in the chosen format, and compare it with the baseline if one was given.
+ *
+ * A median more than `--tolerance` percent slower than the baseline is reported as a regression, and makes
+ * #bench_exit fail.
+ *
+ * @param[in] r   The result from #bench_end
+ * @param[in] fmt The `printf` format for the name of the benchmark, followed by its arguments
+ */
+void bench_report(bench_result r, const char *fmt, ...) {
+    char name[128];
+    const bench_baseline *base = NULL;
+    double change = 0;
+    bool regressed = false;
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof name, fmt, ap);
+    va_end(ap);
+
+    for (size_t i = 0; i < opts.baseline_count; i++) {
+        if (strcmp(opts.baseline[i].name, name) == 0) base = &opts.baseline[i];
+    }
+    if (base != NULL && base->median > 0) {
+        change = 100.0 * ((double)r.median - base->median) / base->median;
+        regressed = change > opts.tolerance;
+        opts.regressed |= regressed;
+    }
+
+    switch (opts.format) {
+    case FORMAT_TEXT:
+        printf("%s %lu ns/op (p99 %lu ns, %lu reps, %.0f ops/s", name, r.median, r.p99, r.reps, r.ops_per_sec);
+        if (r.bytes_per_sec > 0) printf(", %.1f MB/s", r.bytes_per_sec / 1e6);
+        if (base != NULL) printf(", %+.1f%% against %lu ns%s", change, base->median, regressed ? ", REGRESSION" : "");
+        printf(")\n");
+        break;
+    case FORMAT_JSON:
+        printf("{\"bench\": \"%s\", \"host\": \"%s\", \"reps\": %lu, \"median_ns\": %lu, \"p99_ns\": %lu, "
+               "\"mean_ns\": %lu, \"ops_per_sec\": %.1f, \"bytes_per_sec\": %.1f",
+               name, opts.host, r.reps, r.median, r.p99, r.mean, r.ops_per_sec, r.bytes_per_sec);
+        if (base != NULL) printf(", \"baseline_ns\": %lu, \"regressed\": %s", base->median, regressed ? "true" : "false");
+        printf("}\n");
+        break;
+    case FORMAT_CSV:
+        if (!opts.header_done) printf("%s\n", BENCH_CSV_HEADER);
+        opts.header_done = true;
+        bench_csv(stdout, name, r);
+        break;
+    }
+    fflush(stdout);
+
+    if (opts.save != NULL) {
+        bench_csv(opts.save, name, r);
+        fflush(opts.save);
+    }
+}
+
+/**
+ * Tidy up at the end of a benchmark program.
+ *
+ * @return `EXIT_FAILURE` if anything regressed against the baseline, otherwise `EXIT_SUCCESS`
+ */
+int bench_exit(void) {
+    if (opts.save != NULL) fclose(opts.save);
+    free(opts.baseline);
+    if (opts.regressed) bench_note("*** Slower than the baseline by more than %.1f%%.\n", opts.tolerance);
+    return opts.regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -14,11 +14,55 @@
  * limitations under the License.
  */
 
-#include <time.h> // CLOCK_REALTIME, clock_gettime(), timespec
+#include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+#include <time.h>    // CLOCK_REALTIME, clock_gettime(), timespec
 
 typedef struct timespec timespec_t;
 
 #define NANO 1000000000L
 #define NSEC 1
 
+/** The options understood by #bench_init, for the usage messages of the benchmarks. */
+#define BENCH_OPTIONS                                                                                                  \
+    "[--format text|json|csv] [--threads N] [--cpus LIST] [--warmup N] [--reps N] [--save FILE] [--baseline FILE] "  \
+    "[--tolerance PERCENT]"
+
+/**
+ * The state of one benchmark while it runs: see #bench_begin.
+ */
+typedef struct {
+    unsigned long *samples; /**< The time of each timed repetition in nanoseconds */
+    size_t count;           /**< The number of samples */
+    size_t capacity;        /**< The space for samples */
+    unsigned long total;    /**< The sum of the samples */
+    unsigned long budget;   /**< The time to keep repeating for, in nanoseconds */
+    unsigned int warmup;    /**< The number of untimed repetitions still to run */
+    timespec_t t0;          /**< The start of the current repetition */
+} bench_t;
+
+/**
+ * The summary of a finished benchmark, per item processed.
+ */
+typedef struct {
+    uint64_t reps;        /**< The number of timed repetitions */
+    unsigned long median; /**< The median time in nanoseconds */
+    unsigned long p99;    /**< The 99th percentile time in nanoseconds */
+    unsigned long mean;   /**< The mean time in nanoseconds */
+    double ops_per_sec;   /**< Items per second, from the median */
+    double bytes_per_sec; /**< Bytes per second, from the median, or zero if not measured */
+} bench_result;
+
 unsigned long tdiff(timespec_t start, timespec_t end);
+
+int bench_init(int argc, char *argv[]);
+unsigned int bench_threads(void);
+void bench_note(const char *fmt, ...);
+void bench_begin(bench_t *b, int max_seconds);
+bool bench_more(const bench_t *b);
+void bench_start(bench_t *b);
+void bench_stop(bench_t *b);
+bench_result bench_end(bench_t *b, uint64_t items, uint64_t bytes);
+void bench_report(bench_result r, const char *fmt, ...);
+int bench_exit(void);
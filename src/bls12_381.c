@@ -20,12 +20,34 @@
  * Wrappers for cryptographic library functions, allowing different libraries to be supported.
  */
 
+#include "control.h"
 #include "bls12_381.h"
+#include "stats.h"
+#include "c_kzg_alloc.h"
 
 #ifdef BLST
 
 #include <stdlib.h> // malloc(), free(), NULL
 
+#ifdef KZG_INLINE
+// The single external definition of each inline function in bls12_381_inline.h
+extern inline bool fr_is_zero(const fr_t *p);
+extern inline bool fr_is_one(const fr_t *p);
+extern inline bool fr_is_null(const fr_t *p);
+extern inline bool fr_equal(const fr_t *aa, const fr_t *bb);
+extern inline void fr_negate(fr_t *out, const fr_t *in);
+extern inline void fr_add(fr_t *out, const fr_t *a, const fr_t *b);
+extern inline void fr_sub(fr_t *out, const fr_t *a, const fr_t *b);
+extern inline void fr_mul(fr_t *out, const fr_t *a, const fr_t *b);
+extern inline void fr_sqr(fr_t *out, const fr_t *a);
+extern inline bool g1_is_inf(const g1_t *a);
+extern inline void g1_dbl(g1_t *out, const g1_t *a);
+extern inline void g1_add_or_dbl(g1_t *out, const g1_t *a, const g1_t *b);
+extern inline bool g1_equal(const g1_t *a, const g1_t *b);
+#else
+#include "bls12_381_inline.h"
+#endif
+
 /**
  * Fast log base 2 of a byte.
  *
@@ -45,49 +67,6 @@ static int log_2_byte(byte b) {
     return r;
 }
 
-/**
- * Test whether the operand is zero in the finite field.
- *
- * @param p The field element to be checked
- * @retval true The element is zero
- * @retval false The element is non-zero
- *
- * @todo See if there is a more efficient way to check for zero in the finite field.
- */
-bool fr_is_zero(const fr_t *p) {
-    uint64_t a[4];
-    blst_uint64_from_fr(a, p);
-    return a[0] == 0 && a[1] == 0 && a[2] == 0 && a[3] == 0;
-}
-
-/**
- * Test whether the operand is one in the finite field.
- *
- * @param p The field element to be checked
- * @retval true The element is one
- * @retval false The element is not one
- *
- * @todo See if there is a more efficient way to check for one in the finite field.
- */
-bool fr_is_one(const fr_t *p) {
-    uint64_t a[4];
-    blst_uint64_from_fr(a, p);
-    return a[0] == 1 && a[1] == 0 && a[2] == 0 && a[3] == 0;
-}
-
-/**
- * Test whether the operand is a specially defined NULL value.
- *
- * @param p The field element to be checked
- * @retval true The element is the NULL value
- * @retval false The element is not the NULL value
- */
-bool fr_is_null(const fr_t *p) {
-    uint64_t *null = (uint64_t *)&fr_null;
-    uint64_t *a = (uint64_t *)p;
-    return a[0] == null[0] && a[1] == null[1] && a[2] == null[2] && a[3] == null[3];
-}
-
 /**
  * Create a field element from a scalar, which is a little-endian sequence of bytes.
  *
@@ -132,94 +111,147 @@ void fr_to_uint64s(uint64_t out[4], const fr_t *fr) {
 }
 
 /**
- * Test whether two field elements are equal.
+ * Inverse of a field element.
  *
- * @param[in] aa The first element
- * @param[in] bb The second element
- * @retval true if @p aa and @p bb are equal
- * @retval false otherwise
+ * @param[out] out The inverse of @p a
+ * @param[in]  a   A field element
  */
-bool fr_equal(const fr_t *aa, const fr_t *bb) {
-    uint64_t a[4], b[4];
-    blst_uint64_from_fr(a, aa);
-    blst_uint64_from_fr(b, bb);
-    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+void fr_inv(fr_t *out, const fr_t *a) {
+    STAT_COUNT(FR_INV, 1);
+    blst_fr_eucl_inverse(out, a);
 }
 
 /**
- * Negate a field element.
+ * Division of two field elements.
  *
- * @param[out] out The negation of @p in
- * @param[in]  in  The element to be negated
+ * @param[out] out @p a divided by @p b in the field
+ * @param[in]  a   The dividend
+ * @param[in]  b   The divisor
  */
-void fr_negate(fr_t *out, const fr_t *in) {
-    blst_fr_cneg(out, in, true);
+void fr_div(fr_t *out, const fr_t *a, const fr_t *b) {
+    blst_fr tmp;
+    STAT_COUNT(FR_INV, 1);
+    blst_fr_eucl_inverse(&tmp, b);
+    blst_fr_mul(out, a, &tmp);
 }
 
 /**
- * Add two field elements.
+ * Invert an array of field elements all at once.
+ *
+ * Uses Montgomery's trick, so that the cost is a single inversion plus three multiplications per element.
+ *
+ * @remark Zero elements are tolerated: in line with #fr_div their "inverse" is zero, and they do not affect the results
+ * for the other elements.
+ *
+ * @remark @p out and @p a must not overlap.
  *
- * @param[out] out @p a plus @p b in the field
- * @param[in]  a   Field element
- * @param[in]  b   Field element
+ * @param[out] out The inverses of the elements of @p a, array length @p len
+ * @param[in]  a   The field elements to be inverted, array length @p len
+ * @param[in]  len The number of elements
  */
-void fr_add(fr_t *out, const fr_t *a, const fr_t *b) {
-    blst_fr_add(out, a, b);
+void fr_batch_inv(fr_t *out, const fr_t *a, uint64_t len) {
+    fr_t acc = fr_one, inv, tmp;
+
+    // out[i] is the product of all the non-zero elements before the i-th
+    for (uint64_t i = 0; i < len; i++) {
+        out[i] = acc;
+        if (!fr_is_zero(&a[i])) fr_mul(&acc, &acc, &a[i]);
+    }
+
+    // inv is the inverse of the product of all the non-zero elements up to and including the i-th
+    fr_inv(&inv, &acc);
+    for (uint64_t i = len; i-- > 0;) {
+        if (fr_is_zero(&a[i])) {
+            out[i] = fr_zero;
+        } else {
+            fr_mul(&tmp, &out[i], &inv);
+            fr_mul(&inv, &inv, &a[i]);
+            out[i] = tmp;
+        }
+    }
 }
 
 /**
- * Subtract one field element from another.
+ * Point-wise product of two arrays of field elements.
+ *
+ * The vector routines here are the hot loops of the FFTs and polynomial arithmetic, kept in one place so that they
+ * call straight into the field arithmetic. Output arrays may be the same as input arrays.
  *
- * @param[out] out @p a minus @p b in the field
- * @param[in]  a   Field element
- * @param[in]  b   Field element
+ * @param[out] out `a[i] * b[i]` for each `i`, array length @p n
+ * @param[in]  a   An array of field elements, length @p n
+ * @param[in]  b   An array of field elements, length @p n
+ * @param[in]  n   The number of elements
  */
-void fr_sub(fr_t *out, const fr_t *a, const fr_t *b) {
-    blst_fr_sub(out, a, b);
+void fr_mul_vec(fr_t *out, const fr_t *a, const fr_t *b, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        blst_fr_mul(&out[i], &a[i], &b[i]);
+    }
 }
 
 /**
- * Multiply two field elements.
+ * Point-wise sum of two arrays of field elements.
  *
- * @param[out] out @p a multiplied by @p b in the field
- * @param[in]  a   Multiplicand
- * @param[in]  b   Multiplier
+ * @param[out] out `a[i] + b[i]` for each `i`, array length @p n
+ * @param[in]  a   An array of field elements, length @p n
+ * @param[in]  b   An array of field elements, length @p n
+ * @param[in]  n   The number of elements
  */
-void fr_mul(fr_t *out, const fr_t *a, const fr_t *b) {
-    blst_fr_mul(out, a, b);
+void fr_add_vec(fr_t *out, const fr_t *a, const fr_t *b, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        blst_fr_add(&out[i], &a[i], &b[i]);
+    }
 }
 
 /**
- * Inverse of a field element.
+ * Multiply an array of field elements by a constant.
  *
- * @param[out] out The inverse of @p a
- * @param[in]  a   A field element
+ * @param[out] out `a[i] * s` for each `i`, array length @p n
+ * @param[in]  a   An array of field elements, length @p n
+ * @param[in]  s   The constant multiplier
+ * @param[in]  n   The number of elements
  */
-void fr_inv(fr_t *out, const fr_t *a) {
-    blst_fr_eucl_inverse(out, a);
+void fr_scale_vec(fr_t *out, const fr_t *a, const fr_t *s, uint64_t n) {
+    blst_fr k = *s;
+    for (uint64_t i = 0; i < n; i++) {
+        blst_fr_mul(&out[i], &a[i], &k);
+    }
 }
 
 /**
- * Division of two field elements.
+ * Multiply an array of field elements by successive powers of a field element.
  *
- * @param[out] out @p a divided by @p b in the field
- * @param[in]  a   The dividend
- * @param[in]  b   The divisor
+ * @param[out] out `a[i] * x^i` for each `i`, array length @p n
+ * @param[in]  a   An array of field elements, length @p n
+ * @param[in]  x   The field element whose powers are applied
+ * @param[in]  n   The number of elements
  */
-void fr_div(fr_t *out, const fr_t *a, const fr_t *b) {
-    blst_fr tmp;
-    blst_fr_eucl_inverse(&tmp, b);
-    blst_fr_mul(out, a, &tmp);
+void fr_mul_powers_vec(fr_t *out, const fr_t *a, const fr_t *x, uint64_t n) {
+    blst_fr power = *x, base = *x;
+    if (n > 0) out[0] = a[0];
+    for (uint64_t i = 1; i < n; i++) {
+        blst_fr_mul(&out[i], &a[i], &power);
+        blst_fr_mul(&power, &power, &base);
+    }
 }
 
 /**
- * Square a field element.
+ * Radix-2 butterflies across two arrays of field elements.
  *
- * @param[out] out @p a squared
- * @param[in]  a   A field element
+ * For each `i`, with `t = b[i] * roots[i * roots_stride]`, sets `a[i]` to `a[i] + t` and `b[i]` to `a[i] - t`.
+ *
+ * @param[in,out] a            The upper inputs and outputs of the butterflies, array length @p n
+ * @param[in,out] b            The lower inputs and outputs of the butterflies, array length @p n
+ * @param[in]     roots        The twiddle factors
+ * @param[in]     roots_stride The step through @p roots between successive butterflies
+ * @param[in]     n            The number of butterflies
  */
-void fr_sqr(fr_t *out, const fr_t *a) {
-    blst_fr_sqr(out, a);
+void fr_butterfly_vec(fr_t *a, fr_t *b, const fr_t *roots, uint64_t roots_stride, uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        blst_fr t;
+        blst_fr_mul(&t, &b[i], &roots[i * roots_stride]);
+        blst_fr_sub(&b[i], &a[i], &t);
+        blst_fr_add(&a[i], &a[i], &t);
+    }
 }
 
 /**
@@ -246,52 +278,6 @@ void fr_pow(fr_t *out, const fr_t *a, uint64_t n) {
     }
 }
 
-/**
- * Test G1 point for being infinity/the identity.
- *
- * @param[in] a A G1 point
- * @retval true if @p a is the identity point in G1
- * @retval false otherwise
- */
-bool g1_is_inf(const g1_t *a) {
-    return blst_p1_is_inf(a);
-}
-
-/**
- * Double a G1 point.
- *
- * @param[out] out @p a plus @p a in the group
- * @param[in]  a   G1 group point
- */
-void g1_dbl(g1_t *out, const g1_t *a) {
-    blst_p1_double(out, a);
-}
-
-/**
- * Add or double G1 points.
- *
- * This is safe if the two points are the same.
- *
- * @param[out] out @p a plus @p b in the group
- * @param[in]  a   G1 group point
- * @param[in]  b   G1 group point
- */
-void g1_add_or_dbl(g1_t *out, const g1_t *a, const g1_t *b) {
-    blst_p1_add_or_double(out, a, b);
-}
-
-/**
- * Test G1 points for equality.
- *
- * @param[in] a A G1 point
- * @param[in] b A G1 point
- * @retval true if @p a and @p b are the same point
- * @retval false otherwise
- */
-bool g1_equal(const g1_t *a, const g1_t *b) {
-    return blst_p1_is_equal(a, b);
-}
-
 /**
  * Multiply a G1 group element by a field element.
  *
@@ -303,6 +289,7 @@ bool g1_equal(const g1_t *a, const g1_t *b) {
  */
 void g1_mul(g1_t *out, const g1_t *a, const fr_t *b) {
     blst_scalar s;
+    STAT_COUNT(G1_MUL, 1);
     blst_scalar_from_fr(&s, b);
 
     // Count the number of bytes to be multiplied.
@@ -392,6 +379,22 @@ void g2_dbl(g2_t *out, const g2_t *a) {
     blst_p2_double(out, a);
 }
 
+/**
+ * The smallest linear combination computed by the Pippenger method rather than directly, see #g1_set_pippenger_min.
+ */
+static uint64_t pippenger_min = 8;
+
+/**
+ * Set the smallest linear combination that is computed by the Pippenger method rather than point by point.
+ *
+ * This is a tunable parameter, normally set from a #KZGTuning profile by #kzg_set_tuning.
+ *
+ * @param[in] len The number of points, raised to two if smaller, since Blst fails for 0 or 1
+ */
+void g1_set_pippenger_min(uint64_t len) {
+    pippenger_min = len < 2 ? 2 : len;
+}
+
 /**
  * Calculate a linear combination of G1 group elements.
  *
@@ -401,6 +404,8 @@ void g2_dbl(g2_t *out, const g2_t *a) {
  * @param[in]  p      Array of G1 group elements, length @p len
  * @param[in]  coeffs Array of field elements, length @p len
  * @param[in]  len    The number of group/field elements
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
  *
  * For the benefit of future generations (since Blst has no documentation to speak of),
  * there are two ways to pass the arrays of scalars and points into `blst_p1s_mult_pippenger()`.
@@ -412,9 +417,12 @@ void g2_dbl(g2_t *out, const g2_t *a) {
  *
  * We do the second of these to save memory here.
  */
-void g1_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, const uint64_t len) {
+C_KZG_RET g1_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, const uint64_t len) {
+    STAT_SCOPE(MSM);
+    C_KZG_RET ret = C_KZG_OK;
 
-    if (len < 8) { // Tunable parameter: must be at least 2 since Blst fails for 0 or 1
+    STAT_SIZED(MSM, len);
+    if (len < pippenger_min) {
         // Direct approach
         g1_t tmp;
         *out = g1_identity;
@@ -423,30 +431,333 @@ void g1_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, const u
             blst_p1_add_or_double(out, out, &tmp);
         }
     } else {
-        // Blst's implementation of the Pippenger method
-        void *scratch = malloc(blst_p1s_mult_pippenger_scratch_sizeof(len));
-        blst_p1_affine *p_affine = malloc(len * sizeof(blst_p1_affine));
-        blst_scalar *scalars = malloc(len * sizeof(blst_scalar));
+        byte *scratch = NULL;
+        g1_affine_t *p_affine = NULL;
+        scalar_t *scalars = NULL;
+
+        ret = new_byte_array(&scratch, g1_linear_combination_scratch_sizeof(len));
+        if (ret == C_KZG_OK) ret = new_g1_affine_array(&p_affine, len);
+        if (ret == C_KZG_OK) ret = new_scalar_array(&scalars, len);
+        if (ret == C_KZG_OK) {
+            // Transform the points to affine representation
+            g1_array_to_affine(p_affine, p, len);
+
+            g1_affine_linear_combination(out, p_affine, coeffs, len, scalars, scratch);
+        }
+
+        // Tidy up
+        c_kzg_free(scratch);
+        c_kzg_free(p_affine);
+        c_kzg_free(scalars);
+    }
+
+    return ret;
+}
 
-        // Transform the points to affine representation
-        const blst_p1 *p_arg[2] = {p, NULL};
-        blst_p1s_to_affine(p_affine, p_arg, len);
+/**
+ * The size in bytes of the scratch space required by #g1_affine_linear_combination for @p len points.
+ *
+ * This does not depend on #g1_set_pippenger_min, so buffers sized before it is changed remain large enough.
+ *
+ * @param[in] len The number of points in the linear combination
+ * @return The number of bytes of scratch space needed
+ */
+size_t g1_linear_combination_scratch_sizeof(uint64_t len) {
+    return len < 2 ? 0 : blst_p1s_mult_pippenger_scratch_sizeof(len);
+}
 
+/**
+ * Calculate a linear combination of G1 group elements given in affine form.
+ *
+ * This is the same as #g1_linear_combination, except that the points are already in affine form.
+ *
+ * @remark No memory is allocated here: the caller provides space for the scalars and the scratch area, so this is
+ * suitable for use with long-lived buffers.
+ *
+ * @param[out] out     The resulting sum-product
+ * @param[in]  p       Array of G1 group elements in affine form, length @p len
+ * @param[in]  coeffs  Array of field elements, length @p len
+ * @param[in]  len     The number of group/field elements
+ * @param      scalars Space for @p len scalars
+ * @param      scratch Scratch space of at least #g1_linear_combination_scratch_sizeof(@p len) bytes
+ */
+void g1_affine_linear_combination(g1_t *out, const g1_affine_t *p, const fr_t *coeffs, uint64_t len, scalar_t *scalars,
+                                  void *scratch) {
+    if (len < pippenger_min) {
+        g1_t tmp;
+        *out = g1_identity;
+        for (uint64_t i = 0; i < len; i++) {
+            blst_p1_from_affine(&tmp, &p[i]);
+            g1_mul(&tmp, &tmp, &coeffs[i]);
+            blst_p1_add_or_double(out, out, &tmp);
+        }
+    } else {
         // Transform the field elements to 256-bit scalars
-        for (int i = 0; i < len; i++) {
+        for (uint64_t i = 0; i < len; i++) {
             blst_scalar_from_fr(&scalars[i], &coeffs[i]);
         }
 
-        // Call the Pippenger implementation
+        // Call Blst's implementation of the Pippenger method
         const byte *scalars_arg[2] = {(byte *)scalars, NULL};
-        const blst_p1_affine *points_arg[2] = {p_affine, NULL};
+        const blst_p1_affine *points_arg[2] = {p, NULL};
         blst_p1s_mult_pippenger(out, points_arg, len, scalars_arg, 256, scratch);
+    }
+}
 
-        // Tidy up
-        free(scratch);
-        free(p_affine);
-        free(scalars);
+/**
+ * Convert a G1 group element from affine representation.
+ *
+ * @param[out] out The point in the internal representation
+ * @param[in]  in  The affine point to be converted
+ */
+void g1_from_affine(g1_t *out, const g1_affine_t *in) {
+    blst_p1_from_affine(out, in);
+}
+
+/**
+ * Convert an array of G1 group elements to affine representation.
+ *
+ * @param[out] out The affine points, array length @p len
+ * @param[in]  in  The points to be converted, array length @p len
+ * @param[in]  len The number of points
+ */
+void g1_array_to_affine(g1_affine_t *out, const g1_t *in, uint64_t len) {
+    const blst_p1 *in_arg[2] = {in, NULL};
+    blst_p1s_to_affine(out, in_arg, len);
+}
+
+/**
+ * The number of affine points needed to hold fixed-base tables for @p len points with window size @p wbits.
+ *
+ * Each point gets a row of `2^(wbits - 1)` precomputed multiples, so memory use grows exponentially with @p wbits.
+ *
+ * @param[in] wbits The window size in bits, at least 1
+ * @param[in] len   The number of base points
+ * @return The length of the table as an array of #g1_affine_t
+ */
+uint64_t g1_fixed_base_table_length(unsigned int wbits, uint64_t len) {
+    return blst_p1s_mult_wbits_precompute_sizeof(wbits, len) / sizeof(blst_p1_affine);
+}
+
+/**
+ * The size in bytes of the scratch space required by #g1_fixed_base_linear_combination for @p len points.
+ *
+ * @param[in] len The number of points in the linear combination
+ * @return The number of bytes of scratch space needed
+ */
+size_t g1_fixed_base_scratch_sizeof(uint64_t len) {
+    return blst_p1s_mult_wbits_scratch_sizeof(len);
+}
+
+/**
+ * Build fixed-base window tables for a set of G1 points.
+ *
+ * The resulting table may be used with #g1_fixed_base_linear_combination for any number of points up to @p len, always
+ * starting from the first point.
+ *
+ * @param[out] table The precomputed table, length #g1_fixed_base_table_length(@p wbits, @p len)
+ * @param[in]  wbits The window size in bits, at least 1
+ * @param[in]  p     The base points in affine form, array length @p len
+ * @param[in]  len   The number of base points
+ */
+void g1_fixed_base_precompute(g1_affine_t *table, unsigned int wbits, const g1_affine_t *p, uint64_t len) {
+    const blst_p1_affine *points_arg[2] = {p, NULL};
+    blst_p1s_mult_wbits_precompute(table, wbits, points_arg, len);
+}
+
+/**
+ * Calculate a linear combination of G1 group elements using precomputed fixed-base tables.
+ *
+ * Calculates `[coeffs_0]p_0 + [coeffs_1]p_1 + ... + [coeffs_n]p_n` where `n` is `len - 1` and the `p_i` are the points
+ * that were passed to #g1_fixed_base_precompute.
+ *
+ * @remark No memory is allocated here: the caller provides space for the scalars and the scratch area.
+ *
+ * @param[out] out     The resulting sum-product
+ * @param[in]  table   Tables previously built for at least @p len points by #g1_fixed_base_precompute
+ * @param[in]  wbits   The window size that @p table was built with
+ * @param[in]  coeffs  Array of field elements, length @p len
+ * @param[in]  len     The number of group/field elements
+ * @param      scalars Space for @p len scalars
+ * @param      scratch Scratch space of at least #g1_fixed_base_scratch_sizeof(@p len) bytes
+ */
+void g1_fixed_base_linear_combination(g1_t *out, const g1_affine_t *table, unsigned int wbits, const fr_t *coeffs,
+                                      uint64_t len, scalar_t *scalars, void *scratch) {
+    if (len == 0) {
+        *out = g1_identity;
+        return;
+    }
+
+    // Transform the field elements to 256-bit scalars
+    for (uint64_t i = 0; i < len; i++) {
+        blst_scalar_from_fr(&scalars[i], &coeffs[i]);
+    }
+
+    // Field elements are less than 2^255, so the top bit is always zero.
+    const byte *scalars_arg[2] = {(byte *)scalars, NULL};
+    blst_p1s_mult_wbits(out, table, wbits, len, scalars_arg, 255, scratch);
+}
+
+/**
+ * The number of windows that a scalar is split into by #g1_mul_precomputed for window size @p wbits.
+ *
+ * Each window holds `wbits - 1` bits of the scalar so that the digits are never negative.
+ *
+ * @param[in] wbits The window size in bits, between 2 and 8
+ * @return The number of windows covering a 255-bit scalar
+ */
+static uint64_t g1_mul_table_windows(unsigned int wbits) {
+    return (255 + wbits - 2) / (wbits - 1);
+}
+
+/**
+ * The number of affine points needed to hold the table built by #g1_mul_precompute for a single point.
+ *
+ * This is `ceil(255 / (wbits - 1)) * 2^(wbits - 1)`, which is to say tens of thousands of bytes per point even at the
+ * smallest window sizes.
+ *
+ * @param[in] wbits The window size in bits, between 2 and 8
+ * @return The length of the table as an array of #g1_affine_t
+ */
+uint64_t g1_mul_table_length(unsigned int wbits) {
+    return g1_fixed_base_table_length(wbits, g1_mul_table_windows(wbits));
+}
+
+/**
+ * The size in bytes of the scratch space required by #g1_mul_precomputed.
+ *
+ * @param[in] wbits The window size in bits, between 2 and 8
+ * @return The number of bytes of scratch space needed
+ */
+size_t g1_mul_table_scratch_sizeof(unsigned int wbits) {
+    return g1_fixed_base_scratch_sizeof(g1_mul_table_windows(wbits));
+}
+
+/**
+ * Build a table for multiplying a fixed G1 group element by many different field elements.
+ *
+ * The table holds window tables for each of the points `[2^(j * (wbits - 1))]p`, so that #g1_mul_precomputed needs
+ * only one addition per window and no doublings.
+ *
+ * @param[out] table The precomputed table, length #g1_mul_table_length(@p wbits)
+ * @param[in]  wbits The window size in bits, between 2 and 8
+ * @param[in]  p     The point to be multiplied
+ */
+void g1_mul_precompute(g1_affine_t *table, unsigned int wbits, const g1_t *p) {
+    uint64_t windows = g1_mul_table_windows(wbits);
+    g1_t bases[255];
+    g1_affine_t bases_affine[255];
+
+    bases[0] = *p;
+    for (uint64_t j = 1; j < windows; j++) {
+        g1_dbl(&bases[j], &bases[j - 1]);
+        for (unsigned int k = 1; k < wbits - 1; k++) {
+            g1_dbl(&bases[j], &bases[j]);
+        }
     }
+
+    g1_array_to_affine(bases_affine, bases, windows);
+    g1_fixed_base_precompute(table, wbits, bases_affine, windows);
+}
+
+/**
+ * Multiply a fixed G1 group element by a field element using a table built by #g1_mul_precompute.
+ *
+ * @remark No memory is allocated here: the caller provides the scratch area.
+ *
+ * @param[out] out     [@p b]`p`, where `p` is the point the table was built for
+ * @param[in]  table   The table previously built by #g1_mul_precompute
+ * @param[in]  wbits   The window size that @p table was built with
+ * @param[in]  b       The multiplier
+ * @param      scratch Scratch space of at least #g1_mul_table_scratch_sizeof(@p wbits) bytes
+ */
+void g1_mul_precomputed(g1_t *out, const g1_affine_t *table, unsigned int wbits, const fr_t *b, void *scratch) {
+    uint64_t windows = g1_mul_table_windows(wbits), bits = wbits - 1;
+    byte digits[255];
+    blst_scalar s;
+
+    STAT_COUNT(G1_MUL, 1);
+    blst_scalar_from_fr(&s, b);
+
+    // Split the scalar into one byte per window. Each digit is less than 2^(wbits - 1), so the multi-scalar
+    // multiplication, which reads `wbits` bits per scalar, sees a zero top bit and never needs to borrow.
+    for (uint64_t j = 0; j < windows; j++) {
+        uint64_t offset = j * bits, byte_offset = offset / 8;
+        unsigned int v = s.b[byte_offset];
+        if (byte_offset + 1 < sizeof s.b) v |= (unsigned int)s.b[byte_offset + 1] << 8;
+        digits[j] = (v >> (offset % 8)) & ((1 << bits) - 1);
+    }
+
+    const byte *digits_arg[2] = {digits, NULL};
+    blst_p1s_mult_wbits(out, table, wbits, windows, digits_arg, bits, scratch);
+}
+
+/**
+ * Serialise a G1 group element in the standard 48-byte compressed form.
+ *
+ * @param[out] out The compressed point
+ * @param[in]  a   The point to be serialised
+ */
+void g1_compress(byte out[48], const g1_t *a) {
+    blst_p1_compress(out, a);
+}
+
+/**
+ * Deserialise a G1 group element from the standard 48-byte compressed form.
+ *
+ * The point is checked to be a valid encoding of a point on the curve, and to be in the G1 subgroup. These are
+ * relatively expensive checks, so callers decoding many points may want to do so in parallel.
+ *
+ * @param[out] out The point
+ * @param[in]  in  The compressed point
+ * @retval true  The point is valid
+ * @retval false The encoding is invalid, or the point is not in G1
+ */
+bool g1_decompress(g1_t *out, const byte in[48]) {
+    blst_p1_affine affine;
+    if (blst_p1_uncompress(&affine, in) != BLST_SUCCESS) return false;
+    if (!blst_p1_affine_in_g1(&affine)) return false;
+    blst_p1_from_affine(out, &affine);
+    return true;
+}
+
+/**
+ * Serialise a G2 group element in the standard 96-byte compressed form.
+ *
+ * @param[out] out The compressed point
+ * @param[in]  a   The point to be serialised
+ */
+void g2_compress(byte out[96], const g2_t *a) {
+    blst_p2_compress(out, a);
+}
+
+/**
+ * Deserialise a G2 group element from the standard 96-byte compressed form.
+ *
+ * As for #g1_decompress.
+ *
+ * @param[out] out The point
+ * @param[in]  in  The compressed point
+ * @retval true  The point is valid
+ * @retval false The encoding is invalid, or the point is not in G2
+ */
+bool g2_decompress(g2_t *out, const byte in[96]) {
+    blst_p2_affine affine;
+    if (blst_p2_uncompress(&affine, in) != BLST_SUCCESS) return false;
+    if (!blst_p2_affine_in_g2(&affine)) return false;
+    blst_p2_from_affine(out, &affine);
+    return true;
+}
+
+/**
+ * Compute the SHA-256 hash of a message.
+ *
+ * @param[out] out     The 32-byte digest
+ * @param[in]  msg     The message to be hashed
+ * @param[in]  msg_len The length of @p msg in bytes
+ */
+void hash_sha256(byte out[32], const byte *msg, size_t msg_len) {
+    blst_sha256(out, msg, msg_len);
 }
 
 /**
@@ -466,6 +777,8 @@ bool pairings_verify(const g1_t *a1, const g2_t *a2, const g1_t *b1, const g2_t
     blst_p1_affine aa1, bb1;
     blst_p2_affine aa2, bb2;
 
+    STAT_COUNT(PAIRINGS, 2);
+
     // As an optimisation, we want to invert one of the pairings,
     // so we negate one of the points.
     g1_t a1neg = *a1;
@@ -585,6 +898,86 @@ void fr_div_by_zero(void) {
     TEST_CHECK(fr_is_zero(&tmp));
 }
 
+void fr_batch_inv_works(void) {
+    fr_t a[32], inv[32], expected;
+
+    for (int i = 0; i < 32; i++) {
+        fr_from_uint64(&a[i], i % 5 == 0 ? 0 : 1000 + i * i);
+    }
+    fr_batch_inv(inv, a, 32);
+    for (int i = 0; i < 32; i++) {
+        fr_inv(&expected, &a[i]);
+        TEST_CHECK(fr_equal(&expected, &inv[i]));
+        TEST_MSG("Mismatch at %d", i);
+    }
+
+    // All zeros, and the empty array
+    for (int i = 0; i < 4; i++) {
+        a[i] = fr_zero;
+    }
+    fr_batch_inv(inv, a, 4);
+    for (int i = 0; i < 4; i++) {
+        TEST_CHECK(fr_is_zero(&inv[i]));
+    }
+    fr_batch_inv(inv, a, 0);
+}
+
+void fr_vec_ops_match_scalar(void) {
+    fr_t a[17], b[17], roots[34], out[17], a2[17], b2[17], x, expected, tmp, power = fr_one;
+
+    for (int i = 0; i < 17; i++) {
+        a[i] = rand_fr();
+        b[i] = rand_fr();
+        roots[2 * i] = rand_fr();
+        roots[2 * i + 1] = rand_fr();
+    }
+    x = rand_fr();
+
+    fr_mul_vec(out, a, b, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_mul(&expected, &a[i], &b[i]);
+        TEST_CHECK(fr_equal(&expected, &out[i]));
+    }
+    fr_add_vec(out, a, b, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_add(&expected, &a[i], &b[i]);
+        TEST_CHECK(fr_equal(&expected, &out[i]));
+    }
+    fr_scale_vec(out, a, &x, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_mul(&expected, &a[i], &x);
+        TEST_CHECK(fr_equal(&expected, &out[i]));
+    }
+    fr_mul_powers_vec(out, a, &x, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_mul(&expected, &a[i], &power);
+        TEST_CHECK(fr_equal(&expected, &out[i]));
+        fr_mul(&power, &power, &x);
+    }
+
+    // In place, and with a strided twiddle
+    for (int i = 0; i < 17; i++) {
+        a2[i] = a[i];
+        b2[i] = b[i];
+    }
+    fr_butterfly_vec(a2, b2, roots, 2, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_mul(&tmp, &b[i], &roots[2 * i]);
+        fr_add(&expected, &a[i], &tmp);
+        TEST_CHECK(fr_equal(&expected, &a2[i]));
+        fr_sub(&expected, &a[i], &tmp);
+        TEST_CHECK(fr_equal(&expected, &b2[i]));
+    }
+    for (int i = 0; i < 17; i++) {
+        a2[i] = a[i];
+    }
+    fr_mul_vec(a2, a2, b, 17);
+    for (int i = 0; i < 17; i++) {
+        fr_mul(&expected, &a[i], &b[i]);
+        TEST_CHECK(fr_equal(&expected, &a2[i]));
+    }
+}
+
 void fr_uint64s_roundtrip(void) {
     fr_t fr;
     uint64_t expected[4] = {1, 2, 3, 4};
@@ -675,7 +1068,7 @@ void g1_make_linear_combination(void) {
     g1_mul(&exp, &g1_generator, &tmp);
 
     // Test result
-    g1_linear_combination(&res, p, coeffs, len);
+    TEST_CHECK(C_KZG_OK == g1_linear_combination(&res, p, coeffs, len));
     TEST_CHECK(g1_equal(&exp, &res));
 }
 
@@ -698,10 +1091,114 @@ void g1_random_linear_combination(void) {
 
     // Test result
     g1_t res;
-    g1_linear_combination(&res, p, coeffs, len);
+    TEST_CHECK(C_KZG_OK == g1_linear_combination(&res, p, coeffs, len));
     TEST_CHECK(g1_equal(&exp, &res));
 }
 
+void g1_affine_linear_combination_works(void) {
+    int len = 100;
+    fr_t coeffs[len];
+    g1_t p[len], exp, res;
+    g1_affine_t p_affine[len];
+    scalar_t scalars[len];
+    for (int i = 0; i < len; i++) {
+        coeffs[i] = rand_fr();
+        p[i] = rand_g1();
+    }
+
+    void *scratch = malloc(g1_linear_combination_scratch_sizeof(len));
+    g1_array_to_affine(p_affine, p, len);
+
+    // Covers both the direct method and Pippenger
+    int lengths[] = {0, 1, 7, 8, 50, 100};
+    for (int j = 0; j < sizeof lengths / sizeof lengths[0]; j++) {
+        int n = lengths[j];
+        TEST_CHECK(C_KZG_OK == g1_linear_combination(&exp, p, coeffs, n));
+        g1_affine_linear_combination(&res, p_affine, coeffs, n, scalars, scratch);
+        TEST_CHECK(g1_equal(&exp, &res));
+        TEST_MSG("Failed for n = %d", n);
+    }
+
+    free(scratch);
+}
+
+void g1_fixed_base_linear_combination_works(void) {
+    int len = 100;
+    unsigned int wbits = 4;
+    fr_t coeffs[len];
+    g1_t p[len], exp, res;
+    g1_affine_t p_affine[len];
+    scalar_t scalars[len];
+    for (int i = 0; i < len; i++) {
+        coeffs[i] = rand_fr();
+        p[i] = rand_g1();
+    }
+
+    g1_affine_t *table = malloc(g1_fixed_base_table_length(wbits, len) * sizeof(g1_affine_t));
+    void *scratch = malloc(g1_fixed_base_scratch_sizeof(len));
+    g1_array_to_affine(p_affine, p, len);
+    g1_fixed_base_precompute(table, wbits, p_affine, len);
+
+    // The table for all the points also works for any leading subset of them
+    for (int n = 0; n <= len; n += 25) {
+        TEST_CHECK(C_KZG_OK == g1_linear_combination(&exp, p, coeffs, n));
+        g1_fixed_base_linear_combination(&res, table, wbits, coeffs, n, scalars, scratch);
+        TEST_CHECK(g1_equal(&exp, &res));
+        TEST_MSG("Failed for n = %d", n);
+    }
+
+    free(table);
+    free(scratch);
+}
+
+void compress_round_trip(void) {
+    g1_t a1 = rand_g1(), b1;
+    g2_t a2, b2;
+    fr_t r = rand_fr();
+    byte c1[48], c2[96];
+
+    g2_mul(&a2, &g2_generator, &r);
+
+    g1_compress(c1, &a1);
+    TEST_CHECK(g1_decompress(&b1, c1));
+    TEST_CHECK(g1_equal(&a1, &b1));
+
+    g2_compress(c2, &a2);
+    TEST_CHECK(g2_decompress(&b2, c2));
+    TEST_CHECK(g2_equal(&a2, &b2));
+
+    // The top bit flags the compressed form
+    c1[0] &= 0x7f;
+    TEST_CHECK(!g1_decompress(&b1, c1));
+    c2[0] &= 0x7f;
+    TEST_CHECK(!g2_decompress(&b2, c2));
+}
+
+void g1_mul_precomputed_works(void) {
+    g1_t p = rand_g1(), exp, res;
+    fr_t b[5];
+
+    b[0] = fr_zero;
+    b[1] = fr_one;
+    fr_negate(&b[2], &fr_one);
+    b[3] = rand_fr();
+    b[4] = rand_fr();
+
+    for (unsigned int wbits = 2; wbits <= 8; wbits++) {
+        g1_affine_t *table = malloc(g1_mul_table_length(wbits) * sizeof(g1_affine_t));
+        void *scratch = malloc(g1_mul_table_scratch_sizeof(wbits));
+        g1_mul_precompute(table, wbits, &p);
+        for (int i = 0; i < sizeof b / sizeof b[0]; i++) {
+            g1_mul(&exp, &p, &b[i]);
+            g1_mul_precomputed(&res, table, wbits, &b[i], scratch);
+            TEST_CHECK(g1_equal(&exp, &res));
+            TEST_MSG("Failed for wbits = %u, multiplier %d", wbits, i);
+        }
+        free(table);
+        free(scratch);
+    }
+}
+
 void pairings_work(void) {
     // Verify that e([3]g1, [5]g2) = e([5]g1, [3]g2)
     fr_t three, five;
@@ -733,6 +1230,8 @@ TEST_LIST = {
     {"fr_pow_works", fr_pow_works},
     {"fr_div_works", fr_div_works},
     {"fr_div_by_zero", fr_div_by_zero},
+    {"fr_batch_inv_works", fr_batch_inv_works},
+    {"fr_vec_ops_match_scalar", fr_vec_ops_match_scalar},
     {"fr_uint64s_roundtrip", fr_uint64s_roundtrip},
     {"p1_mul_works", p1_mul_works},
     {"p1_sub_works", p1_sub_works},
@@ -743,6 +1242,10 @@ TEST_LIST = {
     {"g1_identity_is_identity", g1_identity_is_identity},
     {"g1_make_linear_combination", g1_make_linear_combination},
     {"g1_random_linear_combination", g1_make_linear_combination},
+    {"g1_affine_linear_combination_works", g1_affine_linear_combination_works},
+    {"g1_fixed_base_linear_combination_works", g1_fixed_base_linear_combination_works},
+    {"g1_mul_precomputed_works", g1_mul_precomputed_works},
+    {"compress_round_trip", compress_round_trip},
     {"pairings_work", pairings_work},
     {NULL, NULL} /* zero record marks the end of the list */
 };
@@ -23,6 +23,7 @@
 #ifndef BLS12_381_H
 #define BLS12_381_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -41,6 +42,7 @@ typedef blst_fr fr_t;         /**< Internal Fr field element type */
 typedef blst_fp fp_t;         /**< Internal Fp field element type (used only for debugging) */
 typedef blst_fp2 fp2_t;       /**< Internal Fp2 field element type (used only for debugging) */
 typedef blst_p1 g1_t;         /**< Internal G1 group element type */
+typedef blst_p1_affine g1_affine_t; /**< Internal G1 group element type, affine coordinates */
 typedef blst_p2 g2_t;         /**< Internal G2 group element type */
 
 /** The zero field element */
@@ -101,27 +103,44 @@ static const g2_t g2_negative_generator = {{{{0xf5f28fa202940a10L, 0xb3f5fb2687b
 
 #endif // BLST
 
+/**
+ * Building with `KZG_INLINE` defined makes the simplest field and G1 wrappers inline, so that the loops calling them
+ * compile to direct calls into the library. The functions are the same either way, and bls12_381.c always provides
+ * their external definitions.
+ */
+#ifdef KZG_INLINE
+#define KZG_INLINE_FN inline
+#else
+#define KZG_INLINE_FN
+#endif
+
 // All the functions in the interface
-bool fr_is_zero(const fr_t *p);
-bool fr_is_one(const fr_t *p);
-bool fr_is_null(const fr_t *p);
+KZG_INLINE_FN bool fr_is_zero(const fr_t *p);
+KZG_INLINE_FN bool fr_is_one(const fr_t *p);
+KZG_INLINE_FN bool fr_is_null(const fr_t *p);
 void fr_from_scalar(fr_t *out, const scalar_t *a);
 void fr_from_uint64s(fr_t *out, const uint64_t vals[4]);
 void fr_from_uint64(fr_t *out, uint64_t n);
 void fr_to_uint64s(uint64_t out[4], const fr_t *fr);
-bool fr_equal(const fr_t *aa, const fr_t *bb);
-void fr_negate(fr_t *out, const fr_t *in);
-void fr_add(fr_t *out, const fr_t *a, const fr_t *b);
-void fr_sub(fr_t *out, const fr_t *a, const fr_t *b);
-void fr_mul(fr_t *out, const fr_t *a, const fr_t *b);
+KZG_INLINE_FN bool fr_equal(const fr_t *aa, const fr_t *bb);
+KZG_INLINE_FN void fr_negate(fr_t *out, const fr_t *in);
+KZG_INLINE_FN void fr_add(fr_t *out, const fr_t *a, const fr_t *b);
+KZG_INLINE_FN void fr_sub(fr_t *out, const fr_t *a, const fr_t *b);
+KZG_INLINE_FN void fr_mul(fr_t *out, const fr_t *a, const fr_t *b);
 void fr_inv(fr_t *out, const fr_t *a);
 void fr_div(fr_t *out, const fr_t *a, const fr_t *b);
-void fr_sqr(fr_t *out, const fr_t *a);
+void fr_batch_inv(fr_t *out, const fr_t *a, uint64_t len);
+void fr_mul_vec(fr_t *out, const fr_t *a, const fr_t *b, uint64_t n);
+void fr_add_vec(fr_t *out, const fr_t *a, const fr_t *b, uint64_t n);
+void fr_scale_vec(fr_t *out, const fr_t *a, const fr_t *s, uint64_t n);
+void fr_mul_powers_vec(fr_t *out, const fr_t *a, const fr_t *x, uint64_t n);
+void fr_butterfly_vec(fr_t *a, fr_t *b, const fr_t *roots, uint64_t roots_stride, uint64_t n);
+KZG_INLINE_FN void fr_sqr(fr_t *out, const fr_t *a);
 void fr_pow(fr_t *out, const fr_t *a, uint64_t n);
-bool g1_is_inf(const g1_t *a);
-void g1_dbl(g1_t *out, const g1_t *a);
-void g1_add_or_dbl(g1_t *out, const g1_t *a, const g1_t *b);
-bool g1_equal(const g1_t *a, const g1_t *b);
+KZG_INLINE_FN bool g1_is_inf(const g1_t *a);
+KZG_INLINE_FN void g1_dbl(g1_t *out, const g1_t *a);
+KZG_INLINE_FN void g1_add_or_dbl(g1_t *out, const g1_t *a, const g1_t *b);
+KZG_INLINE_FN bool g1_equal(const g1_t *a, const g1_t *b);
 void g1_mul(g1_t *out, const g1_t *a, const fr_t *b);
 void g1_sub(g1_t *out, const g1_t *a, const g1_t *b);
 bool g2_equal(const g2_t *a, const g2_t *b);
@@ -129,7 +148,30 @@ void g2_mul(g2_t *out, const g2_t *a, const fr_t *b);
 void g2_add_or_dbl(g2_t *out, const g2_t *a, const g2_t *b);
 void g2_sub(g2_t *out, const g2_t *a, const g2_t *b);
 void g2_dbl(g2_t *out, const g2_t *a);
-void g1_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, const uint64_t len);
+void g1_set_pippenger_min(uint64_t len);
+size_t g1_linear_combination_scratch_sizeof(uint64_t len);
+void g1_affine_linear_combination(g1_t *out, const g1_affine_t *p, const fr_t *coeffs, uint64_t len, scalar_t *scalars,
+                                  void *scratch);
+void g1_from_affine(g1_t *out, const g1_affine_t *in);
+void g1_array_to_affine(g1_affine_t *out, const g1_t *in, uint64_t len);
+uint64_t g1_fixed_base_table_length(unsigned int wbits, uint64_t len);
+size_t g1_fixed_base_scratch_sizeof(uint64_t len);
+void g1_fixed_base_precompute(g1_affine_t *table, unsigned int wbits, const g1_affine_t *p, uint64_t len);
+void g1_fixed_base_linear_combination(g1_t *out, const g1_affine_t *table, unsigned int wbits, const fr_t *coeffs,
+                                      uint64_t len, scalar_t *scalars, void *scratch);
+uint64_t g1_mul_table_length(unsigned int wbits);
+size_t g1_mul_table_scratch_sizeof(unsigned int wbits);
+void g1_mul_precompute(g1_affine_t *table, unsigned int wbits, const g1_t *p);
+void g1_mul_precomputed(g1_t *out, const g1_affine_t *table, unsigned int wbits, const fr_t *b, void *scratch);
+void g1_compress(byte out[48], const g1_t *a);
+bool g1_decompress(g1_t *out, const byte in[48]);
+void g2_compress(byte out[96], const g2_t *a);
+bool g2_decompress(g2_t *out, const byte in[96]);
+void hash_sha256(byte out[32], const byte *msg, size_t msg_len);
 bool pairings_verify(const g1_t *a1, const g2_t *a2, const g1_t *b1, const g2_t *b2);
 
+#ifdef KZG_INLINE
+#include "bls12_381_inline.h"
+#endif
+
 #endif // BLS12_381_H
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bls12_381_inline.h
+ *
+ * The field and G1 wrappers that sit in the inner loops of the FFTs, recovery and extension.
+ *
+ * With `KZG_INLINE` defined these are C99 inline definitions, included by bls12_381.h so that every caller can inline
+ * them, and bls12_381.c emits their single external definitions. Otherwise they are ordinary functions compiled only in
+ * bls12_381.c. Either way, they must not refer to the `static` constants in bls12_381.h.
+ */
+
+#ifndef KZG_INLINE_FN
+#error "Include bls12_381.h rather than this file"
+#endif
+
+/**
+ * Test whether the operand is zero in the finite field.
+ *
+ * @param p The field element to be checked
+ * @retval true The element is zero
+ * @retval false The element is non-zero
+ *
+ * @todo See if there is a more efficient way to check for zero in the finite field.
+ */
+KZG_INLINE_FN bool fr_is_zero(const fr_t *p) {
+    uint64_t a[4];
+    blst_uint64_from_fr(a, p);
+    return a[0] == 0 && a[1] == 0 && a[2] == 0 && a[3] == 0;
+}
+
+/**
+ * Test whether the operand is one in the finite field.
+ *
+ * @param p The field element to be checked
+ * @retval true The element is one
+ * @retval false The element is not one
+ *
+ * @todo See if there is a more efficient way to check for one in the finite field.
+ */
+KZG_INLINE_FN bool fr_is_one(const fr_t *p) {
+    uint64_t a[4];
+    blst_uint64_from_fr(a, p);
+    return a[0] == 1 && a[1] == 0 && a[2] == 0 && a[3] == 0;
+}
+
+/**
+ * Test whether the operand is a specially defined NULL value.
+ *
+ * @param p The field element to be checked
+ * @retval true The element is the NULL value
+ * @retval false The element is not the NULL value
+ */
+KZG_INLINE_FN bool fr_is_null(const fr_t *p) {
+    const uint64_t *a = (const uint64_t *)p;
+    return a[0] == UINT64_MAX && a[1] == UINT64_MAX && a[2] == UINT64_MAX && a[3] == UINT64_MAX;
+}
+
+/**
+ * Test whether two field elements are equal.
+ *
+ * @param[in] aa The first element
+ * @param[in] bb The second element
+ * @retval true if @p aa and @p bb are equal
+ * @retval false otherwise
+ */
+KZG_INLINE_FN bool fr_equal(const fr_t *aa, const fr_t *bb) {
+    uint64_t a[4], b[4];
+    blst_uint64_from_fr(a, aa);
+    blst_uint64_from_fr(b, bb);
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+/**
+ * Negate a field element.
+ *
+ * @param[out] out The negation of @p in
+ * @param[in]  in  The element to be negated
+ */
+KZG_INLINE_FN void fr_negate(fr_t *out, const fr_t *in) {
+    blst_fr_cneg(out, in, true);
+}
+
+/**
+ * Add two field elements.
+ *
+ * @param[out] out @p a plus @p b in the field
+ * @param[in]  a   Field element
+ * @param[in]  b   Field element
+ */
+KZG_INLINE_FN void fr_add(fr_t *out, const fr_t *a, const fr_t *b) {
+    blst_fr_add(out, a, b);
+}
+
+/**
+ * Subtract one field element from another.
+ *
+ * @param[out] out @p a minus @p b in the field
+ * @param[in]  a   Field element
+ * @param[in]  b   Field element
+ */
+KZG_INLINE_FN void fr_sub(fr_t *out, const fr_t *a, const fr_t *b) {
+    blst_fr_sub(out, a, b);
+}
+
+/**
+ * Multiply two field elements.
+ *
+ * @param[out] out @p a multiplied by @p b in the field
+ * @param[in]  a   Multiplicand
+ * @param[in]  b   Multiplier
+ */
+KZG_INLINE_FN void fr_mul(fr_t *out, const fr_t *a, const fr_t *b) {
+    blst_fr_mul(out, a, b);
+}
+
+/**
+ * Square a field element.
+ *
+ * @param[out] out @p a squared
+ * @param[in]  a   A field element
+ */
+KZG_INLINE_FN void fr_sqr(fr_t *out, const fr_t *a) {
+    blst_fr_sqr(out, a);
+}
+
+/**
+ * Test G1 point for being infinity/the identity.
+ *
+ * @param[in] a A G1 point
+ * @retval true if @p a is the identity point in G1
+ * @retval false otherwise
+ */
+KZG_INLINE_FN bool g1_is_inf(const g1_t *a) {
+    return blst_p1_is_inf(a);
+}
+
+/**
+ * Double a G1 point.
+ *
+ * @param[out] out @p a plus @p a in the group
+ * @param[in]  a   G1 group point
+ */
+KZG_INLINE_FN void g1_dbl(g1_t *out, const g1_t *a) {
+    blst_p1_double(out, a);
+}
+
+/**
+ * Add or double G1 points.
+ *
+ * This is safe if the two points are the same.
+ *
+ * @param[out] out @p a plus @p b in the group
+ * @param[in]  a   G1 group point
+ * @param[in]  b   G1 group point
+ */
+KZG_INLINE_FN void g1_add_or_dbl(g1_t *out, const g1_t *a, const g1_t *b) {
+    blst_p1_add_or_double(out, a, b);
+}
+
+/**
+ * Test G1 points for equality.
+ *
+ * @param[in] a A G1 point
+ * @param[in] b A G1 point
+ * @retval true if @p a and @p b are the same point
+ * @retval false otherwise
+ */
+KZG_INLINE_FN bool g1_equal(const g1_t *a, const g1_t *b) {
+    return blst_p1_is_equal(a, b);
+}
@@ -23,7 +23,9 @@
 #ifndef C_KZG_H
 #define C_KZG_H
 
+#include <stdio.h> // FILE
 #include "bls12_381.h"
+#include "stats.h"
 
 /**
  * The common return type for all routines in which something can go wrong.
@@ -41,23 +43,119 @@ typedef enum {
     C_KZG_MALLOC,  /**< Could not allocate memory */
 } C_KZG_RET;
 
+//
+// bls12_381.c
+//
+
+C_KZG_RET g1_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, const uint64_t len);
+
+//
+// c_kzg_alloc.c
+//
+
+/**
+ * A bump allocator for the short-lived buffers of the library's routines.
+ *
+ * While an arena is active on a thread (between #arena_begin and #arena_end), the field element and G1 arrays that the
+ * library allocates on that thread, including polynomial coefficients, are carved out of the arena rather than taken
+ * from the heap, and "freeing" them costs nothing. All the memory is then reclaimed at once with #arena_reset.
+ * Allocations that do not fit fall back to the heap, so an arena that is too small is only slower.
+ *
+ * @remark Only scope an arena around operations, not around making settings or workspaces that must outlive the
+ * next reset. Memory from an arena must not be freed once the arena is no longer active.
+ *
+ * Initialise with #new_arena. Free after use with #free_arena.
+ */
+typedef struct Arena {
+    byte *base;          /**< The memory, aligned to #ARENA_ALIGN bytes */
+    size_t size;         /**< The size of `base` in bytes */
+    size_t used;         /**< The number of bytes given out since the last reset */
+    size_t peak;         /**< The largest that `used` has been, for sizing the arena */
+    uint64_t overflows;  /**< The number of allocations that did not fit and came from the heap instead */
+    struct Arena *outer; /**< The arena that was active when this one was begun, restored by #arena_end */
+} Arena;
+
+/** The alignment in bytes of every allocation from an #Arena, suitable for vector loads. */
+#define ARENA_ALIGN 64
+
+C_KZG_RET new_arena(Arena *a, size_t size);
+void arena_begin(Arena *a);
+void arena_end(Arena *a);
+void arena_reset(Arena *a);
+void free_arena(Arena *a);
+
+//
+// thread_pool.c
+//
+
+/**
+ * A unit of parallel work: performs item @p i of the job described by @p arg.
+ */
+typedef void (*pool_task_t)(void *arg, uint64_t i);
+
+/**
+ * An executor for running independent tasks in parallel.
+ *
+ * Callers may wrap their own scheduler by filling in the fields directly, or use the POSIX threads implementation
+ * provided by #new_thread_pool. Routines that accept a pool treat NULL as "run serially on the calling thread".
+ */
+typedef struct {
+    void (*run)(void *ctx, pool_task_t task, void *arg, uint64_t n); /**< Runs `task(arg, i)` for `0 <= i < n` and
+                                                                        returns when all have completed */
+    void *ctx;            /**< Passed as the first argument to `run` */
+    unsigned int threads; /**< The number of threads available to `run`, used to decide how to split up work */
+} ThreadPool;
+
+void pool_run(const ThreadPool *pool, pool_task_t task, void *arg, uint64_t n);
+unsigned int pool_threads(const ThreadPool *pool);
+C_KZG_RET new_thread_pool(ThreadPool *pool, unsigned int threads);
+void free_thread_pool(ThreadPool *pool);
+
 //
 // fft_common.c
 //
 
+/**
+ * The smallest field element FFT for which the iterative engine is used (a tunable parameter).
+ *
+ * Below this the data fits comfortably in cache and the recursive #fft_fr_fast is at least as quick.
+ */
+#define FFT_FR_ITERATIVE_MIN_WIDTH (1 << 12)
+
+/**
+ * The per-size tables of roots of unity built on demand for settings made by #new_fft_settings_lazy.
+ */
+typedef struct FFTRootCache FFTRootCache;
+
 /**
  * Stores the setup and parameters needed for performing FFTs.
  *
- * Initialise with #new_fft_settings. Free after use with #free_fft_settings.
+ * Initialise with #new_fft_settings, or #new_fft_settings_lazy. Free after use with #free_fft_settings.
+ *
+ * Lazy settings have none of the tables below, so code that needs roots of unity directly must get them with
+ * #fft_roots, which works for either kind of settings.
  */
 typedef struct {
-    uint64_t max_width;            /**< The maximum size of FFT these settings support, a power of 2. */
-    fr_t root_of_unity;            /**< The root of unity used to generate the lists in the structure. */
-    fr_t *expanded_roots_of_unity; /**< Ascending powers of the root of unity, size `width + 1`. */
-    fr_t *reverse_roots_of_unity;  /**< Descending powers of the root of unity, size `width + 1`. */
+    uint64_t max_width;                 /**< The maximum size of FFT these settings support, a power of 2. */
+    fr_t root_of_unity;                 /**< The root of unity used to generate the lists in the structure. */
+    fr_t *expanded_roots_of_unity;      /**< Ascending powers of the root of unity, size `width + 1`. */
+    fr_t *reverse_roots_of_unity;       /**< Descending powers of the root of unity, size `width + 1`. */
+    fr_t *stage_roots_of_unity;         /**< Roots for each stage of #fft_fr_iterative, size `width`, or NULL if
+                                             `width` is less than #FFT_FR_ITERATIVE_MIN_WIDTH. */
+    fr_t *reverse_stage_roots_of_unity; /**< As `stage_roots_of_unity`, but for inverse FFTs. */
+    const ThreadPool *pool;             /**< Optional thread pool for large G1 FFTs, NULL to run serially. */
+    FFTRootCache *cache;                /**< The tables built so far if made by #new_fft_settings_lazy, or NULL. */
 } FFTSettings;
 
 C_KZG_RET new_fft_settings(FFTSettings *s, unsigned int max_scale);
+C_KZG_RET new_fft_settings_parallel(FFTSettings *fs, unsigned int max_scale, const ThreadPool *pool);
+C_KZG_RET new_fft_settings_lazy(FFTSettings *fs, unsigned int max_scale);
+C_KZG_RET fft_roots(const fr_t **roots, uint64_t *stride, uint64_t n, const FFTSettings *fs);
+C_KZG_RET fft_stage_roots(const fr_t **roots, uint64_t n, const FFTSettings *fs);
+C_KZG_RET borrow_fft_settings(const FFTSettings **fs);
+void release_fft_settings(const FFTSettings *fs);
+C_KZG_RET warm_fft_settings_cache(unsigned int max_scale);
+C_KZG_RET free_fft_settings_cache(void);
 void free_fft_settings(FFTSettings *s);
 
 //
@@ -65,12 +163,15 @@ void free_fft_settings(FFTSettings *s);
 //
 
 C_KZG_RET fft_fr(fr_t *out, const fr_t *in, bool inverse, uint64_t n, const FFTSettings *fs);
+C_KZG_RET fft_fr_coset(fr_t *out, const fr_t *in, bool inverse, const fr_t *shift, uint64_t n,
+                       const FFTSettings *fs);
 
 //
 // fft_g1.c
 //
 
 C_KZG_RET fft_g1(g1_t *out, const g1_t *in, bool inverse, uint64_t n, const FFTSettings *fs);
+C_KZG_RET fft_g1_bit_reversed(g1_t *out, const g1_t *in, uint64_t n, const FFTSettings *fs);
 
 //
 // poly.c
@@ -89,7 +190,7 @@ typedef struct {
 void eval_poly(fr_t *out, const poly *p, const fr_t *x);
 C_KZG_RET poly_inverse(poly *out, poly *b);
 C_KZG_RET poly_mul(poly *out, const poly *a, const poly *b);
-C_KZG_RET poly_mul_(poly *out, const poly *a, const poly *b, FFTSettings *fs);
+C_KZG_RET poly_mul_(poly *out, const poly *a, const poly *b, const FFTSettings *fs);
 C_KZG_RET new_poly_div(poly *out, const poly *dividend, const poly *divisor);
 C_KZG_RET new_poly(poly *out, uint64_t length);
 C_KZG_RET new_poly_with_coeffs(poly *out, const fr_t *coeffs, uint64_t length);
@@ -99,66 +200,193 @@ void free_poly(poly *p);
 // kzg_proofs.c
 //
 
+/**
+ * Reusable buffers for computing multi-scalar multiplications, such as commitments, without allocating memory.
+ *
+ * Initialise with #new_msm_workspace. Free after use with #free_msm_workspace.
+ */
+typedef struct {
+    uint64_t length;     /**< The maximum number of points in a linear combination */
+    unsigned int parts;  /**< The maximum number of parts a linear combination may be split into for parallel work */
+    g1_affine_t *points; /**< Space for `length` points in affine form */
+    scalar_t *scalars;   /**< Space for `length` scalars */
+    g1_t *partials;      /**< Space for the result of each of the `parts` */
+    byte *scratch;       /**< Scratch space for the underlying multi-scalar multiplication */
+    size_t scratch_len;  /**< The size of `scratch` in bytes */
+    fr_t *quotient;      /**< Space for `2 * length` field elements, for the quotient in a single-point proof */
+} MSMWorkspace;
+
 /**
  * Stores the setup and parameters needed for computing KZG proofs.
  *
  * Initialise with #new_kzg_settings. Free after use with #free_kzg_settings.
  */
 typedef struct {
-    const FFTSettings *fs; /**< The corresponding settings for performing FFTs */
-    g1_t *secret_g1;       /**< G1 group elements from the trusted setup */
-    g2_t *secret_g2;       /**< G2 group elements from the trusted setup */
-    uint64_t length;       /**< The number of elements in secret_g1 and secret_g2 */
+    const FFTSettings *fs;         /**< The corresponding settings for performing FFTs */
+    g1_t *secret_g1;               /**< G1 group elements from the trusted setup, NULL if stored as affine */
+    g1_affine_t *secret_g1_affine; /**< The same in affine form if converted by #kzg_settings_to_affine, or NULL */
+    g2_t *secret_g2;               /**< G2 group elements from the trusted setup */
+    uint64_t length;               /**< The number of elements in secret_g1 */
+    uint64_t g2_length;            /**< The number of elements in secret_g2 */
+    g1_affine_t *secret_g1_table;  /**< Optional fixed-base tables for secret_g1, see #kzg_settings_precompute */
+    unsigned int wbits;            /**< The window size used for `secret_g1_table`, zero if there is no table */
+    g1_affine_t *secret_lagrange;  /**< Optional secrets in Lagrange form, see #kzg_settings_lagrange */
+    uint64_t lagrange_length;      /**< The number of elements in secret_lagrange, zero if there are none */
+    const ThreadPool *pool;        /**< Optional thread pool for parallel operations, NULL to run serially */
+    MSMWorkspace *workspace;       /**< Optional reusable buffers for commitments, NULL to allocate per call */
+    void *mapping;                 /**< The file mapping holding the secrets if loaded by #load_kzg_settings, or NULL */
+    size_t mapping_len;            /**< The length of `mapping` in bytes */
 } KZGSettings;
 
 C_KZG_RET commit_to_poly(g1_t *out, const poly *p, const KZGSettings *ks);
+C_KZG_RET commit_to_evaluations(g1_t *out, const fr_t *evals, uint64_t n, const KZGSettings *ks);
+C_KZG_RET update_commitment(g1_t *out, const g1_t *commitment, const uint64_t *indices, const fr_t *old_coeffs,
+                            const fr_t *new_coeffs, uint64_t len, const KZGSettings *ks);
+C_KZG_RET update_commitment_evaluations(g1_t *out, const g1_t *commitment, const uint64_t *indices,
+                                        const fr_t *old_evals, const fr_t *new_evals, uint64_t len,
+                                        const KZGSettings *ks);
 C_KZG_RET compute_proof_single(g1_t *out, const poly *p, const fr_t *x0, const KZGSettings *ks);
+C_KZG_RET compute_proofs_at_points(g1_t *out, const poly *p, const fr_t *xs, uint64_t k, const KZGSettings *ks);
+C_KZG_RET compute_proof_single_eval(g1_t *out, fr_t *y, const fr_t *evals, const fr_t *x0, const KZGSettings *ks);
 C_KZG_RET check_proof_single(bool *out, const g1_t *commitment, const g1_t *proof, const fr_t *x, fr_t *y,
                              const KZGSettings *ks);
+C_KZG_RET check_proof_single_batch(bool *out, bool *ok, const g1_t *commitments, const g1_t *proofs, const fr_t *xs,
+                                   const fr_t *ys, uint64_t n, const KZGSettings *ks);
 C_KZG_RET compute_proof_multi(g1_t *out, const poly *p, const fr_t *x0, uint64_t n, const KZGSettings *ks);
 C_KZG_RET check_proof_multi(bool *out, const g1_t *commitment, const g1_t *proof, const fr_t *x, const fr_t *ys,
                             uint64_t n, const KZGSettings *ks);
 C_KZG_RET new_kzg_settings(KZGSettings *ks, const g1_t *secret_g1, const g2_t *secret_g2, uint64_t length,
                            const FFTSettings *fs);
+C_KZG_RET kzg_settings_precompute(KZGSettings *ks, unsigned int wbits);
+C_KZG_RET kzg_settings_to_affine(KZGSettings *ks);
+C_KZG_RET kzg_settings_lagrange(KZGSettings *ks, uint64_t n);
+void kzg_settings_secret_g1(g1_t *out, const KZGSettings *ks, uint64_t i);
 void free_kzg_settings(KZGSettings *ks);
+C_KZG_RET new_msm_workspace(MSMWorkspace *ws, uint64_t length, unsigned int parts);
+void free_msm_workspace(MSMWorkspace *ws);
 
 //
 // fk20_proofs.c
 //
 
+/**
+ * Reusable buffers for computing FK20 proofs without allocating memory.
+ *
+ * Initialise with #new_fk20_workspace. Free after use with #free_fk20_workspace.
+ */
+typedef struct {
+    uint64_t length;           /**< The maximum length of the Toeplitz coefficients */
+    unsigned int parts;        /**< The maximum number of parts the chunks may be split into for parallel work */
+    fr_t *toeplitz_coeffs;     /**< Space for `length` Toeplitz coefficients for each part */
+    fr_t *toeplitz_coeffs_fft; /**< Space for `length` transformed Toeplitz coefficients for each part */
+    g1_t *h_ext_fft_files;     /**< Space for `length` Toeplitz products for each part */
+    g1_t *acc;                 /**< Space for `length` partial sums of the Toeplitz products for each part */
+    g1_t *h;                   /**< Space for `length` elements of `h` */
+    C_KZG_RET *ret;            /**< Space for the result of each of the `parts` */
+    byte *scratch;             /**< Scratch space of `scratch_len` bytes for each part, for the multiplications */
+    size_t scratch_len;        /**< The size of the scratch space for each part in bytes */
+} FK20Workspace;
+
 /**
  * Stores the setup and parameters needed for computing FK20 single proofs.
  *
  * Initialise with #new_fk20_single_settings. Free after use with #free_fk20_single_settings.
  */
 typedef struct {
-    const KZGSettings *ks;  /**< The corresponding settings for performing KZG proofs */
-    g1_t *x_ext_fft;        /**< The output of the first part of the Toeplitz process */
-    uint64_t x_ext_fft_len; /**< The length of the `x_ext_fft_len` array (TODO - do we need this?)*/
+    const KZGSettings *ks;        /**< The corresponding settings for performing KZG proofs */
+    g1_t *x_ext_fft;              /**< The output of the first part of the Toeplitz process */
+    uint64_t x_ext_fft_len;       /**< The length of the `x_ext_fft_len` array (TODO - do we need this?)*/
+    g1_affine_t *x_ext_fft_table; /**< Optional multiplication tables, see #fk20_single_settings_precompute */
+    unsigned int wbits;           /**< The window size used for `x_ext_fft_table`, zero if there is no table */
+    FK20Workspace *workspace;     /**< Optional reusable buffers, NULL to allocate per call */
+    void *mapping;                /**< The file mapping holding the points if loaded from a file, otherwise NULL */
+    size_t mapping_len;           /**< The length of `mapping` in bytes */
 } FK20SingleSettings;
 
 /**
  * Stores the setup and parameters needed for computing FK20 multi proofs.
  */
 typedef struct {
-    const KZGSettings *ks;  /**< The corresponding settings for performing KZG proofs */
-    uint64_t chunk_len;     /**< TODO */
-    g1_t **x_ext_fft_files; /**< TODO */
-    uint64_t length;        /**< TODO */
+    const KZGSettings *ks;              /**< The corresponding settings for performing KZG proofs */
+    uint64_t chunk_len;                 /**< TODO */
+    g1_t **x_ext_fft_files;             /**< TODO */
+    uint64_t length;                    /**< The size `n2` that the settings were initialised for */
+    g1_affine_t *x_ext_fft_files_table; /**< Optional multiplication tables, see #fk20_multi_settings_precompute */
+    unsigned int wbits;                 /**< The window size used for `x_ext_fft_files_table`, zero if no table */
+    FK20Workspace *workspace;           /**< Optional reusable buffers, NULL to allocate per call */
+    void *mapping;                      /**< The file mapping holding the points if loaded from a file, or NULL */
+    size_t mapping_len;                 /**< The length of `mapping` in bytes */
 } FK20MultiSettings;
 
 C_KZG_RET da_using_fk20_single(g1_t *out, const poly *p, const FK20SingleSettings *fk);
 C_KZG_RET da_using_fk20_multi(g1_t *out, const poly *p, const FK20MultiSettings *fk);
+C_KZG_RET da_using_fk20_multi_batch(g1_t *out, const poly *ps, uint64_t count, const FK20MultiSettings *fk);
 C_KZG_RET new_fk20_single_settings(FK20SingleSettings *fk, uint64_t n2, const KZGSettings *ks);
 C_KZG_RET new_fk20_multi_settings(FK20MultiSettings *fk, uint64_t n2, uint64_t chunk_len, const KZGSettings *ks);
 void free_fk20_single_settings(FK20SingleSettings *fk);
 void free_fk20_multi_settings(FK20MultiSettings *fk);
+C_KZG_RET fk20_single_settings_precompute(FK20SingleSettings *fk, unsigned int wbits);
+C_KZG_RET fk20_multi_settings_precompute(FK20MultiSettings *fk, unsigned int wbits);
+C_KZG_RET new_fk20_workspace(FK20Workspace *ws, uint64_t length, unsigned int parts);
+void free_fk20_workspace(FK20Workspace *ws);
+
+//
+// fk20_io.c
+//
+
+C_KZG_RET save_fk20_single_settings(FILE *out, const FK20SingleSettings *fk);
+C_KZG_RET save_fk20_multi_settings(FILE *out, const FK20MultiSettings *fk);
+C_KZG_RET load_fk20_single_settings(FK20SingleSettings *fk, FILE *in, const KZGSettings *ks);
+C_KZG_RET load_fk20_multi_settings(FK20MultiSettings *fk, FILE *in, const KZGSettings *ks);
+
+//
+// trusted_setup.c
+//
+
+C_KZG_RET load_trusted_setup(KZGSettings *ks, FILE *in, const FFTSettings *fs, const ThreadPool *pool);
+C_KZG_RET save_kzg_settings(FILE *out, const KZGSettings *ks);
+C_KZG_RET load_kzg_settings(KZGSettings *ks, FILE *in, const FFTSettings *fs);
 
 //
 // recover.c
 //
 
 C_KZG_RET recover_poly_from_samples(fr_t *reconstructed_data, fr_t *samples, uint64_t len_samples, FFTSettings *fs);
+C_KZG_RET recover_polys_from_samples(fr_t *reconstructed_data, const fr_t *samples, uint64_t len_samples,
+                                     uint64_t n_rows, const uint64_t *missing, uint64_t len_missing,
+                                     const FFTSettings *fs, const ThreadPool *pool);
+
+//
+// recover_stream.c
+//
+
+/**
+ * Reads the @p len field elements starting at element @p offset of some storage managed by the caller into @p out.
+ */
+typedef C_KZG_RET (*fr_reader_t)(void *ctx, fr_t *out, uint64_t offset, uint64_t len);
+
+/**
+ * Writes the @p len field elements of @p in to storage managed by the caller, starting at element @p offset.
+ */
+typedef C_KZG_RET (*fr_writer_t)(void *ctx, const fr_t *in, uint64_t offset, uint64_t len);
+
+/**
+ * The caller's side of a recovery by #recover_poly_from_samples_streaming.
+ *
+ * The backing store must hold `3 * len_samples` field elements, and could be a file, for example. Its initial contents
+ * do not matter.
+ */
+typedef struct {
+    fr_reader_t read_samples; /**< Reads the samples, with `fr_null` for missing values. May be called more than once
+                                   for the same range. */
+    fr_writer_t write_data;   /**< Writes the reconstructed data */
+    fr_reader_t read_store;   /**< Reads from the backing store */
+    fr_writer_t write_store;  /**< Writes to the backing store */
+    void *ctx;                /**< Passed as the first argument to every callback */
+    uint64_t budget;          /**< The number of field elements that may be held in memory at once */
+} RecoverStream;
+
+C_KZG_RET recover_poly_from_samples_streaming(const RecoverStream *io, uint64_t len_samples, const FFTSettings *fs);
 
 //
 // zero_poly.c
@@ -167,17 +395,50 @@ C_KZG_RET recover_poly_from_samples(fr_t *reconstructed_data, fr_t *samples, uin
 C_KZG_RET zero_polynomial_via_multiplication(fr_t *zero_eval, poly *zero_poly, uint64_t width,
                                              const uint64_t *missing_indices, uint64_t len_missing,
                                              const FFTSettings *fs);
+C_KZG_RET zero_polynomial_via_multiplication_parallel(fr_t *zero_eval, poly *zero_poly, uint64_t width,
+                                                      const uint64_t *missing_indices, uint64_t len_missing,
+                                                      const FFTSettings *fs, const ThreadPool *pool);
 
 //
 // das_extension.c
 //
 
 C_KZG_RET das_fft_extension(fr_t *vals, uint64_t n, const FFTSettings *fs);
+C_KZG_RET das_fft_extension_rows(fr_t *vals, uint64_t n, uint64_t n_rows, const FFTSettings *fs,
+                                 const ThreadPool *pool);
+C_KZG_RET das_extend_square(fr_t *extended, g1_t *commitments, g1_t *proofs, const fr_t *data, uint64_t k,
+                            const FFTSettings *fs, const FK20MultiSettings *fk, const ThreadPool *pool);
+
+//
+// tuning.c
+//
+
+/**
+ * The crossover points at which the library switches between algorithms, measured by #kzg_tune.
+ *
+ * The library starts with the defaults from #kzg_tuning_defaults. A profile measured on the host, or loaded with
+ * #load_kzg_tuning, takes effect once passed to #kzg_set_tuning.
+ */
+typedef struct {
+    uint64_t poly_mul_fft_min;   /**< #poly_mul multiplies by FFT when both factors have at least this many terms */
+    uint64_t poly_div_fast_min;  /**< #new_poly_div uses #poly_fast_div for divisors of at least this length */
+    uint64_t msm_pippenger_min;  /**< Linear combinations of at least this many points use Pippenger, at least 2 */
+    uint64_t zero_poly_tree_min; /**< Zero polynomials with at least this many roots are built as a tree */
+} KZGTuning;
+
+void kzg_tuning_defaults(KZGTuning *t);
+const KZGTuning *kzg_tuning(void);
+void kzg_set_tuning(const KZGTuning *t);
+C_KZG_RET kzg_tune(KZGTuning *out, unsigned int max_scale);
+C_KZG_RET save_kzg_tuning(FILE *out, const KZGTuning *t);
+C_KZG_RET load_kzg_tuning(KZGTuning *t, FILE *in);
 
 void fft_fr_slow(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride, uint64_t n);
 
 void fft_fr_fast(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride, uint64_t n);
 
+void fft_fr_iterative(fr_t *out, const fr_t *in, const fr_t *roots, uint64_t n);
+
 void fft_g1_fast(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride, uint64_t n);
 
 void fft_g1_slow(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride, uint64_t n);
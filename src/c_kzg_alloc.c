@@ -20,6 +20,7 @@
  * Utilities for dynamically allocating arrays of things.
  */
 
+#include "control.h"
 #include "c_kzg_alloc.h"
 
 /**
@@ -32,6 +33,8 @@
  */
 static C_KZG_RET c_kzg_malloc(void **x, size_t n) {
     if (n > 0) {
+        STAT_COUNT(ALLOCS, 1);
+        STAT_COUNT(ALLOC_BYTES, n);
         *x = malloc(n);
         return *x != NULL ? C_KZG_OK : C_KZG_MALLOC;
     }
@@ -39,6 +42,145 @@ static C_KZG_RET c_kzg_malloc(void **x, size_t n) {
     return C_KZG_OK;
 }
 
+/** The innermost arena active on this thread, or NULL if allocations come from the heap. */
+static __thread Arena *active_arena = NULL;
+
+/**
+ * Allocate from the active arena if there is one and it has room, otherwise from the heap.
+ *
+ * @param[out] x Pointer to the allocated space
+ * @param[in]  n The number of bytes to be allocated
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET c_kzg_malloc_arena(void **x, size_t n) {
+    Arena *a = active_arena;
+
+    if (a != NULL && n > 0) {
+        size_t rounded = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        if (rounded >= n && rounded <= a->size - a->used) {
+            *x = a->base + a->used;
+            a->used += rounded;
+            STAT_COUNT(ALLOCS, 1);
+            STAT_COUNT(ALLOC_BYTES, n);
+            if (a->used > a->peak) a->peak = a->used;
+            return C_KZG_OK;
+        }
+        a->overflows++;
+    }
+    return c_kzg_malloc(x, n);
+}
+
+/**
+ * Free memory allocated by the functions in this file.
+ *
+ * Memory that came from an arena active on this thread is left for #arena_reset, and anything else is passed to
+ * `free()`. Library code must use this, rather than `free()`, for anything that may have been allocated while an arena
+ * was active.
+ *
+ * @param[in] p The memory to be freed, or NULL
+ */
+void c_kzg_free(void *p) {
+    for (const Arena *a = active_arena; a != NULL; a = a->outer) {
+        if ((byte *)p >= a->base && (byte *)p < a->base + a->size) return;
+    }
+    free(p);
+}
+
+/**
+ * Stop allocating from arenas on this thread, for allocations that must outlive the current arena.
+ *
+ * @return The arenas that were active, to be passed to #arena_attach afterwards
+ */
+Arena *arena_detach(void) {
+    Arena *a = active_arena;
+    active_arena = NULL;
+    return a;
+}
+
+/**
+ * Resume allocating from the arenas that were active before #arena_detach.
+ *
+ * @param[in] a The value returned by #arena_detach
+ */
+void arena_attach(Arena *a) {
+    active_arena = a;
+}
+
+/**
+ * Initialise an arena for short-lived allocations.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_arena.
+ *
+ * @param[out] a    The new arena
+ * @param[in]  size The number of bytes it can hold; a routine's needs can be found from `peak` after a trial run
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_arena(Arena *a, size_t size) {
+    void *base;
+
+    CHECK(size > 0);
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (posix_memalign(&base, ARENA_ALIGN, size) != 0) return C_KZG_MALLOC;
+
+    a->base = base;
+    a->size = size;
+    a->used = 0;
+    a->peak = 0;
+    a->overflows = 0;
+    a->outer = NULL;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Make an arena the source of the library's short-lived allocations on the calling thread.
+ *
+ * Arenas nest: the previously active arena, if any, is restored by the matching #arena_end.
+ *
+ * @remark Work that the library hands to a thread pool allocates from the heap as usual.
+ *
+ * @param[in,out] a The arena to use
+ */
+void arena_begin(Arena *a) {
+    a->outer = active_arena;
+    active_arena = a;
+}
+
+/**
+ * Stop allocating from an arena begun with #arena_begin, without reclaiming its memory.
+ *
+ * @param[in,out] a The innermost active arena
+ */
+void arena_end(Arena *a) {
+    if (active_arena == a) active_arena = a->outer;
+    a->outer = NULL;
+}
+
+/**
+ * Reclaim everything allocated from an arena, so that its whole size is available again.
+ *
+ * @param[in,out] a The arena
+ */
+void arena_reset(Arena *a) {
+    a->used = 0;
+}
+
+/**
+ * Free the memory that was previously allocated by #new_arena.
+ *
+ * @param[in,out] a The arena, which must not be active
+ */
+void free_arena(Arena *a) {
+    free(a->base);
+    a->base = NULL;
+    a->size = 0;
+    a->used = 0;
+}
+
 /**
  * Allocate memory for an array of uint64_t.
  *
@@ -56,7 +198,7 @@ C_KZG_RET new_uint64_array(uint64_t **x, size_t n) {
 /**
  * Allocate memory for an array of field elements.
  *
- * @remark Free the space later using `free()`.
+ * @remark Free the space later using #c_kzg_free. While an #Arena is active the space is taken from it.
  *
  * @param[out] x Pointer to the allocated space
  * @param[in]  n The number of field elements to be allocated
@@ -64,7 +206,7 @@ C_KZG_RET new_uint64_array(uint64_t **x, size_t n) {
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET new_fr_array(fr_t **x, size_t n) {
-    return c_kzg_malloc((void **)x, n * sizeof **x);
+    return c_kzg_malloc_arena((void **)x, n * sizeof **x);
 }
 
 /**
@@ -84,7 +226,7 @@ C_KZG_RET new_fr_array_2(fr_t ***x, size_t n) {
 /**
  * Allocate memory for an array of G1 group elements.
  *
- * @remark Free the space later using `free()`.
+ * @remark Free the space later using #c_kzg_free. While an #Arena is active the space is taken from it.
  *
  * @param[out] x Pointer to the allocated space
  * @param[in]  n The number of G1 elements to be allocated
@@ -92,7 +234,7 @@ C_KZG_RET new_fr_array_2(fr_t ***x, size_t n) {
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET new_g1_array(g1_t **x, size_t n) {
-    return c_kzg_malloc((void **)x, n * sizeof **x);
+    return c_kzg_malloc_arena((void **)x, n * sizeof **x);
 }
 
 /**
@@ -109,6 +251,20 @@ C_KZG_RET new_g1_array_2(g1_t ***x, size_t n) {
     return c_kzg_malloc((void **)x, n * sizeof **x);
 }
 
+/**
+ * Allocate memory for an array of G1 group elements in affine form.
+ *
+ * @remark Free the space later using `free()`.
+ *
+ * @param[out] x Pointer to the allocated space
+ * @param[in]  n The number of affine G1 elements to be allocated
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_g1_affine_array(g1_affine_t **x, size_t n) {
+    return c_kzg_malloc((void **)x, n * sizeof **x);
+}
+
 /**
  * Allocate memory for an array of G2 group elements.
  *
@@ -137,6 +293,34 @@ C_KZG_RET new_poly_array(poly **x, size_t n) {
     return c_kzg_malloc((void **)x, n * sizeof **x);
 }
 
+/**
+ * Allocate memory for an array of scalars.
+ *
+ * @remark Free the space later using `free()`.
+ *
+ * @param[out] x Pointer to the allocated space
+ * @param[in]  n The number of scalars to be allocated
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_scalar_array(scalar_t **x, size_t n) {
+    return c_kzg_malloc((void **)x, n * sizeof **x);
+}
+
+/**
+ * Allocate untyped memory, such as scratch space for the underlying library.
+ *
+ * @remark Free the space later using `free()`.
+ *
+ * @param[out] x Pointer to the allocated space
+ * @param[in]  n The number of bytes to be allocated
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_byte_array(byte **x, size_t n) {
+    return c_kzg_malloc((void **)x, n * sizeof **x);
+}
+
 #ifdef KZGTEST
 
 #include "../inc/acutest.h"
@@ -153,10 +337,59 @@ void malloc_huge_fails(void) {
     TEST_CHECK(C_KZG_MALLOC == c_kzg_malloc((void **)&p, -1));
 }
 
+void arena_allocations(void) {
+    Arena outer, inner;
+    fr_t *a, *b, *big;
+    g1_t *g;
+    uint64_t *u;
+
+    TEST_CHECK(C_KZG_OK == new_arena(&outer, 1000));
+    TEST_CHECK(outer.size == 1024);
+    TEST_CHECK(C_KZG_OK == new_arena(&inner, 256));
+
+    // Field element and G1 arrays come from the active arena, aligned, and other arrays from the heap
+    arena_begin(&outer);
+    TEST_CHECK(C_KZG_OK == new_fr_array(&a, 3));
+    TEST_CHECK(C_KZG_OK == new_g1_array(&g, 1));
+    TEST_CHECK(C_KZG_OK == new_uint64_array(&u, 4));
+    TEST_CHECK((byte *)a == outer.base);
+    TEST_CHECK((byte *)g == outer.base + 128);
+    TEST_CHECK((uintptr_t)g % ARENA_ALIGN == 0);
+    TEST_CHECK(outer.used == 128 + 192);
+    c_kzg_free(u);
+
+    // Arenas nest, and an allocation that does not fit comes from the heap
+    arena_begin(&inner);
+    TEST_CHECK(C_KZG_OK == new_fr_array(&b, 8));
+    TEST_CHECK((byte *)b == inner.base);
+    TEST_CHECK(C_KZG_OK == new_fr_array(&big, 8));
+    TEST_CHECK(inner.overflows == 1);
+    TEST_CHECK((byte *)big < inner.base || (byte *)big >= inner.base + inner.size);
+    c_kzg_free(big);
+    c_kzg_free(b);
+    c_kzg_free(a);
+    arena_end(&inner);
+    TEST_CHECK(C_KZG_OK == new_fr_array(&b, 1));
+    TEST_CHECK((byte *)b == outer.base + 128 + 192);
+    arena_end(&outer);
+
+    // Resetting reclaims everything, but remembers the peak
+    arena_reset(&outer);
+    TEST_CHECK(outer.used == 0);
+    TEST_CHECK(outer.peak == 128 + 192 + 64);
+    TEST_CHECK(C_KZG_OK == new_fr_array(&a, 1));
+    TEST_CHECK((byte *)a < outer.base || (byte *)a >= outer.base + outer.size);
+    c_kzg_free(a);
+
+    free_arena(&outer);
+    free_arena(&inner);
+}
+
 TEST_LIST = {
     {"C_KZG_UTIL_TEST", title},
     {"malloc_works", malloc_works},
     {"malloc_huge_fails", malloc_huge_fails},
+    {"arena_allocations", arena_allocations},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
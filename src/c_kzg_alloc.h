@@ -41,10 +41,16 @@
         _a > _b ? _a : _b;                                                                                             \
     })
 
+void c_kzg_free(void *p);
+Arena *arena_detach(void);
+void arena_attach(Arena *a);
 C_KZG_RET new_uint64_array(uint64_t **x, size_t n);
 C_KZG_RET new_fr_array(fr_t **x, size_t n);
 C_KZG_RET new_fr_array_2(fr_t ***x, size_t n);
 C_KZG_RET new_g1_array(g1_t **x, size_t n);
 C_KZG_RET new_g1_array_2(g1_t ***x, size_t n);
+C_KZG_RET new_g1_affine_array(g1_affine_t **x, size_t n);
 C_KZG_RET new_g2_array(g2_t **x, size_t n);
-C_KZG_RET new_poly_array(poly **x, size_t n);
\ No newline at end of file
+C_KZG_RET new_poly_array(poly **x, size_t n);
+C_KZG_RET new_scalar_array(scalar_t **x, size_t n);
+C_KZG_RET new_byte_array(byte **x, size_t n);
@@ -96,3 +96,42 @@
  *
  * @param cond The condition to be tested
  */
+
+#ifdef KZG_STATS
+#define STAT_COUNT(counter, n) kzg_stat_count(KZG_STAT_##counter, (n))
+#define STAT_SIZED(counter, n) kzg_stat_sized(KZG_STAT_##counter, (n))
+#define STAT_SCOPE(op)                                                                                                 \
+    KZGStatScope stat_scope __attribute__((cleanup(kzg_stat_scope_end))) = kzg_stat_scope_begin(KZG_OP_##op)
+#else
+#define STAT_COUNT(counter, n)
+#define STAT_SIZED(counter, n)
+#define STAT_SCOPE(op)
+#endif // KZG_STATS
+
+/** @def STAT_COUNT
+ *
+ * Add @p n to the counter `KZG_STAT_<counter>` in the statistics reported by #kzg_stats.
+ *
+ * This, like the other `STAT_` macros, does nothing unless `KZG_STATS` is defined (`-DKZG_STATS` compiler flag).
+ *
+ * @param counter The name of the counter without the `KZG_STAT_` prefix, such as `G1_MUL`
+ * @param n       The amount to add
+ */
+
+/** @def STAT_SIZED
+ *
+ * Count one FFT or multi-scalar multiplication of size @p n: see #kzg_stat_sized.
+ *
+ * @param counter `FFT_FR`, `FFT_G1` or `MSM`
+ * @param n       The size
+ */
+
+/** @def STAT_SCOPE
+ *
+ * Time the rest of the enclosing block, however it is left, as a call of `KZG_OP_<op>`.
+ *
+ * Put this at the start of a function body to time each call of the function, early returns from `CHECK` and `TRY`
+ * included.
+ *
+ * @param op The name of the call without the `KZG_OP_` prefix, such as `COMMIT_TO_POLY`
+ */
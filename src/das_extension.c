@@ -22,6 +22,7 @@
 
 #include "control.h"
 #include "c_kzg.h"
+#include "c_kzg_alloc.h"
 #include "utility.h"
 
 /**
@@ -30,9 +31,10 @@
  * @param[in, out] ab     Input: values of the even indices. Output: values of the odd indices (in-place)
  * @param[in]      n      The length of @p ab
  * @param[in]      stride The step length through the roots of unity
- * @param[in]      fs     The FFT settings previously initialised with #new_fft_settings
+ * @param[in]      roots  The powers of a root of unity of order @p width, from #fft_roots
+ * @param[in]      width  The order of the root of unity, so that `roots[width - k]` is the inverse of `roots[k]`
  */
-static void das_fft_extension_stride(fr_t *ab, uint64_t n, uint64_t stride, const FFTSettings *fs) {
+static void das_fft_extension_stride(fr_t *ab, uint64_t n, uint64_t stride, const fr_t *roots, uint64_t width) {
 
     if (n < 2) return;
 
@@ -40,7 +42,7 @@ static void das_fft_extension_stride(fr_t *ab, uint64_t n, uint64_t stride, cons
         fr_t x, y, tmp;
         fr_add(&x, &ab[0], &ab[1]);
         fr_sub(&y, &ab[0], &ab[1]);
-        fr_mul(&tmp, &y, &fs->expanded_roots_of_unity[stride]);
+        fr_mul(&tmp, &y, &roots[stride]);
         fr_add(&ab[0], &x, &tmp);
         fr_sub(&ab[1], &x, &tmp);
     } else {
@@ -57,27 +59,20 @@ static void das_fft_extension_stride(fr_t *ab, uint64_t n, uint64_t stride, cons
             fr_t *a_half_1 = ab_half_1s + i;
             fr_add(&tmp1, a_half_0, a_half_1);
             fr_sub(&tmp2, a_half_0, a_half_1);
-            fr_mul(a_half_1, &tmp2, &fs->reverse_roots_of_unity[i * 2 * stride]);
+            fr_mul(a_half_1, &tmp2, &roots[width - i * 2 * stride]);
             *a_half_0 = tmp1;
         }
 
         // Recurse
-        das_fft_extension_stride(ab_half_0s, halfhalf, stride * 2, fs);
-        das_fft_extension_stride(ab_half_1s, halfhalf, stride * 2, fs);
+        das_fft_extension_stride(ab_half_0s, halfhalf, stride * 2, roots, width);
+        das_fft_extension_stride(ab_half_1s, halfhalf, stride * 2, roots, width);
 
         // The odd deduced outputs are written to the output array already, but then updated in-place
         // L1 = b[:halfHalf]
         // R1 = b[halfHalf:]
 
-        for (uint64_t i = 0; i < halfhalf; i++) {
-            fr_t y_times_root;
-            fr_t x = ab_half_0s[i];
-            fr_t y = ab_half_1s[i];
-            fr_mul(&y_times_root, &y, &fs->expanded_roots_of_unity[(1 + 2 * i) * stride]);
-            // write outputs in place, avoid unnecessary list allocations
-            fr_add(&ab_half_0s[i], &x, &y_times_root);
-            fr_sub(&ab_half_1s[i], &x, &y_times_root);
-        }
+        // write outputs in place, avoid unnecessary list allocations
+        fr_butterfly_vec(ab_half_0s, ab_half_1s, roots + stride, 2 * stride, halfhalf);
     }
 }
 
@@ -94,15 +89,19 @@ static void das_fft_extension_stride(fr_t *ab, uint64_t n, uint64_t stride, cons
  * @param[in]      fs   The FFT settings previously initialised with #new_fft_settings
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
  */
 C_KZG_RET das_fft_extension(fr_t *vals, uint64_t n, const FFTSettings *fs) {
+    const fr_t *roots;
+    uint64_t stride;
     fr_t invlen;
 
     CHECK(n > 0);
     CHECK(is_power_of_two(n));
     CHECK(n * 2 <= fs->max_width);
 
-    das_fft_extension_stride(vals, n, fs->max_width / (n * 2), fs);
+    TRY(fft_roots(&roots, &stride, n * 2, fs));
+    das_fft_extension_stride(vals, n, stride, roots, n * 2 * stride);
 
     fr_from_uint64(&invlen, n);
     fr_inv(&invlen, &invlen);
@@ -113,10 +112,293 @@ C_KZG_RET das_fft_extension(fr_t *vals, uint64_t n, const FFTSettings *fs) {
     return C_KZG_OK;
 }
 
+/**
+ * Recursive implementation of #das_fft_extension_rows, for a range of the rows.
+ *
+ * This is #das_fft_extension_stride with each element replaced by a vector of elements, one from each row, so that
+ * each root of unity is loaded once and applied across all the rows.
+ *
+ * @param[in, out] ab     Input: values of the even indices. Output: values of the odd indices (in-place). Element
+ *                        `i` of row `r` is at `ab[i * ld + r]`
+ * @param[in]      n      The length of each row
+ * @param[in]      ld     The distance between consecutive elements of a row
+ * @param[in]      rows   The number of rows, no more than @p ld
+ * @param[in]      stride The step length through the roots of unity
+ * @param[in]      roots  The powers of a root of unity of order @p width, from #fft_roots
+ * @param[in]      width  The order of the root of unity, so that `roots[width - k]` is the inverse of `roots[k]`
+ */
+static void das_fft_extension_rows_stride(fr_t *ab, uint64_t n, uint64_t ld, uint64_t rows, uint64_t stride,
+                                          const fr_t *roots, uint64_t width) {
+
+    if (n < 2) return;
+
+    if (n == 2) {
+        for (uint64_t r = 0; r < rows; r++) {
+            fr_t x, y, tmp;
+            fr_add(&x, &ab[r], &ab[ld + r]);
+            fr_sub(&y, &ab[r], &ab[ld + r]);
+            fr_mul(&tmp, &y, &roots[stride]);
+            fr_add(&ab[r], &x, &tmp);
+            fr_sub(&ab[ld + r], &x, &tmp);
+        }
+    } else {
+        uint64_t halfhalf = n / 2;
+        fr_t *ab_half_0s = ab;
+        fr_t *ab_half_1s = ab + halfhalf * ld;
+
+        for (uint64_t i = 0; i < halfhalf; i++) {
+            const fr_t *root = &roots[width - i * 2 * stride];
+            fr_t *a_half_0 = ab_half_0s + i * ld;
+            fr_t *a_half_1 = ab_half_1s + i * ld;
+            for (uint64_t r = 0; r < rows; r++) {
+                fr_t tmp1, tmp2;
+                fr_add(&tmp1, &a_half_0[r], &a_half_1[r]);
+                fr_sub(&tmp2, &a_half_0[r], &a_half_1[r]);
+                fr_mul(&a_half_1[r], &tmp2, root);
+                a_half_0[r] = tmp1;
+            }
+        }
+
+        das_fft_extension_rows_stride(ab_half_0s, halfhalf, ld, rows, stride * 2, roots, width);
+        das_fft_extension_rows_stride(ab_half_1s, halfhalf, ld, rows, stride * 2, roots, width);
+
+        for (uint64_t i = 0; i < halfhalf; i++) {
+            fr_butterfly_vec(ab_half_0s + i * ld, ab_half_1s + i * ld, &roots[(2 * i + 1) * stride], 0, rows);
+        }
+    }
+}
+
+/**
+ * The shared state for the tasks of #das_fft_extension_rows.
+ */
+typedef struct {
+    fr_t *vals;             /**< The rows, interleaved */
+    uint64_t n;             /**< The length of each row */
+    uint64_t ld;            /**< The distance between consecutive elements of a row */
+    uint64_t n_rows;        /**< The number of rows */
+    uint64_t rows_per_task; /**< The number of consecutive rows extended by each task */
+    uint64_t stride;        /**< The step length through the roots of unity */
+    const fr_t *roots;      /**< The powers of a root of unity of order `width` */
+    uint64_t width;         /**< The order of the root of unity */
+    fr_t invlen;            /**< The inverse of `n` */
+} das_rows_job;
+
+/**
+ * Extend a range of the rows, as one task of #das_fft_extension_rows.
+ *
+ * @param[in] arg The #das_rows_job
+ * @param[in] t   The index of the range of rows
+ */
+static void das_rows_task(void *arg, uint64_t t) {
+    const das_rows_job *job = arg;
+    uint64_t start = t * job->rows_per_task;
+    uint64_t rows = min_u64(job->rows_per_task, job->n_rows - start);
+    fr_t *vals = job->vals + start;
+
+    das_fft_extension_rows_stride(vals, job->n, job->ld, rows, job->stride, job->roots, job->width);
+    for (uint64_t i = 0; i < job->n; i++) {
+        fr_scale_vec(&vals[i * job->ld], &vals[i * job->ld], &job->invlen, rows);
+    }
+}
+
+/**
+ * Implementation of #das_fft_extension_rows, with the rows interleaved at a spacing that may exceed their number.
+ *
+ * @param[in, out] vals   Element `i` of row `r` is at `vals[i * ld + r]`
+ * @param[in]      n      The length of each row, a power of two with `2 * n` no more than `fs->max_width`
+ * @param[in]      ld     The distance between consecutive elements of a row
+ * @param[in]      n_rows The number of rows, at least one and no more than @p ld
+ * @param[in]      fs     The FFT settings
+ * @param[in]      pool   Optional thread pool to extend the rows in parallel, or NULL
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+static C_KZG_RET das_extend_rows_ld(fr_t *vals, uint64_t n, uint64_t ld, uint64_t n_rows, const FFTSettings *fs,
+                                    const ThreadPool *pool) {
+    das_rows_job job;
+    uint64_t tasks;
+
+    TRY(fft_roots(&job.roots, &job.stride, n * 2, fs));
+    job.vals = vals;
+    job.n = n;
+    job.ld = ld;
+    job.n_rows = n_rows;
+    job.width = n * 2 * job.stride;
+    fr_from_uint64(&job.invlen, n);
+    fr_inv(&job.invlen, &job.invlen);
+
+    tasks = min_u64(pool_threads(pool), n_rows);
+    job.rows_per_task = (n_rows + tasks - 1) / tasks;
+    tasks = (n_rows + job.rows_per_task - 1) / job.rows_per_task;
+    pool_run(pool, das_rows_task, &job, tasks);
+
+    return C_KZG_OK;
+}
+
+/**
+ * Perform polynomial extension for data availability sampling on many rows at once.
+ *
+ * Each row is extended as by #das_fft_extension. The rows are interleaved, so that each step of the extension is
+ * applied to a contiguous vector of elements, one from each row. This shares the loads of the roots of unity between
+ * the rows, and with a thread pool the rows are divided between the threads.
+ *
+ * @remark The input (even index) values are replace by the output (odd index) values.
+ *
+ * @param[in, out] vals   Input: values of the even indices. Output: values of the odd indices (in place). Element `i`
+ *                        of row `r` is at `vals[i * n_rows + r]`
+ * @param[in]      n      The length of each row
+ * @param[in]      n_rows The number of rows
+ * @param[in]      fs     The FFT settings previously initialised with #new_fft_settings
+ * @param[in]      pool   Optional thread pool to extend the rows in parallel, or NULL
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+C_KZG_RET das_fft_extension_rows(fr_t *vals, uint64_t n, uint64_t n_rows, const FFTSettings *fs,
+                                 const ThreadPool *pool) {
+    CHECK(n > 0);
+    CHECK(is_power_of_two(n));
+    CHECK(n * 2 <= fs->max_width);
+    if (n_rows == 0) return C_KZG_OK;
+
+    return das_extend_rows_ld(vals, n, n_rows, n_rows, fs, pool);
+}
+
+/**
+ * The number of rows of the data square that #das_extend_square takes through the row stages together (a tunable
+ * parameter).
+ */
+#define DAS_SQUARE_BLOCK_ROWS 16
+
+/**
+ * The working state of #das_extend_square.
+ */
+typedef struct {
+    fr_t *extended;                /**< The extended square */
+    g1_t *commitments;             /**< The row commitments, or NULL */
+    g1_t *proofs;                  /**< The row proofs, or NULL */
+    uint64_t k;                    /**< The width of the original square */
+    const FFTSettings *fs;         /**< The FFT settings */
+    const FK20MultiSettings *fk;   /**< The FK20 settings, or NULL if neither commitments nor proofs are wanted */
+    const ThreadPool *pool;        /**< Optional thread pool */
+    fr_t *block;                   /**< A block of rows, interleaved, `k * DAS_SQUARE_BLOCK_ROWS` elements */
+    poly row_poly;                 /**< The coefficients of one row, length `k` */
+} das_square_state;
+
+/**
+ * Take a block of rows of the square through the row stages of #das_extend_square.
+ *
+ * On entry, the first `k` entries of each of the rows hold the values at the even columns. These are interpolated to
+ * give the row polynomials for the commitments and proofs, and also transposed into `block`, where the rows are
+ * extended together. The results are then interleaved back into the rows.
+ *
+ * @param[in,out] s     The working state
+ * @param[in]     start The first row of the block
+ * @param[in]     rows  The number of rows in the block, at most #DAS_SQUARE_BLOCK_ROWS
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET das_square_rows(const das_square_state *s, uint64_t start, uint64_t rows) {
+    uint64_t k = s->k, proofs_per_row;
+
+    for (uint64_t b = 0; b < rows; b++) {
+        fr_t *row = s->extended + (start + b) * 2 * k;
+
+        if (s->fk != NULL) {
+            TRY(fft_fr(s->row_poly.coeffs, row, true, k, s->fs));
+            if (s->commitments != NULL) {
+                TRY(commit_to_poly(&s->commitments[start + b], &s->row_poly, s->fk->ks));
+            }
+            if (s->proofs != NULL) {
+                proofs_per_row = 2 * k / s->fk->chunk_len;
+                TRY(da_using_fk20_multi(&s->proofs[(start + b) * proofs_per_row], &s->row_poly, s->fk));
+            }
+        }
+
+        for (uint64_t i = 0; i < k; i++) {
+            s->block[i * rows + b] = row[i];
+        }
+    }
+
+    TRY(das_extend_rows_ld(s->block, k, rows, rows, s->fs, s->pool));
+
+    for (uint64_t b = 0; b < rows; b++) {
+        fr_t *row = s->extended + (start + b) * 2 * k;
+        // Spread the even columns out from the right, so that nothing is overwritten before it is moved
+        for (uint64_t i = k; i-- > 0;) {
+            row[2 * i] = row[i];
+            row[2 * i + 1] = s->block[i * rows + b];
+        }
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Extend a square of data in both dimensions for data availability sampling, with optional row commitments and
+ * proofs.
+ *
+ * The `k * k` square is taken to be the values at the even rows and columns of a `2k * 2k` square whose rows and
+ * columns are each extended as by #das_fft_extension. The columns are extended first, in place in @p extended,
+ * and then the rows are taken in blocks through their extension, and the commitments and FK20 multi proofs for each
+ * row, while the block is in cache. Apart from the output, only one block of rows and one row polynomial are held.
+ *
+ * Row `R` has polynomial `p_R` of degree less than `k`, with the extended square holding `p_R(w^C)` at column `C`,
+ * where `w` is the primitive `2k`-th root of unity. Its commitment is `commitments[R]`, and its proofs follow
+ * #da_using_fk20_multi, starting at `proofs[R * 2k / fk->chunk_len]`.
+ *
+ * @param[out] extended    The extended square, `2k * 2k` elements in row-major order
+ * @param[out] commitments The commitments to the @p 2k row polynomials, or NULL
+ * @param[out] proofs      The FK20 multi proofs of the rows, `2k * 2k / fk->chunk_len` points, or NULL
+ * @param[in]  data        The original square, `k * k` elements in row-major order
+ * @param[in]  k           The width of the original square, a power of two
+ * @param[in]  fs          FFT settings with `max_width` at least `2 * k`
+ * @param[in]  fk          FK20 multi settings for `n2 = 2 * k`, or NULL if neither commitments nor proofs are wanted
+ * @param[in]  pool        Optional thread pool for the extensions, or NULL
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET das_extend_square(fr_t *extended, g1_t *commitments, g1_t *proofs, const fr_t *data, uint64_t k,
+                            const FFTSettings *fs, const FK20MultiSettings *fk, const ThreadPool *pool) {
+    STAT_SCOPE(DAS_EXTEND_SQUARE);
+    das_square_state s = {extended, commitments, proofs, k, fs, commitments || proofs ? fk : NULL, pool};
+    C_KZG_RET ret = C_KZG_OK;
+    uint64_t block_rows = min_u64(2 * k, DAS_SQUARE_BLOCK_ROWS);
+
+    CHECK(k > 0);
+    CHECK(is_power_of_two(k));
+    CHECK(k * 2 <= fs->max_width);
+    CHECK(s.fk != NULL || (commitments == NULL && proofs == NULL));
+    CHECK(s.fk == NULL || s.fk->length == 2 * k);
+
+    // The original rows go to the even rows, and copies of them to the odd rows to be extended into the missing ones,
+    // each of them packed into its first k entries. Down each of the columns, these are k values, 4k apart.
+    for (uint64_t r = 0; r < k; r++) {
+        for (uint64_t c = 0; c < k; c++) {
+            extended[2 * r * 2 * k + c] = data[r * k + c];
+            extended[(2 * r + 1) * 2 * k + c] = data[r * k + c];
+        }
+    }
+    TRY(das_extend_rows_ld(extended + 2 * k, k, 4 * k, k, fs, pool));
+
+    TRY(new_fr_array(&s.block, k * block_rows));
+    ret = new_poly(&s.row_poly, k);
+    for (uint64_t start = 0; ret == C_KZG_OK && start < 2 * k; start += block_rows) {
+        ret = das_square_rows(&s, start, block_rows);
+    }
+
+    c_kzg_free(s.block);
+    free_poly(&s.row_poly);
+
+    return ret;
+}
+
 #ifdef KZGTEST
 
 #include "../inc/acutest.h"
-#include "c_kzg_alloc.h"
 #include "test_util.h"
 
 void das_extension_test_known(void) {
@@ -150,6 +432,19 @@ void das_extension_test_known(void) {
         fr_from_uint64s(&expected, expected_u[i]);
         TEST_CHECK(fr_equal(&expected, data + i));
     }
+    free_fft_settings(&fs);
+
+    // Lazy settings of any size give the same results
+    TEST_CHECK(C_KZG_OK == new_fft_settings_lazy(&fs, 10));
+    for (uint64_t i = 0; i < half; i++) {
+        fr_from_uint64(data + i, i);
+    }
+    TEST_CHECK(C_KZG_OK == das_fft_extension(data, half, &fs));
+    for (uint64_t i = 0; i < 8; i++) {
+        fr_t expected;
+        fr_from_uint64s(&expected, expected_u[i]);
+        TEST_CHECK(fr_equal(&expected, data + i));
+    }
 
     free(data);
     free_fft_settings(&fs);
@@ -201,10 +496,159 @@ void das_extension_test_random(void) {
     free_fft_settings(&fs);
 }
 
+void das_extension_test_rows(void) {
+    FFTSettings fs;
+    ThreadPool pool;
+    uint64_t n = 64, n_rows = 13;
+    fr_t *rows, *vals;
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 8));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&rows, n * n_rows));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&vals, n * n_rows));
+
+    for (uint64_t width = 1; width <= n; width *= 2) {
+        for (int threaded = 0; threaded <= 1; threaded++) {
+            // Interleave random rows, then extend each of them separately
+            for (uint64_t r = 0; r < n_rows; r++) {
+                for (uint64_t i = 0; i < width; i++) {
+                    rows[r * width + i] = rand_fr();
+                    vals[i * n_rows + r] = rows[r * width + i];
+                }
+                TEST_CHECK(C_KZG_OK == das_fft_extension(rows + r * width, width, &fs));
+            }
+
+            TEST_CHECK(C_KZG_OK == das_fft_extension_rows(vals, width, n_rows, &fs, threaded ? &pool : NULL));
+            for (uint64_t r = 0; r < n_rows; r++) {
+                for (uint64_t i = 0; i < width; i++) {
+                    TEST_CHECK(fr_equal(&rows[r * width + i], &vals[i * n_rows + r]));
+                    TEST_MSG("Mismatch at width %lu, threaded %d, row %lu, index %lu", width, threaded, r, i);
+                }
+            }
+        }
+    }
+
+    TEST_CHECK(C_KZG_OK == das_fft_extension_rows(vals, n, 0, &fs, NULL));
+    TEST_CHECK(C_KZG_BADARGS == das_fft_extension_rows(vals, 3, n_rows, &fs, NULL));
+    TEST_CHECK(C_KZG_BADARGS == das_fft_extension_rows(vals, fs.max_width, n_rows, &fs, NULL));
+
+    free(rows);
+    free(vals);
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+}
+
+void das_extension_test_square(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20MultiSettings fk;
+    ThreadPool pool;
+    uint64_t k = 16, chunk_len = 4, proofs_per_row = 2 * k / chunk_len;
+    g1_t *s1, *commitments, *proofs, *expected_proofs, expected;
+    g2_t *s2;
+    fr_t *data, *extended, *line, *coeffs;
+    poly p;
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, 2 * k));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, 2 * k));
+    generate_trusted_setup(s1, s2, &secret, 2 * k);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 5));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, 2 * k, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk, 2 * k, chunk_len, &ks));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+
+    TEST_CHECK(C_KZG_OK == new_fr_array(&data, k * k));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&extended, 4 * k * k));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&line, 2 * k));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&coeffs, 2 * k));
+    TEST_CHECK(C_KZG_OK == new_g1_array(&commitments, 2 * k));
+    TEST_CHECK(C_KZG_OK == new_g1_array(&proofs, 2 * k * proofs_per_row));
+    TEST_CHECK(C_KZG_OK == new_g1_array(&expected_proofs, proofs_per_row));
+    TEST_CHECK(C_KZG_OK == new_poly(&p, k));
+    for (uint64_t i = 0; i < k * k; i++) {
+        data[i] = rand_fr();
+    }
+
+    TEST_CHECK(C_KZG_OK == das_extend_square(extended, commitments, proofs, data, k, &fs, &fk, &pool));
+
+    // The original data is at the even rows and columns
+    for (uint64_t r = 0; r < k; r++) {
+        for (uint64_t c = 0; c < k; c++) {
+            TEST_CHECK(fr_equal(&data[r * k + c], &extended[2 * r * 2 * k + 2 * c]));
+        }
+    }
+
+    // Every row, and every column, has the upper half of its coefficients zero
+    for (uint64_t j = 0; j < 2 * k; j++) {
+        for (uint64_t i = 0; i < 2 * k; i++) {
+            line[i] = extended[j * 2 * k + i];
+        }
+        TEST_CHECK(C_KZG_OK == fft_fr(coeffs, line, true, 2 * k, &fs));
+        for (uint64_t i = k; i < 2 * k; i++) {
+            TEST_CHECK(fr_is_zero(&coeffs[i]));
+            TEST_MSG("Row %lu, coefficient %lu", j, i);
+        }
+
+        // The commitment and proofs of the row are for its polynomial
+        for (uint64_t i = 0; i < k; i++) {
+            p.coeffs[i] = coeffs[i];
+        }
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+        TEST_CHECK(g1_equal(&expected, &commitments[j]));
+        TEST_CHECK(C_KZG_OK == da_using_fk20_multi(expected_proofs, &p, &fk));
+        for (uint64_t i = 0; i < proofs_per_row; i++) {
+            TEST_CHECK(g1_equal(&expected_proofs[i], &proofs[j * proofs_per_row + i]));
+        }
+
+        for (uint64_t i = 0; i < 2 * k; i++) {
+            line[i] = extended[i * 2 * k + j];
+        }
+        TEST_CHECK(C_KZG_OK == fft_fr(coeffs, line, true, 2 * k, &fs));
+        for (uint64_t i = k; i < 2 * k; i++) {
+            TEST_CHECK(fr_is_zero(&coeffs[i]));
+            TEST_MSG("Column %lu, coefficient %lu", j, i);
+        }
+    }
+
+    // Without commitments or proofs, and without a pool, the extension is the same
+    TEST_CHECK(C_KZG_OK == das_extend_square(line, NULL, NULL, data, 1, &fs, NULL, NULL));
+    TEST_CHECK(fr_equal(&line[0], &data[0]));
+    for (uint64_t i = 1; i < 4; i++) {
+        TEST_CHECK(fr_equal(&line[i], &data[0]));
+    }
+    fr_t *again = malloc(4 * k * k * sizeof(fr_t));
+    TEST_CHECK(C_KZG_OK == das_extend_square(again, NULL, NULL, data, k, &fs, NULL, NULL));
+    for (uint64_t i = 0; i < 4 * k * k; i++) {
+        TEST_CHECK(fr_equal(&again[i], &extended[i]));
+    }
+
+    TEST_CHECK(C_KZG_BADARGS == das_extend_square(again, commitments, NULL, data, k, &fs, NULL, NULL));
+    TEST_CHECK(C_KZG_BADARGS == das_extend_square(again, commitments, NULL, data, k / 2, &fs, &fk, NULL));
+    TEST_CHECK(C_KZG_BADARGS == das_extend_square(again, NULL, NULL, data, 3, &fs, NULL, NULL));
+
+    free(again);
+    free(data);
+    free(extended);
+    free(line);
+    free(coeffs);
+    free(commitments);
+    free(proofs);
+    free(expected_proofs);
+    free(s1);
+    free(s2);
+    free_poly(&p);
+    free_thread_pool(&pool);
+    free_fk20_multi_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
 TEST_LIST = {
     {"DAS_EXTENSION_TEST", title},
     {"das_extension_test_known", das_extension_test_known},
     {"das_extension_test_random", das_extension_test_random},
+    {"das_extension_test_rows", das_extension_test_rows},
+    {"das_extension_test_square", das_extension_test_square},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
@@ -22,10 +22,9 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+bench_result run_bench(int scale, int max_seconds) {
+    bench_t bench;
     FFTSettings fs;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
@@ -38,22 +37,81 @@ long run_bench(int scale, int max_seconds) {
         data[i] = rand_fr();
     }
 
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
         assert(C_KZG_OK == das_fft_extension(data, fs.max_width / 2, &fs));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+        bench_stop(&bench);
     }
 
     free(data);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, ((uint64_t)1 << scale) / 2 * sizeof(fr_t));
+}
+
+// Run the benchmark for `max_seconds` and return the timings per row of length 2^(scale - 1) extended by
+// #das_fft_extension_rows. If `pool` is non-NULL then the rows are extended in parallel using it.
+bench_result run_rows_bench(int scale, int max_seconds, uint64_t rows, const ThreadPool *pool) {
+    bench_t bench;
+    FFTSettings fs;
+
+    assert(C_KZG_OK == new_fft_settings(&fs, scale));
+
+    fr_t *data = malloc((fs.max_width / 2) * rows * sizeof(fr_t));
+
+    for (uint64_t i = 0; i < (fs.max_width / 2) * rows; i++) {
+        data[i] = rand_fr();
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        assert(C_KZG_OK == das_fft_extension_rows(data, fs.max_width / 2, rows, &fs, pool));
+        bench_stop(&bench);
+    }
+
+    free(data);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, rows, rows * ((uint64_t)1 << scale) / 2 * sizeof(fr_t));
+}
+
+// Run the benchmark for `max_seconds` and return the timings to extend a square of width 2^(scale - 1)
+// with #das_extend_square, without commitments or proofs.
+bench_result run_square_bench(int scale, int max_seconds, const ThreadPool *pool) {
+    bench_t bench;
+    FFTSettings fs;
+
+    assert(C_KZG_OK == new_fft_settings(&fs, scale));
+    uint64_t k = fs.max_width / 2;
+
+    fr_t *data = malloc(k * k * sizeof(fr_t));
+    fr_t *extended = malloc(4 * k * k * sizeof(fr_t));
+
+    for (uint64_t i = 0; i < k * k; i++) {
+        data[i] = rand_fr();
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        assert(C_KZG_OK == das_extend_square(extended, NULL, NULL, data, k, &fs, NULL, pool));
+        bench_stop(&bench);
+    }
+
+    free(data);
+    free(extended);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, 1, k * k * sizeof(fr_t));
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
         case 1:
@@ -67,14 +125,31 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking das_extension, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking das_extension, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
     for (int scale = 4; scale <= 15; scale++) {
-        printf("das_extension/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec), "das_extension/scale_%d", scale);
+    }
+
+    for (int scale = 4; scale <= 14; scale++) {
+        bench_report(run_rows_bench(scale, nsec, 32, NULL), "das_extension_rows_32/scale_%d", scale);
+    }
+    for (int scale = 4; scale <= 10; scale++) {
+        bench_report(run_square_bench(scale, nsec, NULL), "das_extend_square/scale_%d", scale);
+    }
+
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 4; scale <= 14; scale++) {
+        bench_report(run_rows_bench(scale, nsec, 32, &pool), "das_extension_rows_32_threaded/scale_%d", scale);
+    }
+    for (int scale = 4; scale <= 10; scale++) {
+        bench_report(run_square_bench(scale, nsec, &pool), "das_extend_square_threaded/scale_%d", scale);
     }
+    free_thread_pool(&pool);
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
@@ -20,8 +20,10 @@
  * Code shared between the FFTs over field elements and FFTs over G1 group elements.
  */
 
+#include <pthread.h>
 #include "control.h"
 #include "c_kzg_alloc.h"
+#include "utility.h"
 
 void generate_trusted_setup(g1_t *s1, g2_t *s2, const scalar_t *secret, const uint64_t n) {
     fr_t s_pow, s;
@@ -89,27 +91,66 @@ static const uint64_t scale2_root_of_unity[][4] = {
     {0x694341f608c9dd56L, 0xed3a181fabb30adcL, 0x1339a815da8b398fL, 0x2c6d4e4511657e1eL},
     {0x63e7cb4906ffc93fL, 0xf070bb00e28a193dL, 0xad1715b02e5713b5L, 0x4b5371495990693fL}};
 
+/**
+ * The number of consecutive powers of a root of unity computed by each task of #expand_root_of_unity.
+ *
+ * Each block is seeded independently by exponentiation, which costs about as much as 40 multiplications.
+ */
+#define EXPAND_ROOTS_BLOCK (1 << 12)
+
+/**
+ * The shared state for expanding the powers of a root of unity in blocks.
+ */
+typedef struct {
+    fr_t *out;        /**< The powers, array size `width + 1` */
+    const fr_t *root; /**< The root of unity */
+    uint64_t width;   /**< The order of the root */
+} expand_job;
+
+/**
+ * Compute block @p k of the powers of the root, as one task of #expand_root_of_unity.
+ *
+ * @param[in,out] arg The #expand_job
+ * @param[in]     k   The index of the block
+ */
+static void expand_task(void *arg, uint64_t k) {
+    const expand_job *job = arg;
+    uint64_t start = k * EXPAND_ROOTS_BLOCK;
+    uint64_t end = job->width - start < EXPAND_ROOTS_BLOCK ? job->width : start + EXPAND_ROOTS_BLOCK;
+
+    fr_pow(&job->out[start], job->root, start);
+    for (uint64_t i = start + 1; i < end; i++) {
+        fr_mul(&job->out[i], &job->out[i - 1], job->root);
+    }
+}
+
 /**
  * Generate powers of a root of unity in the field for use in the FFTs.
  *
+ * The powers are computed in independent blocks of #EXPAND_ROOTS_BLOCK, each starting from `root^(k * block)`, so
+ * that they can be spread across the threads of @p pool.
+ *
  * @remark @p root must be such that @p root ^ @p width is equal to one, but no smaller power of @p root is equal to
  * one.
  *
  * @param[out] out   The generated powers of the root of unity (array size @p width + 1)
  * @param[in]  root  A root of unity
- * @param[in]  width One less than the size of @p out
+ * @param[in]  width One less than the size of @p out, a power of two
+ * @param[in]  pool  Optional thread pool, NULL to run serially
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
  */
-static C_KZG_RET expand_root_of_unity(fr_t *out, const fr_t *root, uint64_t width) {
-    out[0] = fr_one;
-    out[1] = *root;
+static C_KZG_RET expand_root_of_unity(fr_t *out, const fr_t *root, uint64_t width, const ThreadPool *pool) {
+    expand_job job = {out, root, width};
 
-    for (uint64_t i = 2; !fr_is_one(&out[i - 1]); i++) {
-        CHECK(i <= width);
-        fr_mul(&out[i], &out[i - 1], root);
-    }
+    CHECK(is_power_of_two(width));
+
+    pool_run(pool, expand_task, &job, (width + EXPAND_ROOTS_BLOCK - 1) / EXPAND_ROOTS_BLOCK);
+    fr_mul(&out[width], &out[width - 1], root);
+
+    // For a power of two width, the root has exactly that order if the half-way power is not one
     CHECK(fr_is_one(&out[width]));
+    CHECK(width == 1 || !fr_is_one(&out[width / 2]));
 
     return C_KZG_OK;
 }
@@ -135,7 +176,31 @@ static C_KZG_RET expand_root_of_unity(fr_t *out, const fr_t *root, uint64_t widt
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET new_fft_settings(FFTSettings *fs, unsigned int max_scale) {
+    return new_fft_settings_parallel(fs, max_scale, NULL);
+}
+
+/**
+ * Initialise an FFTSettings structure, computing the roots of unity in parallel.
+ *
+ * This is the same as #new_fft_settings, except that generating the powers of the root of unity, which dominates
+ * the time taken for large @p max_scale, is spread across the threads of @p pool. The pool is also stored in the
+ * settings for use by later G1 FFTs.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_fft_settings.
+ *
+ * @param[out] fs        The new settings
+ * @param[in]  max_scale Log base 2 of the max FFT size to be used with these settings
+ * @param[in]  pool      Optional thread pool, NULL to run serially
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_fft_settings_parallel(FFTSettings *fs, unsigned int max_scale, const ThreadPool *pool) {
     fs->max_width = (uint64_t)1 << max_scale;
+    fs->pool = pool;
+    fs->cache = NULL;
 
     CHECK((max_scale < sizeof scale2_root_of_unity / sizeof scale2_root_of_unity[0]));
     fr_from_uint64s(&fs->root_of_unity, scale2_root_of_unity[max_scale]);
@@ -145,32 +210,386 @@ C_KZG_RET new_fft_settings(FFTSettings *fs, unsigned int max_scale) {
     TRY(new_fr_array(&fs->reverse_roots_of_unity, fs->max_width + 1));
 
     // Populate the roots of unity
-    TRY(expand_root_of_unity(fs->expanded_roots_of_unity, &fs->root_of_unity, fs->max_width));
+    TRY(expand_root_of_unity(fs->expanded_roots_of_unity, &fs->root_of_unity, fs->max_width, pool));
 
     // Populate reverse roots of unity
     for (uint64_t i = 0; i <= fs->max_width; i++) {
         fs->reverse_roots_of_unity[i] = fs->expanded_roots_of_unity[fs->max_width - i];
     }
 
+    // Populate the contiguous per-stage roots of unity for the iterative FFT: stage `m` uses the `2m`-th roots
+    fs->stage_roots_of_unity = NULL;
+    fs->reverse_stage_roots_of_unity = NULL;
+    if (fs->max_width >= FFT_FR_ITERATIVE_MIN_WIDTH) {
+        TRY(new_fr_array(&fs->stage_roots_of_unity, fs->max_width));
+        TRY(new_fr_array(&fs->reverse_stage_roots_of_unity, fs->max_width));
+        fs->stage_roots_of_unity[0] = fr_one;
+        fs->reverse_stage_roots_of_unity[0] = fr_one;
+        for (uint64_t m = 1; m < fs->max_width; m *= 2) {
+            uint64_t stride = fs->max_width / (2 * m);
+            for (uint64_t j = 0; j < m; j++) {
+                fs->stage_roots_of_unity[m + j] = fs->expanded_roots_of_unity[j * stride];
+                fs->reverse_stage_roots_of_unity[m + j] = fs->reverse_roots_of_unity[j * stride];
+            }
+        }
+    }
+
+    return C_KZG_OK;
+}
+
+/** The number of sizes of FFT that settings can support, one for each of #scale2_root_of_unity. */
+#define FFT_SCALES (sizeof scale2_root_of_unity / sizeof scale2_root_of_unity[0])
+
+/**
+ * The tables of roots of unity for settings made by #new_fft_settings_lazy, indexed by log base 2 of the FFT size.
+ */
+struct FFTRootCache {
+    pthread_mutex_t lock;      /**< Held while looking up or building tables */
+    fr_t *roots[FFT_SCALES];   /**< `roots[s]` holds the powers of the `2^s`-th root of unity, size `2^s + 1` */
+    fr_t *stages[FFT_SCALES];  /**< `stages[s]` holds the #fft_fr_iterative stage roots for size `2^s` */
+    uint64_t allocated;        /**< The number of roots held in all of the tables, for testing */
+};
+
+/**
+ * Initialise an FFTSettings structure that builds its tables of roots of unity only when they are needed.
+ *
+ * Settings made by #new_fft_settings hold `2 * max_width + 2` roots of unity, and more for the iterative FFT, all
+ * computed up front. This is wasteful when `max_width` is large but only smaller FFTs are performed, so these
+ * settings instead compute the roots for each size of FFT the first time that size is used. Inverse FFTs use the
+ * same roots as forward FFTs, so no reversed copies are kept.
+ *
+ * The `expanded_roots_of_unity`, `reverse_roots_of_unity` and stage root tables are all NULL in these settings:
+ * use #fft_roots to get roots of unity from them.
+ *
+ * @remark The tables are built under a lock, so these settings may be shared between threads.
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_fft_settings.
+ *
+ * @param[out] fs        The new settings
+ * @param[in]  max_scale Log base 2 of the max FFT size to be used with these settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_fft_settings_lazy(FFTSettings *fs, unsigned int max_scale) {
+    CHECK(max_scale < FFT_SCALES);
+
+    fs->max_width = (uint64_t)1 << max_scale;
+    fs->pool = NULL;
+    fr_from_uint64s(&fs->root_of_unity, scale2_root_of_unity[max_scale]);
+    fs->expanded_roots_of_unity = NULL;
+    fs->reverse_roots_of_unity = NULL;
+    fs->stage_roots_of_unity = NULL;
+    fs->reverse_stage_roots_of_unity = NULL;
+
+    TRY(new_byte_array((byte **)&fs->cache, sizeof *fs->cache));
+    if (pthread_mutex_init(&fs->cache->lock, NULL) != 0) {
+        c_kzg_free(fs->cache);
+        return C_KZG_ERROR;
+    }
+    for (uint64_t s = 0; s < FFT_SCALES; s++) {
+        fs->cache->roots[s] = NULL;
+        fs->cache->stages[s] = NULL;
+    }
+    fs->cache->allocated = 0;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Build the table of roots of unity for FFTs of size `2^scale` if it is not already in the cache.
+ *
+ * @remark The cache's lock must be held.
+ *
+ * @param[in] fs    Settings made by #new_fft_settings_lazy
+ * @param[in] scale Log base 2 of the FFT size, at most the max scale of @p fs
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET build_roots(const FFTSettings *fs, unsigned int scale) {
+    FFTRootCache *cache = fs->cache;
+    uint64_t width = (uint64_t)1 << scale;
+    fr_t root = fs->root_of_unity;
+    fr_t *roots;
+    Arena *arena;
+    C_KZG_RET ret;
+
+    if (cache->roots[scale] != NULL) return C_KZG_OK;
+
+    // The `2^scale`-th root is a power of the settings' root: square it once for each halving of the width
+    for (uint64_t w = fs->max_width; w > width; w /= 2) {
+        fr_sqr(&root, &root);
+    }
+
+    // The table outlives any arena in use by the caller. Not on the settings' pool: this may be reached from a task
+    // already running on it.
+    arena = arena_detach();
+    ret = new_fr_array(&roots, width + 1);
+    arena_attach(arena);
+    if (ret != C_KZG_OK) return ret;
+    if (expand_root_of_unity(roots, &root, width, NULL) != C_KZG_OK) {
+        c_kzg_free(roots);
+        return C_KZG_ERROR;
+    }
+    cache->roots[scale] = roots;
+    cache->allocated += width + 1;
+
     return C_KZG_OK;
 }
 
 /**
- * Free the memory that was previously allocated by #new_fft_settings.
+ * Build the stage roots of unity for iterative FFTs of size `2^scale` if they are not already in the cache.
+ *
+ * @remark The cache's lock must be held.
+ *
+ * @param[in] fs    Settings made by #new_fft_settings_lazy
+ * @param[in] scale Log base 2 of the FFT size, at most the max scale of @p fs
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET build_stages(const FFTSettings *fs, unsigned int scale) {
+    FFTRootCache *cache = fs->cache;
+    uint64_t width = (uint64_t)1 << scale;
+    const fr_t *roots;
+    fr_t *stages;
+    Arena *arena;
+    C_KZG_RET ret;
+
+    if (cache->stages[scale] != NULL) return C_KZG_OK;
+
+    TRY(build_roots(fs, scale));
+    roots = cache->roots[scale];
+
+    arena = arena_detach();
+    ret = new_fr_array(&stages, width);
+    arena_attach(arena);
+    if (ret != C_KZG_OK) return ret;
+    stages[0] = fr_one;
+    for (uint64_t m = 1; m < width; m *= 2) {
+        uint64_t stride = width / (2 * m);
+        for (uint64_t j = 0; j < m; j++) {
+            stages[m + j] = roots[j * stride];
+        }
+    }
+    cache->stages[scale] = stages;
+    cache->allocated += width;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Look up the powers of the primitive @p n-th root of unity, for either kind of FFT settings.
+ *
+ * On return, `(*roots)[i * *stride]` is the `i`-th power of the root for `0 <= i <= n`. For settings made by
+ * #new_fft_settings this is the `expanded_roots_of_unity` table with a stride of `max_width / n`. For settings made by
+ * #new_fft_settings_lazy it is a table just for size @p n with a stride of one, built on the first call for that size.
+ * Since `(*roots)[n * *stride]` is one, the inverse powers are `(*roots)[(n - i) * *stride]`.
+ *
+ * @param[out] roots  The table of roots, which lasts as long as @p fs
+ * @param[out] stride The stride through @p roots
+ * @param[in]  n      The order of the root, a power of two no larger than `fs->max_width`
+ * @param[in]  fs     Previously initialised FFT settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET fft_roots(const fr_t **roots, uint64_t *stride, uint64_t n, const FFTSettings *fs) {
+    C_KZG_RET ret;
+    unsigned int scale;
+
+    CHECK(n <= fs->max_width);
+    CHECK(is_power_of_two(n));
+    scale = log2_u64(n);
+
+    if (fs->cache == NULL) {
+        *roots = fs->expanded_roots_of_unity;
+        *stride = fs->max_width / n;
+        return C_KZG_OK;
+    }
+
+    pthread_mutex_lock(&fs->cache->lock);
+    ret = build_roots(fs, scale);
+    *roots = fs->cache->roots[scale];
+    pthread_mutex_unlock(&fs->cache->lock);
+    *stride = 1;
+
+    return ret;
+}
+
+/**
+ * Look up the stage roots of unity for a forward #fft_fr_iterative of size @p n, for either kind of FFT settings.
+ *
+ * @param[out] roots The stage roots, which last as long as @p fs
+ * @param[in]  n     The size of the FFT, a power of two no larger than `fs->max_width`
+ * @param[in]  fs    Previously initialised FFT settings, which for those made by #new_fft_settings must have
+ *                   `max_width` at least #FFT_FR_ITERATIVE_MIN_WIDTH
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET fft_stage_roots(const fr_t **roots, uint64_t n, const FFTSettings *fs) {
+    C_KZG_RET ret;
+    unsigned int scale;
+
+    CHECK(n <= fs->max_width);
+    CHECK(is_power_of_two(n));
+    scale = log2_u64(n);
+
+    if (fs->cache == NULL) {
+        // Stage `m` has the same roots at any size, so the table for `max_width` serves all smaller sizes too
+        CHECK(fs->stage_roots_of_unity != NULL);
+        *roots = fs->stage_roots_of_unity;
+        return C_KZG_OK;
+    }
+
+    pthread_mutex_lock(&fs->cache->lock);
+    ret = build_stages(fs, scale);
+    *roots = fs->cache->stages[scale];
+    pthread_mutex_unlock(&fs->cache->lock);
+
+    return ret;
+}
+
+/**
+ * Free the memory that was previously allocated by #new_fft_settings or #new_fft_settings_lazy.
  *
  * @param fs The settings to be freed
  */
 void free_fft_settings(FFTSettings *fs) {
-    free(fs->expanded_roots_of_unity);
-    free(fs->reverse_roots_of_unity);
+    c_kzg_free(fs->expanded_roots_of_unity);
+    c_kzg_free(fs->reverse_roots_of_unity);
+    c_kzg_free(fs->stage_roots_of_unity);
+    c_kzg_free(fs->reverse_stage_roots_of_unity);
+    if (fs->cache != NULL) {
+        for (uint64_t s = 0; s < FFT_SCALES; s++) {
+            c_kzg_free(fs->cache->roots[s]);
+            c_kzg_free(fs->cache->stages[s]);
+        }
+        pthread_mutex_destroy(&fs->cache->lock);
+        c_kzg_free(fs->cache);
+        fs->cache = NULL;
+    }
     fs->max_width = 0;
 }
 
+/** Guards the shared settings and their reference count. */
+static pthread_mutex_t shared_fft_settings_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Process-wide lazy settings of the largest scale, lent out by #borrow_fft_settings. */
+static FFTSettings shared_fft_settings;
+
+/** The number of borrowers of #shared_fft_settings, or -1 if the settings have not been made. */
+static int64_t shared_fft_settings_refs = -1;
+
+/**
+ * Borrow the process-wide FFT settings, for callers that do not have their own.
+ *
+ * The shared settings are lazy (see #new_fft_settings_lazy) and support the largest possible FFT size, so the roots of
+ * unity for each size are computed once for the life of the process, the first time any borrower uses that size, and
+ * are then reused by every later borrower. Use #warm_fft_settings_cache to build them at startup instead.
+ *
+ * @remark Return the settings with #release_fft_settings when done. They may be used from any thread.
+ *
+ * @param[out] fs The shared settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET borrow_fft_settings(const FFTSettings **fs) {
+    C_KZG_RET ret = C_KZG_OK;
+
+    pthread_mutex_lock(&shared_fft_settings_lock);
+    if (shared_fft_settings_refs < 0) {
+        ret = new_fft_settings_lazy(&shared_fft_settings, FFT_SCALES - 1);
+        if (ret == C_KZG_OK) shared_fft_settings_refs = 0;
+    }
+    if (ret == C_KZG_OK) {
+        shared_fft_settings_refs++;
+        *fs = &shared_fft_settings;
+    }
+    pthread_mutex_unlock(&shared_fft_settings_lock);
+
+    return ret == C_KZG_BADARGS ? C_KZG_ERROR : ret;
+}
+
+/**
+ * Return settings obtained from #borrow_fft_settings.
+ *
+ * The tables are kept for later borrowers, and only freed by #free_fft_settings_cache.
+ *
+ * @param[in] fs The shared settings
+ */
+void release_fft_settings(const FFTSettings *fs) {
+    pthread_mutex_lock(&shared_fft_settings_lock);
+    if (fs == &shared_fft_settings && shared_fft_settings_refs > 0) shared_fft_settings_refs--;
+    pthread_mutex_unlock(&shared_fft_settings_lock);
+}
+
+/**
+ * Build the roots of unity in the process-wide FFT settings for every size up to `2^max_scale`.
+ *
+ * This takes the cost of building the tables up front, at startup, rather than in the first calls that need them.
+ *
+ * @param[in] max_scale Log base 2 of the largest size of FFT to prepare for
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET warm_fft_settings_cache(unsigned int max_scale) {
+    const FFTSettings *fs;
+    const fr_t *roots;
+    uint64_t stride;
+    C_KZG_RET ret = C_KZG_OK;
+
+    CHECK(max_scale < FFT_SCALES);
+
+    TRY(borrow_fft_settings(&fs));
+    for (unsigned int scale = 0; scale <= max_scale && ret == C_KZG_OK; scale++) {
+        uint64_t n = (uint64_t)1 << scale;
+        ret = fft_roots(&roots, &stride, n, fs);
+        if (ret == C_KZG_OK && n >= FFT_FR_ITERATIVE_MIN_WIDTH) {
+            ret = fft_stage_roots(&roots, n, fs);
+        }
+    }
+    release_fft_settings(fs);
+
+    return ret;
+}
+
+/**
+ * Free the process-wide FFT settings lent out by #borrow_fft_settings.
+ *
+ * @remark This is only needed to reclaim the memory before the process exits, for example to satisfy a leak checker.
+ * Later calls to #borrow_fft_settings make new settings.
+ *
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The settings are still borrowed
+ */
+C_KZG_RET free_fft_settings_cache(void) {
+    C_KZG_RET ret = C_KZG_OK;
+
+    pthread_mutex_lock(&shared_fft_settings_lock);
+    if (shared_fft_settings_refs > 0) {
+        ret = C_KZG_BADARGS;
+    } else if (shared_fft_settings_refs == 0) {
+        free_fft_settings(&shared_fft_settings);
+        shared_fft_settings_refs = -1;
+    }
+    pthread_mutex_unlock(&shared_fft_settings_lock);
+
+    return ret;
+}
+
 #ifdef KZGTEST
 
 #include "../inc/acutest.h"
 #include "test_util.h"
-#include "utility.h"
 
 #define NUM_ROOTS 32
 
@@ -203,7 +622,7 @@ void expand_roots_is_plausible(void) {
 
     // Initialise
     fr_from_uint64s(&root, scale2_root_of_unity[scale]);
-    TEST_CHECK(expand_root_of_unity(expanded, &root, width) == C_KZG_OK);
+    TEST_CHECK(expand_root_of_unity(expanded, &root, width, NULL) == C_KZG_OK);
 
     // Verify - each pair should multiply to one
     TEST_CHECK(true == fr_is_one(expanded + 0));
@@ -232,6 +651,148 @@ void new_fft_settings_is_plausible(void) {
     free_fft_settings(&s);
 }
 
+void expand_roots_in_parallel(void) {
+    unsigned int scale = 14;
+    uint64_t width = (uint64_t)1 << scale;
+    fr_t root, wrong, *serial, *parallel;
+    ThreadPool pool;
+
+    TEST_CHECK(C_KZG_OK == new_fr_array(&serial, width + 1));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&parallel, width + 1));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+
+    // Every block matches the straightforward chain of multiplications
+    fr_from_uint64s(&root, scale2_root_of_unity[scale]);
+    serial[0] = fr_one;
+    for (uint64_t i = 1; i <= width; i++) {
+        fr_mul(&serial[i], &serial[i - 1], &root);
+    }
+    TEST_CHECK(C_KZG_OK == expand_root_of_unity(parallel, &root, width, &pool));
+    for (uint64_t i = 0; i <= width; i++) {
+        TEST_CHECK(fr_equal(&serial[i], &parallel[i]));
+        TEST_MSG("Mismatch at %lu", i);
+    }
+
+    // Roots of too large or too small an order are rejected
+    TEST_CHECK(C_KZG_BADARGS == expand_root_of_unity(parallel, &root, width / 2, &pool));
+    fr_sqr(&wrong, &root);
+    TEST_CHECK(C_KZG_BADARGS == expand_root_of_unity(parallel, &wrong, width, &pool));
+
+    free_thread_pool(&pool);
+    free(serial);
+    free(parallel);
+}
+
+void new_fft_settings_parallel_matches(void) {
+    FFTSettings expected, actual;
+    ThreadPool pool;
+
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 4));
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&expected, 13));
+    TEST_CHECK(C_KZG_OK == new_fft_settings_parallel(&actual, 13, &pool));
+    TEST_CHECK(actual.pool == &pool);
+
+    for (uint64_t i = 0; i <= expected.max_width; i++) {
+        TEST_CHECK(fr_equal(&expected.expanded_roots_of_unity[i], &actual.expanded_roots_of_unity[i]));
+        TEST_CHECK(fr_equal(&expected.reverse_roots_of_unity[i], &actual.reverse_roots_of_unity[i]));
+    }
+    for (uint64_t i = 0; i < expected.max_width; i++) {
+        TEST_CHECK(fr_equal(&expected.stage_roots_of_unity[i], &actual.stage_roots_of_unity[i]));
+    }
+
+    free_fft_settings(&expected);
+    free_fft_settings(&actual);
+    free_thread_pool(&pool);
+}
+
+void lazy_fft_settings_match(void) {
+    FFTSettings eager, lazy;
+    uint64_t sizes[] = {16, FFT_FR_ITERATIVE_MIN_WIDTH * 2};
+    uint64_t expected_allocated = 0;
+    const fr_t *eager_roots, *lazy_roots;
+    uint64_t eager_stride, lazy_stride;
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&eager, 13));
+    TEST_CHECK(C_KZG_OK == new_fft_settings_lazy(&lazy, 20));
+    TEST_CHECK(lazy.expanded_roots_of_unity == NULL);
+    TEST_CHECK(lazy.cache->allocated == 0);
+
+    for (int s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+        uint64_t n = sizes[s];
+        fr_t *data, *expected, *actual;
+
+        TEST_CHECK(C_KZG_OK == fft_roots(&eager_roots, &eager_stride, n, &eager));
+        TEST_CHECK(C_KZG_OK == fft_roots(&lazy_roots, &lazy_stride, n, &lazy));
+        TEST_CHECK(lazy_stride == 1);
+        for (uint64_t i = 0; i <= n; i++) {
+            TEST_CHECK(fr_equal(&eager_roots[i * eager_stride], &lazy_roots[i]));
+        }
+
+        TEST_CHECK(C_KZG_OK == new_fr_array(&data, n));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&expected, n));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&actual, n));
+        for (uint64_t i = 0; i < n; i++) {
+            data[i] = rand_fr();
+        }
+        for (int inverse = 0; inverse <= 1; inverse++) {
+            TEST_CHECK(C_KZG_OK == fft_fr(expected, data, inverse, n, &eager));
+            TEST_CHECK(C_KZG_OK == fft_fr(actual, data, inverse, n, &lazy));
+            for (uint64_t i = 0; i < n; i++) {
+                TEST_CHECK(fr_equal(&expected[i], &actual[i]));
+                TEST_MSG("Mismatch at size %lu, inverse %d, index %lu", n, inverse, i);
+            }
+        }
+        free(data);
+        free(expected);
+        free(actual);
+
+        // Only the tables for the sizes used have been built, plus the stage roots for the iterative FFT
+        expected_allocated += n + 1;
+        if (n >= FFT_FR_ITERATIVE_MIN_WIDTH) expected_allocated += n;
+        TEST_CHECK(lazy.cache->allocated == expected_allocated);
+    }
+
+    free_fft_settings(&eager);
+    free_fft_settings(&lazy);
+}
+
+void shared_fft_settings_are_reused(void) {
+    const FFTSettings *fs1, *fs2;
+    uint64_t allocated = 0;
+    fr_t data[64], out[64], back[64];
+
+    TEST_CHECK(C_KZG_OK == borrow_fft_settings(&fs1));
+    TEST_CHECK(C_KZG_OK == borrow_fft_settings(&fs2));
+    TEST_CHECK(fs1 == fs2);
+    TEST_CHECK(fs1->cache != NULL);
+
+    // Warming builds every size up to the one asked for, and nothing more
+    TEST_CHECK(C_KZG_OK == warm_fft_settings_cache(6));
+    for (int scale = 0; scale <= 6; scale++) {
+        allocated += ((uint64_t)1 << scale) + 1;
+    }
+    TEST_CHECK(fs1->cache->allocated == allocated);
+    TEST_CHECK(C_KZG_BADARGS == warm_fft_settings_cache(FFT_SCALES));
+
+    // Using a warmed size builds nothing new
+    for (int i = 0; i < 64; i++) {
+        data[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == fft_fr(out, data, false, 64, fs1));
+    TEST_CHECK(C_KZG_OK == fft_fr(back, out, true, 64, fs2));
+    for (int i = 0; i < 64; i++) {
+        TEST_CHECK(fr_equal(&data[i], &back[i]));
+    }
+    TEST_CHECK(fs1->cache->allocated == allocated);
+
+    // The settings can only be freed once they have all been returned
+    release_fft_settings(fs1);
+    TEST_CHECK(C_KZG_BADARGS == free_fft_settings_cache());
+    release_fft_settings(fs2);
+    TEST_CHECK(C_KZG_OK == free_fft_settings_cache());
+    TEST_CHECK(C_KZG_OK == free_fft_settings_cache());
+}
+
 TEST_LIST = {
     {"FFT_COMMON_TEST", title},
     {"roots_of_unity_is_the_expected_size", roots_of_unity_is_the_expected_size},
@@ -239,6 +800,10 @@ TEST_LIST = {
     {"roots_of_unity_are_plausible", roots_of_unity_are_plausible},
     {"expand_roots_is_plausible", expand_roots_is_plausible},
     {"new_fft_settings_is_plausible", new_fft_settings_is_plausible},
+    {"expand_roots_in_parallel", expand_roots_in_parallel},
+    {"new_fft_settings_parallel_matches", new_fft_settings_parallel_matches},
+    {"lazy_fft_settings_match", lazy_fft_settings_match},
+    {"shared_fft_settings_are_reused", shared_fft_settings_are_reused},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
@@ -25,10 +25,19 @@
  * @remark Functions here work only for lengths that are a power of two.
  */
 
+#include <pthread.h>
 #include "control.h"
 #include "c_kzg.h"
+#include "c_kzg_alloc.h"
 #include "utility.h"
 
+/**
+ * The number of elements processed together in the early stages of #fft_fr_iterative (a tunable parameter).
+ *
+ * 1024 field elements is 32KiB, about the size of a typical L1 data cache.
+ */
+#define FFT_FR_BLOCK_SIZE 1024
+
 /**
  * Slow Fourier Transform.
  *
@@ -56,10 +65,126 @@ void fft_fr_slow(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots,
     }
 }
 
+/**
+ * Fourier transform of length four, a leaf of #fft_fr_fast.
+ *
+ * Fully unrolled, this needs only the one multiplication by a non-trivial root of unity.
+ *
+ * @param[out] out    The results (array of length 4)
+ * @param[in]  in     The input data (array of length 4 * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  w      A primitive fourth root of unity
+ */
+static void fft_fr_codelet4(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *w) {
+    fr_t s0, d0, s1, d1;
+    fr_add(&s0, &in[0], &in[2 * stride]);
+    fr_sub(&d0, &in[0], &in[2 * stride]);
+    fr_add(&s1, &in[stride], &in[3 * stride]);
+    fr_sub(&d1, &in[stride], &in[3 * stride]);
+    fr_mul(&d1, &d1, w);
+    fr_add(&out[0], &s0, &s1);
+    fr_sub(&out[2], &s0, &s1);
+    fr_add(&out[1], &d0, &d1);
+    fr_sub(&out[3], &d0, &d1);
+}
+
+/**
+ * Fourier transform of length eight, a leaf of #fft_fr_fast.
+ *
+ * Two #fft_fr_codelet4 transforms followed by a row of butterflies, the first of which needs no multiplication.
+ *
+ * @param[out] out    The results (array of length 8)
+ * @param[in]  in     The input data (array of length 8 * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  roots  Roots of unity (array of length 8 * @p roots_stride)
+ * @param[in]  roots_stride The stride interval among the roots of unity
+ */
+static void fft_fr_codelet8(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride) {
+    fr_t t;
+    fft_fr_codelet4(out, in, stride * 2, &roots[roots_stride * 2]);
+    fft_fr_codelet4(out + 4, in + stride, stride * 2, &roots[roots_stride * 2]);
+    t = out[4];
+    fr_sub(&out[4], &out[0], &t);
+    fr_add(&out[0], &out[0], &t);
+    fr_butterfly_vec(out + 1, out + 5, roots + roots_stride, roots_stride, 3);
+}
+
+/**
+ * The twiddle factors of #fft_fr_codelet16, as powers `w^k` and `w^-k` for `k` from 0 to 7.
+ *
+ * Here `w` is the primitive sixteenth root of unity, #scale2_root_of_unity at scale four, to which every size of
+ * settings reduces. They are given in canonical form, and converted once by #fft_fr_roots16_init.
+ */
+static const uint64_t fft_fr_roots16_u64[2][8][4] = {
+    {{0x0000000000000001L, 0x0000000000000000L, 0x0000000000000000L, 0x0000000000000000L},
+     {0x53ea61d87742bcceL, 0x17beb312f20b6f76L, 0xdd1c0af834cec32cL, 0x20b1ce9140267af9L},
+     {0x7228fd3397743f7aL, 0xb38b21c28713b700L, 0x8c0625cd70d77ce2L, 0x345766f603fa66e7L},
+     {0x807b811a823f728dL, 0x967a6b6cfb0faca4L, 0x5ccd4631f16edba4L, 0x1edc919ec91f38acL},
+     {0x0001000000000000L, 0xec03000276030000L, 0x8d51ccce760304d0L, 0x0000000000000000L},
+     {0x95df4b360411fe73L, 0x1ef4e672ebc1e1bbL, 0x6e92a9c460afca4aL, 0x4f2c596e753e4fccL},
+     {0x6037fe81ae99502eL, 0x8e74903694b04fd8L, 0xbabc5affca86bf65L, 0x1333b22e5ce11044L},
+     {0xa1abb31fb37786b9L, 0x57bc96af334c36bcL, 0xcabf643eda8951f2L, 0x38c7f2dd7e0c63fcL}},
+    {{0x0000000000000001L, 0x0000000000000000L, 0x0000000000000000L, 0x0000000000000000L},
+     {0x5e544cdf4c887948L, 0xfc010d53ccb22542L, 0x687a73c92f188612L, 0x3b25b475ab91194bL},
+     {0x9fc8017d5166afd3L, 0xc54913cc6b4e0c26L, 0x787d7d083f1b189fL, 0x60b9f524ccbc6d03L},
+     {0x6a20b4c8fbee018eL, 0x34c8bd90143c7a43L, 0xc4a72e43a8f20dbbL, 0x24c14de4b45f2d7bL},
+     {0xfffeffff00000001L, 0x67baa40089fb5bfeL, 0xa5e80b39939ed334L, 0x73eda753299d7d47L},
+     {0x7f847ee47dc08d74L, 0xbd43389604eeaf5aL, 0xd66c91d61832fc60L, 0x551115b4607e449bL},
+     {0x8dd702cb688bc087L, 0xa032824078eaa4feL, 0xa733b23a98ca5b22L, 0x3f96405d25a31660L},
+     {0xac159e2688bd4333L, 0x3bfef0f00df2ec88L, 0x561dcd0fd4d314d9L, 0x533bd8c1e977024eL}}};
+
+/** The twiddle factors of #fft_fr_codelet16 as field elements, forward then inverse. */
+static fr_t fft_fr_roots16_fr[2][8];
+
+/** Converts #fft_fr_roots16_fr the first time a length sixteen transform is run. */
+static pthread_once_t fft_fr_roots16_once = PTHREAD_ONCE_INIT;
+
+static void fft_fr_roots16_init(void) {
+    for (int d = 0; d < 2; d++) {
+        for (int k = 0; k < 8; k++) {
+            fr_from_uint64s(&fft_fr_roots16_fr[d][k], fft_fr_roots16_u64[d][k]);
+        }
+    }
+}
+
+/**
+ * Find the baked twiddle factors for a length sixteen transform.
+ *
+ * @param[in] w The primitive sixteenth root of unity that the transform is to use
+ * @return The eight contiguous twiddles `w^k`, or `NULL` if @p w is neither of the baked roots
+ */
+static const fr_t *fft_fr_roots16(const fr_t *w) {
+    pthread_once(&fft_fr_roots16_once, fft_fr_roots16_init);
+    if (fr_equal(w, &fft_fr_roots16_fr[0][1])) return fft_fr_roots16_fr[0];
+    if (fr_equal(w, &fft_fr_roots16_fr[1][1])) return fft_fr_roots16_fr[1];
+    return NULL;
+}
+
+/**
+ * Fourier transform of length sixteen, a leaf of #fft_fr_fast.
+ *
+ * The twiddles are read contiguously from a baked table, rather than at a wide stride through the settings, and the
+ * two halves reuse them at a stride of two.
+ *
+ * @param[out] out    The results (array of length 16)
+ * @param[in]  in     The input data (array of length 16 * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  w      The twiddles `w^k` for `k` from 0 to 7, from #fft_fr_roots16
+ */
+static void fft_fr_codelet16(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *w) {
+    fr_t t;
+    fft_fr_codelet8(out, in, stride * 2, w, 2);
+    fft_fr_codelet8(out + 8, in + stride, stride * 2, w, 2);
+    t = out[8];
+    fr_sub(&out[8], &out[0], &t);
+    fr_add(&out[0], &out[0], &t);
+    fr_butterfly_vec(out + 1, out + 9, w + 1, 1, 7);
+}
+
 /**
  * Fast Fourier Transform.
  *
- * Recursively divide and conquer.
+ * Recursively divide and conquer, down to unrolled transforms for lengths of sixteen or less.
  *
  * @param[out] out    The results (array of length @p n)
  * @param[in]  in     The input data (array of length @p n * @p stride)
@@ -71,23 +196,276 @@ void fft_fr_slow(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots,
 void fft_fr_fast(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride,
                         uint64_t n) {
     uint64_t half = n / 2;
-    if (half > 0) { // Tunable parameter
+    const fr_t *w;
+    switch (n) {
+    case 1:
+        *out = *in;
+        break;
+    case 2:
+        fr_add(&out[0], &in[0], &in[stride]);
+        fr_sub(&out[1], &in[0], &in[stride]);
+        break;
+    case 4:
+        fft_fr_codelet4(out, in, stride, &roots[roots_stride]);
+        break;
+    case 8:
+        fft_fr_codelet8(out, in, stride, roots, roots_stride);
+        break;
+    case 16:
+        if ((w = fft_fr_roots16(&roots[roots_stride])) != NULL) {
+            fft_fr_codelet16(out, in, stride, w);
+            break;
+        }
+        // Other roots fall through to the general path
+    default:
         fft_fr_fast(out, in, stride * 2, roots, roots_stride * 2, half);
         fft_fr_fast(out + half, in + stride, stride * 2, roots, roots_stride * 2, half);
-        for (uint64_t i = 0; i < half; i++) {
-            fr_t y_times_root;
-            fr_mul(&y_times_root, &out[i + half], &roots[i * roots_stride]);
-            fr_sub(&out[i + half], &out[i], &y_times_root);
-            fr_add(&out[i], &out[i], &y_times_root);
+        fr_butterfly_vec(out, out + half, roots, roots_stride, half);
+    }
+}
+
+/**
+ * Radix-2 butterflies for one stage of the iterative FFT.
+ *
+ * @param[in,out] data   The data being transformed (array of length @p len)
+ * @param[in]     len    The length of @p data, a multiple of `2 * m`
+ * @param[in]     m      Half the width of the butterflies in this stage
+ * @param[in]     roots  Stage roots of unity, as built by #new_fft_settings
+ */
+static void fft_fr_radix2(fr_t *data, uint64_t len, uint64_t m, const fr_t *roots) {
+    for (uint64_t k = 0; k < len; k += 2 * m) {
+        fr_butterfly_vec(data + k, data + k + m, roots + m, 1, m);
+    }
+}
+
+/**
+ * The first two stages of the iterative FFT, as unrolled transforms of length four.
+ *
+ * Only one of the four roots of unity in these stages is non-trivial, so this needs a quarter of the multiplications of
+ * #fft_fr_radix4 with `m = 1`.
+ *
+ * @param[in,out] data   The data being transformed (array of length @p len)
+ * @param[in]     len    The length of @p data, a multiple of four
+ * @param[in]     roots  Stage roots of unity, as built by #new_fft_settings
+ */
+static void fft_fr_radix4_first(fr_t *data, uint64_t len, const fr_t *roots) {
+    const fr_t *w = &roots[3]; // The primitive fourth root of unity
+    for (uint64_t k = 0; k < len; k += 4) {
+        fr_t t0, t1, t2, t3, *a = data + k;
+        fr_add(&t0, &a[0], &a[1]);
+        fr_sub(&t1, &a[0], &a[1]);
+        fr_add(&t2, &a[2], &a[3]);
+        fr_sub(&t3, &a[2], &a[3]);
+        fr_mul(&t3, &t3, w);
+        fr_add(&a[0], &t0, &t2);
+        fr_sub(&a[2], &t0, &t2);
+        fr_add(&a[1], &t1, &t3);
+        fr_sub(&a[3], &t1, &t3);
+    }
+}
+
+/**
+ * Radix-4 butterflies, equivalent to two consecutive radix-2 stages, for the iterative FFT.
+ *
+ * Combining the stages halves the number of passes over the data for the same number of multiplications.
+ *
+ * @param[in,out] data   The data being transformed (array of length @p len)
+ * @param[in]     len    The length of @p data, a multiple of `4 * m`
+ * @param[in]     m      Half the width of the butterflies in the first of the two stages
+ * @param[in]     roots  Stage roots of unity, as built by #new_fft_settings
+ */
+static void fft_fr_radix4(fr_t *data, uint64_t len, uint64_t m, const fr_t *roots) {
+    const fr_t *w2 = roots + m, *w4 = roots + 2 * m;
+    for (uint64_t k = 0; k < len; k += 4 * m) {
+        fr_t *a0 = data + k, *a1 = a0 + m, *a2 = a1 + m, *a3 = a2 + m;
+        for (uint64_t j = 0; j < m; j++) {
+            fr_t t0, t1, t2, t3, u, v;
+
+            // First stage: pairs (a0, a1) and (a2, a3) with the 2m-th roots of unity
+            fr_mul(&u, &a1[j], &w2[j]);
+            fr_mul(&v, &a3[j], &w2[j]);
+            fr_add(&t0, &a0[j], &u);
+            fr_sub(&t1, &a0[j], &u);
+            fr_add(&t2, &a2[j], &v);
+            fr_sub(&t3, &a2[j], &v);
+
+            // Second stage: pairs (t0, t2) and (t1, t3) with the 4m-th roots of unity
+            fr_mul(&u, &t2, &w4[j]);
+            fr_mul(&v, &t3, &w4[j + m]);
+            fr_add(&a0[j], &t0, &u);
+            fr_sub(&a2[j], &t0, &u);
+            fr_add(&a1[j], &t1, &v);
+            fr_sub(&a3[j], &t1, &v);
         }
-    } else {
+    }
+}
+
+/**
+ * Perform the iterative FFT stages with butterfly half-widths from @p m up to, but not including, @p m_end.
+ *
+ * @param[in,out] data   The data being transformed (array of length @p len)
+ * @param[in]     len    The length of @p data, a multiple of @p m_end
+ * @param[in]     m      The half-width of the first stage, a power of two
+ * @param[in]     m_end  One more than the half-width of the last stage, a power of two no more than @p len
+ * @param[in]     roots  Stage roots of unity, as built by #new_fft_settings
+ */
+static void fft_fr_stages(fr_t *data, uint64_t len, uint64_t m, uint64_t m_end, const fr_t *roots) {
+    if (m == 1 && m_end >= 4) {
+        fft_fr_radix4_first(data, len, roots);
+        m = 4;
+    }
+    while (m < m_end) {
+        if (2 * m < m_end) {
+            fft_fr_radix4(data, len, m, roots);
+            m *= 4;
+        } else {
+            fft_fr_radix2(data, len, m, roots);
+            m *= 2;
+        }
+    }
+}
+
+/**
+ * The butterfly stages of #fft_fr_iterative, on data already in bit-reversal order.
+ *
+ * The early stages are done block by block, each block of #FFT_FR_BLOCK_SIZE elements being taken through all of
+ * them while it is in cache, before the remaining stages are done over the whole array.
+ *
+ * @param[in,out] data  The data being transformed (array of length @p n)
+ * @param[in]     roots Stage roots of unity, as for #fft_fr_iterative
+ * @param[in]     n     Length of the FFT, a power of two
+ */
+static void fft_fr_iterative_stages(fr_t *data, const fr_t *roots, uint64_t n) {
+    uint64_t block = n < FFT_FR_BLOCK_SIZE ? n : FFT_FR_BLOCK_SIZE;
+    for (uint64_t k = 0; k < n; k += block) {
+        fft_fr_stages(data + k, block, 1, block, roots);
+    }
+    fft_fr_stages(data, n, block, n, roots);
+}
+
+/**
+ * Iterative Fast Fourier Transform.
+ *
+ * The input is permuted into bit-reversal order, and then transformed in place, stage by stage, using radix-4
+ * butterflies. Unlike #fft_fr_fast, the roots of unity for each stage are read contiguously.
+ *
+ * @remark @p out and @p in may be the same array.
+ *
+ * @param[out] out   The results (array of length @p n)
+ * @param[in]  in    The input data (array of length @p n)
+ * @param[in]  roots Stage roots of unity: `roots[m + j]` is `w^j` where `w` is a primitive `2m`-th root of unity,
+ *                   for each power of two `m < n`, and `j < m`. See the `stage_roots_of_unity` in #FFTSettings.
+ * @param[in]  n     Length of the FFT, must be a power of two less than 2^32
+ */
+void fft_fr_iterative(fr_t *out, const fr_t *in, const fr_t *roots, uint64_t n) {
+    if (n == 1) {
         *out = *in;
+        return;
     }
+
+    if (out == in) {
+        reverse_bit_order(out, sizeof(fr_t), n);
+    } else {
+        for (uint64_t i = 0; i < n; i++) {
+            out[reverse_bits_limited(n, i)] = in[i];
+        }
+    }
+
+    fft_fr_iterative_stages(out, roots, n);
+}
+
+/**
+ * Iterative Fast Fourier Transform over a coset.
+ *
+ * As #fft_fr_iterative, but evaluating at `shift` times the roots of unity. The input is multiplied by the powers of
+ * @p shift as it is permuted into bit-reversal order, so this takes no more passes over the data than the plain FFT.
+ *
+ * @param[out] out   The results (array of length @p n)
+ * @param[in]  in    The input data (array of length @p n), which must not overlap @p out
+ * @param[in]  shift The coset shift
+ * @param[in]  roots Stage roots of unity, as for #fft_fr_iterative
+ * @param[in]  n     Length of the FFT, must be a power of two less than 2^32
+ */
+static void fft_fr_iterative_coset(fr_t *out, const fr_t *in, const fr_t *shift, const fr_t *roots, uint64_t n) {
+    fr_t pow = *shift;
+    out[0] = in[0];
+    for (uint64_t i = 1; i < n; i++) {
+        fr_mul(&out[reverse_bits_limited(n, i)], &in[i], &pow);
+        fr_mul(&pow, &pow, shift);
+    }
+
+    fft_fr_iterative_stages(out, roots, n);
+}
+
+/**
+ * Multiply the elements of an array by the terms of a geometric sequence, in place.
+ *
+ * @param[in,out] data  The array (of length @p n)
+ * @param[in]     start The multiplier of `data[0]`
+ * @param[in]     ratio The ratio of each multiplier to the one before
+ * @param[in]     n     The length of @p data
+ */
+static void scale_by_powers(fr_t *data, const fr_t *start, const fr_t *ratio, uint64_t n) {
+    fr_t pow = *start;
+    for (uint64_t i = 0; i < n; i++) {
+        fr_mul(&data[i], &data[i], &pow);
+        fr_mul(&pow, &pow, ratio);
+    }
+}
+
+/**
+ * Forward FFT, or inverse FFT without the final division by @p n.
+ *
+ * @param[out] out     The results (array of length @p n)
+ * @param[in]  in      The input data (array of length @p n)
+ * @param[in]  inverse `false` for forward transform, `true` for inverse transform
+ * @param[in]  n       Length of the FFT, a power of two no larger than `fs->max_width`
+ * @param[in]  fs      Previously initialised FFT settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+static C_KZG_RET fft_fr_unscaled(fr_t *out, const fr_t *in, bool inverse, uint64_t n, const FFTSettings *fs) {
+    STAT_SCOPE(FFT_FR);
+    const fr_t *roots;
+    uint64_t stride;
+
+    STAT_SIZED(FFT_FR, n);
+
+    if (inverse && fs->cache == NULL) {
+        stride = fs->max_width / n;
+        if (n >= FFT_FR_ITERATIVE_MIN_WIDTH) {
+            fft_fr_iterative(out, in, fs->reverse_stage_roots_of_unity, n);
+        } else {
+            fft_fr_fast(out, in, 1, fs->reverse_roots_of_unity, stride, n);
+        }
+        return C_KZG_OK;
+    }
+
+    if (n >= FFT_FR_ITERATIVE_MIN_WIDTH) {
+        TRY(fft_stage_roots(&roots, n, fs));
+        fft_fr_iterative(out, in, roots, n);
+    } else {
+        TRY(fft_roots(&roots, &stride, n, fs));
+        fft_fr_fast(out, in, 1, roots, stride, n);
+    }
+
+    if (inverse) {
+        // Lazy settings keep no reversed roots: the inverse is the forward transform with outputs 1 to n - 1 reversed
+        for (uint64_t i = 1; i < n / 2; i++) {
+            fr_t tmp = out[i];
+            out[i] = out[n - i];
+            out[n - i] = tmp;
+        }
+    }
+
+    return C_KZG_OK;
 }
 
 /**
  * The main entry point for forward and reverse FFTs over the finite field.
  *
+ * Sizes of at least #FFT_FR_ITERATIVE_MIN_WIDTH use #fft_fr_iterative, and smaller sizes use #fft_fr_fast.
+ *
  * @param[out] out     The results (array of length @p n)
  * @param[in]  in      The input data (array of length @p n)
  * @param[in]  inverse `false` for forward transform, `true` for inverse transform
@@ -95,22 +473,78 @@ void fft_fr_fast(fr_t *out, const fr_t *in, uint64_t stride, const fr_t *roots,
  * @param[in]  fs      Pointer to previously initialised FFTSettings structure with `max_width` at least @p n.
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
  */
 C_KZG_RET fft_fr(fr_t *out, const fr_t *in, bool inverse, uint64_t n, const FFTSettings *fs) {
-    uint64_t stride = fs->max_width / n;
+    fr_t inv_len;
+
     CHECK(n <= fs->max_width);
     CHECK(is_power_of_two(n));
+
+    TRY(fft_fr_unscaled(out, in, inverse, n, fs));
+
     if (inverse) {
-        fr_t inv_len;
         fr_from_uint64(&inv_len, n);
         fr_inv(&inv_len, &inv_len);
-        fft_fr_fast(out, in, 1, fs->reverse_roots_of_unity, stride, n);
-        for (uint64_t i = 0; i < n; i++) {
-            fr_mul(&out[i], &out[i], &inv_len);
-        }
-    } else {
-        fft_fr_fast(out, in, 1, fs->expanded_roots_of_unity, stride, n);
+        fr_scale_vec(out, out, &inv_len, n);
     }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Forward and reverse FFTs over a coset of the roots of unity.
+ *
+ * The forward transform evaluates the polynomial with coefficients @p in at the points `shift * w^i`, where `w` is
+ * the primitive @p n-th root of unity, and the inverse transform interpolates the polynomial from its values at those
+ * points. This is the same as multiplying coefficient `i` by `shift^i` before #fft_fr, or by `shift^-i` after the
+ * inverse #fft_fr, but the multiplications are folded into the permutation of the input or the final scaling of the
+ * output rather than taking a pass over the data of their own.
+ *
+ * @remark Forward transforms with settings made by #new_fft_settings that have no stage roots of unity, because
+ * `max_width` is less than #FFT_FR_ITERATIVE_MIN_WIDTH, are done the unfolded way, with a temporary array.
+ *
+ * @param[out] out     The results (array of length @p n)
+ * @param[in]  in      The input data (array of length @p n), which must not overlap @p out
+ * @param[in]  inverse `false` for forward transform, `true` for inverse transform
+ * @param[in]  shift   The coset shift, which must be non-zero
+ * @param[in]  n       Length of the FFT, must be a power of two
+ * @param[in]  fs      Pointer to previously initialised FFTSettings structure with `max_width` at least @p n.
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET fft_fr_coset(fr_t *out, const fr_t *in, bool inverse, const fr_t *shift, uint64_t n,
+                       const FFTSettings *fs) {
+    const fr_t *roots;
+    uint64_t stride;
+    fr_t factor, ratio, *tmp;
+
+    CHECK(n <= fs->max_width);
+    CHECK(is_power_of_two(n));
+    CHECK(!fr_is_zero(shift));
+
+    if (inverse) {
+        TRY(fft_fr_unscaled(out, in, true, n, fs));
+        fr_from_uint64(&factor, n);
+        fr_inv(&factor, &factor);
+        fr_inv(&ratio, shift);
+        scale_by_powers(out, &factor, &ratio, n);
+        return C_KZG_OK;
+    }
+
+    if (fs->cache != NULL || fs->stage_roots_of_unity != NULL) {
+        TRY(fft_stage_roots(&roots, n, fs));
+        fft_fr_iterative_coset(out, in, shift, roots, n);
+        return C_KZG_OK;
+    }
+
+    TRY(fft_roots(&roots, &stride, n, fs));
+    TRY(new_fr_array(&tmp, n));
+    fr_mul_powers_vec(tmp, in, shift, n);
+    fft_fr_fast(out, tmp, 1, roots, stride, n);
+    c_kzg_free(tmp);
+
     return C_KZG_OK;
 }
 
@@ -229,12 +663,180 @@ void stride_fft(void) {
     free_fft_settings(&fs2);
 }
 
+void small_fft(void) {
+    // Each of the unrolled lengths, and the first that recurses into them, with strided input and roots
+    FFTSettings fs;
+    TEST_CHECK(new_fft_settings(&fs, 6) == C_KZG_OK);
+    fr_t data[2 * fs.max_width], out0[fs.max_width], out1[fs.max_width];
+    for (int i = 0; i < 2 * fs.max_width; i++) {
+        data[i] = rand_fr();
+    }
+
+    for (uint64_t n = 1; n <= 16; n *= 2) {
+        fft_fr_slow(out0, data, 2, fs.expanded_roots_of_unity, fs.max_width / n, n);
+        fft_fr_fast(out1, data, 2, fs.expanded_roots_of_unity, fs.max_width / n, n);
+        for (int i = 0; i < n; i++) {
+            TEST_CHECK(fr_equal(out0 + i, out1 + i));
+            TEST_MSG("Mismatch at n = %lu, i = %d", n, i);
+        }
+    }
+
+    free_fft_settings(&fs);
+}
+
+void codelet16_fft(void) {
+    // The baked twiddles in both directions, at each size of settings that has them, and a root that is not baked
+    fr_t data[32], out0[16], out1[16], other[16], w3;
+    for (int i = 0; i < 32; i++) {
+        data[i] = rand_fr();
+    }
+
+    for (unsigned int scale = 4; scale <= 8; scale += 4) {
+        FFTSettings fs;
+        TEST_CHECK(new_fft_settings(&fs, scale) == C_KZG_OK);
+        for (int inv = 0; inv < 2; inv++) {
+            const fr_t *roots = inv ? fs.reverse_roots_of_unity : fs.expanded_roots_of_unity;
+            fft_fr_slow(out0, data, 2, roots, fs.max_width / 16, 16);
+            fft_fr_fast(out1, data, 2, roots, fs.max_width / 16, 16);
+            for (int i = 0; i < 16; i++) {
+                TEST_CHECK(fr_equal(out0 + i, out1 + i));
+                TEST_MSG("Mismatch at scale = %u, inv = %d, i = %d", scale, inv, i);
+            }
+        }
+        free_fft_settings(&fs);
+    }
+
+    FFTSettings fs;
+    TEST_CHECK(new_fft_settings(&fs, 4) == C_KZG_OK);
+    w3 = fs.expanded_roots_of_unity[3];
+    other[0] = fr_one;
+    for (int i = 1; i < 16; i++) {
+        fr_mul(&other[i], &other[i - 1], &w3);
+    }
+    fft_fr_slow(out0, data, 1, other, 1, 16);
+    fft_fr_fast(out1, data, 1, other, 1, 16);
+    for (int i = 0; i < 16; i++) {
+        TEST_CHECK(fr_equal(out0 + i, out1 + i));
+        TEST_MSG("Mismatch with other roots at i = %d", i);
+    }
+    free_fft_settings(&fs);
+}
+
+void compare_iterative_fft(void) {
+    // Large enough to have more stages than fit in a block, with an odd number of stages overall
+    unsigned int size = 13;
+    FFTSettings fs;
+    TEST_CHECK(new_fft_settings(&fs, size) == C_KZG_OK);
+    TEST_CHECK(fs.stage_roots_of_unity != NULL);
+    fr_t *data = malloc(fs.max_width * sizeof(fr_t));
+    fr_t *out0 = malloc(fs.max_width * sizeof(fr_t));
+    fr_t *out1 = malloc(fs.max_width * sizeof(fr_t));
+    for (int i = 0; i < fs.max_width; i++) {
+        data[i] = rand_fr();
+    }
+
+    // Every size that the stage roots support, including in-place
+    for (uint64_t n = 1; n <= fs.max_width; n *= 2) {
+        fft_fr_fast(out0, data, 1, fs.expanded_roots_of_unity, fs.max_width / n, n);
+        fft_fr_iterative(out1, data, fs.stage_roots_of_unity, n);
+        for (int i = 0; i < n; i++) {
+            TEST_CHECK(fr_equal(out0 + i, out1 + i));
+            TEST_MSG("Mismatch at n = %lu, i = %d", n, i);
+        }
+
+        for (int i = 0; i < n; i++) {
+            out1[i] = data[i];
+        }
+        fft_fr_iterative(out1, out1, fs.stage_roots_of_unity, n);
+        for (int i = 0; i < n; i++) {
+            TEST_CHECK(fr_equal(out0 + i, out1 + i));
+            TEST_MSG("In-place mismatch at n = %lu, i = %d", n, i);
+        }
+    }
+
+    // The inverse via the main entry point
+    TEST_CHECK(fft_fr(out0, data, false, fs.max_width, &fs) == C_KZG_OK);
+    TEST_CHECK(fft_fr(out1, out0, true, fs.max_width, &fs) == C_KZG_OK);
+    for (int i = 0; i < fs.max_width; i++) {
+        TEST_CHECK(fr_equal(data + i, out1 + i));
+    }
+
+    free(data);
+    free(out0);
+    free(out1);
+    free_fft_settings(&fs);
+}
+
+void coset_fft(void) {
+    // Eager settings with and without stage roots, and lazy settings, at sizes either side of the iterative threshold
+    FFTSettings fs[3];
+    TEST_CHECK(new_fft_settings(&fs[0], 6) == C_KZG_OK);
+    TEST_CHECK(new_fft_settings(&fs[1], 13) == C_KZG_OK);
+    TEST_CHECK(new_fft_settings_lazy(&fs[2], 13) == C_KZG_OK);
+    uint64_t width = fs[1].max_width;
+    fr_t *data = malloc(width * sizeof(fr_t));
+    fr_t *scaled = malloc(width * sizeof(fr_t));
+    fr_t *expected = malloc(width * sizeof(fr_t));
+    fr_t *out = malloc(width * sizeof(fr_t));
+    fr_t *back = malloc(width * sizeof(fr_t));
+    fr_t shift, pow;
+    for (int i = 0; i < width; i++) {
+        data[i] = rand_fr();
+    }
+    fr_from_uint64(&shift, 7);
+
+    for (int f = 0; f < 3; f++) {
+        for (uint64_t n = 1; n <= fs[f].max_width; n *= 8) {
+            // Against the FFT of explicitly scaled coefficients
+            pow = fr_one;
+            for (int i = 0; i < n; i++) {
+                fr_mul(&scaled[i], &data[i], &pow);
+                fr_mul(&pow, &pow, &shift);
+            }
+            TEST_CHECK(fft_fr(expected, scaled, false, n, &fs[f]) == C_KZG_OK);
+            TEST_CHECK(fft_fr_coset(out, data, false, &shift, n, &fs[f]) == C_KZG_OK);
+            for (int i = 0; i < n; i++) {
+                TEST_CHECK(fr_equal(&expected[i], &out[i]));
+                TEST_MSG("Mismatch with settings %d at n = %lu, i = %d", f, n, i);
+            }
+
+            // And back again
+            TEST_CHECK(fft_fr_coset(back, out, true, &shift, n, &fs[f]) == C_KZG_OK);
+            for (int i = 0; i < n; i++) {
+                TEST_CHECK(fr_equal(&data[i], &back[i]));
+                TEST_MSG("Inverse mismatch with settings %d at n = %lu, i = %d", f, n, i);
+            }
+        }
+    }
+
+    // The value of the polynomial at the shift itself
+    poly p = {data, 16};
+    eval_poly(&expected[0], &p, &shift);
+    TEST_CHECK(fft_fr_coset(out, data, false, &shift, 16, &fs[0]) == C_KZG_OK);
+    TEST_CHECK(fr_equal(&expected[0], &out[0]));
+
+    TEST_CHECK(fft_fr_coset(out, data, false, &fr_zero, 16, &fs[0]) == C_KZG_BADARGS);
+
+    free(data);
+    free(scaled);
+    free(expected);
+    free(out);
+    free(back);
+    for (int f = 0; f < 3; f++) {
+        free_fft_settings(&fs[f]);
+    }
+}
+
 TEST_LIST = {
     {"FFT_FR_TEST", title},
     {"compare_sft_fft", compare_sft_fft},
     {"roundtrip_fft", roundtrip_fft},
     {"inverse_fft", inverse_fft},
     {"stride_fft", stride_fft},
+    {"small_fft", small_fft},
+    {"codelet16_fft", codelet16_fft},
+    {"compare_iterative_fft", compare_iterative_fft},
+    {"coset_fft", coset_fft},
 
     {NULL, NULL} /* zero record marks the end of the list */
 };
@@ -22,10 +22,12 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Which FFT implementation to benchmark
+typedef enum { FFT_AUTO, FFT_RECURSIVE, FFT_ITERATIVE } fft_variant;
+
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+bench_result run_bench(int scale, int max_seconds, fft_variant variant) {
+    bench_t bench;
     FFTSettings fs;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
@@ -40,24 +42,35 @@ long run_bench(int scale, int max_seconds) {
         data[i] = rand_fr();
     }
 
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
-        assert(C_KZG_OK == fft_fr(out, data, false, fs.max_width, &fs));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        switch (variant) {
+        case FFT_AUTO:
+            assert(C_KZG_OK == fft_fr(out, data, false, fs.max_width, &fs));
+            break;
+        case FFT_RECURSIVE:
+            fft_fr_fast(out, data, 1, fs.expanded_roots_of_unity, 1, fs.max_width);
+            break;
+        case FFT_ITERATIVE:
+            fft_fr_iterative(out, data, fs.stage_roots_of_unity, fs.max_width);
+            break;
+        }
+        bench_stop(&bench);
     }
 
     free(out);
     free(data);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, ((uint64_t)1 << scale) * sizeof(fr_t));
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
 
+    argc = bench_init(argc, argv);
+
     switch (argc) {
     case 1:
         nsec = NSEC;
@@ -70,14 +83,20 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking FFT_fr, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking FFT_fr, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
     for (int scale = 4; scale <= 15; scale++) {
-        printf("fft_fr/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec, FFT_AUTO), "fft_fr/scale_%d", scale);
+    }
+
+    // The iterative engine needs stage roots, which are only built for large enough settings
+    for (int scale = 12; scale <= 18; scale++) {
+        bench_report(run_bench(scale, nsec, FFT_RECURSIVE), "fft_fr_fast/scale_%d", scale);
+        bench_report(run_bench(scale, nsec, FFT_ITERATIVE), "fft_fr_iterative/scale_%d", scale);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
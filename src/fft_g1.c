@@ -66,10 +66,58 @@ void fft_g1_slow(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots,
     }
 }
 
+/**
+ * Fourier transform of length four, a leaf of #fft_g1_fast.
+ *
+ * Fully unrolled, this needs only the one multiplication by a non-trivial root of unity.
+ *
+ * @param[out] out    The results (array of length 4)
+ * @param[in]  in     The input data (array of length 4 * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  w      A primitive fourth root of unity
+ */
+static void fft_g1_codelet4(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *w) {
+    g1_t s0, d0, s1, d1;
+    g1_add_or_dbl(&s0, &in[0], &in[2 * stride]);
+    g1_sub(&d0, &in[0], &in[2 * stride]);
+    g1_add_or_dbl(&s1, &in[stride], &in[3 * stride]);
+    g1_sub(&d1, &in[stride], &in[3 * stride]);
+    g1_mul(&d1, &d1, w);
+    g1_add_or_dbl(&out[0], &s0, &s1);
+    g1_sub(&out[2], &s0, &s1);
+    g1_add_or_dbl(&out[1], &d0, &d1);
+    g1_sub(&out[3], &d0, &d1);
+}
+
+/**
+ * Fourier transform of length eight, a leaf of #fft_g1_fast.
+ *
+ * Two #fft_g1_codelet4 transforms followed by a row of butterflies, the first of which needs no multiplication.
+ *
+ * @param[out] out    The results (array of length 8)
+ * @param[in]  in     The input data (array of length 8 * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  roots  Roots of unity (array of length 8 * @p roots_stride)
+ * @param[in]  roots_stride The stride interval among the roots of unity
+ */
+static void fft_g1_codelet8(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride) {
+    g1_t t;
+    fft_g1_codelet4(out, in, stride * 2, &roots[roots_stride * 2]);
+    fft_g1_codelet4(out + 4, in + stride, stride * 2, &roots[roots_stride * 2]);
+    t = out[4];
+    g1_sub(&out[4], &out[0], &t);
+    g1_add_or_dbl(&out[0], &out[0], &t);
+    for (uint64_t i = 1; i < 4; i++) {
+        g1_mul(&t, &out[i + 4], &roots[i * roots_stride]);
+        g1_sub(&out[i + 4], &out[i], &t);
+        g1_add_or_dbl(&out[i], &out[i], &t);
+    }
+}
+
 /**
  * Fast Fourier Transform.
  *
- * Recursively divide and conquer.
+ * Recursively divide and conquer, down to unrolled transforms for lengths of eight or less.
  *
  * @param[out] out    The results (array of length @p n)
  * @param[in]  in     The input data (array of length @p n * @p stride)
@@ -81,7 +129,14 @@ void fft_g1_slow(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots,
 void fft_g1_fast(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride,
                         uint64_t n) {
     uint64_t half = n / 2;
-    if (half > 0) { // Tunable parameter
+    if (n == 2) {
+        g1_add_or_dbl(&out[0], &in[0], &in[stride]);
+        g1_sub(&out[1], &in[0], &in[stride]);
+    } else if (n == 4) {
+        fft_g1_codelet4(out, in, stride, &roots[roots_stride]);
+    } else if (n == 8) {
+        fft_g1_codelet8(out, in, stride, roots, roots_stride);
+    } else if (half > 0) {
         fft_g1_fast(out, in, stride * 2, roots, roots_stride * 2, half);
         fft_g1_fast(out + half, in + stride, stride * 2, roots, roots_stride * 2, half);
         for (uint64_t i = 0; i < half; i++) {
@@ -95,9 +150,109 @@ void fft_g1_fast(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots,
     }
 }
 
+/**
+ * The smallest G1 FFT that is split across a thread pool (a tunable parameter).
+ */
+#define FFT_G1_PARALLEL_MIN_WIDTH 64
+
+/**
+ * The shared state for the tasks of #fft_g1_parallel.
+ */
+typedef struct {
+    g1_t *out;             /**< The results */
+    const g1_t *in;        /**< The input data */
+    uint64_t stride;       /**< The input data stride */
+    const fr_t *roots;     /**< Roots of unity */
+    uint64_t roots_stride; /**< The stride interval among the roots of unity */
+    uint64_t n;            /**< Length of the FFT */
+    uint64_t sub_count;    /**< The number of independent sub-FFTs at the top level of the recursion */
+    uint64_t half;         /**< Half the width of the butterflies in the current row */
+    uint64_t task_len;     /**< The number of butterflies, or elements to be scaled, in each task */
+    const fr_t *scale;     /**< The factor for #fft_g1_scale_task */
+} fft_g1_job;
+
+/**
+ * Compute sub-FFT @p i of the top level of the recursion, as one task of #fft_g1_parallel.
+ *
+ * Expanding the recursion of #fft_g1_fast `log2(sub_count)` times, output block `i` is the FFT of the input elements
+ * starting at offset `reverse_bits(i)`, with stride `sub_count` times the original.
+ *
+ * @param[in] arg The #fft_g1_job
+ * @param[in] i   The index of the sub-FFT
+ */
+static void fft_g1_sub_task(void *arg, uint64_t i) {
+    const fft_g1_job *job = arg;
+    uint64_t len = job->n / job->sub_count;
+    uint64_t offset = reverse_bits_limited(job->sub_count, i);
+    fft_g1_fast(job->out + i * len, job->in + offset * job->stride, job->stride * job->sub_count, job->roots,
+                job->roots_stride * job->sub_count, len);
+}
+
+/**
+ * Perform the butterflies in range @p t of the current row, as one task of #fft_g1_parallel.
+ *
+ * @param[in] arg The #fft_g1_job
+ * @param[in] t   The index of the range of butterflies
+ */
+static void fft_g1_butterfly_task(void *arg, uint64_t t) {
+    const fft_g1_job *job = arg;
+    uint64_t half = job->half, roots_stride = job->roots_stride * (job->n / (2 * half));
+    uint64_t start = t * job->task_len, end = start + job->task_len < job->n / 2 ? start + job->task_len : job->n / 2;
+    for (uint64_t b = start; b < end; b++) {
+        g1_t y_times_root, *x = job->out + (b / half) * 2 * half + b % half;
+        g1_mul(&y_times_root, &x[half], &job->roots[(b % half) * roots_stride]);
+        g1_sub(&x[half], &x[0], &y_times_root);
+        g1_add_or_dbl(&x[0], &x[0], &y_times_root);
+    }
+}
+
+/**
+ * Multiply the elements in range @p t of the output by a scalar, as one task of #fft_g1.
+ *
+ * @param[in] arg The #fft_g1_job
+ * @param[in] t   The index of the range of elements
+ */
+static void fft_g1_scale_task(void *arg, uint64_t t) {
+    const fft_g1_job *job = arg;
+    uint64_t start = t * job->task_len, end = start + job->task_len < job->n ? start + job->task_len : job->n;
+    for (uint64_t i = start; i < end; i++) {
+        g1_mul(&job->out[i], &job->out[i], job->scale);
+    }
+}
+
+/**
+ * Fast Fourier Transform using a thread pool.
+ *
+ * The top levels of the recursion in #fft_g1_fast are unrolled: enough independent sub-FFTs to keep all the threads
+ * busy are computed in parallel, followed by the remaining rows of butterflies, each row being divided between the
+ * threads.
+ *
+ * @param[out] out    The results (array of length @p n)
+ * @param[in]  in     The input data (array of length @p n * @p stride)
+ * @param[in]  stride The input data stride
+ * @param[in]  roots  Roots of unity (array of length @p n * @p roots_stride)
+ * @param[in]  roots_stride The stride interval among the roots of unity
+ * @param[in]  n      Length of the FFT, must be a power of two, at least twice `pool->threads`
+ * @param[in]  pool   The thread pool
+ */
+static void fft_g1_parallel(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots, uint64_t roots_stride,
+                            uint64_t n, const ThreadPool *pool) {
+    uint64_t threads = pool_threads(pool);
+    fft_g1_job job = {out, in, stride, roots, roots_stride, n, next_power_of_two(threads), 0, 0, NULL};
+
+    pool_run(pool, fft_g1_sub_task, &job, job.sub_count);
+
+    job.task_len = (n / 2 + threads - 1) / threads;
+    for (job.half = n / job.sub_count; job.half < n; job.half *= 2) {
+        pool_run(pool, fft_g1_butterfly_task, &job, threads);
+    }
+}
+
 /**
  * The main entry point for forward and reverse FFTs over the finite field.
  *
+ * If a thread pool is set in @p fs then large FFTs are computed in parallel.
+ *
  * @param[out] out     The results (array of length @p n)
  * @param[in]  in      The input data (array of length @p n)
  * @param[in]  inverse `false` for forward transform, `true` for inverse transform
@@ -105,22 +260,162 @@ void fft_g1_fast(g1_t *out, const g1_t *in, uint64_t stride, const fr_t *roots,
  * @param[in]  fs      Pointer to previously initialised FFTSettings structure with `max_width` at least @p n.
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
  */
 C_KZG_RET fft_g1(g1_t *out, const g1_t *in, bool inverse, uint64_t n, const FFTSettings *fs) {
-    uint64_t stride = fs->max_width / n;
+    STAT_SCOPE(FFT_G1);
+    uint64_t stride;
+    uint64_t threads = pool_threads(fs->pool);
+    bool parallel = threads > 1 && n >= FFT_G1_PARALLEL_MIN_WIDTH && n >= 2 * threads;
+    const fr_t *roots;
+
     CHECK(n <= fs->max_width);
     CHECK(is_power_of_two(n));
+    STAT_SIZED(FFT_G1, n);
+
+    if (inverse && fs->cache == NULL) {
+        roots = fs->reverse_roots_of_unity;
+        stride = fs->max_width / n;
+    } else {
+        TRY(fft_roots(&roots, &stride, n, fs));
+    }
+
+    if (parallel) {
+        fft_g1_parallel(out, in, 1, roots, stride, n, fs->pool);
+    } else {
+        fft_g1_fast(out, in, 1, roots, stride, n);
+    }
+
+    if (inverse && fs->cache != NULL) {
+        // Lazy settings keep no reversed roots: the inverse is the forward transform with outputs 1 to n - 1 reversed
+        for (uint64_t i = 1; i < n / 2; i++) {
+            g1_t tmp = out[i];
+            out[i] = out[n - i];
+            out[n - i] = tmp;
+        }
+    }
+
     if (inverse) {
         fr_t inv_len;
         fr_from_uint64(&inv_len, n);
         fr_inv(&inv_len, &inv_len);
-        fft_g1_fast(out, in, 1, fs->reverse_roots_of_unity, stride, n);
+        if (parallel) {
+            fft_g1_job job = {out, NULL, 0, NULL, 0, n, 0, 0, (n + threads - 1) / threads, &inv_len};
+            pool_run(fs->pool, fft_g1_scale_task, &job, threads);
+        } else {
+            for (uint64_t i = 0; i < n; i++) {
+                g1_mul(&out[i], &out[i], &inv_len);
+            }
+        }
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Fast Fourier Transform in place, by decimation in frequency, leaving the results in bit-reversed order.
+ *
+ * Each row of butterflies combines the two halves of a block before the halves are transformed, so the inputs are in
+ * natural order and output `i` lands at `reverse_bits_limited(n, i)`.
+ *
+ * @param[in,out] x    The input data and then the results (array of length @p n)
+ * @param[in]  roots   Roots of unity (array of length @p n * @p roots_stride)
+ * @param[in]  roots_stride The stride interval among the roots of unity
+ * @param[in]  n       Length of the FFT, must be a power of two
+ */
+static void fft_g1_dif(g1_t *x, const fr_t *roots, uint64_t roots_stride, uint64_t n) {
+    uint64_t half = n / 2;
+    if (half == 0) return;
+    for (uint64_t i = 0; i < half; i++) {
+        g1_t diff;
+        g1_sub(&diff, &x[i], &x[i + half]);
+        g1_add_or_dbl(&x[i], &x[i], &x[i + half]);
+        if (i == 0) {
+            x[half] = diff;
+        } else {
+            g1_mul(&x[i + half], &diff, &roots[i * roots_stride]);
+        }
+    }
+    fft_g1_dif(x, roots, roots_stride * 2, half);
+    fft_g1_dif(x + half, roots, roots_stride * 2, half);
+}
+
+/**
+ * Perform the butterflies in range @p t of the current row of #fft_g1_dif, as one task of #fft_g1_bit_reversed.
+ *
+ * @param[in] arg The #fft_g1_job
+ * @param[in] t   The index of the range of butterflies
+ */
+static void fft_g1_dif_butterfly_task(void *arg, uint64_t t) {
+    const fft_g1_job *job = arg;
+    uint64_t half = job->half, roots_stride = job->roots_stride * (job->n / (2 * half));
+    uint64_t start = t * job->task_len, end = start + job->task_len < job->n / 2 ? start + job->task_len : job->n / 2;
+    for (uint64_t b = start; b < end; b++) {
+        g1_t diff, *x = job->out + (b / half) * 2 * half + b % half;
+        g1_sub(&diff, &x[0], &x[half]);
+        g1_add_or_dbl(&x[0], &x[0], &x[half]);
+        g1_mul(&x[half], &diff, &job->roots[(b % half) * roots_stride]);
+    }
+}
+
+/**
+ * Compute sub-FFT @p i of the bottom of the recursion of #fft_g1_dif, as one task of #fft_g1_bit_reversed.
+ *
+ * @param[in] arg The #fft_g1_job
+ * @param[in] i   The index of the sub-FFT
+ */
+static void fft_g1_dif_sub_task(void *arg, uint64_t i) {
+    const fft_g1_job *job = arg;
+    uint64_t len = job->n / job->sub_count;
+    fft_g1_dif(job->out + i * len, job->roots, job->roots_stride * job->sub_count, len);
+}
+
+/**
+ * Forward FFT with the results in bit-reversed order.
+ *
+ * `out[reverse_bits_limited(n, i)]` is `out[i]` of the forward #fft_g1, so this takes the place of an #fft_g1
+ * followed by #reverse_bit_order, without the separate pass over the array. The transform is done in place in @p out.
+ *
+ * If a thread pool is set in @p fs then large FFTs are computed in parallel: the top rows of butterflies are divided
+ * between the threads, then the independent sub-FFTs below them are computed as separate tasks.
+ *
+ * @param[out] out The results (array of length @p n), which may be the same as @p in
+ * @param[in]  in  The input data (array of length @p n)
+ * @param[in]  n   Length of the FFT, must be a power of two
+ * @param[in]  fs  Pointer to previously initialised FFTSettings structure with `max_width` at least @p n.
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+C_KZG_RET fft_g1_bit_reversed(g1_t *out, const g1_t *in, uint64_t n, const FFTSettings *fs) {
+    STAT_SCOPE(FFT_G1);
+    uint64_t stride;
+    uint64_t threads = pool_threads(fs->pool);
+    const fr_t *roots;
+
+    CHECK(n <= fs->max_width);
+    CHECK(is_power_of_two(n));
+    STAT_SIZED(FFT_G1, n);
+
+    TRY(fft_roots(&roots, &stride, n, fs));
+
+    if (out != in) {
         for (uint64_t i = 0; i < n; i++) {
-            g1_mul(&out[i], &out[i], &inv_len);
+            out[i] = in[i];
         }
+    }
+
+    if (threads > 1 && n >= FFT_G1_PARALLEL_MIN_WIDTH && n >= 2 * threads) {
+        fft_g1_job job = {out, NULL, 0, roots, stride, n, next_power_of_two(threads), 0, (n / 2 + threads - 1) / threads,
+                          NULL};
+        for (job.half = n / 2; job.half >= n / job.sub_count; job.half /= 2) {
+            pool_run(fs->pool, fft_g1_dif_butterfly_task, &job, threads);
+        }
+        pool_run(fs->pool, fft_g1_dif_sub_task, &job, job.sub_count);
     } else {
-        fft_g1_fast(out, in, 1, fs->expanded_roots_of_unity, stride, n);
+        fft_g1_dif(out, roots, stride, n);
     }
+
     return C_KZG_OK;
 }
 
@@ -149,6 +444,25 @@ void compare_sft_fft(void) {
     free_fft_settings(&fs);
 }
 
+void small_fft(void) {
+    // Each of the unrolled lengths, and the first that recurses into them, with strided input and roots
+    FFTSettings fs;
+    TEST_CHECK(new_fft_settings(&fs, 5) == C_KZG_OK);
+    g1_t data[2 * fs.max_width], slow[fs.max_width], fast[fs.max_width];
+    make_data(data, 2 * fs.max_width);
+
+    for (uint64_t n = 1; n <= 16; n *= 2) {
+        fft_g1_slow(slow, data, 2, fs.expanded_roots_of_unity, fs.max_width / n, n);
+        fft_g1_fast(fast, data, 2, fs.expanded_roots_of_unity, fs.max_width / n, n);
+        for (int i = 0; i < n; i++) {
+            TEST_CHECK(g1_equal(slow + i, fast + i));
+            TEST_MSG("Mismatch at n = %lu, i = %d", n, i);
+        }
+    }
+
+    free_fft_settings(&fs);
+}
+
 void roundtrip_fft(void) {
     // Initialise: arbitrary size
     unsigned int size = 10;
@@ -190,11 +504,105 @@ void stride_fft(void) {
     free_fft_settings(&fs2);
 }
 
+void parallel_fft(void) {
+    unsigned int size = 8;
+    FFTSettings fs;
+    ThreadPool pool;
+    TEST_CHECK(new_fft_settings(&fs, size) == C_KZG_OK);
+    g1_t data[fs.max_width], expected[fs.max_width], out[fs.max_width];
+    make_data(data, fs.max_width);
+
+    // Thread counts that are, and are not, powers of two
+    for (unsigned int threads = 2; threads <= 5; threads++) {
+        TEST_CHECK(new_thread_pool(&pool, threads) == C_KZG_OK);
+        for (int inverse = 0; inverse <= 1; inverse++) {
+            fs.pool = NULL;
+            TEST_CHECK(fft_g1(expected, data, inverse, fs.max_width, &fs) == C_KZG_OK);
+            fs.pool = &pool;
+            TEST_CHECK(fft_g1(out, data, inverse, fs.max_width, &fs) == C_KZG_OK);
+            for (int i = 0; i < fs.max_width; i++) {
+                TEST_CHECK(g1_equal(&expected[i], &out[i]));
+                TEST_MSG("Mismatch with %u threads, inverse %d, at %d", threads, inverse, i);
+            }
+        }
+        free_thread_pool(&pool);
+    }
+
+    free_fft_settings(&fs);
+}
+
+void lazy_fft(void) {
+    FFTSettings eager, lazy;
+    TEST_CHECK(new_fft_settings(&eager, 6) == C_KZG_OK);
+    TEST_CHECK(new_fft_settings_lazy(&lazy, 10) == C_KZG_OK);
+    uint64_t width = eager.max_width;
+    g1_t data[width], expected[width], out[width];
+    make_data(data, width);
+
+    for (int inverse = 0; inverse <= 1; inverse++) {
+        TEST_CHECK(fft_g1(expected, data, inverse, width, &eager) == C_KZG_OK);
+        TEST_CHECK(fft_g1(out, data, inverse, width, &lazy) == C_KZG_OK);
+        for (int i = 0; i < width; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &out[i]));
+        }
+    }
+
+    free_fft_settings(&eager);
+    free_fft_settings(&lazy);
+}
+
+void bit_reversed_fft(void) {
+    FFTSettings fs, lazy;
+    ThreadPool pool;
+    TEST_CHECK(new_fft_settings(&fs, 8) == C_KZG_OK);
+    TEST_CHECK(new_fft_settings_lazy(&lazy, 9) == C_KZG_OK);
+    g1_t data[fs.max_width], expected[fs.max_width], out[fs.max_width];
+    make_data(data, fs.max_width);
+
+    // Serial, and parallel with thread counts that are, and are not, powers of two
+    for (unsigned int threads = 1; threads <= 4; threads++) {
+        TEST_CHECK(new_thread_pool(&pool, threads) == C_KZG_OK);
+        fs.pool = threads > 1 ? &pool : NULL;
+        for (uint64_t n = 1; n <= fs.max_width; n *= 2) {
+            TEST_CHECK(fft_g1(expected, data, false, n, &fs) == C_KZG_OK);
+            TEST_CHECK(reverse_bit_order(expected, sizeof expected[0], n) == C_KZG_OK);
+            TEST_CHECK(fft_g1_bit_reversed(out, data, n, &fs) == C_KZG_OK);
+            for (int i = 0; i < n; i++) {
+                TEST_CHECK(g1_equal(&expected[i], &out[i]));
+                TEST_MSG("Mismatch with %u threads, n = %lu, at %d", threads, n, i);
+            }
+        }
+        free_thread_pool(&pool);
+    }
+
+    // In place, with lazy settings
+    for (int i = 0; i < fs.max_width; i++) {
+        out[i] = data[i];
+    }
+    TEST_CHECK(fft_g1_bit_reversed(out, out, fs.max_width, &lazy) == C_KZG_OK);
+    for (int i = 0; i < fs.max_width; i++) {
+        TEST_CHECK(g1_equal(&expected[i], &out[i]));
+    }
+
+#ifndef DEBUG
+    TEST_CHECK(fft_g1_bit_reversed(out, data, 3, &fs) == C_KZG_BADARGS);
+    TEST_CHECK(fft_g1_bit_reversed(out, data, 2 * fs.max_width, &fs) == C_KZG_BADARGS);
+#endif
+
+    fs.pool = NULL;
+    free_fft_settings(&fs);
+    free_fft_settings(&lazy);
+}
+
 TEST_LIST = {
     {"FFT_G1_TEST", title},
     {"compare_sft_fft", compare_sft_fft},
+    {"small_fft", small_fft},
     {"roundtrip_fft", roundtrip_fft},
     {"stride_fft", stride_fft},
+    {"parallel_fft", parallel_fft},
+    {"lazy_fft", lazy_fft},
+    {"bit_reversed_fft", bit_reversed_fft},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
@@ -22,13 +22,15 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+// If `pool` is non-NULL then the FFTs are computed in parallel using it.
+// If `bit_reversed` is set then fft_g1_bit_reversed() is timed rather than fft_g1().
+bench_result run_bench(int scale, int max_seconds, const ThreadPool *pool, bool bit_reversed) {
+    bench_t bench;
     FFTSettings fs;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
+    fs.pool = pool;
 
     // Allocate on the heap to avoid stack overflow for large sizes
     g1_t *data, *out;
@@ -40,23 +42,30 @@ long run_bench(int scale, int max_seconds) {
         data[i] = rand_g1();
     }
 
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
-        assert(C_KZG_OK == fft_g1(out, data, false, fs.max_width, &fs));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        if (bit_reversed) {
+            assert(C_KZG_OK == fft_g1_bit_reversed(out, data, fs.max_width, &fs));
+        } else {
+            assert(C_KZG_OK == fft_g1(out, data, false, fs.max_width, &fs));
+        }
+        bench_stop(&bench);
     }
 
     free(out);
     free(data);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, ((uint64_t)1 << scale) * sizeof(g1_t));
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+    unsigned int max_threads;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
     case 1:
@@ -70,14 +79,32 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking FFT_g1, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking FFT_g1, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    for (int scale = 4; scale <= 15; scale++) {
+        bench_report(run_bench(scale, nsec, NULL, false), "fft_g1/scale_%d", scale);
+    }
     for (int scale = 4; scale <= 15; scale++) {
-        printf("fft_g1/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec, NULL, true), "fft_g1_bit_reversed/scale_%d", scale);
+    }
+
+    // The scaling curve with the number of threads: powers of two, and then all the processors
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    max_threads = pool.threads;
+    free_thread_pool(&pool);
+    for (unsigned int threads = 2; threads < 2 * max_threads; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        assert(C_KZG_OK == new_thread_pool(&pool, threads));
+        for (int scale = 10; scale <= 15; scale++) {
+            bench_report(run_bench(scale, nsec, &pool, false), "fft_g1_threads_%u/scale_%d", threads, scale);
+            bench_report(run_bench(scale, nsec, &pool, true), "fft_g1_bit_reversed_threads_%u/scale_%d", threads,
+                         scale);
+        }
+        free_thread_pool(&pool);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
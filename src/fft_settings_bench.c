@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h> // malloc(), free(), atoi()
+#include <stdio.h>  // printf()
+#include <assert.h> // assert()
+#include <unistd.h> // EXIT_SUCCESS/FAILURE
+#include "bench_util.h"
+#include "test_util.h"
+#include "c_kzg.h"
+
+// The largest scale run by default: settings take around 128 bytes per unit of width, so 28 needs over 32 GiB
+#define DEFAULT_MAX_SCALE 24
+
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+// If `lazy` is set then lazy settings are made and the table for the full width built, otherwise the settings are
+// made up front, using `pool` if it is non-NULL.
+bench_result run_bench(int scale, int max_seconds, const ThreadPool *pool, bool lazy) {
+    bench_t bench;
+    FFTSettings fs;
+    const fr_t *roots;
+    uint64_t stride;
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        if (lazy) {
+            assert(C_KZG_OK == new_fft_settings_lazy(&fs, scale));
+            assert(C_KZG_OK == fft_roots(&roots, &stride, fs.max_width, &fs));
+        } else {
+            assert(C_KZG_OK == new_fft_settings_parallel(&fs, scale, pool));
+        }
+        bench_stop(&bench);
+        free_fft_settings(&fs);
+    }
+
+    return bench_end(&bench, 1, 0);
+}
+
+int main(int argc, char *argv[]) {
+    int nsec = 0, max_scale = DEFAULT_MAX_SCALE;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
+
+    switch (argc) {
+    case 1:
+        nsec = NSEC;
+        break;
+    case 3:
+        max_scale = atoi(argv[2]);
+        // fall through
+    case 2:
+        nsec = atoi(argv[1]);
+        break;
+    default:
+        break;
+    };
+
+    if (nsec == 0 || max_scale < 16 || max_scale > 28) {
+        printf("Usage: %s [test time in seconds > 0] [max scale 16 to 28, default %d]\n", argv[0], DEFAULT_MAX_SCALE);
+        exit(EXIT_FAILURE);
+    }
+
+    bench_note("*** Benchmarking new_fft_settings, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    for (int scale = 16; scale <= max_scale; scale++) {
+        bench_report(run_bench(scale, nsec, NULL, false), "new_fft_settings/scale_%d", scale);
+    }
+    for (int scale = 16; scale <= max_scale; scale++) {
+        bench_report(run_bench(scale, nsec, NULL, true), "new_fft_settings_lazy/scale_%d", scale);
+    }
+
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 16; scale <= max_scale; scale++) {
+        bench_report(run_bench(scale, nsec, &pool, false), "new_fft_settings_threaded/scale_%d", scale);
+    }
+    free_thread_pool(&pool);
+
+    return bench_exit();
+}
@@ -0,0 +1,511 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file fk20_io.c
+ *
+ * Saving FK20 settings to disk and memory-mapping them back in.
+ *
+ * Building FK20 settings takes one G1 FFT per chunk, and building the optional multiplication tables takes far
+ * longer. Both depend only on the trusted setup, so they can be saved once and loaded by every process that needs them.
+ * Loading maps the file read-only and uses the points in place, so processes on the same host share the page cache.
+ *
+ * The file format is the raw in-memory representation of the points, preceded by a header. It is therefore specific to
+ * the byte order and the build of the library that wrote it, and the header records enough to detect a mismatch.
+ */
+
+#include <string.h>   // memcmp(), memcpy(), memset()
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/stat.h> // fstat()
+#include "control.h"
+#include "c_kzg_alloc.h"
+#include "utility.h"
+
+/** The current version of the file format. */
+#define FK20_FILE_VERSION 1
+
+/** Identifies files written by #save_fk20_single_settings and #save_fk20_multi_settings. */
+static const byte fk20_file_magic[8] = {'C', 'K', 'Z', 'G', 'F', 'K', '2', '0'};
+
+/** Written natively so that files from machines of a different byte order are rejected. */
+#define FK20_FILE_BYTE_ORDER 0x01020304
+
+/** The kinds of settings that may be stored in a file. */
+typedef enum {
+    FK20_FILE_SINGLE = 1, /**< #FK20SingleSettings */
+    FK20_FILE_MULTI = 2,  /**< #FK20MultiSettings */
+} fk20_file_kind;
+
+/**
+ * The header at the start of every FK20 settings file.
+ *
+ * The points follow immediately after, then the multiplication tables if `wbits` is non-zero. The header is a multiple
+ * of 64 bytes so that the points are aligned for mapping.
+ */
+typedef struct {
+    byte magic[8];           /**< #fk20_file_magic */
+    uint32_t version;        /**< #FK20_FILE_VERSION */
+    uint32_t byte_order;     /**< #FK20_FILE_BYTE_ORDER */
+    uint32_t g1_size;        /**< `sizeof(g1_t)` */
+    uint32_t g1_affine_size; /**< `sizeof(g1_affine_t)` */
+    uint32_t kind;           /**< An #fk20_file_kind */
+    uint32_t wbits;          /**< The window size of the multiplication tables, zero if there are none */
+    uint64_t n2;             /**< The `n2` the settings were initialised with */
+    uint64_t chunk_len;      /**< The chunk length for multi settings, one for single settings */
+    byte fingerprint[32];    /**< Identifies the trusted setup, see #setup_fingerprint */
+    byte reserved[48];       /**< Zero */
+} fk20_file_header;
+
+/**
+ * Identify the part of the trusted setup that FK20 settings of size @p n2 are built from.
+ *
+ * Settings loaded from a file are only valid with the same trusted setup, so the file records the SHA-256 hash of the
+ * affine forms of the first `n2 / 2 - 1` G1 points, which are all the points that the settings depend on.
+ *
+ * @param[out] out The fingerprint
+ * @param[in]  n2  The size of the FK20 settings
+ * @param[in]  ks  The KZG settings holding the trusted setup
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET setup_fingerprint(byte out[32], uint64_t n2, const KZGSettings *ks) {
+    uint64_t n = n2 / 2 - 1;
+    g1_affine_t *points;
+
+    CHECK(n <= ks->length);
+
+    if (ks->secret_g1_affine != NULL) {
+        hash_sha256(out, (const byte *)ks->secret_g1_affine, n * sizeof *points);
+        return C_KZG_OK;
+    }
+
+    TRY(new_g1_affine_array(&points, n));
+    g1_array_to_affine(points, ks->secret_g1, n);
+    hash_sha256(out, (byte *)points, n * sizeof *points);
+
+    c_kzg_free(points);
+    return C_KZG_OK;
+}
+
+/**
+ * Write a header and the points to a file.
+ *
+ * @param[in] out       The file to write to
+ * @param[in] kind      The kind of settings
+ * @param[in] n2        The size of the settings
+ * @param[in] chunk_len The chunk length
+ * @param[in] rows      The points, in @p row_count rows of @p row_len
+ * @param[in] row_count The number of rows of points
+ * @param[in] row_len   The number of points in each row
+ * @param[in] table     The multiplication tables for the points, or NULL
+ * @param[in] wbits     The window size of @p table
+ * @param[in] ks        The KZG settings the FK20 settings were built from
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   The file could not be written
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET save_fk20_file(FILE *out, fk20_file_kind kind, uint64_t n2, uint64_t chunk_len,
+                                g1_t *const *rows, uint64_t row_count, uint64_t row_len, const g1_affine_t *table,
+                                unsigned int wbits, const KZGSettings *ks) {
+    fk20_file_header header;
+
+    CHECK(n2 / 2 - 1 <= ks->length);
+
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, fk20_file_magic, sizeof header.magic);
+    header.version = FK20_FILE_VERSION;
+    header.byte_order = FK20_FILE_BYTE_ORDER;
+    header.g1_size = sizeof(g1_t);
+    header.g1_affine_size = sizeof(g1_affine_t);
+    header.kind = kind;
+    header.wbits = table == NULL ? 0 : wbits;
+    header.n2 = n2;
+    header.chunk_len = chunk_len;
+    TRY(setup_fingerprint(header.fingerprint, n2, ks));
+
+    if (fwrite(&header, sizeof header, 1, out) != 1) return C_KZG_ERROR;
+    for (uint64_t i = 0; i < row_count; i++) {
+        if (fwrite(rows[i], sizeof(g1_t), row_len, out) != row_len) return C_KZG_ERROR;
+    }
+    if (header.wbits) {
+        uint64_t table_len = row_count * row_len * g1_mul_table_length(wbits);
+        if (fwrite(table, sizeof(g1_affine_t), table_len, out) != table_len) return C_KZG_ERROR;
+    }
+    if (fflush(out) != 0) return C_KZG_ERROR;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Map a file written by #save_fk20_file, and check that it is compatible.
+ *
+ * @param[out] mapping     The start of the mapping, to be released with `munmap()`
+ * @param[out] mapping_len The length of the mapping
+ * @param[in]  in          The file to map
+ * @param[in]  kind        The kind of settings expected
+ * @param[in]  ks          The KZG settings the FK20 settings are to be used with
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not valid, or not compatible with @p ks and this build of the library
+ * @retval C_CZK_ERROR   The file could not be mapped
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET map_fk20_file(const byte **mapping, size_t *mapping_len, FILE *in, fk20_file_kind kind,
+                               const KZGSettings *ks) {
+    const fk20_file_header *header;
+    byte fingerprint[32];
+    uint64_t body, point_size;
+    struct stat st;
+    void *map;
+    C_KZG_RET ret;
+    bool ok;
+
+    if (fstat(fileno(in), &st) != 0) return C_KZG_ERROR;
+    CHECK((uint64_t)st.st_size >= sizeof *header);
+    body = (uint64_t)st.st_size - sizeof *header;
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(in), 0);
+    if (map == MAP_FAILED) return C_KZG_ERROR;
+    header = map;
+
+    // Check the header before trusting any of the sizes in it
+    ok = memcmp(header->magic, fk20_file_magic, sizeof header->magic) == 0 &&
+         header->version == FK20_FILE_VERSION && header->byte_order == FK20_FILE_BYTE_ORDER &&
+         header->g1_size == sizeof(g1_t) && header->g1_affine_size == sizeof(g1_affine_t) && header->kind == kind &&
+         header->n2 >= 2 && is_power_of_two(header->n2) && header->n2 <= ks->fs->max_width &&
+         header->chunk_len > 0 && is_power_of_two(header->chunk_len) && header->chunk_len <= header->n2 / 2 &&
+         (header->wbits == 0 || (header->wbits >= 2 && header->wbits <= 8));
+
+    // Each point is followed, in the tables, by its row of multiples. Bound the count by the file before multiplying.
+    if (ok) {
+        point_size = sizeof(g1_t) + (header->wbits ? g1_mul_table_length(header->wbits) * sizeof(g1_affine_t) : 0);
+        ok = header->n2 <= body / point_size && body == header->n2 * point_size;
+    }
+
+    ret = ok ? setup_fingerprint(fingerprint, header->n2, ks) : C_KZG_BADARGS;
+    if (ret == C_KZG_OK && memcmp(fingerprint, header->fingerprint, sizeof fingerprint) != 0) ret = C_KZG_BADARGS;
+    if (ret != C_KZG_OK) {
+        munmap(map, st.st_size);
+        return ret;
+    }
+
+    *mapping = map;
+    *mapping_len = st.st_size;
+    return C_KZG_OK;
+}
+
+/**
+ * Save FK20 single settings to a file, for loading with #load_fk20_single_settings.
+ *
+ * Any multiplication tables made by #fk20_single_settings_precompute are saved too.
+ *
+ * @param[in] out The file to write to
+ * @param[in] fk  The settings to be saved
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   The file could not be written
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET save_fk20_single_settings(FILE *out, const FK20SingleSettings *fk) {
+    return save_fk20_file(out, FK20_FILE_SINGLE, fk->x_ext_fft_len, 1, &fk->x_ext_fft, 1, fk->x_ext_fft_len,
+                          fk->x_ext_fft_table, fk->wbits, fk->ks);
+}
+
+/**
+ * Save FK20 multi settings to a file, for loading with #load_fk20_multi_settings.
+ *
+ * Any multiplication tables made by #fk20_multi_settings_precompute are saved too.
+ *
+ * @param[in] out The file to write to
+ * @param[in] fk  The settings to be saved
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   The file could not be written
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET save_fk20_multi_settings(FILE *out, const FK20MultiSettings *fk) {
+    return save_fk20_file(out, FK20_FILE_MULTI, fk->length, fk->chunk_len, fk->x_ext_fft_files, fk->chunk_len,
+                          fk->length / fk->chunk_len, fk->x_ext_fft_files_table, fk->wbits, fk->ks);
+}
+
+/**
+ * Load FK20 single settings from a file written by #save_fk20_single_settings.
+ *
+ * The file is mapped into memory read-only and the points are used in place, so this is fast and uses no memory
+ * beyond the page cache, which is shared with any other process that maps the same file.
+ *
+ * @remark The file must not be modified while the settings are in use. The file itself may be closed once this
+ * returns.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates resources that need to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_fk20_single_settings.
+ *
+ * @param[out] fk The loaded settings
+ * @param[in]  in The file to read from
+ * @param[in]  ks The KZG settings with the same trusted setup as the saved settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not valid, or not compatible with @p ks and this build of the library
+ * @retval C_CZK_ERROR   The file could not be mapped
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET load_fk20_single_settings(FK20SingleSettings *fk, FILE *in, const KZGSettings *ks) {
+    const fk20_file_header *header;
+    const byte *mapping;
+    size_t mapping_len;
+    C_KZG_RET ret;
+
+    // Pass on the reason that the file was rejected, which TRY would not
+    ret = map_fk20_file(&mapping, &mapping_len, in, FK20_FILE_SINGLE, ks);
+    if (ret != C_KZG_OK) return ret;
+    header = (const fk20_file_header *)mapping;
+
+    fk->ks = ks;
+    fk->x_ext_fft_len = header->n2;
+    fk->x_ext_fft = (g1_t *)(mapping + sizeof *header);
+    fk->wbits = header->wbits;
+    fk->x_ext_fft_table = fk->wbits ? (g1_affine_t *)(fk->x_ext_fft + fk->x_ext_fft_len) : NULL;
+    fk->workspace = NULL;
+    fk->mapping = (void *)mapping;
+    fk->mapping_len = mapping_len;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Load FK20 multi settings from a file written by #save_fk20_multi_settings.
+ *
+ * As for #load_fk20_single_settings.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates resources that need to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_fk20_multi_settings.
+ *
+ * @param[out] fk The loaded settings
+ * @param[in]  in The file to read from
+ * @param[in]  ks The KZG settings with the same trusted setup as the saved settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not valid, or not compatible with @p ks and this build of the library
+ * @retval C_CZK_ERROR   The file could not be mapped
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET load_fk20_multi_settings(FK20MultiSettings *fk, FILE *in, const KZGSettings *ks) {
+    const fk20_file_header *header;
+    const byte *mapping;
+    size_t mapping_len;
+    g1_t *points;
+    uint64_t file_len;
+    C_KZG_RET ret;
+
+    ret = map_fk20_file(&mapping, &mapping_len, in, FK20_FILE_MULTI, ks);
+    if (ret != C_KZG_OK) return ret;
+    header = (const fk20_file_header *)mapping;
+    points = (g1_t *)(mapping + sizeof *header);
+    file_len = header->n2 / header->chunk_len;
+
+    fk->ks = ks;
+    fk->chunk_len = header->chunk_len;
+    fk->length = header->n2;
+    fk->wbits = header->wbits;
+    fk->x_ext_fft_files_table = fk->wbits ? (g1_affine_t *)(points + fk->length) : NULL;
+    fk->workspace = NULL;
+    fk->mapping = (void *)mapping;
+    fk->mapping_len = mapping_len;
+
+    // Only the pointers to the rows need allocating
+    TRY(new_g1_array_2(&fk->x_ext_fft_files, fk->chunk_len));
+    for (uint64_t i = 0; i < fk->chunk_len; i++) {
+        fk->x_ext_fft_files[i] = points + i * file_len;
+    }
+
+    return C_KZG_OK;
+}
+
+#ifdef KZGTEST
+
+#include <stddef.h> // offsetof()
+#include <unistd.h> // ftruncate()
+#include "../inc/acutest.h"
+#include "test_util.h"
+
+void fk_single_save_load(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20SingleSettings fk, loaded;
+    uint64_t n = 32, secrets_len = 2 * n;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected[2 * n], actual[2 * n];
+    poly p;
+    FILE *file;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_single_settings(&fk, 2 * n, &ks));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == da_using_fk20_single(expected, &p, &fk));
+
+    // Both with and without multiplication tables
+    for (int with_table = 0; with_table <= 1; with_table++) {
+        if (with_table) TEST_CHECK(C_KZG_OK == fk20_single_settings_precompute(&fk, 3));
+
+        file = tmpfile();
+        TEST_CHECK(file != NULL);
+        TEST_CHECK(C_KZG_OK == save_fk20_single_settings(file, &fk));
+        TEST_CHECK(C_KZG_OK == load_fk20_single_settings(&loaded, file, &ks));
+        fclose(file);
+
+        TEST_CHECK(loaded.x_ext_fft_len == fk.x_ext_fft_len);
+        TEST_CHECK(loaded.wbits == fk.wbits);
+        TEST_CHECK((loaded.x_ext_fft_table != NULL) == with_table);
+        TEST_CHECK(C_KZG_OK == da_using_fk20_single(actual, &p, &loaded));
+        for (int i = 0; i < 2 * n; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+        }
+
+        free_fk20_single_settings(&loaded);
+    }
+
+    free_poly(&p);
+    free_fk20_single_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_multi_save_load(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20MultiSettings fk, loaded;
+    FK20Workspace ws;
+    uint64_t n = 64, chunk_len = 4, secrets_len = 2 * n, k2 = 2 * n / chunk_len;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected[k2], actual[k2];
+    poly p;
+    FILE *file;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk, 2 * n, chunk_len, &ks));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == da_using_fk20_multi(expected, &p, &fk));
+
+    for (int with_table = 0; with_table <= 1; with_table++) {
+        if (with_table) TEST_CHECK(C_KZG_OK == fk20_multi_settings_precompute(&fk, 4));
+
+        file = tmpfile();
+        TEST_CHECK(file != NULL);
+        TEST_CHECK(C_KZG_OK == save_fk20_multi_settings(file, &fk));
+        TEST_CHECK(C_KZG_OK == load_fk20_multi_settings(&loaded, file, &ks));
+        fclose(file);
+
+        TEST_CHECK(loaded.chunk_len == fk.chunk_len);
+        TEST_CHECK(loaded.length == fk.length);
+        TEST_CHECK(loaded.wbits == fk.wbits);
+
+        TEST_CHECK(C_KZG_OK == new_fk20_workspace(&ws, loaded.length / loaded.chunk_len, 1));
+        loaded.workspace = &ws;
+        TEST_CHECK(C_KZG_OK == da_using_fk20_multi(actual, &p, &loaded));
+        for (int i = 0; i < k2; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+        }
+
+        // Loaded settings are read-only
+        TEST_CHECK(C_KZG_BADARGS == fk20_multi_settings_precompute(&loaded, 4));
+
+        free_fk20_workspace(&ws);
+        free_fk20_multi_settings(&loaded);
+    }
+
+    free_poly(&p);
+    free_fk20_multi_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_load_rejects_bad_files(void) {
+    FFTSettings fs;
+    KZGSettings ks, other_ks;
+    FK20SingleSettings fk, loaded;
+    FK20MultiSettings loaded_multi;
+    uint64_t n = 16, secrets_len = 2 * n;
+    g1_t s1[secrets_len], other_s1[secrets_len];
+    g2_t s2[secrets_len], other_s2[secrets_len];
+    scalar_t other_secret = secret;
+    byte b;
+    FILE *file;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    other_secret.b[0] ^= 1;
+    generate_trusted_setup(other_s1, other_s2, &other_secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&other_ks, other_s1, other_s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_single_settings(&fk, 2 * n, &ks));
+
+    file = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_fk20_single_settings(file, &fk));
+
+    // A different trusted setup, and a different kind of settings
+    TEST_CHECK(C_KZG_BADARGS == load_fk20_single_settings(&loaded, file, &other_ks));
+    TEST_CHECK(C_KZG_BADARGS == load_fk20_multi_settings(&loaded_multi, file, &ks));
+
+    // A truncated file
+    TEST_CHECK(0 == ftruncate(fileno(file), sizeof(fk20_file_header) + sizeof(g1_t)));
+    TEST_CHECK(C_KZG_BADARGS == load_fk20_single_settings(&loaded, file, &ks));
+    fclose(file);
+
+    // A file from a different version of the format
+    file = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_fk20_single_settings(file, &fk));
+    b = FK20_FILE_VERSION + 1;
+    TEST_CHECK(0 == fseek(file, offsetof(fk20_file_header, version), SEEK_SET));
+    TEST_CHECK(1 == fwrite(&b, 1, 1, file));
+    TEST_CHECK(0 == fflush(file));
+    TEST_CHECK(C_KZG_BADARGS == load_fk20_single_settings(&loaded, file, &ks));
+    fclose(file);
+
+    // Not a settings file at all
+    file = tmpfile();
+    TEST_CHECK(1 == fwrite("hello", 5, 1, file));
+    TEST_CHECK(0 == fflush(file));
+    TEST_CHECK(C_KZG_BADARGS == load_fk20_single_settings(&loaded, file, &ks));
+    fclose(file);
+
+    free_fk20_single_settings(&fk);
+    free_kzg_settings(&ks);
+    free_kzg_settings(&other_ks);
+    free_fft_settings(&fs);
+}
+
+TEST_LIST = {
+    {"FK20_IO_TEST", title},
+    {"fk_single_save_load", fk_single_save_load},
+    {"fk_multi_save_load", fk_multi_save_load},
+    {"fk_load_rejects_bad_files", fk_load_rejects_bad_files},
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
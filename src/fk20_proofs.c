@@ -23,6 +23,7 @@
  * @todo Split this out into smaller files.
  */
 
+#include <sys/mman.h> // munmap()
 #include "control.h"
 #include "c_kzg_alloc.h"
 #include "utility.h"
@@ -53,7 +54,44 @@ C_KZG_RET toeplitz_part_1(g1_t *out, const g1_t *x, uint64_t n, const FFTSetting
 
     TRY(fft_g1(out, x_ext, false, n2, fs));
 
-    free(x_ext);
+    c_kzg_free(x_ext);
+    return C_KZG_OK;
+}
+
+/**
+ * The second part of the Toeplitz matrix multiplication algorithm, using caller-supplied scratch space.
+ *
+ * This is #toeplitz_part_2 without the memory allocation, for use in loops over many chunks or many polynomials. If
+ * a table built by #g1_mul_precompute for each point of @p x_ext_fft is supplied, then it is used for the
+ * multiplications in place of the points themselves.
+ *
+ * @param[out] out Array of G1 group elements, length `n`
+ * @param[in]  toeplitz_coeffs Toeplitz coefficients, a polynomial length `n`
+ * @param[in]  x_ext_fft The Fourier transform of the extended `x` vector, length `n`
+ * @param[in]  table The tables for the points of @p x_ext_fft, contiguously, or NULL
+ * @param[in]  wbits The window size that @p table was built with
+ * @param[out] toeplitz_coeffs_fft Scratch space, length `n`
+ * @param      scratch Scratch space of at least #g1_mul_table_scratch_sizeof(@p wbits) bytes if @p table is not NULL
+ * @param[in]  fs  The FFT settings previously initialised with #new_fft_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ */
+static C_KZG_RET toeplitz_part_2_scratch(g1_t *out, const poly *toeplitz_coeffs, const g1_t *x_ext_fft,
+                                         const g1_affine_t *table, unsigned int wbits, fr_t *toeplitz_coeffs_fft,
+                                         void *scratch, const FFTSettings *fs) {
+    TRY(fft_fr(toeplitz_coeffs_fft, toeplitz_coeffs->coeffs, false, toeplitz_coeffs->length, fs));
+
+    if (table != NULL) {
+        uint64_t row = g1_mul_table_length(wbits);
+        for (uint64_t i = 0; i < toeplitz_coeffs->length; i++) {
+            g1_mul_precomputed(&out[i], table + i * row, wbits, &toeplitz_coeffs_fft[i], scratch);
+        }
+    } else {
+        for (uint64_t i = 0; i < toeplitz_coeffs->length; i++) {
+            g1_mul(&out[i], &x_ext_fft[i], &toeplitz_coeffs_fft[i]);
+        }
+    }
+
     return C_KZG_OK;
 }
 
@@ -75,13 +113,9 @@ C_KZG_RET toeplitz_part_2(g1_t *out, const poly *toeplitz_coeffs, const g1_t *x_
     // CHECK(toeplitz_coeffs->length == fk->x_ext_fft_len); // TODO: how to implement?
 
     TRY(new_fr_array(&toeplitz_coeffs_fft, toeplitz_coeffs->length));
-    TRY(fft_fr(toeplitz_coeffs_fft, toeplitz_coeffs->coeffs, false, toeplitz_coeffs->length, fs));
-
-    for (uint64_t i = 0; i < toeplitz_coeffs->length; i++) {
-        g1_mul(&out[i], &x_ext_fft[i], &toeplitz_coeffs_fft[i]);
-    }
+    TRY(toeplitz_part_2_scratch(out, toeplitz_coeffs, x_ext_fft, NULL, 0, toeplitz_coeffs_fft, NULL, fs));
 
-    free(toeplitz_coeffs_fft);
+    c_kzg_free(toeplitz_coeffs_fft);
     return C_KZG_OK;
 }
 
@@ -156,6 +190,51 @@ C_KZG_RET toeplitz_coeffs_step(poly *out, const poly *in) {
     return toeplitz_coeffs_stride(out, in, 0, 1);
 }
 
+/**
+ * The steps common to the FK20 single-proof methods for data availability.
+ *
+ * If a workspace of length at least `n * 2` is set in @p fk then no memory is allocated.
+ *
+ * @param[out] out          Array size `n * 2`
+ * @param[in]  p            Polynomial, size `n`, a power of two
+ * @param[in]  fk           FK20 single settings previously initialised by #new_fk20_single_settings
+ * @param[in]  bit_reversed `true` to leave the proofs in bit-reversed order, `false` for natural order
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET fk20_single_proofs(g1_t *out, const poly *p, const FK20SingleSettings *fk, bool bit_reversed) {
+    uint64_t n2 = p->length * 2;
+    FK20Workspace tmp, *ws = fk->workspace;
+    poly toeplitz_coeffs;
+
+    if (ws == NULL || ws->length < n2) {
+        TRY(new_fk20_workspace(&tmp, n2, 1));
+        ws = &tmp;
+    }
+
+    toeplitz_coeffs.coeffs = ws->toeplitz_coeffs;
+    toeplitz_coeffs.length = n2;
+    TRY(toeplitz_coeffs_step(&toeplitz_coeffs, p));
+
+    TRY(toeplitz_part_2_scratch(ws->h_ext_fft_files, &toeplitz_coeffs, fk->x_ext_fft, fk->x_ext_fft_table, fk->wbits,
+                                ws->toeplitz_coeffs_fft, ws->scratch, fk->ks->fs));
+    TRY(toeplitz_part_3(ws->h, ws->h_ext_fft_files, n2, fk->ks->fs));
+
+    if (bit_reversed) {
+        TRY(fft_g1_bit_reversed(out, ws->h, n2, fk->ks->fs));
+    } else {
+        TRY(fft_g1(out, ws->h, false, n2, fk->ks->fs));
+    }
+
+    if (ws == &tmp) {
+        free_fk20_workspace(&tmp);
+    }
+
+    return C_KZG_OK;
+}
+
 /**
  * Optimised version of the FK20 algorithm for use in data availability checks.
  *
@@ -167,6 +246,8 @@ C_KZG_RET toeplitz_coeffs_step(poly *out, const poly *in) {
  * @remark Only the lower half of the polynomial is supplied; the upper, zero, half is assumed. The
  * #toeplitz_coeffs_step routine does the right thing.
  *
+ * @remark If a workspace of length at least `n * 2` is set in @p fk then no memory is allocated.
+ *
  * @param[out] out Array size `n * 2`
  * @param[in]  p   Polynomial, size `n`
  * @param[in]  fk  FK20 single settings previously initialised by #new_fk20_single_settings
@@ -177,27 +258,11 @@ C_KZG_RET toeplitz_coeffs_step(poly *out, const poly *in) {
  */
 C_KZG_RET fk20_single_da_opt(g1_t *out, const poly *p, const FK20SingleSettings *fk) {
     uint64_t n = p->length, n2 = n * 2;
-    g1_t *h, *h_ext_fft;
-    poly toeplitz_coeffs;
 
     CHECK(n2 <= fk->ks->fs->max_width);
     CHECK(is_power_of_two(n));
 
-    TRY(new_poly(&toeplitz_coeffs, 2 * p->length));
-    TRY(toeplitz_coeffs_step(&toeplitz_coeffs, p));
-
-    TRY(new_g1_array(&h_ext_fft, toeplitz_coeffs.length));
-    TRY(toeplitz_part_2(h_ext_fft, &toeplitz_coeffs, fk->x_ext_fft, fk->ks->fs));
-
-    TRY(new_g1_array(&h, n2));
-    TRY(toeplitz_part_3(h, h_ext_fft, n2, fk->ks->fs));
-
-    TRY(fft_g1(out, h, false, n2, fk->ks->fs));
-
-    free_poly(&toeplitz_coeffs);
-    free(h_ext_fft);
-    free(h);
-    return C_KZG_OK;
+    return fk20_single_proofs(out, p, fk, false);
 }
 
 /**
@@ -217,13 +282,156 @@ C_KZG_RET fk20_single_da_opt(g1_t *out, const poly *p, const FK20SingleSettings
  * @retval C_CZK_ERROR   An internal error occurred
  */
 C_KZG_RET da_using_fk20_single(g1_t *out, const poly *p, const FK20SingleSettings *fk) {
+    STAT_SCOPE(DA_USING_FK20_SINGLE);
     uint64_t n = p->length, n2 = n * 2;
 
     CHECK(n2 <= fk->ks->fs->max_width);
     CHECK(is_power_of_two(n));
 
-    TRY(fk20_single_da_opt(out, p, fk));
-    TRY(reverse_bit_order(out, sizeof out[0], n2));
+    return fk20_single_proofs(out, p, fk, true);
+}
+
+/**
+ * The shared state for accumulating the Toeplitz products of the chunks in the FK20 multi-proof methods.
+ */
+typedef struct {
+    const poly *p;               /**< The polynomial */
+    const FK20MultiSettings *fk; /**< The FK20 multi settings */
+    uint64_t len;                /**< The length of the Toeplitz coefficients and of each accumulator */
+    uint64_t chunks_per_task;    /**< The number of chunks handled by each task */
+    FK20Workspace *ws;           /**< Buffers of length `len` for each task, and the result of each task */
+    uint64_t reduce_stride;      /**< The distance between the partial sums being added in the current level */
+} fk20_multi_job;
+
+/**
+ * Accumulate the Toeplitz products for a range of chunks, as one task of #fk20_multi_h_ext_fft.
+ *
+ * @param[in,out] arg The #fk20_multi_job
+ * @param[in]     t   The index of the task
+ */
+static void fk20_multi_chunk_task(void *arg, uint64_t t) {
+    const fk20_multi_job *job = arg;
+    const FK20MultiSettings *fk = job->fk;
+    uint64_t len = job->len, start = t * job->chunks_per_task;
+    uint64_t end = start + job->chunks_per_task < fk->chunk_len ? start + job->chunks_per_task : fk->chunk_len;
+    g1_t *acc = job->ws->acc + t * len, *h_ext_fft_file = job->ws->h_ext_fft_files + t * len;
+    fr_t *toeplitz_coeffs_fft = job->ws->toeplitz_coeffs_fft + t * len;
+    byte *scratch = job->ws->scratch + t * job->ws->scratch_len;
+    uint64_t file_len = fk->length / fk->chunk_len;
+    poly toeplitz_coeffs = {job->ws->toeplitz_coeffs + t * len, len};
+    C_KZG_RET ret = C_KZG_OK;
+
+    for (uint64_t j = 0; j < len; j++) {
+        acc[j] = g1_identity;
+    }
+    for (uint64_t i = start; i < end && ret == C_KZG_OK; i++) {
+        ret = toeplitz_coeffs_stride(&toeplitz_coeffs, job->p, i, fk->chunk_len);
+        if (ret == C_KZG_OK) {
+            // The tables cover only the `file_len` points of each file
+            const g1_affine_t *table = NULL;
+            if (fk->x_ext_fft_files_table != NULL && len <= file_len) {
+                table = fk->x_ext_fft_files_table + i * file_len * g1_mul_table_length(fk->wbits);
+            }
+            ret = toeplitz_part_2_scratch(h_ext_fft_file, &toeplitz_coeffs, fk->x_ext_fft_files[i], table, fk->wbits,
+                                          toeplitz_coeffs_fft, scratch, fk->ks->fs);
+        }
+        if (ret == C_KZG_OK) {
+            for (uint64_t j = 0; j < len; j++) {
+                g1_add_or_dbl(&acc[j], &acc[j], &h_ext_fft_file[j]);
+            }
+        }
+    }
+    job->ws->ret[t] = ret;
+}
+
+/**
+ * Add together a pair of partial sums at the current level of the reduction in #fk20_multi_h_ext_fft.
+ *
+ * @param[in,out] arg The #fk20_multi_job
+ * @param[in]     i   The index of the pair
+ */
+static void fk20_multi_reduce_task(void *arg, uint64_t i) {
+    const fk20_multi_job *job = arg;
+    g1_t *a = job->ws->acc + 2 * i * job->reduce_stride * job->len, *b = a + job->reduce_stride * job->len;
+    for (uint64_t j = 0; j < job->len; j++) {
+        g1_add_or_dbl(&a[j], &a[j], &b[j]);
+    }
+}
+
+/**
+ * Calculate the sum over all the chunks of the Toeplitz products, for the FK20 multi-proof methods.
+ *
+ * The chunks are independent, so if a thread pool is set in the KZG settings then they are divided between the
+ * threads, each accumulating its own partial sum. The partial sums are then combined by a tree reduction.
+ *
+ * @param[in]  p         The polynomial
+ * @param[in]  fk        FK20 multi settings previously initialised by #new_fk20_multi_settings
+ * @param[in]  len       The length of the Toeplitz coefficients
+ * @param[in,out] ws     A workspace of length at least @p len. The sum is left in the first @p len entries of `acc`.
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ */
+static C_KZG_RET fk20_multi_h_ext_fft(const poly *p, const FK20MultiSettings *fk, uint64_t len, FK20Workspace *ws) {
+    const ThreadPool *pool = fk->ks->pool;
+    uint64_t tasks = pool_threads(pool) < fk->chunk_len ? pool_threads(pool) : fk->chunk_len;
+    if (tasks > ws->parts) tasks = ws->parts;
+    fk20_multi_job job = {p, fk, len, (fk->chunk_len + tasks - 1) / tasks, ws};
+
+    ASSERT(len <= ws->length);
+
+    pool_run(pool, fk20_multi_chunk_task, &job, tasks);
+    for (uint64_t t = 0; t < tasks; t++) {
+        TRY(ws->ret[t]);
+    }
+
+    for (job.reduce_stride = 1; job.reduce_stride < tasks; job.reduce_stride *= 2) {
+        // Pairs (t, t + stride) for every t that is a multiple of 2 * stride
+        uint64_t pairs = (tasks - job.reduce_stride + 2 * job.reduce_stride - 1) / (2 * job.reduce_stride);
+        pool_run(pool, fk20_multi_reduce_task, &job, pairs);
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * The steps common to the FK20 multi-proof methods: sum the Toeplitz products, then transform back to `h` and on to
+ * the proofs.
+ *
+ * If a workspace large enough for @p len is set in @p fk then no memory is allocated, otherwise a temporary one is
+ * used.
+ *
+ * @param[out] out     The proofs, array size @p len
+ * @param[in]  p       The polynomial
+ * @param[in]  fk      FK20 multi settings previously initialised by #new_fk20_multi_settings
+ * @param[in]  len     The length of the Toeplitz coefficients
+ * @param[in]  bit_reversed `true` to leave the proofs in bit-reversed order, `false` for natural order
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET fk20_multi_proofs(g1_t *out, const poly *p, const FK20MultiSettings *fk, uint64_t len,
+                                   bool bit_reversed) {
+    FK20Workspace tmp, *ws = fk->workspace;
+
+    if (ws == NULL || ws->length < len) {
+        unsigned int parts = pool_threads(fk->ks->pool);
+        TRY(new_fk20_workspace(&tmp, len, parts < fk->chunk_len ? parts : fk->chunk_len));
+        ws = &tmp;
+    }
+
+    TRY(fk20_multi_h_ext_fft(p, fk, len, ws));
+    TRY(toeplitz_part_3(ws->h, ws->acc, len, fk->ks->fs));
+    if (bit_reversed) {
+        TRY(fft_g1_bit_reversed(out, ws->h, len, fk->ks->fs));
+    } else {
+        TRY(fft_g1(out, ws->h, false, len, fk->ks->fs));
+    }
+
+    if (ws == &tmp) {
+        free_fk20_workspace(&tmp);
+    }
 
     return C_KZG_OK;
 }
@@ -243,42 +451,26 @@ C_KZG_RET da_using_fk20_single(g1_t *out, const poly *p, const FK20SingleSetting
  * proof[i]: w^(i*l + 0), w^(i*l + 1), ... w^(i*l + l - 1)
  * ```
  *
- * @param[out] out The proofs, array size @p p->length * 2
- * @param[in]  p   The polynomial
+ * Each chunk `i` of the Toeplitz sum takes every `l`th coefficient from offset `i`, and is multiplied by the `i`th
+ * file of `x_ext_fft`, which has `2 * k` points.
+ *
+ * @param[out] out The proofs, array size `2 * n / fk->chunk_len`
+ * @param[in]  p   The polynomial, length `n`, a power of two no smaller than `fk->chunk_len`
  * @param[in]  fk  FK20 multi settings previously initialised by #new_fk20_multi_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET fk20_compute_proof_multi(g1_t *out, const poly *p, const FK20MultiSettings *fk) {
     uint64_t n = p->length, n2 = n * 2;
-    g1_t *h_ext_fft, *h_ext_fft_file, *h;
-    poly toeplitz_coeffs;
 
     CHECK(fk->ks->fs->max_width >= n2);
+    CHECK(n2 <= fk->length);
+    CHECK(is_power_of_two(n));
+    CHECK(n >= fk->chunk_len);
 
-    TRY(new_g1_array(&h_ext_fft, n2));
-    for (uint64_t i = 0; i < n2; i++) {
-        h_ext_fft[i] = g1_identity;
-    }
-
-    TRY(new_poly(&toeplitz_coeffs, 2 * p->length));
-    TRY(new_g1_array(&h_ext_fft_file, toeplitz_coeffs.length));
-    for (uint64_t i = 0; i < fk->chunk_len; i++) {
-        TRY(toeplitz_coeffs_step(&toeplitz_coeffs, p));
-        TRY(toeplitz_part_2(h_ext_fft_file, &toeplitz_coeffs, fk->x_ext_fft_files[i], fk->ks->fs));
-        for (uint64_t j = 0; j < n2; j++) {
-            g1_add_or_dbl(&h_ext_fft[j], &h_ext_fft[j], &h_ext_fft_file[j]);
-        }
-    }
-    free_poly(&toeplitz_coeffs);
-    free(h_ext_fft_file);
-
-    TRY(new_g1_array(&h, n2));
-    TRY(toeplitz_part_3(h, h_ext_fft, n2, fk->ks->fs));
-
-    TRY(fft_g1(out, h, false, n2, fk->ks->fs));
-
-    free(h_ext_fft);
-    free(h);
-    return C_KZG_OK;
+    return fk20_multi_proofs(out, p, fk, n2 / fk->chunk_len, false);
 }
 
 /**
@@ -288,72 +480,247 @@ C_KZG_RET fk20_compute_proof_multi(g1_t *out, const poly *p, const FK20MultiSett
  * @remark Only the lower half of the polynomial is supplied; the upper, zero, half is assumed. The
  * #toeplitz_coeffs_stride routine does the right thing.
  *
+ * @remark If a workspace of length at least `2 * n / fk->chunk_length` is set in @p fk then no memory is allocated.
+ *
  * @param[out] out The proofs, array size `2 * n / fk->chunk_length`
  * @param[in]  p   The polynomial, length `n`
  * @param[in]  fk  FK20 multi settings previously initialised by #new_fk20_multi_settings
  */
 C_KZG_RET fk20_multi_da_opt(g1_t *out, const poly *p, const FK20MultiSettings *fk) {
-    uint64_t n = p->length, n2 = n * 2, k, k2;
-    g1_t *h_ext_fft, *h_ext_fft_file, *h;
-    poly toeplitz_coeffs;
+    uint64_t n = p->length, n2 = n * 2, k2;
 
     CHECK(n2 <= fk->ks->fs->max_width);
+    CHECK(n2 <= fk->length);
     CHECK(is_power_of_two(n));
 
-    n = n2 / 2;
-    k = n / fk->chunk_len;
-    k2 = k * 2;
+    k2 = n / fk->chunk_len * 2;
+
+    // The second half of `h` is zeroed by `toeplitz_part_3`
+    return fk20_multi_proofs(out, p, fk, k2, false);
+}
+
+/**
+ * Computes all the KZG proofs for data availability checks.
+ *
+ * This involves sampling on the double domain and reordering according to reverse bit order.
+ *
+ */
+C_KZG_RET da_using_fk20_multi(g1_t *out, const poly *p, const FK20MultiSettings *fk) {
+    STAT_SCOPE(DA_USING_FK20_MULTI);
+    uint64_t n = p->length, n2 = n * 2;
 
-    TRY(new_g1_array(&h_ext_fft, k2));
-    for (uint64_t i = 0; i < k2; i++) {
-        h_ext_fft[i] = g1_identity;
+    CHECK(n2 <= fk->ks->fs->max_width);
+    CHECK(n2 <= fk->length);
+    CHECK(is_power_of_two(n));
+
+    // The second half of `h` is zeroed by `toeplitz_part_3`
+    return fk20_multi_proofs(out, p, fk, n / fk->chunk_len * 2, true);
+}
+
+/**
+ * The shared state for the tasks of #da_using_fk20_multi_batch.
+ */
+typedef struct {
+    const poly *ps;              /**< The polynomials */
+    uint64_t count;              /**< The number of polynomials */
+    const FK20MultiSettings *fk; /**< The FK20 multi settings */
+    uint64_t len;                /**< The length of the Toeplitz coefficients, and the number of proofs per polynomial */
+    uint64_t per_task;           /**< The number of items handled by each task of the current stage */
+    fr_t *toeplitz_coeffs;       /**< Space for `len` Toeplitz coefficients for each task */
+    fr_t *toeplitz_coeffs_fft;   /**< The transformed Toeplitz coefficients, `len` for each chunk of each polynomial */
+    g1_t *acc;                   /**< The sums of the Toeplitz products, `len` for each polynomial */
+    byte *scratch;               /**< Scratch space of `scratch_len` bytes for each task, for the multiplications */
+    size_t scratch_len;          /**< The size of the scratch space for each task in bytes */
+    C_KZG_RET *ret;              /**< The result of each task */
+    g1_t *out;                   /**< The proofs, `len` for each polynomial */
+} fk20_batch_job;
+
+/**
+ * Transform the Toeplitz coefficients for a range of (polynomial, chunk) pairs, as one task of
+ * #da_using_fk20_multi_batch.
+ *
+ * @param[in,out] arg The #fk20_batch_job
+ * @param[in]     t   The index of the task
+ */
+static void fk20_batch_coeffs_task(void *arg, uint64_t t) {
+    const fk20_batch_job *job = arg;
+    uint64_t chunk_len = job->fk->chunk_len, len = job->len, start = t * job->per_task;
+    uint64_t end = min_u64(start + job->per_task, job->count * chunk_len);
+    poly toeplitz_coeffs = {job->toeplitz_coeffs + t * len, len};
+    C_KZG_RET ret = C_KZG_OK;
+
+    for (uint64_t q = start; q < end && ret == C_KZG_OK; q++) {
+        ret = toeplitz_coeffs_stride(&toeplitz_coeffs, &job->ps[q / chunk_len], q % chunk_len, chunk_len);
+        if (ret == C_KZG_OK) {
+            ret = fft_fr(job->toeplitz_coeffs_fft + q * len, toeplitz_coeffs.coeffs, false, len, job->fk->ks->fs);
+        }
     }
+    job->ret[t] = ret;
+}
+
+/**
+ * Accumulate the Toeplitz products of every chunk for a range of positions, as one task of
+ * #da_using_fk20_multi_batch.
+ *
+ * Each point of each file, or its table, is read once and applied to all the polynomials before moving on.
+ *
+ * @param[in,out] arg The #fk20_batch_job
+ * @param[in]     t   The index of the task
+ */
+static void fk20_batch_products_task(void *arg, uint64_t t) {
+    const fk20_batch_job *job = arg;
+    const FK20MultiSettings *fk = job->fk;
+    uint64_t len = job->len, start = t * job->per_task, end = min_u64(start + job->per_task, len);
+    uint64_t file_len = fk->length / fk->chunk_len, row = g1_mul_table_length(fk->wbits);
+    bool tables = fk->x_ext_fft_files_table != NULL && len <= file_len;
+    byte *scratch = job->scratch + t * job->scratch_len;
 
-    TRY(new_poly(&toeplitz_coeffs, n2 / fk->chunk_len));
-    TRY(new_g1_array(&h_ext_fft_file, toeplitz_coeffs.length));
     for (uint64_t i = 0; i < fk->chunk_len; i++) {
-        TRY(toeplitz_coeffs_stride(&toeplitz_coeffs, p, i, fk->chunk_len));
-        TRY(toeplitz_part_2(h_ext_fft_file, &toeplitz_coeffs, fk->x_ext_fft_files[i], fk->ks->fs));
-        for (uint64_t j = 0; j < k2; j++) {
-            g1_add_or_dbl(&h_ext_fft[j], &h_ext_fft[j], &h_ext_fft_file[j]);
+        const fr_t *coeffs_fft = job->toeplitz_coeffs_fft + i * len;
+        for (uint64_t j = start; j < end; j++) {
+            const g1_affine_t *table = tables ? fk->x_ext_fft_files_table + (i * file_len + j) * row : NULL;
+            for (uint64_t b = 0; b < job->count; b++) {
+                g1_t product, *acc = &job->acc[b * len + j];
+                const fr_t *c = &coeffs_fft[b * fk->chunk_len * len + j];
+                if (table != NULL) {
+                    g1_mul_precomputed(&product, table, fk->wbits, c, scratch);
+                } else {
+                    g1_mul(&product, &fk->x_ext_fft_files[i][j], c);
+                }
+                if (i == 0) {
+                    *acc = product;
+                } else {
+                    g1_add_or_dbl(acc, acc, &product);
+                }
+            }
         }
     }
-    free_poly(&toeplitz_coeffs);
-    free(h_ext_fft_file);
+}
 
-    // Calculate `h`
-    TRY(new_g1_array(&h, k2));
-    TRY(toeplitz_part_3(h, h_ext_fft, k2, fk->ks->fs));
+/**
+ * Transform the sums for polynomial @p b back to `h` and on to its proofs, as one task of #da_using_fk20_multi_batch.
+ *
+ * @param[in,out] arg The #fk20_batch_job
+ * @param[in]     b   The index of the polynomial
+ */
+static void fk20_batch_proofs_task(void *arg, uint64_t b) {
+    const fk20_batch_job *job = arg;
+    const FFTSettings *fs = job->fk->ks->fs;
+    g1_t *out = job->out + b * job->len;
+
+    job->ret[b] = toeplitz_part_3(out, job->acc + b * job->len, job->len, fs);
+    if (job->ret[b] == C_KZG_OK) {
+        job->ret[b] = fft_g1_bit_reversed(out, out, job->len, fs);
+    }
+}
 
-    // Overwrite the second half of `h` with zero
-    for (uint64_t i = k; i < k2; i++) {
-        h[i] = g1_identity;
+/**
+ * Run the stages of #da_using_fk20_multi_batch, once the buffers in @p job have been allocated.
+ *
+ * @param[in,out] job   The state, with space for the results of at least @p tasks tasks and `job->count` polynomials
+ * @param[in]     tasks The number of tasks for transforming the Toeplitz coefficients
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ */
+static C_KZG_RET fk20_batch_stages(fk20_batch_job *job, uint64_t tasks) {
+    const ThreadPool *pool = job->fk->ks->pool;
+    uint64_t threads = pool_threads(pool);
+
+    job->per_task = (job->count * job->fk->chunk_len + tasks - 1) / tasks;
+    pool_run(pool, fk20_batch_coeffs_task, job, tasks);
+    for (uint64_t t = 0; t < tasks; t++) {
+        TRY(job->ret[t]);
     }
 
-    TRY(fft_g1(out, h, false, k2, fk->ks->fs));
+    tasks = min_u64(threads, job->len);
+    job->per_task = (job->len + tasks - 1) / tasks;
+    pool_run(pool, fk20_batch_products_task, job, tasks);
 
-    free(h_ext_fft);
-    free(h);
+    if (job->count >= threads) {
+        pool_run(pool, fk20_batch_proofs_task, job, job->count);
+    } else {
+        // Too few polynomials to go round, so leave the threads to the FFTs themselves
+        for (uint64_t b = 0; b < job->count; b++) {
+            fk20_batch_proofs_task(job, b);
+        }
+    }
+    for (uint64_t b = 0; b < job->count; b++) {
+        TRY(job->ret[b]);
+    }
 
     return C_KZG_OK;
 }
 
 /**
- * Computes all the KZG proofs for data availability checks.
+ * Computes all the KZG proofs for data availability checks for a batch of polynomials.
  *
- * This involves sampling on the double domain and reordering according to reverse bit order.
+ * The result for each polynomial is the same as from #da_using_fk20_multi, but the work is arranged so that the
+ * settings are read from memory once for the whole batch: the Toeplitz coefficients of every chunk of every polynomial
+ * are transformed first, then each point of `fk->x_ext_fft_files`, or its multiplication table, is applied to all the
+ * polynomials in turn. This is worthwhile when the multiplications are limited by memory bandwidth, as they are with
+ * tables.
+ *
+ * If a thread pool is set in the KZG settings then each stage is divided between the threads, and the final FFTs of
+ * the polynomials are computed in parallel with each other.
  *
+ * @remark This allocates space for the transformed Toeplitz coefficients of the whole batch, the same number of field
+ * elements as there are in the polynomials, doubled. The workspace in @p fk is not used.
+ *
+ * @param[out] out   The proofs, `2 * n / fk->chunk_len` for each polynomial in turn
+ * @param[in]  ps    The polynomials, @p count of them, each of the same length `n`
+ * @param[in]  count The number of polynomials
+ * @param[in]  fk    FK20 multi settings previously initialised by #new_fk20_multi_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
  */
-C_KZG_RET da_using_fk20_multi(g1_t *out, const poly *p, const FK20MultiSettings *fk) {
-    uint64_t n = p->length, n2 = n * 2;
+C_KZG_RET da_using_fk20_multi_batch(g1_t *out, const poly *ps, uint64_t count, const FK20MultiSettings *fk) {
+    STAT_SCOPE(DA_USING_FK20_MULTI_BATCH);
+    uint64_t n, len, threads = pool_threads(fk->ks->pool), tasks;
+    fk20_batch_job job;
+    C_KZG_RET ret = C_KZG_OK;
 
-    CHECK(n2 <= fk->ks->fs->max_width);
-    CHECK(is_power_of_two(n));
+    if (count == 0) return C_KZG_OK;
 
-    TRY(fk20_multi_da_opt(out, p, fk));
-    TRY(reverse_bit_order(out, sizeof out[0], n2 / fk->chunk_len));
+    n = ps[0].length;
+    CHECK(n * 2 <= fk->ks->fs->max_width);
+    CHECK(n * 2 <= fk->length);
+    CHECK(is_power_of_two(n));
+    CHECK(n >= fk->chunk_len);
+    for (uint64_t b = 1; b < count; b++) {
+        CHECK(ps[b].length == n);
+    }
 
-    return C_KZG_OK;
+    len = n / fk->chunk_len * 2;
+    tasks = min_u64(threads, count * fk->chunk_len);
+
+    job.ps = ps;
+    job.count = count;
+    job.fk = fk;
+    job.len = len;
+    job.out = out;
+    job.toeplitz_coeffs = NULL;
+    job.toeplitz_coeffs_fft = NULL;
+    job.acc = NULL;
+    job.scratch = NULL;
+    job.ret = NULL;
+    job.scratch_len = fk->x_ext_fft_files_table != NULL ? g1_mul_table_scratch_sizeof(fk->wbits) : 0;
+
+    ret = new_fr_array(&job.toeplitz_coeffs, tasks * len);
+    if (ret == C_KZG_OK) ret = new_fr_array(&job.toeplitz_coeffs_fft, count * fk->chunk_len * len);
+    if (ret == C_KZG_OK) ret = new_g1_array(&job.acc, count * len);
+    if (ret == C_KZG_OK) ret = new_byte_array(&job.scratch, threads * job.scratch_len);
+    if (ret == C_KZG_OK) ret = new_byte_array((byte **)&job.ret, max_u64(tasks, count) * sizeof *job.ret);
+    if (ret == C_KZG_OK) ret = fk20_batch_stages(&job, tasks);
+
+    c_kzg_free(job.toeplitz_coeffs);
+    c_kzg_free(job.toeplitz_coeffs_fft);
+    c_kzg_free(job.acc);
+    c_kzg_free(job.scratch);
+    c_kzg_free(job.ret);
+    return ret;
 }
 
 /**
@@ -380,17 +747,22 @@ C_KZG_RET new_fk20_single_settings(FK20SingleSettings *fk, uint64_t n2, const KZ
 
     fk->ks = ks;
     fk->x_ext_fft_len = n2;
+    fk->x_ext_fft_table = NULL;
+    fk->wbits = 0;
+    fk->workspace = NULL;
+    fk->mapping = NULL;
+    fk->mapping_len = 0;
 
     TRY(new_g1_array(&x, n));
     for (uint64_t i = 0; i < n - 1; i++) {
-        x[i] = ks->secret_g1[n - 2 - i];
+        kzg_settings_secret_g1(&x[i], ks, n - 2 - i);
     }
     x[n - 1] = g1_identity;
 
     TRY(new_g1_array(&fk->x_ext_fft, 2 * n));
     TRY(toeplitz_part_1(fk->x_ext_fft, x, n, ks->fs));
 
-    free(x);
+    c_kzg_free(x);
     return C_KZG_OK;
 }
 
@@ -425,6 +797,12 @@ C_KZG_RET new_fk20_multi_settings(FK20MultiSettings *fk, uint64_t n2, uint64_t c
 
     fk->ks = ks;
     fk->chunk_len = chunk_len;
+    fk->length = n2;
+    fk->x_ext_fft_files_table = NULL;
+    fk->wbits = 0;
+    fk->workspace = NULL;
+    fk->mapping = NULL;
+    fk->mapping_len = 0;
 
     // `x_ext_fft_files` is two dimensional. Allocate space for pointers to the rows.
     TRY(new_g1_array_2(&fk->x_ext_fft_files, chunk_len * sizeof *fk->x_ext_fft_files));
@@ -433,7 +811,7 @@ C_KZG_RET new_fk20_multi_settings(FK20MultiSettings *fk, uint64_t n2, uint64_t c
     for (uint64_t offset = 0; offset < chunk_len; offset++) {
         uint64_t start = n - chunk_len - 1 - offset;
         for (uint64_t i = 0, j = start; i + 1 < k; i++, j -= chunk_len) {
-            x[i] = ks->secret_g1[j];
+            kzg_settings_secret_g1(&x[i], ks, j);
         }
         x[k - 1] = g1_identity;
 
@@ -441,34 +819,194 @@ C_KZG_RET new_fk20_multi_settings(FK20MultiSettings *fk, uint64_t n2, uint64_t c
         TRY(toeplitz_part_1(fk->x_ext_fft_files[offset], x, k, ks->fs));
     }
 
-    free(x);
+    c_kzg_free(x);
     return C_KZG_OK;
 }
 
 /**
- * Free the memory that was previously allocated by #new_fk20_single_settings.
+ * Precompute multiplication tables for the points of `x_ext_fft` to speed up FK20 single proofs.
+ *
+ * The points are fixed when the settings are initialised, and every proof multiplies each of them by a new field
+ * element. With a table per point each multiplication becomes around `255 / (wbits - 1)` point additions, and no
+ * doublings.
+ *
+ * The tables take `x_ext_fft_len` * #g1_mul_table_length(@p wbits) affine points of memory, which is several
+ * megabytes for every hundred points even at the smallest window sizes. Larger windows are faster and take
+ * exponentially more memory.
+ *
+ * @remark This may be called more than once; any existing tables are replaced. The memory is reclaimed by
+ * #free_fk20_single_settings. Settings loaded by #load_fk20_single_settings are read-only, so save them with their
+ * tables instead.
+ *
+ * @param[in,out] fk    Settings previously initialised with #new_fk20_single_settings
+ * @param[in]     wbits The window size in bits, between 2 and 8
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET fk20_single_settings_precompute(FK20SingleSettings *fk, unsigned int wbits) {
+    uint64_t row;
+    g1_affine_t *table;
+
+    CHECK(wbits >= 2 && wbits <= 8);
+    CHECK(fk->mapping == NULL);
+    row = g1_mul_table_length(wbits);
+
+    TRY(new_g1_affine_array(&table, fk->x_ext_fft_len * row));
+    for (uint64_t i = 0; i < fk->x_ext_fft_len; i++) {
+        g1_mul_precompute(table + i * row, wbits, &fk->x_ext_fft[i]);
+    }
+
+    c_kzg_free(fk->x_ext_fft_table);
+    fk->x_ext_fft_table = table;
+    fk->wbits = wbits;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Precompute multiplication tables for the points of `x_ext_fft_files` to speed up FK20 multi proofs.
+ *
+ * As for #fk20_single_settings_precompute. The tables take `length` * #g1_mul_table_length(@p wbits) affine points of
+ * memory, and are used for the data availability methods #fk20_multi_da_opt and #da_using_fk20_multi.
+ *
+ * @remark This may be called more than once; any existing tables are replaced. The memory is reclaimed by
+ * #free_fk20_multi_settings. Settings loaded by #load_fk20_multi_settings are read-only, so save them with their
+ * tables instead.
+ *
+ * @param[in,out] fk    Settings previously initialised with #new_fk20_multi_settings
+ * @param[in]     wbits The window size in bits, between 2 and 8
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET fk20_multi_settings_precompute(FK20MultiSettings *fk, unsigned int wbits) {
+    uint64_t row, file_len = fk->length / fk->chunk_len;
+    g1_affine_t *table;
+
+    CHECK(wbits >= 2 && wbits <= 8);
+    CHECK(fk->mapping == NULL);
+    row = g1_mul_table_length(wbits);
+
+    TRY(new_g1_affine_array(&table, fk->length * row));
+    for (uint64_t i = 0; i < fk->chunk_len; i++) {
+        for (uint64_t j = 0; j < file_len; j++) {
+            g1_mul_precompute(table + (i * file_len + j) * row, wbits, &fk->x_ext_fft_files[i][j]);
+        }
+    }
+
+    c_kzg_free(fk->x_ext_fft_files_table);
+    fk->x_ext_fft_files_table = table;
+    fk->wbits = wbits;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Free the memory that was previously allocated by #new_fk20_single_settings or #load_fk20_single_settings.
  *
  * @param fk The settings to be freed
  */
 void free_fk20_single_settings(FK20SingleSettings *fk) {
-    free(fk->x_ext_fft);
+    if (fk->mapping != NULL) {
+        munmap(fk->mapping, fk->mapping_len);
+        fk->mapping = NULL;
+        fk->mapping_len = 0;
+    } else {
+        c_kzg_free(fk->x_ext_fft);
+        c_kzg_free(fk->x_ext_fft_table);
+    }
+    fk->x_ext_fft_table = NULL;
+    fk->wbits = 0;
     fk->x_ext_fft_len = 0;
 }
 
 /**
- * Free the memory that was previously allocated by #new_fk20_multi_settings.
+ * Free the memory that was previously allocated by #new_fk20_multi_settings or #load_fk20_multi_settings.
  *
  * @param fk The settings to be freed
  */
 void free_fk20_multi_settings(FK20MultiSettings *fk) {
-    for (uint64_t i = 0; i < fk->chunk_len; i++) {
-        free((fk->x_ext_fft_files)[i]);
+    if (fk->mapping != NULL) {
+        munmap(fk->mapping, fk->mapping_len);
+        fk->mapping = NULL;
+        fk->mapping_len = 0;
+    } else {
+        for (uint64_t i = 0; i < fk->chunk_len; i++) {
+            c_kzg_free((fk->x_ext_fft_files)[i]);
+        }
+        c_kzg_free(fk->x_ext_fft_files_table);
     }
-    free(fk->x_ext_fft_files);
+    c_kzg_free(fk->x_ext_fft_files);
+    fk->x_ext_fft_files_table = NULL;
+    fk->wbits = 0;
     fk->chunk_len = 0;
     fk->length = 0;
 }
 
+/**
+ * Initialise a workspace for computing FK20 proofs without allocating memory.
+ *
+ * A workspace can be attached to FK20 single or multi settings `fk` by setting `fk->workspace`, after which proof
+ * generation allocates nothing. For #FK20SingleSettings the length should be `fk->x_ext_fft_len`; for
+ * #FK20MultiSettings used for data availability it should be `fk->length / fk->chunk_len`.
+ *
+ * @remark A workspace holds the intermediate state of a single computation, so settings with an attached workspace
+ * must not be used for more than one set of proofs at a time. When computing multi proofs in parallel via a thread
+ * pool, @p parts should be at least the number of threads in the pool; any excess threads are left idle. Single
+ * proofs only ever use one part.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_fk20_workspace.
+ *
+ * @param[out] ws     The new workspace
+ * @param[in]  length The maximum length of the Toeplitz coefficients
+ * @param[in]  parts  The maximum number of parts that the chunks will be split into, at least one
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_fk20_workspace(FK20Workspace *ws, uint64_t length, unsigned int parts) {
+    CHECK(parts >= 1);
+
+    ws->length = length;
+    ws->parts = parts;
+
+    // Enough scratch space for multiplying by tables of any window size
+    ws->scratch_len = 0;
+    for (unsigned int wbits = 2; wbits <= 8; wbits++) {
+        size_t len = g1_mul_table_scratch_sizeof(wbits);
+        if (len > ws->scratch_len) ws->scratch_len = len;
+    }
+
+    TRY(new_fr_array(&ws->toeplitz_coeffs, parts * length));
+    TRY(new_fr_array(&ws->toeplitz_coeffs_fft, parts * length));
+    TRY(new_g1_array(&ws->h_ext_fft_files, parts * length));
+    TRY(new_g1_array(&ws->acc, parts * length));
+    TRY(new_g1_array(&ws->h, length));
+    TRY(new_byte_array((byte **)&ws->ret, parts * sizeof *ws->ret));
+    TRY(new_byte_array(&ws->scratch, parts * ws->scratch_len));
+
+    return C_KZG_OK;
+}
+
+/**
+ * Free the memory that was previously allocated by #new_fk20_workspace.
+ *
+ * @param ws The workspace to be freed
+ */
+void free_fk20_workspace(FK20Workspace *ws) {
+    c_kzg_free(ws->toeplitz_coeffs);
+    c_kzg_free(ws->toeplitz_coeffs_fft);
+    c_kzg_free(ws->h_ext_fft_files);
+    c_kzg_free(ws->acc);
+    c_kzg_free(ws->h);
+    c_kzg_free(ws->ret);
+    c_kzg_free(ws->scratch);
+    ws->length = 0;
+    ws->parts = 0;
+}
+
 #ifdef KZGTEST
 
 #include "../inc/acutest.h"
@@ -751,7 +1289,325 @@ void fk_multi_chunk_len_16_16() {
     fk_multi_case(16, 16);
 }
 
-// TODO: compare results of fk20_multi_da_opt() and  fk20_compute_proof_multi()
+// With chunks longer than one, each chunk reads only its own file of `x_ext_fft`
+void fk_multi_compute_proof_chunks(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20MultiSettings fk;
+    ThreadPool pool;
+    uint64_t n = 64, chunk_len = 8, secrets_len = 2 * n, k2 = 2 * n / chunk_len;
+    g1_t *s1;
+    g2_t *s2;
+    g1_t expected[k2], actual[k2];
+    poly p;
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, secrets_len));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, secrets_len));
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk, 2 * n, chunk_len, &ks));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    // The serial result is the same as the data availability method's, whose proofs are checked in fk_multi_case()
+    TEST_CHECK(C_KZG_OK == fk20_compute_proof_multi(expected, &p, &fk));
+    TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(actual, &p, &fk));
+    for (int i = 0; i < k2; i++) {
+        TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+        TEST_MSG("fk20_compute_proof_multi differs from fk20_multi_da_opt at %d", i);
+    }
+
+    unsigned int thread_counts[] = {2, 3, 16};
+    for (int t = 0; t < sizeof thread_counts / sizeof thread_counts[0]; t++) {
+        TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, thread_counts[t]));
+        ks.pool = &pool;
+        TEST_CHECK(C_KZG_OK == fk20_compute_proof_multi(actual, &p, &fk));
+        ks.pool = NULL;
+        for (int i = 0; i < k2; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+            TEST_MSG("fk20_compute_proof_multi mismatch with %u threads at %d", thread_counts[t], i);
+        }
+        free_thread_pool(&pool);
+    }
+
+#ifndef DEBUG
+    // A polynomial longer than the settings allow would read past the end of each file
+    poly q;
+    TEST_CHECK(C_KZG_OK == new_poly(&q, 2 * n));
+    TEST_CHECK(C_KZG_BADARGS == fk20_compute_proof_multi(actual, &q, &fk));
+    free_poly(&q);
+#endif
+
+    free_poly(&p);
+    free(s1);
+    free(s2);
+    free_fk20_multi_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_multi_parallel(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20MultiSettings fk;
+    ThreadPool pool;
+    uint64_t n = 128, chunk_len = 16, secrets_len = 2 * n;
+    g1_t *s1;
+    g2_t *s2;
+    g1_t expected[2 * n / chunk_len], actual[2 * n / chunk_len];
+    poly p;
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, secrets_len));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, secrets_len));
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk, 2 * n, chunk_len, &ks));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    // Thread counts that divide the chunks evenly, unevenly, and leave some threads with nothing to do
+    unsigned int thread_counts[] = {2, 3, 5, 32};
+    for (int t = 0; t < sizeof thread_counts / sizeof thread_counts[0]; t++) {
+        TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, thread_counts[t]));
+
+        ks.pool = NULL;
+        TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(expected, &p, &fk));
+        ks.pool = &pool;
+        TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(actual, &p, &fk));
+        for (int i = 0; i < 2 * n / chunk_len; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+            TEST_MSG("fk20_multi_da_opt mismatch with %u threads at %d", thread_counts[t], i);
+        }
+
+        free_thread_pool(&pool);
+    }
+
+    free_poly(&p);
+    free(s1);
+    free(s2);
+    free_fk20_multi_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_multi_batch(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20MultiSettings fk;
+    ThreadPool pool;
+    uint64_t n = 64, chunk_len = 4, secrets_len = 2 * n, k2 = 2 * n / chunk_len, count = 3;
+    g1_t *s1;
+    g2_t *s2;
+    g1_t expected[count * k2], actual[count * k2];
+    poly ps[count];
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, secrets_len));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, secrets_len));
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk, 2 * n, chunk_len, &ks));
+
+    for (int b = 0; b < count; b++) {
+        TEST_CHECK(C_KZG_OK == new_poly(&ps[b], n));
+        for (int i = 0; i < n; i++) {
+            ps[b].coeffs[i] = rand_fr();
+        }
+        TEST_CHECK(C_KZG_OK == da_using_fk20_multi(&expected[b * k2], &ps[b], &fk));
+    }
+
+    // Serially, then with more threads and with fewer threads than polynomials, then with tables
+    for (int pass = 0; pass < 4; pass++) {
+        if (pass == 1 || pass == 2) {
+            TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, pass == 1 ? 5 : 2));
+            ks.pool = &pool;
+            fs.pool = &pool;
+        }
+        if (pass == 3) {
+            TEST_CHECK(C_KZG_OK == fk20_multi_settings_precompute(&fk, 3));
+        }
+        TEST_CHECK(C_KZG_OK == da_using_fk20_multi_batch(actual, ps, count, &fk));
+        for (int i = 0; i < count * k2; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+            TEST_MSG("Mismatch on pass %d at proof %d of polynomial %lu", pass, i % (int)k2, i / k2);
+        }
+        if (pass == 1 || pass == 2) {
+            ks.pool = NULL;
+            fs.pool = NULL;
+            free_thread_pool(&pool);
+        }
+    }
+
+    TEST_CHECK(C_KZG_OK == da_using_fk20_multi_batch(actual, ps, 0, &fk));
+
+#ifndef DEBUG
+    ps[1].length = n / 2;
+    TEST_CHECK(C_KZG_BADARGS == da_using_fk20_multi_batch(actual, ps, count, &fk));
+    ps[1].length = n;
+
+    // Polynomials twice as long as the settings, which the FFT settings would otherwise allow
+    FK20MultiSettings fk_short;
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk_short, n, chunk_len, &ks));
+    TEST_CHECK(C_KZG_BADARGS == da_using_fk20_multi_batch(actual, ps, count, &fk_short));
+    free_fk20_multi_settings(&fk_short);
+#endif
+
+    for (int b = 0; b < count; b++) {
+        free_poly(&ps[b]);
+    }
+    free(s1);
+    free(s2);
+    free_fk20_multi_settings(&fk);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_workspace(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20SingleSettings fk_single;
+    FK20MultiSettings fk_multi;
+    FK20Workspace single_ws, multi_ws, small_ws, bad_ws;
+    ThreadPool pool;
+    uint64_t n = 128, chunk_len = 16, secrets_len = 2 * n, k2 = 2 * n / chunk_len;
+    g1_t *s1;
+    g2_t *s2;
+    g1_t expected[2 * n], actual[2 * n];
+    poly p;
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, secrets_len));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, secrets_len));
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_single_settings(&fk_single, 2 * n, &ks));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk_multi, 2 * n, chunk_len, &ks));
+    TEST_CHECK(2 * n == fk_multi.length);
+
+    TEST_CHECK(C_KZG_OK == new_fk20_workspace(&single_ws, fk_single.x_ext_fft_len, 1));
+    TEST_CHECK(C_KZG_OK == new_fk20_workspace(&multi_ws, fk_multi.length / fk_multi.chunk_len, 2));
+    TEST_CHECK(C_KZG_OK == new_fk20_workspace(&small_ws, k2 / 2, 1));
+    TEST_CHECK(C_KZG_BADARGS == new_fk20_workspace(&bad_ws, k2, 0));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    // Single proofs: reusing the workspace gives the same results as allocating each time
+    TEST_CHECK(C_KZG_OK == fk20_single_da_opt(expected, &p, &fk_single));
+    fk_single.workspace = &single_ws;
+    for (int rep = 0; rep < 2; rep++) {
+        TEST_CHECK(C_KZG_OK == fk20_single_da_opt(actual, &p, &fk_single));
+        for (int i = 0; i < 2 * n; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+        }
+    }
+
+    // Multi proofs: serially, and with more threads than the workspace has parts for
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+    TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(expected, &p, &fk_multi));
+    fk_multi.workspace = &multi_ws;
+    for (int rep = 0; rep < 2; rep++) {
+        ks.pool = rep == 0 ? NULL : &pool;
+        TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(actual, &p, &fk_multi));
+        for (int i = 0; i < k2; i++) {
+            TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+            TEST_MSG("fk20_multi_da_opt mismatch on repetition %d at %d", rep, i);
+        }
+    }
+
+    // A workspace that is too small is not used
+    fk_multi.workspace = &small_ws;
+    TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(actual, &p, &fk_multi));
+    for (int i = 0; i < k2; i++) {
+        TEST_CHECK(g1_equal(&expected[i], &actual[i]));
+    }
+
+    free_thread_pool(&pool);
+    free_poly(&p);
+    free(s1);
+    free(s2);
+    free_fk20_workspace(&single_ws);
+    free_fk20_workspace(&multi_ws);
+    free_fk20_workspace(&small_ws);
+    free_fk20_single_settings(&fk_single);
+    free_fk20_multi_settings(&fk_multi);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
+
+void fk_precompute(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    FK20SingleSettings fk_single;
+    FK20MultiSettings fk_multi;
+    FK20Workspace ws;
+    uint64_t n = 64, chunk_len = 4, secrets_len = 2 * n, k2 = 2 * n / chunk_len;
+    g1_t *s1;
+    g2_t *s2;
+    g1_t expected_single[2 * n], expected_multi[2 * n], actual[2 * n];
+    poly p;
+
+    TEST_CHECK(C_KZG_OK == new_g1_array(&s1, secrets_len));
+    TEST_CHECK(C_KZG_OK == new_g2_array(&s2, secrets_len));
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, log2_pow2(secrets_len)));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_fk20_single_settings(&fk_single, 2 * n, &ks));
+    TEST_CHECK(C_KZG_OK == new_fk20_multi_settings(&fk_multi, 2 * n, chunk_len, &ks));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    TEST_CHECK(C_KZG_OK == fk20_single_da_opt(expected_single, &p, &fk_single));
+    TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(expected_multi, &p, &fk_multi));
+
+    TEST_CHECK(C_KZG_BADARGS == fk20_single_settings_precompute(&fk_single, 1));
+    TEST_CHECK(C_KZG_BADARGS == fk20_multi_settings_precompute(&fk_multi, 9));
+
+    // Replacing the tables with different window sizes, with and without a workspace
+    unsigned int wbits[] = {3, 6};
+    for (int w = 0; w < sizeof wbits / sizeof wbits[0]; w++) {
+        TEST_CHECK(C_KZG_OK == fk20_single_settings_precompute(&fk_single, wbits[w]));
+        TEST_CHECK(C_KZG_OK == fk20_multi_settings_precompute(&fk_multi, wbits[w]));
+        TEST_CHECK(wbits[w] == fk_single.wbits && wbits[w] == fk_multi.wbits);
+
+        TEST_CHECK(C_KZG_OK == new_fk20_workspace(&ws, 2 * n, 1));
+        for (int rep = 0; rep < 2; rep++) {
+            fk_single.workspace = fk_multi.workspace = rep == 0 ? NULL : &ws;
+            TEST_CHECK(C_KZG_OK == fk20_single_da_opt(actual, &p, &fk_single));
+            for (int i = 0; i < 2 * n; i++) {
+                TEST_CHECK(g1_equal(&expected_single[i], &actual[i]));
+                TEST_MSG("fk20_single_da_opt mismatch with wbits %u at %d", wbits[w], i);
+            }
+            TEST_CHECK(C_KZG_OK == fk20_multi_da_opt(actual, &p, &fk_multi));
+            for (int i = 0; i < k2; i++) {
+                TEST_CHECK(g1_equal(&expected_multi[i], &actual[i]));
+                TEST_MSG("fk20_multi_da_opt mismatch with wbits %u at %d", wbits[w], i);
+            }
+        }
+        free_fk20_workspace(&ws);
+    }
+
+    free_poly(&p);
+    free(s1);
+    free(s2);
+    free_fk20_single_settings(&fk_single);
+    free_fk20_multi_settings(&fk_multi);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+}
 
 TEST_LIST = {
     {"FK20_PROOFS_TEST", title},
@@ -761,6 +1617,11 @@ TEST_LIST = {
     {"fk_multi_chunk_len_1_512", fk_multi_chunk_len_1_512},
     {"fk_multi_chunk_len_16_512", fk_multi_chunk_len_16_512},
     {"fk_multi_chunk_len_16_16", fk_multi_chunk_len_16_16},
+    {"fk_multi_compute_proof_chunks", fk_multi_compute_proof_chunks},
+    {"fk_multi_parallel", fk_multi_parallel},
+    {"fk_multi_batch", fk_multi_batch},
+    {"fk_workspace", fk_workspace},
+    {"fk_precompute", fk_precompute},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
@@ -24,19 +24,23 @@
 #include "utility.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+// If `wbits` is non-zero then multiplication tables with that window size are used.
+// If `pool` is non-NULL then it is used for both the FK20 chunks and the G1 FFTs.
+// If `batch` is more than one then that many polynomials are done at a time by da_using_fk20_multi_batch(), and the
+// timings are per polynomial.
+bench_result run_bench(int scale, int max_seconds, unsigned int wbits, const ThreadPool *pool, int batch) {
+    bench_t bench;
 
     FFTSettings fs;
     KZGSettings ks;
     FK20MultiSettings fk;
+    FK20Workspace ws;
     uint64_t chunk_count, width;
     uint64_t secrets_len;
     g1_t *s1;
     g2_t *s2;
-    poly p;
+    poly p, *ps;
     uint64_t vv[] = {1, 2, 3, 4, 7, 8, 9, 10, 13, 14, 1, 15, 1, 1000, 134, 33};
     g1_t commitment;
     g1_t *all_proofs;
@@ -60,6 +64,13 @@ long run_bench(int scale, int max_seconds) {
     assert(C_KZG_OK == new_fft_settings(&fs, width));
     assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
     assert(C_KZG_OK == new_fk20_multi_settings(&fk, n * 2, chunk_len, &ks));
+    if (wbits) {
+        assert(C_KZG_OK == fk20_multi_settings_precompute(&fk, wbits));
+    }
+    assert(C_KZG_OK == new_fk20_workspace(&ws, fk.length / fk.chunk_len, pool_threads(pool)));
+    fk.workspace = &ws;
+    fs.pool = pool;
+    ks.pool = pool;
 
     // Create a test polynomial of size n that's independent of chunk_len
     assert(C_KZG_OK == new_poly(&p, n));
@@ -78,16 +89,25 @@ long run_bench(int scale, int max_seconds) {
     }
 
     assert(C_KZG_OK == commit_to_poly(&commitment, &p, &ks));
-    assert(C_KZG_OK == new_g1_array(&all_proofs, 2 * chunk_count));
-
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
-        assert(C_KZG_OK == da_using_fk20_multi(all_proofs, &p, &fk));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+    assert(C_KZG_OK == new_g1_array(&all_proofs, 2 * chunk_count * batch));
+    ps = malloc(batch * sizeof *ps);
+    assert(ps != NULL);
+    for (int b = 0; b < batch; b++) {
+        ps[b] = p;
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        if (batch > 1) {
+            assert(C_KZG_OK == da_using_fk20_multi_batch(all_proofs, ps, batch, &fk));
+        } else {
+            assert(C_KZG_OK == da_using_fk20_multi(all_proofs, &p, &fk));
+        }
+        bench_stop(&bench);
     }
 
+    free(ps);
     free_poly(&p);
     free(all_proofs);
     free(s1);
@@ -95,12 +115,16 @@ long run_bench(int scale, int max_seconds) {
     free_fft_settings(&fs);
     free_kzg_settings(&ks);
     free_fk20_multi_settings(&fk);
+    free_fk20_workspace(&ws);
 
-    return total_time / nits;
+    return bench_end(&bench, batch, batch * (uint64_t)n * sizeof(fr_t));
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
         case 1:
@@ -114,14 +138,32 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking fk_multi_da, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking fk_multi_da, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    for (int scale = 4; scale <= 14; scale++) {
+        bench_report(run_bench(scale, nsec, 0, NULL, 1), "fk_multi_da/scale_%d", scale);
+    }
+
+    // The tables take around 100kB per point at this window size, so stick to the smaller scales
+    for (int scale = 4; scale <= 9; scale++) {
+        bench_report(run_bench(scale, nsec, 5, NULL, 1), "fk_multi_da_wbits_5/scale_%d", scale);
+    }
+    for (int scale = 4; scale <= 9; scale++) {
+        bench_report(run_bench(scale, nsec, 5, NULL, 8), "fk_multi_da_wbits_5_batch_8/scale_%d", scale);
+    }
+
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 4; scale <= 14; scale++) {
+        bench_report(run_bench(scale, nsec, 0, &pool, 1), "fk_multi_da_threaded/scale_%d", scale);
+    }
     for (int scale = 4; scale <= 14; scale++) {
-        printf("fk_multi_da/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec, 0, &pool, 8), "fk_multi_da_threaded_batch_8/scale_%d", scale);
     }
+    free_thread_pool(&pool);
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
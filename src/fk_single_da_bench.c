@@ -23,10 +23,10 @@
 #include "c_kzg_alloc.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+// If `wbits` is non-zero then multiplication tables with that window size are used.
+bench_result run_bench(int scale, int max_seconds, unsigned int wbits) {
+    bench_t bench;
 
     // Fill with randomness
     uint64_t coeffs[1 << (scale - 1)];
@@ -41,6 +41,7 @@ long run_bench(int scale, int max_seconds) {
     FFTSettings fs;
     KZGSettings ks;
     FK20SingleSettings fk;
+    FK20Workspace ws;
     uint64_t secrets_len = n_len + 1;
     g1_t s1[secrets_len];
     g2_t s2[secrets_len];
@@ -60,16 +61,20 @@ long run_bench(int scale, int max_seconds) {
     assert(C_KZG_OK == new_fft_settings(&fs, n));
     assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
     assert(C_KZG_OK == new_fk20_single_settings(&fk, 2 * poly_len, &ks));
+    if (wbits) {
+        assert(C_KZG_OK == fk20_single_settings_precompute(&fk, wbits));
+    }
+    assert(C_KZG_OK == new_fk20_workspace(&ws, fk.x_ext_fft_len, 1));
+    fk.workspace = &ws;
 
     // Commit to the polynomial
     assert(C_KZG_OK == commit_to_poly(&commitment, &p, &ks));
 
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
         assert(C_KZG_OK == da_using_fk20_single(all_proofs, &p, &fk));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+        bench_stop(&bench);
     }
 
     free_poly(&p);
@@ -77,13 +82,16 @@ long run_bench(int scale, int max_seconds) {
     free_fft_settings(&fs);
     free_kzg_settings(&ks);
     free_fk20_single_settings(&fk);
+    free_fk20_workspace(&ws);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, 0);
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
 
+    argc = bench_init(argc, argv);
+
     switch (argc) {
         case 1:
             nsec = NSEC;
@@ -96,14 +104,19 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking fk_single_da, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking fk_single_da, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
     for (int scale = 4; scale <= 14; scale++) {
-        printf("fk_single_da/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec, 0), "fk_single_da/scale_%d", scale);
+    }
+
+    // The tables take around 100kB per point at this window size, so stick to the smaller scales
+    for (int scale = 4; scale <= 10; scale++) {
+        bench_report(run_bench(scale, nsec, 5), "fk_single_da_wbits_5/scale_%d", scale);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
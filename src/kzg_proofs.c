@@ -23,29 +23,370 @@
  * Applications](https://www.iacr.org/archive/asiacrypt2010/6477178/6477178.pdf) for the theoretical background.
  */
 
-#include <stddef.h> // NULL
+#include <stddef.h>   // NULL
+#include <sys/mman.h> // munmap()
 #include "control.h"
 #include "c_kzg_alloc.h"
 #include "utility.h"
 
+/**
+ * The minimum number of points given to each thread when a commitment is split across a thread pool.
+ *
+ * Below this the per-thread overhead, and the loss of efficiency from running Pippenger on fewer points, outweigh the
+ * gains.
+ */
+#define MIN_POINTS_PER_THREAD 256
+
+/**
+ * The scratch space needed for a multi-scalar multiplication of @p len points by either method.
+ *
+ * @param[in] len The number of points
+ * @return The number of bytes needed
+ */
+static size_t msm_scratch_sizeof(uint64_t len) {
+    size_t pippenger = g1_linear_combination_scratch_sizeof(len);
+    size_t fixed_base = g1_fixed_base_scratch_sizeof(len);
+    return pippenger > fixed_base ? pippenger : fixed_base;
+}
+
+/**
+ * The shared state for committing to the chunks of a polynomial in parallel.
+ */
+typedef struct {
+    MSMWorkspace *ws;         /**< Buffers for the work, the outputs go in `ws->partials` */
+    const poly *p;            /**< The polynomial being committed to */
+    const KZGSettings *ks;    /**< The settings containing the secrets */
+    const g1_affine_t *basis; /**< The Lagrange-form secrets if committing to evaluations, NULL for coefficients */
+    uint64_t chunk_len;       /**< The number of coefficients in each chunk (the last may be shorter) */
+    size_t scratch_len;       /**< The size of the scratch space for each chunk */
+} commit_job;
+
+/**
+ * Commit to chunk @p i of the polynomial, as one task of #commit_to_poly.
+ *
+ * @param[in,out] arg The #commit_job
+ * @param[in]     i   The index of the chunk
+ */
+static void commit_task(void *arg, uint64_t i) {
+    const commit_job *job = arg;
+    uint64_t start = i * job->chunk_len;
+    uint64_t len = job->p->length - start < job->chunk_len ? job->p->length - start : job->chunk_len;
+    const KZGSettings *ks = job->ks;
+    MSMWorkspace *ws = job->ws;
+    byte *scratch = ws->scratch + i * job->scratch_len;
+
+    if (job->basis != NULL) {
+        g1_affine_linear_combination(&ws->partials[i], job->basis + start, job->p->coeffs + start, len,
+                                     ws->scalars + start, scratch);
+    } else if (ks->secret_g1_table != NULL) {
+        const g1_affine_t *table = ks->secret_g1_table + g1_fixed_base_table_length(ks->wbits, start);
+        g1_fixed_base_linear_combination(&ws->partials[i], table, ks->wbits, job->p->coeffs + start, len,
+                                         ws->scalars + start, scratch);
+    } else if (ks->secret_g1_affine != NULL) {
+        g1_affine_linear_combination(&ws->partials[i], ks->secret_g1_affine + start, job->p->coeffs + start, len,
+                                     ws->scalars + start, scratch);
+    } else {
+        g1_array_to_affine(ws->points + start, ks->secret_g1 + start, len);
+        g1_affine_linear_combination(&ws->partials[i], ws->points + start, job->p->coeffs + start, len,
+                                     ws->scalars + start, scratch);
+    }
+}
+
+/**
+ * Allocate the buffers of a workspace needed for multi-scalar multiplications only, as for #new_msm_workspace.
+ *
+ * This is enough for the temporary workspaces used internally, which have no need of space for quotients.
+ *
+ * @param[out] ws     The new workspace, to be freed with #free_msm_workspace
+ * @param[in]  length The maximum number of points in a linear combination using the workspace
+ * @param[in]  parts  The maximum number of parts that a linear combination will be split into, at least one
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET new_msm_buffers(MSMWorkspace *ws, uint64_t length, unsigned int parts) {
+    ws->length = length;
+    ws->parts = parts;
+    ws->quotient = NULL;
+
+    // Enough scratch space for splitting the work into any number of parts up to the maximum
+    ws->scratch_len = 0;
+    for (uint64_t i = 1; i <= parts; i++) {
+        size_t len = i * msm_scratch_sizeof((length + i - 1) / i);
+        if (len > ws->scratch_len) ws->scratch_len = len;
+    }
+
+    TRY(new_g1_affine_array(&ws->points, length));
+    TRY(new_scalar_array(&ws->scalars, length));
+    TRY(new_g1_array(&ws->partials, parts));
+    TRY(new_byte_array(&ws->scratch, ws->scratch_len));
+
+    return C_KZG_OK;
+}
+
+/**
+ * Implementation of #commit_to_poly and #commit_to_evaluations.
+ *
+ * @param[out] out   The commitment
+ * @param[in]  p     The coefficients or evaluations, no more than `ks->length` of them
+ * @param[in]  basis The Lagrange-form secrets for evaluations, or NULL for coefficients
+ * @param[in]  ks    The settings containing the secrets
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET commit_with_basis(g1_t *out, const poly *p, const g1_affine_t *basis, const KZGSettings *ks) {
+    MSMWorkspace tmp, *ws = ks->workspace;
+    commit_job job;
+    uint64_t chunks;
+
+    CHECK(p->length <= ks->length);
+    if (p->length == 0) {
+        *out = g1_identity;
+        return C_KZG_OK;
+    }
+
+    chunks = pool_threads(ks->pool);
+    if (chunks > p->length / MIN_POINTS_PER_THREAD) {
+        chunks = p->length / MIN_POINTS_PER_THREAD;
+    }
+    if (chunks == 0) chunks = 1;
+
+    if (ws == NULL || ws->length < p->length) {
+        TRY(new_msm_buffers(&tmp, p->length, chunks));
+        ws = &tmp;
+    } else if (chunks > ws->parts) {
+        chunks = ws->parts;
+    }
+
+    job.ws = ws;
+    job.p = p;
+    job.ks = ks;
+    job.basis = basis;
+    job.chunk_len = (p->length + chunks - 1) / chunks;
+    job.scratch_len = msm_scratch_sizeof(job.chunk_len);
+    ASSERT(chunks * job.scratch_len <= ws->scratch_len);
+
+    pool_run(ks->pool, commit_task, &job, chunks);
+
+    *out = ws->partials[0];
+    for (uint64_t i = 1; i < chunks; i++) {
+        g1_add_or_dbl(out, out, &ws->partials[i]);
+    }
+
+    if (ws == &tmp) {
+        free_msm_workspace(&tmp);
+    }
+
+    return C_KZG_OK;
+}
+
 /**
  * Make a KZG commitment to a polynomial.
  *
+ * If fixed-base tables have been built with #kzg_settings_precompute then these are used, otherwise a generic
+ * multi-scalar multiplication is performed over the secrets. This is a little quicker if the secrets are stored in
+ * affine form, see #kzg_settings_to_affine, as they need not be converted on each call.
+ *
+ * If a thread pool is set in @p ks, the coefficients are split into contiguous chunks, one per thread, that are
+ * committed to in parallel and then summed.
+ *
+ * If a workspace large enough for the polynomial is set in @p ks then no memory is allocated, otherwise temporary
+ * buffers are used.
+ *
  * @param[out] out The commitment to the polynomial, in the form of a G1 group point
  * @param[in]  p   The polynomial to be committed to
  * @param[in]  ks  The settings containing the secrets, previously initialised with #new_kzg_settings
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET commit_to_poly(g1_t *out, const poly *p, const KZGSettings *ks) {
-    CHECK(p->length <= ks->length);
-    g1_linear_combination(out, ks->secret_g1, p->coeffs, p->length);
+    STAT_SCOPE(COMMIT_TO_POLY);
+    return commit_with_basis(out, p, NULL, ks);
+}
+
+/**
+ * Make a KZG commitment to a polynomial given by its evaluations.
+ *
+ * The commitment is the same as that by #commit_to_poly to the polynomial's coefficients, but made directly from the
+ * Lagrange-form secrets, with no inverse FFT.
+ *
+ * @param[out] out   The commitment to the polynomial, in the form of a G1 group point
+ * @param[in]  evals The values of the polynomial at the powers of the primitive @p n-th root of unity, in order
+ * @param[in]  n     The number of evaluations, which must be `ks->lagrange_length`
+ * @param[in]  ks    Settings with Lagrange-form secrets, see #kzg_settings_lagrange
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET commit_to_evaluations(g1_t *out, const fr_t *evals, uint64_t n, const KZGSettings *ks) {
+    STAT_SCOPE(COMMIT_TO_EVALUATIONS);
+    poly p = {(fr_t *)evals, n};
+
+    CHECK(ks->secret_lagrange != NULL);
+    CHECK(n == ks->lagrange_length);
+
+    return commit_with_basis(out, &p, ks->secret_lagrange, ks);
+}
+
+/**
+ * Implementation of #update_commitment and #update_commitment_evaluations.
+ *
+ * @param[out] out        The updated commitment
+ * @param[in]  commitment The commitment before the changes
+ * @param[in]  indices    The indices of the changes, each less than @p basis_len
+ * @param[in]  old_coeffs The values at @p indices before the changes
+ * @param[in]  new_coeffs The values at @p indices after the changes
+ * @param[in]  len        The number of changes
+ * @param[in]  basis      The Lagrange-form secrets for changes to evaluations, or NULL for changes to coefficients
+ * @param[in]  basis_len  The number of secrets in the basis
+ * @param[in]  ks         The settings containing the secrets
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET update_with_basis(g1_t *out, const g1_t *commitment, const uint64_t *indices,
+                                   const fr_t *old_coeffs, const fr_t *new_coeffs, uint64_t len,
+                                   const g1_affine_t *basis, uint64_t basis_len, const KZGSettings *ks) {
+    fr_t *deltas;
+    g1_affine_t *points = NULL;
+    scalar_t *scalars;
+    byte *scratch;
+    g1_t sum;
+
+    for (uint64_t i = 0; i < len; i++) {
+        CHECK(indices[i] < basis_len);
+    }
+    if (len == 0) {
+        *out = *commitment;
+        return C_KZG_OK;
+    }
+
+    TRY(new_fr_array(&deltas, len));
+    TRY(new_scalar_array(&scalars, len));
+    TRY(new_byte_array(&scratch, msm_scratch_sizeof(len)));
+    for (uint64_t i = 0; i < len; i++) {
+        fr_sub(&deltas[i], &new_coeffs[i], &old_coeffs[i]);
+    }
+
+    if (basis == NULL && ks->secret_g1_table != NULL) {
+        sum = *commitment;
+        for (uint64_t i = 0; i < len; i++) {
+            const g1_affine_t *table = ks->secret_g1_table + g1_fixed_base_table_length(ks->wbits, indices[i]);
+            g1_t term;
+            g1_fixed_base_linear_combination(&term, table, ks->wbits, &deltas[i], 1, scalars, scratch);
+            g1_add_or_dbl(&sum, &sum, &term);
+        }
+    } else {
+        TRY(new_g1_affine_array(&points, len));
+        if (basis != NULL || ks->secret_g1_affine != NULL) {
+            const g1_affine_t *secrets = basis != NULL ? basis : ks->secret_g1_affine;
+            for (uint64_t i = 0; i < len; i++) {
+                points[i] = secrets[indices[i]];
+            }
+        } else {
+            for (uint64_t i = 0; i < len; i++) {
+                g1_array_to_affine(&points[i], &ks->secret_g1[indices[i]], 1);
+            }
+        }
+        g1_affine_linear_combination(&sum, points, deltas, len, scalars, scratch);
+        g1_add_or_dbl(&sum, &sum, commitment);
+    }
+    *out = sum;
+
+    c_kzg_free(deltas);
+    c_kzg_free(points);
+    c_kzg_free(scalars);
+    c_kzg_free(scratch);
+
     return C_KZG_OK;
 }
 
+/**
+ * Update a KZG commitment for a change to some of the coefficients of the polynomial.
+ *
+ * The commitment is linear in the coefficients, so the new commitment is the old one plus the commitment to the
+ * differences, which needs a multi-scalar multiplication over only the changed coefficients. With fixed-base tables
+ * from #kzg_settings_precompute, each changed coefficient is instead a single lookup-based multiplication.
+ *
+ * @remark Indices may be repeated, in which case each of their changes is applied in turn.
+ *
+ * @param[out] out        The commitment to the updated polynomial, which may be the same as @p commitment
+ * @param[in]  commitment The commitment to the polynomial before the changes
+ * @param[in]  indices    The indices of the changed coefficients, length @p len, each less than `ks->length`
+ * @param[in]  old_coeffs The coefficients at @p indices before the changes, length @p len
+ * @param[in]  new_coeffs The coefficients at @p indices after the changes, length @p len
+ * @param[in]  len        The number of changed coefficients
+ * @param[in]  ks         The settings containing the secrets, previously initialised with #new_kzg_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET update_commitment(g1_t *out, const g1_t *commitment, const uint64_t *indices, const fr_t *old_coeffs,
+                            const fr_t *new_coeffs, uint64_t len, const KZGSettings *ks) {
+    return update_with_basis(out, commitment, indices, old_coeffs, new_coeffs, len, NULL, ks->length, ks);
+}
+
+/**
+ * Update a KZG commitment for a change to some of the evaluations of the polynomial.
+ *
+ * As #update_commitment, but for a commitment made by #commit_to_evaluations, and changes to its evaluations.
+ *
+ * @param[out] out        The commitment to the updated polynomial, which may be the same as @p commitment
+ * @param[in]  commitment The commitment to the polynomial before the changes
+ * @param[in]  indices    The indices of the changed evaluations, length @p len, each less than `ks->lagrange_length`
+ * @param[in]  old_evals  The evaluations at @p indices before the changes, length @p len
+ * @param[in]  new_evals  The evaluations at @p indices after the changes, length @p len
+ * @param[in]  len        The number of changed evaluations
+ * @param[in]  ks         Settings with Lagrange-form secrets, see #kzg_settings_lagrange
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET update_commitment_evaluations(g1_t *out, const g1_t *commitment, const uint64_t *indices,
+                                        const fr_t *old_evals, const fr_t *new_evals, uint64_t len,
+                                        const KZGSettings *ks) {
+    CHECK(ks->secret_lagrange != NULL);
+    return update_with_basis(out, commitment, indices, old_evals, new_evals, len, ks->secret_lagrange,
+                             ks->lagrange_length, ks);
+}
+
+/**
+ * Get space for the quotient in a single-point proof, from the workspace if there is one big enough.
+ *
+ * @param[out] out The space, to be released with #release_quotient_space
+ * @param[in]  n   The number of field elements needed
+ * @param[in]  ks  The settings, with or without a workspace
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET get_quotient_space(fr_t **out, uint64_t n, const KZGSettings *ks) {
+    if (ks->workspace != NULL && ks->workspace->quotient != NULL && 2 * ks->workspace->length >= n) {
+        *out = ks->workspace->quotient;
+        return C_KZG_OK;
+    }
+    return new_fr_array(out, n);
+}
+
+/**
+ * Release the space given by #get_quotient_space.
+ *
+ * @param[in] q  The space
+ * @param[in] ks The settings it was got for
+ */
+static void release_quotient_space(fr_t *q, const KZGSettings *ks) {
+    if (ks->workspace == NULL || q != ks->workspace->quotient) c_kzg_free(q);
+}
+
 /**
  * Compute KZG proof for polynomial at position x0.
  *
+ * The quotient `(p(x) - p(x0)) / (x - x0)` is found by synthetic division in a single pass over the coefficients.
+ * With a workspace attached to the settings, nothing is allocated.
+ *
  * @param[out] out The proof, in the form of a G1 point
  * @param[in]  p   The polynomial
  * @param[in]  x0  The x-value the polynomial is to be proved at
@@ -55,7 +396,213 @@ C_KZG_RET commit_to_poly(g1_t *out, const poly *p, const KZGSettings *ks) {
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET compute_proof_single(g1_t *out, const poly *p, const fr_t *x0, const KZGSettings *ks) {
-    return compute_proof_multi(out, p, x0, 1, ks);
+    STAT_SCOPE(COMPUTE_PROOF_SINGLE);
+    C_KZG_RET ret;
+    poly q;
+
+    if (p->length <= 1) {
+        *out = g1_identity;
+        return C_KZG_OK;
+    }
+
+    // q_(i-1) = p_i + x0 * q_i, from the top down
+    q.length = p->length - 1;
+    TRY(get_quotient_space(&q.coeffs, q.length, ks));
+    q.coeffs[q.length - 1] = p->coeffs[p->length - 1];
+    for (uint64_t i = q.length - 1; i > 0; i--) {
+        fr_mul(&q.coeffs[i - 1], &q.coeffs[i], x0);
+        fr_add(&q.coeffs[i - 1], &q.coeffs[i - 1], &p->coeffs[i]);
+    }
+
+    ret = commit_to_poly(out, &q, ks);
+    release_quotient_space(q.coeffs, ks);
+
+    return ret;
+}
+
+/**
+ * The shared state for computing proofs of one polynomial at many points in parallel.
+ */
+typedef struct {
+    g1_t *out;                 /**< The proofs */
+    const poly *p;             /**< The polynomial */
+    const fr_t *xs;            /**< The points */
+    uint64_t k;                /**< The number of points */
+    uint64_t per_task;         /**< The number of points handled by each task (the last may have fewer) */
+    const KZGSettings *ks;     /**< The settings containing the secrets */
+    const g1_affine_t *points; /**< The secrets in affine form, or NULL if using the fixed-base tables */
+    fr_t *quotients;           /**< Space for one quotient per task */
+    scalar_t *scalars;         /**< Space for the scalars of one multi-scalar multiplication per task */
+    byte *scratch;             /**< Scratch space for one multi-scalar multiplication per task */
+    size_t scratch_len;        /**< The size of the scratch space for each task */
+} proofs_job;
+
+/**
+ * Compute the proofs at range @p t of the points, as one task of #compute_proofs_at_points.
+ *
+ * @param[in,out] arg The #proofs_job
+ * @param[in]     t   The index of the task
+ */
+static void proofs_task(void *arg, uint64_t t) {
+    const proofs_job *job = arg;
+    const KZGSettings *ks = job->ks;
+    uint64_t len = job->p->length - 1, end = min_u64(job->k, (t + 1) * job->per_task);
+    const fr_t *c = job->p->coeffs;
+    fr_t *q = job->quotients + t * len;
+    scalar_t *scalars = job->scalars + t * len;
+    byte *scratch = job->scratch + t * job->scratch_len;
+
+    for (uint64_t j = t * job->per_task; j < end; j++) {
+        q[len - 1] = c[len];
+        for (uint64_t i = len - 1; i > 0; i--) {
+            fr_mul(&q[i - 1], &q[i], &job->xs[j]);
+            fr_add(&q[i - 1], &q[i - 1], &c[i]);
+        }
+        if (job->points != NULL) {
+            g1_affine_linear_combination(&job->out[j], job->points, q, len, scalars, scratch);
+        } else {
+            g1_fixed_base_linear_combination(&job->out[j], ks->secret_g1_table, ks->wbits, q, len, scalars, scratch);
+        }
+    }
+}
+
+/**
+ * Compute KZG proofs for a polynomial at each of many points.
+ *
+ * This gives the same proofs as calling #compute_proof_single for each point, but the secrets are converted to affine
+ * form once for all of them, the buffers are allocated once, and the proofs are shared out across the thread pool in
+ * @p ks, if there is one.
+ *
+ * @param[out] out The proofs, an array of @p k G1 points
+ * @param[in]  p   The polynomial
+ * @param[in]  xs  The x-values the polynomial is to be proved at, an array of length @p k
+ * @param[in]  k   The number of points
+ * @param[in]  ks  The settings containing the secrets, previously initialised with #new_kzg_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET compute_proofs_at_points(g1_t *out, const poly *p, const fr_t *xs, uint64_t k, const KZGSettings *ks) {
+    STAT_SCOPE(COMPUTE_PROOFS_AT_POINTS);
+    g1_affine_t *affine = NULL;
+    proofs_job job;
+    uint64_t len, tasks;
+
+    if (p->length <= 1) {
+        for (uint64_t j = 0; j < k; j++) {
+            out[j] = g1_identity;
+        }
+        return C_KZG_OK;
+    }
+    len = p->length - 1;
+    CHECK(len <= ks->length);
+    if (k == 0) return C_KZG_OK;
+
+    tasks = min_u64(pool_threads(ks->pool), k);
+    job.out = out;
+    job.p = p;
+    job.xs = xs;
+    job.k = k;
+    job.per_task = (k + tasks - 1) / tasks;
+    job.ks = ks;
+    job.points = ks->secret_g1_affine;
+    job.scratch_len = msm_scratch_sizeof(len);
+    if (ks->secret_g1_table != NULL) {
+        job.points = NULL;
+    } else if (ks->secret_g1_affine == NULL) {
+        TRY(new_g1_affine_array(&affine, len));
+        g1_array_to_affine(affine, ks->secret_g1, len);
+        job.points = affine;
+    }
+    TRY(new_fr_array(&job.quotients, tasks * len));
+    TRY(new_scalar_array(&job.scalars, tasks * len));
+    TRY(new_byte_array(&job.scratch, tasks * job.scratch_len));
+
+    pool_run(ks->pool, proofs_task, &job, tasks);
+
+    c_kzg_free(affine);
+    c_kzg_free(job.quotients);
+    c_kzg_free(job.scalars);
+    c_kzg_free(job.scratch);
+
+    return C_KZG_OK;
+}
+
+/**
+ * Compute a KZG proof for a polynomial given by its evaluations, at position @p x0.
+ *
+ * The quotient `q(x) = (p(x) - y) / (x - x0)` is found in evaluation form and committed to with the Lagrange-form
+ * secrets, so no FFT is needed. Where @p x0 is one of the roots of unity `w^m`, the value of `q` at `w^m` is the
+ * derivative `p'(w^m)`, found as `sum_{i != m} (p(w^i) - y) w^(i - m) / (w^m - w^i)`. With a workspace attached to
+ * the settings, nothing is allocated.
+ *
+ * @param[out] out   The proof, in the form of a G1 point
+ * @param[out] y     The value of the polynomial at @p x0
+ * @param[in]  evals The values of the polynomial at the powers of the primitive `n`-th root of unity, in order, where
+ *                   `n` is `ks->lagrange_length`
+ * @param[in]  x0    The x-value the polynomial is to be proved at
+ * @param[in]  ks    Settings with Lagrange-form secrets, see #kzg_settings_lagrange
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET compute_proof_single_eval(g1_t *out, fr_t *y, const fr_t *evals, const fr_t *x0, const KZGSettings *ks) {
+    STAT_SCOPE(COMPUTE_PROOF_SINGLE_EVAL);
+    uint64_t n = ks->lagrange_length, stride, m;
+    const fr_t *roots;
+    fr_t *q, *inv_d, tmp;
+    C_KZG_RET ret;
+
+    CHECK(ks->secret_lagrange != NULL);
+    TRY(fft_roots(&roots, &stride, n, ks->fs));
+
+    for (m = 0; m < n && !fr_equal(&roots[m * stride], x0); m++)
+        ;
+
+    TRY(get_quotient_space(&q, 2 * n, ks));
+    inv_d = q + n;
+    for (uint64_t i = 0; i < n; i++) {
+        fr_sub(&q[i], &roots[i * stride], x0);
+    }
+    fr_batch_inv(inv_d, q, n);
+
+    if (m < n) {
+        *y = evals[m];
+    } else {
+        // Barycentric evaluation: p(x0) = (x0^n - 1) / n * sum_i p(w^i) w^i / (x0 - w^i)
+        fr_t sum = fr_zero, scale;
+        for (uint64_t i = 0; i < n; i++) {
+            fr_mul(&tmp, &evals[i], &roots[i * stride]);
+            fr_mul(&tmp, &tmp, &inv_d[i]);
+            fr_sub(&sum, &sum, &tmp);
+        }
+        fr_pow(&scale, x0, n);
+        fr_sub(&scale, &scale, &fr_one);
+        fr_mul(&sum, &sum, &scale);
+        fr_from_uint64(&scale, n);
+        fr_inv(&scale, &scale);
+        fr_mul(y, &sum, &scale);
+    }
+
+    // q(w^i) = (p(w^i) - y) / (w^i - x0), where the batch inversion leaves the zero at i = m alone
+    for (uint64_t i = 0; i < n; i++) {
+        fr_sub(&tmp, &evals[i], y);
+        fr_mul(&q[i], &tmp, &inv_d[i]);
+    }
+    if (m < n) {
+        q[m] = fr_zero;
+        for (uint64_t i = 0; i < n; i++) {
+            if (i == m) continue;
+            fr_mul(&tmp, &q[i], &roots[((i + n - m) % n) * stride]);
+            fr_sub(&q[m], &q[m], &tmp);
+        }
+    }
+
+    ret = commit_to_evaluations(out, q, n, ks);
+    release_quotient_space(q, ks);
+
+    return ret;
 }
 
 /**
@@ -73,6 +620,7 @@ C_KZG_RET compute_proof_single(g1_t *out, const poly *p, const fr_t *x0, const K
  */
 C_KZG_RET check_proof_single(bool *out, const g1_t *commitment, const g1_t *proof, const fr_t *x, fr_t *y,
                              const KZGSettings *ks) {
+    STAT_SCOPE(CHECK_PROOF_SINGLE);
     g2_t x_g2, s_minus_x;
     g1_t y_g1, commitment_minus_y;
     g2_mul(&x_g2, &g2_generator, x);
@@ -85,6 +633,162 @@ C_KZG_RET check_proof_single(bool *out, const g1_t *commitment, const g1_t *proo
     return C_KZG_OK;
 }
 
+/**
+ * Serialise a field element as 32 little-endian bytes.
+ *
+ * @param[out] out The serialised field element
+ * @param[in]  a   The field element
+ */
+static void fr_to_bytes(byte out[32], const fr_t *a) {
+    uint64_t limbs[4];
+    fr_to_uint64s(limbs, a);
+    for (int i = 0; i < 32; i++) {
+        out[i] = limbs[i / 8] >> (8 * (i % 8));
+    }
+}
+
+/**
+ * Derive the random challenges used to combine the openings in #check_proof_single_batch.
+ *
+ * The challenges are a hash of all the inputs (the Fiat-Shamir heuristic), so they cannot be predicted by whoever made
+ * the proofs. They are 128 bits each, which bounds the chance of an invalid batch passing at 2^-128.
+ *
+ * @param[out] r           The challenges, array length @p n
+ * @param[in]  commitments The commitments, array length @p n
+ * @param[in]  proofs      The proofs, array length @p n
+ * @param[in]  xs          The points at which the proofs are opened, array length @p n
+ * @param[in]  ys          The claimed values, array length @p n
+ * @param[in]  n           The number of openings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET batch_challenges(fr_t *r, const g1_t *commitments, const g1_t *proofs, const fr_t *xs,
+                                  const fr_t *ys, uint64_t n) {
+    const size_t item_len = 48 + 48 + 32 + 32;
+    byte *transcript, seed[32 + 8], digest[32];
+
+    TRY(new_byte_array(&transcript, n * item_len));
+    for (uint64_t i = 0; i < n; i++) {
+        byte *item = transcript + i * item_len;
+        g1_compress(item, &commitments[i]);
+        g1_compress(item + 48, &proofs[i]);
+        fr_to_bytes(item + 96, &xs[i]);
+        fr_to_bytes(item + 128, &ys[i]);
+    }
+    hash_sha256(seed, transcript, n * item_len);
+    c_kzg_free(transcript);
+
+    // r_i is the low 128 bits of H(seed || i)
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t limbs[4] = {0, 0, 0, 0};
+        for (int j = 0; j < 8; j++) {
+            seed[32 + j] = i >> (8 * j);
+        }
+        hash_sha256(digest, seed, sizeof seed);
+        for (int j = 0; j < 16; j++) {
+            limbs[j / 8] |= (uint64_t)digest[j] << (8 * (j % 8));
+        }
+        fr_from_uint64s(&r[i], limbs);
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Compute a linear combination of G1 points using the buffers in a workspace.
+ *
+ * @param[out] out    The resulting sum-product
+ * @param[in]  p      Array of G1 group elements, length @p len
+ * @param[in]  coeffs Array of field elements, length @p len
+ * @param[in]  len    The number of group/field elements, no more than `ws->length`
+ * @param      ws     A workspace with a single part
+ */
+static void workspace_linear_combination(g1_t *out, const g1_t *p, const fr_t *coeffs, uint64_t len,
+                                         MSMWorkspace *ws) {
+    g1_array_to_affine(ws->points, p, len);
+    g1_affine_linear_combination(out, ws->points, coeffs, len, ws->scalars, ws->scratch);
+}
+
+/**
+ * Check a batch of KZG proofs, each at a single point, against their commitments.
+ *
+ * Each opening `i` claims that the polynomial committed to by `commitments[i]` has value `ys[i]` at `xs[i]`, as shown by
+ * `proofs[i]`. The individual checks `e(C_i - [y_i], [1]) = e(pi_i, [s - x_i])` are rearranged as
+ * `e(C_i - [y_i] + [x_i]pi_i, [1]) = e(pi_i, [s])`, and combined using random challenges `r_i` into a single check,
+ *
+ *     e(sum(r_i * (C_i - [y_i] + [x_i]pi_i)), [1]) = e(sum(r_i * pi_i), [s])
+ *
+ * This costs two multi-scalar multiplications and one pairing check for the whole batch, rather than a pairing check
+ * per opening.
+ *
+ * If @p ok is not NULL then it receives the result for each opening. When the batch fails this requires checking each
+ * opening individually with #check_proof_single, so the slow path only happens when something is actually wrong.
+ *
+ * @param[out] out         `true` if all the proofs are valid, `false` if not
+ * @param[out] ok          Optional, array length @p n: `ok[i]` is `true` if and only if opening `i` is valid
+ * @param[in]  commitments The commitments to the polynomials, array length @p n
+ * @param[in]  proofs      The proofs of the value of each polynomial at its point, array length @p n
+ * @param[in]  xs          The points at which the proofs are to be checked, array length @p n
+ * @param[in]  ys          The claimed values of the polynomials at their points, array length @p n
+ * @param[in]  n           The number of openings in the batch
+ * @param[in]  ks          The settings containing the secrets, previously initialised with #new_kzg_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET check_proof_single_batch(bool *out, bool *ok, const g1_t *commitments, const g1_t *proofs, const fr_t *xs,
+                                   const fr_t *ys, uint64_t n, const KZGSettings *ks) {
+    STAT_SCOPE(CHECK_PROOF_SINGLE_BATCH);
+    MSMWorkspace ws;
+    g1_t *points, lhs, rhs;
+    fr_t *r, *coeffs, ry, ry_sum = fr_zero;
+
+    if (n == 0) {
+        *out = true;
+        return C_KZG_OK;
+    }
+
+    TRY(new_fr_array(&r, n));
+    TRY(batch_challenges(r, commitments, proofs, xs, ys, n));
+
+    // The first linear combination is over [C_0, ..., C_{n-1}, pi_0, ..., pi_{n-1}, G1]
+    TRY(new_g1_array(&points, 2 * n + 1));
+    TRY(new_fr_array(&coeffs, 2 * n + 1));
+    TRY(new_msm_buffers(&ws, 2 * n + 1, 1));
+    for (uint64_t i = 0; i < n; i++) {
+        points[i] = commitments[i];
+        points[n + i] = proofs[i];
+        coeffs[i] = r[i];
+        fr_mul(&coeffs[n + i], &r[i], &xs[i]);
+        fr_mul(&ry, &r[i], &ys[i]);
+        fr_add(&ry_sum, &ry_sum, &ry);
+    }
+    points[2 * n] = g1_generator;
+    fr_negate(&coeffs[2 * n], &ry_sum);
+
+    workspace_linear_combination(&lhs, points, coeffs, 2 * n + 1, &ws);
+    workspace_linear_combination(&rhs, proofs, r, n, &ws);
+
+    *out = pairings_verify(&lhs, &g2_generator, &rhs, &ks->secret_g2[1]);
+
+    if (ok != NULL) {
+        for (uint64_t i = 0; i < n; i++) {
+            if (*out) {
+                ok[i] = true;
+            } else {
+                fr_t y = ys[i];
+                TRY(check_proof_single(&ok[i], &commitments[i], &proofs[i], &xs[i], &y, ks));
+            }
+        }
+    }
+
+    free_msm_workspace(&ws);
+    c_kzg_free(coeffs);
+    c_kzg_free(points);
+    c_kzg_free(r);
+
+    return C_KZG_OK;
+}
+
 /**
  * Compute KZG proof for polynomial at positions x0 * w^y where w is an n-th root of unity.
  *
@@ -102,6 +806,7 @@ C_KZG_RET check_proof_single(bool *out, const g1_t *commitment, const g1_t *proo
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET compute_proof_multi(g1_t *out, const poly *p, const fr_t *x0, uint64_t n, const KZGSettings *ks) {
+    STAT_SCOPE(COMPUTE_PROOF_MULTI);
     poly divisor, q;
     fr_t x_pow_n;
 
@@ -153,27 +858,21 @@ C_KZG_RET compute_proof_multi(g1_t *out, const poly *p, const fr_t *x0, uint64_t
  */
 C_KZG_RET check_proof_multi(bool *out, const g1_t *commitment, const g1_t *proof, const fr_t *x, const fr_t *ys,
                             uint64_t n, const KZGSettings *ks) {
+    STAT_SCOPE(CHECK_PROOF_MULTI);
     poly interp;
-    fr_t inv_x, inv_x_pow, x_pow;
+    fr_t x_pow;
     g2_t xn2, xn_minus_yn;
     g1_t is1, commit_minus_interp;
 
     CHECK(is_power_of_two(n));
+    CHECK(n < ks->g2_length);
 
     // Interpolate at a coset.
     TRY(new_poly(&interp, n));
-    TRY(fft_fr(interp.coeffs, ys, true, n, ks->fs));
-
-    // Because it is a coset, not the subgroup, we have to multiply the polynomial coefficients by x^-i
-    fr_inv(&inv_x, x);
-    inv_x_pow = inv_x;
-    for (uint64_t i = 1; i < n; i++) {
-        fr_mul(&interp.coeffs[i], &interp.coeffs[i], &inv_x_pow);
-        fr_mul(&inv_x_pow, &inv_x_pow, &inv_x);
-    }
+    TRY(fft_fr_coset(interp.coeffs, ys, true, x, n, ks->fs));
 
     // [x^n]_2
-    fr_inv(&x_pow, &inv_x_pow);
+    fr_pow(&x_pow, x, n);
     g2_mul(&xn2, &g2_generator, &x_pow);
 
     // [s^n - x^n]_2
@@ -213,6 +912,7 @@ C_KZG_RET new_kzg_settings(KZGSettings *ks, const g1_t *secret_g1, const g2_t *s
 
     CHECK(length >= fs->max_width);
     ks->length = length;
+    ks->g2_length = length;
 
     // Allocate space for the secrets
     TRY(new_g1_array(&ks->secret_g1, ks->length));
@@ -224,19 +924,240 @@ C_KZG_RET new_kzg_settings(KZGSettings *ks, const g1_t *secret_g1, const g2_t *s
         ks->secret_g2[i] = secret_g2[i];
     }
     ks->fs = fs;
+    ks->secret_g1_affine = NULL;
+    ks->secret_g1_table = NULL;
+    ks->wbits = 0;
+    ks->secret_lagrange = NULL;
+    ks->lagrange_length = 0;
+    ks->pool = NULL;
+    ks->workspace = NULL;
+    ks->mapping = NULL;
+    ks->mapping_len = 0;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Precompute fixed-base tables for the G1 secrets to speed up commitments.
+ *
+ * Since every commitment is a linear combination over the same `secret_g1` points, we can build window tables for them
+ * once and reuse them for every subsequent call to #commit_to_poly (and hence for computing and checking proofs).
+ *
+ * The tables take `length * 2^(wbits - 1)` affine points of memory. Larger windows give faster commitments at the
+ * cost of exponentially more memory: around 8 is a reasonable choice for a few thousand points.
+ *
+ * @remark This may be called more than once; any existing tables are replaced. The memory is reclaimed by
+ * #free_kzg_settings.
+ *
+ * @param[in,out] ks    Settings previously initialised with #new_kzg_settings
+ * @param[in]     wbits The window size in bits, between 1 and 16
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET kzg_settings_precompute(KZGSettings *ks, unsigned int wbits) {
+    g1_affine_t *secret_g1_affine, *table;
+
+    CHECK(wbits >= 1 && wbits <= 16);
+    CHECK(ks->length > 0);
+
+    TRY(new_g1_affine_array(&table, g1_fixed_base_table_length(wbits, ks->length)));
+
+    if (ks->secret_g1_affine != NULL) {
+        g1_fixed_base_precompute(table, wbits, ks->secret_g1_affine, ks->length);
+    } else {
+        TRY(new_g1_affine_array(&secret_g1_affine, ks->length));
+        g1_array_to_affine(secret_g1_affine, ks->secret_g1, ks->length);
+        g1_fixed_base_precompute(table, wbits, secret_g1_affine, ks->length);
+        c_kzg_free(secret_g1_affine);
+    }
+
+    c_kzg_free(ks->secret_g1_table);
+    ks->secret_g1_table = table;
+    ks->wbits = wbits;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Store the G1 secrets in affine form, replacing the projective ones.
+ *
+ * Affine points take two thirds of the memory, and are what the multi-scalar multiplication in #commit_to_poly
+ * consumes, so converting once here saves converting the secrets on every commitment. Use #kzg_settings_secret_g1
+ * to read individual secrets from settings that may have been converted.
+ *
+ * @remark After this, `ks->secret_g1` is NULL and `ks->secret_g1_affine` holds the secrets. Settings that are
+ * already affine are left as they are. The memory is reclaimed by #free_kzg_settings.
+ *
+ * @param[in,out] ks Settings previously initialised with #new_kzg_settings or #load_trusted_setup
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The settings are mapped from a file by #load_kzg_settings
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET kzg_settings_to_affine(KZGSettings *ks) {
+    if (ks->secret_g1_affine != NULL) return C_KZG_OK;
+
+    CHECK(ks->mapping == NULL);
+    CHECK(ks->length > 0);
+
+    TRY(new_g1_affine_array(&ks->secret_g1_affine, ks->length));
+    g1_array_to_affine(ks->secret_g1_affine, ks->secret_g1, ks->length);
+    c_kzg_free(ks->secret_g1);
+    ks->secret_g1 = NULL;
 
     return C_KZG_OK;
 }
 
 /**
- * Free the memory that was previously allocated by #new_kzg_settings.
+ * Whether the Lagrange-form secrets are part of a file mapped by #load_kzg_settings, rather than allocated.
+ *
+ * @param[in] ks The settings
+ * @return True if the secrets must not be freed
+ */
+static bool lagrange_is_mapped(const KZGSettings *ks) {
+    const byte *p = (const byte *)ks->secret_lagrange;
+    return ks->mapping != NULL && p >= (const byte *)ks->mapping && p < (const byte *)ks->mapping + ks->mapping_len;
+}
+
+/**
+ * Compute the G1 secrets in Lagrange form, for commitments and proofs made directly from evaluations.
+ *
+ * These are the commitments to the Lagrange polynomials `L_i` of the roots of unity of order @p n, which are the
+ * inverse FFT of the first @p n secrets. They enable #commit_to_evaluations, #update_commitment_evaluations and
+ * #compute_proof_single_eval for polynomials given by their values at those roots.
+ *
+ * @remark This may be called more than once; any existing Lagrange-form secrets are replaced, or kept if this fails.
+ * The memory is reclaimed by #free_kzg_settings. The secrets can be saved with the rest of the settings by
+ * #save_kzg_settings.
+ *
+ * @param[in,out] ks Settings previously initialised with #new_kzg_settings or #load_trusted_setup
+ * @param[in]     n  The number of evaluations, a power of two no larger than `ks->length` or `ks->fs->max_width`
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET kzg_settings_lagrange(KZGSettings *ks, uint64_t n) {
+    g1_t *monomial = NULL, *lagrange = NULL;
+    g1_affine_t *affine = NULL;
+    C_KZG_RET ret;
+
+    CHECK(n > 0 && is_power_of_two(n));
+    CHECK(n <= ks->length);
+    CHECK(n <= ks->fs->max_width);
+
+    // Any existing secrets are kept until the new ones are complete
+    ret = new_g1_array(&monomial, n);
+    if (ret == C_KZG_OK) ret = new_g1_array(&lagrange, n);
+    if (ret == C_KZG_OK) ret = new_g1_affine_array(&affine, n);
+    if (ret == C_KZG_OK) {
+        for (uint64_t i = 0; i < n; i++) {
+            kzg_settings_secret_g1(&monomial[i], ks, i);
+        }
+        ret = fft_g1(lagrange, monomial, true, n, ks->fs);
+    }
+
+    if (ret == C_KZG_OK) {
+        g1_array_to_affine(affine, lagrange, n);
+        if (!lagrange_is_mapped(ks)) c_kzg_free(ks->secret_lagrange);
+        ks->secret_lagrange = affine;
+        ks->lagrange_length = n;
+    } else {
+        c_kzg_free(affine);
+    }
+
+    c_kzg_free(monomial);
+    c_kzg_free(lagrange);
+
+    return ret;
+}
+
+/**
+ * Retrieve one of the G1 secrets, whichever form the settings store them in.
+ *
+ * @param[out] out The G1 secret at index @p i
+ * @param[in]  ks  The settings containing the secrets
+ * @param[in]  i   The index of the secret, less than `ks->length`
+ */
+void kzg_settings_secret_g1(g1_t *out, const KZGSettings *ks, uint64_t i) {
+    if (ks->secret_g1_affine != NULL) {
+        g1_from_affine(out, &ks->secret_g1_affine[i]);
+    } else {
+        *out = ks->secret_g1[i];
+    }
+}
+
+/**
+ * Free the memory that was previously allocated by #new_kzg_settings, #load_trusted_setup or #load_kzg_settings.
  *
  * @param ks The settings to be freed
  */
 void free_kzg_settings(KZGSettings *ks) {
-    free(ks->secret_g1);
-    free(ks->secret_g2);
+    if (!lagrange_is_mapped(ks)) c_kzg_free(ks->secret_lagrange);
+    if (ks->mapping != NULL) {
+        munmap(ks->mapping, ks->mapping_len);
+        ks->mapping = NULL;
+        ks->mapping_len = 0;
+    } else {
+        c_kzg_free(ks->secret_g1);
+        c_kzg_free(ks->secret_g1_affine);
+        c_kzg_free(ks->secret_g2);
+    }
+    ks->secret_g1 = NULL;
+    ks->secret_g1_affine = NULL;
+    c_kzg_free(ks->secret_g1_table);
+    ks->secret_g1_table = NULL;
+    ks->wbits = 0;
+    ks->secret_lagrange = NULL;
+    ks->lagrange_length = 0;
     ks->length = 0;
+    ks->g2_length = 0;
+}
+
+/**
+ * Initialise a workspace for computing commitments without allocating memory.
+ *
+ * A workspace sized for `ks->length` points can be attached to a #KZGSettings structure `ks` by setting
+ * `ks->workspace`, after which commitments allocate nothing for the multi-scalar multiplication, and single-point
+ * proofs allocate nothing at all.
+ *
+ * @remark A workspace holds the intermediate state of a single computation, so settings with an attached workspace
+ * must not be used for more than one commitment at a time. When committing in parallel via a thread pool, @p parts
+ * should be at least the number of threads in the pool; any excess threads are left idle.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_msm_workspace.
+ *
+ * @param[out] ws     The new workspace
+ * @param[in]  length The maximum number of points in a linear combination using the workspace
+ * @param[in]  parts  The maximum number of parts that a linear combination will be split into, at least one
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_msm_workspace(MSMWorkspace *ws, uint64_t length, unsigned int parts) {
+    CHECK(parts >= 1);
+
+    TRY(new_msm_buffers(ws, length, parts));
+    TRY(new_fr_array(&ws->quotient, 2 * length));
+
+    return C_KZG_OK;
+}
+
+/**
+ * Free the memory that was previously allocated by #new_msm_workspace.
+ *
+ * @param ws The workspace to be freed
+ */
+void free_msm_workspace(MSMWorkspace *ws) {
+    c_kzg_free(ws->points);
+    c_kzg_free(ws->scalars);
+    c_kzg_free(ws->partials);
+    c_kzg_free(ws->scratch);
+    c_kzg_free(ws->quotient);
+    ws->length = 0;
+    ws->parts = 0;
+    ws->scratch_len = 0;
 }
 
 #ifdef KZGTEST
@@ -291,6 +1212,188 @@ void proof_single(void) {
     free_poly(&p);
 }
 
+void proof_single_without_allocation(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    MSMWorkspace ws;
+    Arena arena;
+    uint64_t secrets_len = 33, lens[] = {0, 1, 2, 17, 33};
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected, actual;
+    fr_t evals[32], x, y;
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 5));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == kzg_settings_lagrange(&ks, 32));
+    TEST_CHECK(C_KZG_OK == new_msm_workspace(&ws, ks.length, 1));
+    TEST_CHECK(C_KZG_OK == new_arena(&arena, 64));
+    TEST_CHECK(C_KZG_OK == new_poly(&p, secrets_len));
+    x = rand_fr();
+
+    // Synthetic division agrees with long division, and allocates nothing given a workspace
+    for (int i = 0; i < sizeof lens / sizeof lens[0]; i++) {
+        p.length = lens[i];
+        for (int j = 0; j < p.length; j++) {
+            p.coeffs[j] = rand_fr();
+        }
+        TEST_CHECK(C_KZG_OK == compute_proof_multi(&expected, &p, &x, 1, &ks));
+        TEST_CHECK(C_KZG_OK == compute_proof_single(&actual, &p, &x, &ks));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        TEST_MSG("Mismatch for length %d", (int)lens[i]);
+
+        ks.workspace = &ws;
+        arena_begin(&arena);
+        TEST_CHECK(C_KZG_OK == compute_proof_single(&actual, &p, &x, &ks));
+        arena_end(&arena);
+        ks.workspace = NULL;
+        TEST_CHECK(g1_equal(&expected, &actual));
+        TEST_CHECK(0 == arena.peak && 0 == arena.overflows);
+    }
+
+    // Likewise the proof from evaluations
+    for (int i = 0; i < 32; i++) {
+        evals[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == compute_proof_single_eval(&expected, &y, evals, &x, &ks));
+    ks.workspace = &ws;
+    arena_begin(&arena);
+    TEST_CHECK(C_KZG_OK == compute_proof_single_eval(&actual, &y, evals, &x, &ks));
+    arena_end(&arena);
+    TEST_CHECK(g1_equal(&expected, &actual));
+    TEST_CHECK(0 == arena.peak && 0 == arena.overflows);
+
+    free_poly(&p);
+    free_arena(&arena);
+    ks.workspace = NULL;
+    free_msm_workspace(&ws);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
+void proofs_at_points_works(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    ThreadPool pool;
+    uint64_t secrets_len = 129, k = 11;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected[k], actual[k];
+    fr_t xs[k];
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 7));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+    TEST_CHECK(C_KZG_OK == new_poly(&p, secrets_len));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    for (int j = 0; j < k; j++) {
+        xs[j] = rand_fr();
+    }
+
+    // With projective secrets, affine secrets, and fixed-base tables, serially and in parallel
+    for (int form = 0; form < 3; form++) {
+        TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+        if (form == 1) TEST_CHECK(C_KZG_OK == kzg_settings_to_affine(&ks));
+        if (form == 2) TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 4));
+        for (int j = 0; j < k; j++) {
+            TEST_CHECK(C_KZG_OK == compute_proof_single(&expected[j], &p, &xs[j], &ks));
+        }
+        for (int threaded = 0; threaded < 2; threaded++) {
+            ks.pool = threaded ? &pool : NULL;
+            TEST_CHECK(C_KZG_OK == compute_proofs_at_points(actual, &p, xs, k, &ks));
+            for (int j = 0; j < k; j++) {
+                TEST_CHECK(g1_equal(&expected[j], &actual[j]));
+                TEST_MSG("Mismatch at point %d with secrets in form %d, threaded %d", j, form, threaded);
+            }
+        }
+        free_kzg_settings(&ks);
+    }
+
+    // Constant and short polynomials
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    for (p.length = 1; p.length < 4; p.length++) {
+        for (int j = 0; j < k; j++) {
+            TEST_CHECK(C_KZG_OK == compute_proof_single(&expected[j], &p, &xs[j], &ks));
+        }
+        TEST_CHECK(C_KZG_OK == compute_proofs_at_points(actual, &p, xs, k, &ks));
+        for (int j = 0; j < k; j++) {
+            TEST_CHECK(g1_equal(&expected[j], &actual[j]));
+        }
+    }
+
+#ifndef DEBUG
+    p.length = secrets_len + 2;
+    TEST_CHECK(C_KZG_BADARGS == compute_proofs_at_points(actual, &p, xs, k, &ks));
+#endif
+
+    p.length = secrets_len;
+    free_poly(&p);
+    free_kzg_settings(&ks);
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+}
+
+void proof_single_batch(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    uint64_t secrets_len = 17, n = 10;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t commitments[n], proofs[n];
+    fr_t xs[n], ys[n];
+    bool ok[n], result;
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 4));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+
+    // A different random polynomial and point for each opening
+    TEST_CHECK(C_KZG_OK == new_poly(&p, 16));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < p.length; j++) {
+            p.coeffs[j] = rand_fr();
+        }
+        xs[i] = rand_fr();
+        eval_poly(&ys[i], &p, &xs[i]);
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&commitments[i], &p, &ks));
+        TEST_CHECK(C_KZG_OK == compute_proof_single(&proofs[i], &p, &xs[i], &ks));
+    }
+
+    TEST_CHECK(C_KZG_OK == check_proof_single_batch(&result, ok, commitments, proofs, xs, ys, n, &ks));
+    TEST_CHECK(true == result);
+    for (int i = 0; i < n; i++) {
+        TEST_CHECK(true == ok[i]);
+    }
+
+    // The result array is optional
+    TEST_CHECK(C_KZG_OK == check_proof_single_batch(&result, NULL, commitments, proofs, xs, ys, n, &ks));
+    TEST_CHECK(true == result);
+
+    // An empty batch is valid
+    TEST_CHECK(C_KZG_OK == check_proof_single_batch(&result, NULL, commitments, proofs, xs, ys, 0, &ks));
+    TEST_CHECK(true == result);
+
+    // Break two of the openings and check that exactly those are reported
+    fr_add(&ys[3], &ys[3], &fr_one);
+    proofs[7] = proofs[6];
+    TEST_CHECK(C_KZG_OK == check_proof_single_batch(&result, ok, commitments, proofs, xs, ys, n, &ks));
+    TEST_CHECK(false == result);
+    for (int i = 0; i < n; i++) {
+        TEST_CHECK((i != 3 && i != 7) == ok[i]);
+        TEST_MSG("Wrong result for opening %d", i);
+    }
+
+    free_poly(&p);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
 void proof_multi(void) {
     // Our polynomial: degree 15, 16 coefficients
     uint64_t coeffs[] = {1, 2, 3, 4, 7, 7, 7, 7, 13, 13, 13, 13, 13, 13, 13, 13};
@@ -397,12 +1500,359 @@ void commit_to_too_long_poly(void) {
     free_kzg_settings(&ks);
 }
 
+void commit_with_precompute(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    uint64_t secrets_len = 257;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected, actual, proof;
+    fr_t x, y;
+    poly p;
+    bool result;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 8));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, 200));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    // Commit without, and then with, the fixed-base tables
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+    TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 5));
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+    TEST_CHECK(g1_equal(&expected, &actual));
+
+    // Proofs made and checked with the tables still work
+    fr_from_uint64(&x, 1234);
+    eval_poly(&y, &p, &x);
+    TEST_CHECK(C_KZG_OK == compute_proof_single(&proof, &p, &x, &ks));
+    TEST_CHECK(C_KZG_OK == check_proof_single(&result, &actual, &proof, &x, &y, &ks));
+    TEST_CHECK(true == result);
+
+#ifndef DEBUG
+    TEST_CHECK(C_KZG_BADARGS == kzg_settings_precompute(&ks, 0));
+#endif
+
+    free_poly(&p);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
+void commit_with_thread_pool(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    ThreadPool pool;
+    uint64_t secrets_len = 1025;
+    g1_t *s1 = malloc(secrets_len * sizeof(g1_t));
+    g2_t *s2 = malloc(secrets_len * sizeof(g2_t));
+    g1_t expected, actual;
+    poly p;
+
+    // Lengths that split into unequal chunks, or are too short to split at all
+    uint64_t lengths[] = {1, 255, 600, 1000, 1025};
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 10));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 4));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+
+    for (int j = 0; j < sizeof lengths / sizeof lengths[0]; j++) {
+        TEST_CHECK(C_KZG_OK == new_poly(&p, lengths[j]));
+        for (int i = 0; i < p.length; i++) {
+            p.coeffs[i] = rand_fr();
+        }
+        TEST_CHECK(C_KZG_OK == g1_linear_combination(&expected, s1, p.coeffs, p.length));
+
+        // Fixed-base path
+        ks.pool = &pool;
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        TEST_MSG("Fixed-base path failed for length %lu", lengths[j]);
+
+        // Generic path
+        free(ks.secret_g1_table);
+        ks.secret_g1_table = NULL;
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        TEST_MSG("Generic path failed for length %lu", lengths[j]);
+        TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 4));
+
+        free_poly(&p);
+    }
+
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+    free(s1);
+    free(s2);
+}
+
+void commit_with_workspace(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    MSMWorkspace ws, small_ws;
+    ThreadPool pool;
+    uint64_t secrets_len = 1025;
+    g1_t *s1 = malloc(secrets_len * sizeof(g1_t));
+    g2_t *s2 = malloc(secrets_len * sizeof(g2_t));
+    g1_t expected, actual;
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 10));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 4));
+    TEST_CHECK(C_KZG_OK == new_msm_workspace(&ws, ks.length, 2));
+    TEST_CHECK(C_KZG_OK == new_msm_workspace(&small_ws, 100, 1));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, 1000));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == g1_linear_combination(&expected, s1, p.coeffs, p.length));
+
+    // Reusing the workspace, both serially and with more threads than it has parts for
+    ks.workspace = &ws;
+    for (int i = 0; i < 2; i++) {
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        ks.pool = &pool;
+        TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        ks.pool = NULL;
+        TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 3));
+    }
+
+    // A workspace that is too small is not used
+    ks.workspace = &small_ws;
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+    TEST_CHECK(g1_equal(&expected, &actual));
+
+#ifndef DEBUG
+    MSMWorkspace bad_ws;
+    TEST_CHECK(C_KZG_BADARGS == new_msm_workspace(&bad_ws, 100, 0));
+#endif
+
+    free_poly(&p);
+    free_msm_workspace(&ws);
+    free_msm_workspace(&small_ws);
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+    free(s1);
+    free(s2);
+}
+
+void commit_with_affine_secrets(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    uint64_t secrets_len = 257;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected, actual, proof, point;
+    fr_t x, y[4], tmp;
+    poly p;
+    bool result;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 8));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, 200));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    // Commit with projective, and then affine, secrets
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+    TEST_CHECK(C_KZG_OK == kzg_settings_to_affine(&ks));
+    TEST_CHECK(ks.secret_g1 == NULL);
+    TEST_CHECK(C_KZG_OK == kzg_settings_to_affine(&ks));
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+    TEST_CHECK(g1_equal(&expected, &actual));
+
+    for (int i = 0; i < secrets_len; i++) {
+        kzg_settings_secret_g1(&point, &ks, i);
+        TEST_CHECK(g1_equal(&s1[i], &point));
+    }
+
+    // Multi proofs work, as do the tables built from the affine secrets
+    TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks, 4));
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&actual, &p, &ks));
+    TEST_CHECK(g1_equal(&expected, &actual));
+    x = rand_fr();
+    TEST_CHECK(C_KZG_OK == compute_proof_multi(&proof, &p, &x, 4, &ks));
+    for (int i = 0; i < 4; i++) {
+        fr_mul(&tmp, &x, &fs.expanded_roots_of_unity[i * fs.max_width / 4]);
+        eval_poly(&y[i], &p, &tmp);
+    }
+    TEST_CHECK(C_KZG_OK == check_proof_multi(&result, &actual, &proof, &x, y, 4, &ks));
+    TEST_CHECK(true == result);
+
+    free_poly(&p);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
+void update_commitment_works(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    uint64_t secrets_len = 257;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t expected, actual, original;
+    uint64_t indices[] = {0, 17, 199, 17, 256};
+    uint64_t len = sizeof indices / sizeof indices[0];
+    fr_t old_coeffs[len], new_coeffs[len];
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 8));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+
+    TEST_CHECK(C_KZG_OK == new_poly(&p, secrets_len));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&original, &p, &ks));
+
+    // Change the coefficients, one index twice, recording the changes
+    for (int i = 0; i < len; i++) {
+        old_coeffs[i] = p.coeffs[indices[i]];
+        new_coeffs[i] = rand_fr();
+        p.coeffs[indices[i]] = new_coeffs[i];
+    }
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+
+    // With projective secrets, affine secrets, and fixed-base tables
+    for (int form = 0; form < 3; form++) {
+        KZGSettings ks2;
+        TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks2, s1, s2, secrets_len, &fs));
+        if (form == 1) TEST_CHECK(C_KZG_OK == kzg_settings_to_affine(&ks2));
+        if (form == 2) TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&ks2, 4));
+        actual = original;
+        TEST_CHECK(C_KZG_OK == update_commitment(&actual, &actual, indices, old_coeffs, new_coeffs, len, &ks2));
+        TEST_CHECK(g1_equal(&expected, &actual));
+        TEST_MSG("Mismatch with secrets in form %d", form);
+        free_kzg_settings(&ks2);
+    }
+
+    TEST_CHECK(C_KZG_OK == update_commitment(&actual, &original, indices, old_coeffs, new_coeffs, 0, &ks));
+    TEST_CHECK(g1_equal(&original, &actual));
+#ifndef DEBUG
+    indices[0] = secrets_len;
+    TEST_CHECK(C_KZG_BADARGS == update_commitment(&actual, &original, indices, old_coeffs, new_coeffs, len, &ks));
+#endif
+
+    free_poly(&p);
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
+void lagrange_form_works(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    uint64_t secrets_len = 65, n = 32;
+    g1_t s1[secrets_len];
+    g2_t s2[secrets_len];
+    g1_t commitment, expected, proof;
+    uint64_t indices[] = {3, 31, 3};
+    uint64_t len = sizeof indices / sizeof indices[0];
+    fr_t evals[n], old_evals[len], new_evals[len], x, y, value;
+    bool result;
+    poly p;
+
+    generate_trusted_setup(s1, s2, &secret, secrets_len);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 6));
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+    TEST_CHECK(C_KZG_OK == kzg_settings_lagrange(&ks, n));
+    TEST_CHECK(n == ks.lagrange_length);
+
+    // The commitment to the evaluations is that to the polynomial interpolating them
+    TEST_CHECK(C_KZG_OK == new_poly(&p, n));
+    for (int i = 0; i < n; i++) {
+        evals[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == fft_fr(p.coeffs, evals, true, n, &fs));
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+    TEST_CHECK(C_KZG_OK == commit_to_evaluations(&commitment, evals, n, &ks));
+    TEST_CHECK(g1_equal(&expected, &commitment));
+
+    // Proofs outside the domain, and at one of its points, match those from the coefficients
+    for (int k = 0; k < 2; k++) {
+        x = k == 0 ? rand_fr() : fs.expanded_roots_of_unity[5 * fs.max_width / n];
+        TEST_CHECK(C_KZG_OK == compute_proof_single_eval(&proof, &y, evals, &x, &ks));
+        eval_poly(&value, &p, &x);
+        TEST_CHECK(fr_equal(&value, &y));
+        TEST_CHECK(C_KZG_OK == compute_proof_single(&expected, &p, &x, &ks));
+        TEST_CHECK(g1_equal(&expected, &proof));
+        TEST_CHECK(C_KZG_OK == check_proof_single(&result, &commitment, &proof, &x, &y, &ks));
+        TEST_CHECK(true == result);
+        TEST_MSG("Failed with x %s the domain", k == 0 ? "outside" : "in");
+    }
+
+    // Updating evaluations, one of them twice
+    for (int i = 0; i < len; i++) {
+        old_evals[i] = evals[indices[i]];
+        new_evals[i] = rand_fr();
+        evals[indices[i]] = new_evals[i];
+    }
+    TEST_CHECK(C_KZG_OK == commit_to_evaluations(&expected, evals, n, &ks));
+    TEST_CHECK(C_KZG_OK == update_commitment_evaluations(&commitment, &commitment, indices, old_evals, new_evals, len,
+                                                         &ks));
+    TEST_CHECK(g1_equal(&expected, &commitment));
+
+    // Recomputing for a smaller domain replaces the secrets
+    TEST_CHECK(C_KZG_OK == kzg_settings_lagrange(&ks, 8));
+    TEST_CHECK(C_KZG_OK == commit_to_evaluations(&commitment, evals, 8, &ks));
+    TEST_CHECK(C_KZG_OK == fft_fr(p.coeffs, evals, true, 8, &fs));
+    p.length = 8;
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&expected, &p, &ks));
+    TEST_CHECK(g1_equal(&expected, &commitment));
+
+#ifndef DEBUG
+    TEST_CHECK(C_KZG_BADARGS == commit_to_evaluations(&commitment, evals, n, &ks));
+    TEST_CHECK(C_KZG_BADARGS == kzg_settings_lagrange(&ks, 24));
+    TEST_CHECK(C_KZG_BADARGS == kzg_settings_lagrange(&ks, 128));
+    indices[0] = 8;
+    TEST_CHECK(C_KZG_BADARGS == update_commitment_evaluations(&commitment, &commitment, indices, old_evals, new_evals,
+                                                              len, &ks));
+#endif
+
+    free_poly(&p);
+    free_kzg_settings(&ks);
+
+    // Without Lagrange-form secrets
+    TEST_CHECK(C_KZG_OK == new_kzg_settings(&ks, s1, s2, secrets_len, &fs));
+#ifndef DEBUG
+    TEST_CHECK(C_KZG_BADARGS == commit_to_evaluations(&commitment, evals, n, &ks));
+    TEST_CHECK(C_KZG_BADARGS == compute_proof_single_eval(&proof, &y, evals, &x, &ks));
+#endif
+
+    free_fft_settings(&fs);
+    free_kzg_settings(&ks);
+}
+
 TEST_LIST = {
     {"KZG_PROOFS_TEST", title},
     {"proof_single", proof_single},
+    {"proof_single_without_allocation", proof_single_without_allocation},
+    {"proofs_at_points_works", proofs_at_points_works},
+    {"proof_single_batch", proof_single_batch},
     {"proof_multi", proof_multi},
     {"commit_to_nil_poly", commit_to_nil_poly},
     {"commit_to_too_long_poly", commit_to_too_long_poly},
+    {"commit_with_precompute", commit_with_precompute},
+    {"commit_with_thread_pool", commit_with_thread_pool},
+    {"commit_with_workspace", commit_with_workspace},
+    {"commit_with_affine_secrets", commit_with_affine_secrets},
+    {"update_commitment_works", update_commitment_works},
+    {"lagrange_form_works", lagrange_form_works},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
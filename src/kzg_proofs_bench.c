@@ -22,12 +22,15 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+// If `wbits` is non-zero then fixed-base tables with that window size are used.
+// If `pool` is non-NULL then commitments are computed in parallel using it. A workspace is always attached, so the
+// timings are for steady-state commitments that do not allocate.
+bench_result run_bench(int scale, int max_seconds, unsigned int wbits, const ThreadPool *pool) {
+    bench_t bench;
     FFTSettings fs;
     KZGSettings ks;
+    MSMWorkspace ws;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
 
@@ -37,6 +40,12 @@ long run_bench(int scale, int max_seconds) {
 
     generate_trusted_setup(s1, s2, &secret, fs.max_width);
     assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, fs.max_width, &fs));
+    if (wbits) {
+        assert(C_KZG_OK == kzg_settings_precompute(&ks, wbits));
+    }
+    ks.pool = pool;
+    assert(C_KZG_OK == new_msm_workspace(&ws, ks.length, pool_threads(pool)));
+    ks.workspace = &ws;
 
     poly p;
     assert(C_KZG_OK == new_poly(&p, fs.max_width));
@@ -44,28 +53,190 @@ long run_bench(int scale, int max_seconds) {
         p.coeffs[i] = rand_fr();
     }
 
-    while (total_time < max_seconds * NANO) {
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
         g1_t commitment;
-        clock_gettime(CLOCK_REALTIME, &t0);
+        bench_start(&bench);
 
         assert(C_KZG_OK == commit_to_poly(&commitment, &p, &ks));
 
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+        bench_stop(&bench);
     }
 
     free_poly(&p);
     free(s1);
     free(s2);
+    free_msm_workspace(&ws);
     free_kzg_settings(&ks);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, 0);
+}
+
+// Time computing a single proof for a polynomial of size 2^`scale` and return the timings per proof.
+// If `evaluations` is set then the polynomial is given by its evaluations, otherwise by its coefficients. Either
+// way a workspace is attached, so no memory is allocated while timing.
+bench_result run_proof_bench(int scale, int max_seconds, bool evaluations) {
+    bench_t bench;
+    FFTSettings fs;
+    KZGSettings ks;
+    MSMWorkspace ws;
+    g1_t proof;
+    fr_t x, y;
+
+    assert(C_KZG_OK == new_fft_settings(&fs, scale));
+    g1_t *s1 = malloc(fs.max_width * sizeof(g1_t));
+    g2_t *s2 = malloc(fs.max_width * sizeof(g2_t));
+    generate_trusted_setup(s1, s2, &secret, fs.max_width);
+    assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, fs.max_width, &fs));
+    if (evaluations) {
+        assert(C_KZG_OK == kzg_settings_lagrange(&ks, fs.max_width));
+    }
+    assert(C_KZG_OK == new_msm_workspace(&ws, ks.length, 1));
+    ks.workspace = &ws;
+
+    poly p;
+    assert(C_KZG_OK == new_poly(&p, fs.max_width));
+    for (int i = 0; i < fs.max_width; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        x = rand_fr();
+        bench_start(&bench);
+
+        if (evaluations) {
+            assert(C_KZG_OK == compute_proof_single_eval(&proof, &y, p.coeffs, &x, &ks));
+        } else {
+            assert(C_KZG_OK == compute_proof_single(&proof, &p, &x, &ks));
+        }
+
+        bench_stop(&bench);
+    }
+
+    free_poly(&p);
+    free(s1);
+    free(s2);
+    free_msm_workspace(&ws);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, 1, 0);
+}
+
+// Time computing proofs for a polynomial of size 2^`scale` at `k` points, either with a single call to
+// compute_proofs_at_points() or with `k` calls to compute_proof_single(), and return the timings for all of them.
+// If `pool` is non-NULL then it is attached to the settings.
+bench_result run_proofs_bench(int scale, int k, int max_seconds, bool together, const ThreadPool *pool) {
+    bench_t bench;
+    FFTSettings fs;
+    KZGSettings ks;
+    g1_t *proofs = malloc(k * sizeof(g1_t));
+    fr_t *xs = malloc(k * sizeof(fr_t));
+
+    assert(C_KZG_OK == new_fft_settings(&fs, scale));
+    g1_t *s1 = malloc(fs.max_width * sizeof(g1_t));
+    g2_t *s2 = malloc(fs.max_width * sizeof(g2_t));
+    generate_trusted_setup(s1, s2, &secret, fs.max_width);
+    assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, fs.max_width, &fs));
+    ks.pool = pool;
+
+    poly p;
+    assert(C_KZG_OK == new_poly(&p, fs.max_width));
+    for (int i = 0; i < fs.max_width; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    for (int j = 0; j < k; j++) {
+        xs[j] = rand_fr();
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+
+        if (together) {
+            assert(C_KZG_OK == compute_proofs_at_points(proofs, &p, xs, k, &ks));
+        } else {
+            for (int j = 0; j < k; j++) {
+                assert(C_KZG_OK == compute_proof_single(&proofs[j], &p, &xs[j], &ks));
+            }
+        }
+
+        bench_stop(&bench);
+    }
+
+    free_poly(&p);
+    free(proofs);
+    free(xs);
+    free(s1);
+    free(s2);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, 1, 0);
+}
+
+// Time verifying `n` single proofs, either individually or as a batch, and return the timings per batch.
+bench_result run_verify_bench(int n, int max_seconds, bool batch) {
+    bench_t bench;
+    FFTSettings fs;
+    KZGSettings ks;
+    bool result, ok[n];
+    g1_t *commitments = malloc(n * sizeof(g1_t)), *proofs = malloc(n * sizeof(g1_t));
+    fr_t *xs = malloc(n * sizeof(fr_t)), *ys = malloc(n * sizeof(fr_t));
+
+    assert(C_KZG_OK == new_fft_settings(&fs, 4));
+    g1_t s1[fs.max_width + 1];
+    g2_t s2[fs.max_width + 1];
+    generate_trusted_setup(s1, s2, &secret, fs.max_width + 1);
+    assert(C_KZG_OK == new_kzg_settings(&ks, s1, s2, fs.max_width + 1, &fs));
+
+    poly p;
+    assert(C_KZG_OK == new_poly(&p, fs.max_width));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < p.length; j++) {
+            p.coeffs[j] = rand_fr();
+        }
+        xs[i] = rand_fr();
+        eval_poly(&ys[i], &p, &xs[i]);
+        assert(C_KZG_OK == commit_to_poly(&commitments[i], &p, &ks));
+        assert(C_KZG_OK == compute_proof_single(&proofs[i], &p, &xs[i], &ks));
+    }
+
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+
+        if (batch) {
+            assert(C_KZG_OK == check_proof_single_batch(&result, ok, commitments, proofs, xs, ys, n, &ks));
+            assert(result);
+        } else {
+            for (int i = 0; i < n; i++) {
+                assert(C_KZG_OK == check_proof_single(&result, &commitments[i], &proofs[i], &xs[i], &ys[i], &ks));
+                assert(result);
+            }
+        }
+
+        bench_stop(&bench);
+    }
+
+    free_poly(&p);
+    free(commitments);
+    free(proofs);
+    free(xs);
+    free(ys);
+    free_kzg_settings(&ks);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, 1, 0);
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
     case 1:
@@ -79,14 +250,48 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking Polynomial Commitment, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking Polynomial Commitment, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
     for (int scale = 1; scale <= 15; scale++) {
-        printf("commit_to_poly/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec, 0, NULL), "commit_to_poly/scale_%d", scale);
+    }
+    for (int scale = 1; scale <= 15; scale++) {
+        bench_report(run_bench(scale, nsec, 6, NULL), "commit_to_poly_precomputed/scale_%d", scale);
+    }
+
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 1; scale <= 15; scale++) {
+        bench_report(run_bench(scale, nsec, 0, &pool), "commit_to_poly_threaded/scale_%d", scale);
+    }
+    for (int scale = 1; scale <= 15; scale++) {
+        bench_report(run_bench(scale, nsec, 6, &pool), "commit_to_poly_precomputed_threaded/scale_%d", scale);
+    }
+    for (int scale = 4; scale <= 12; scale += 4) {
+        bench_report(run_proofs_bench(scale, 16, nsec, true, &pool), "compute_proofs_at_points_threaded/scale_%d_k_16",
+                     scale);
+    }
+    free_thread_pool(&pool);
+
+    for (int scale = 1; scale <= 15; scale++) {
+        bench_report(run_proof_bench(scale, nsec, false), "compute_proof_single/scale_%d", scale);
+    }
+    for (int scale = 1; scale <= 15; scale++) {
+        bench_report(run_proof_bench(scale, nsec, true), "compute_proof_single_eval/scale_%d", scale);
+    }
+
+    for (int scale = 4; scale <= 12; scale += 4) {
+        bench_report(run_proofs_bench(scale, 16, nsec, false, NULL), "compute_proof_single/scale_%d_k_16", scale);
+        bench_report(run_proofs_bench(scale, 16, nsec, true, NULL), "compute_proofs_at_points/scale_%d_k_16", scale);
+    }
+
+    for (int n = 1; n <= 256; n *= 4) {
+        bench_report(run_verify_bench(n, nsec, false), "check_proof_single/n_%d", n);
+        bench_report(run_verify_bench(n, nsec, true), "check_proof_single_batch/n_%d", n);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
@@ -75,7 +75,7 @@ C_KZG_RET poly_long_div(poly *out, const poly *dividend, const poly *divisor) {
     uint64_t a_pos = dividend->length - 1;
     uint64_t b_pos = divisor->length - 1;
     uint64_t diff = a_pos - b_pos;
-    fr_t *a;
+    fr_t *a, inv_lead;
 
     // Dividing by zero is undefined
     CHECK(divisor->length > 0);
@@ -98,8 +98,10 @@ C_KZG_RET poly_long_div(poly *out, const poly *dividend, const poly *divisor) {
         a[i] = dividend->coeffs[i];
     }
 
+    // Every step divides by the divisor's leading coefficient, so invert it just once
+    fr_inv(&inv_lead, &divisor->coeffs[b_pos]);
     while (diff > 0) {
-        fr_div(&out->coeffs[diff], &a[a_pos], &divisor->coeffs[b_pos]);
+        fr_mul(&out->coeffs[diff], &a[a_pos], &inv_lead);
         for (uint64_t i = 0; i <= b_pos; i++) {
             fr_t tmp;
             // a[diff + i] -= b[i] * quot
@@ -109,9 +111,9 @@ C_KZG_RET poly_long_div(poly *out, const poly *dividend, const poly *divisor) {
         --diff;
         --a_pos;
     }
-    fr_div(&out->coeffs[0], &a[a_pos], &divisor->coeffs[b_pos]);
+    fr_mul(&out->coeffs[0], &a[a_pos], &inv_lead);
 
-    free(a);
+    c_kzg_free(a);
     return C_KZG_OK;
 }
 
@@ -161,9 +163,11 @@ C_KZG_RET poly_fast_div(poly *out, const poly *dividend, const poly *divisor) {
 
     // Special case for divisor.length == 1 (it's a constant)
     if (divisor->length == 1) {
+        fr_t inv;
+        fr_inv(&inv, &divisor->coeffs[0]);
         out->length = dividend->length;
         for (uint64_t i = 0; i < out->length; i++) {
-            fr_div(&out->coeffs[i], &dividend->coeffs[i], &divisor->coeffs[0]);
+            fr_mul(&out->coeffs[i], &dividend->coeffs[i], &inv);
         }
         return C_KZG_OK;
     }
@@ -301,8 +305,8 @@ static C_KZG_RET poly_mul_direct(poly *out, const poly *a, const poly *b) {
  * The size of the output polynomial determines the number of coefficients returned.
  *
  * @remark This version uses FFTs to calculate the product via convolution, and is very efficient for large
- * calculations. If @p fs is supplied as NULL, then the FFTSettings are allocated internally, otherwise the supplied
- * settings are used, which must be sufficiently sized for the calculation.
+ * calculations. If @p fs is supplied as NULL, then the shared settings from #borrow_fft_settings are used, otherwise the
+ * supplied settings are used, which must be sufficiently sized for the calculation.
  *
  * @param[in,out] out The result of the division - its size determines the number of coefficients returned
  * @param[in]     a   The muliplicand polynomial
@@ -313,23 +317,22 @@ static C_KZG_RET poly_mul_direct(poly *out, const poly *a, const poly *b) {
  * @retval C_CZK_ERROR   An internal error occurred
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
-static C_KZG_RET poly_mul_fft(poly *out, const poly *a, const poly *b, FFTSettings *fs_) {
+static C_KZG_RET poly_mul_fft(poly *out, const poly *a, const poly *b, const FFTSettings *fs_) {
 
     // Truncate a and b so as not to do excess work for the number of coefficients required.
     uint64_t a_len = min_u64(a->length, out->length);
     uint64_t b_len = min_u64(b->length, out->length);
     uint64_t length = next_power_of_two(a_len + b_len - 1);
 
-    // If the FFT settings are NULL then make a local set, otherwise use the ones passed in.
-    FFTSettings fs, *fs_p;
-    if (fs_ != NULL) {
-        fs_p = fs_;
-    } else {
-        fs_p = &fs;
-        int scale = log2_pow2(length); // TODO only good up to length < 32 bits
-        TRY(new_fft_settings(fs_p, scale));
+    // If the FFT settings are NULL then borrow the shared ones, whose roots persist between calls
+    const FFTSettings *fs_p = fs_;
+    if (fs_p == NULL) {
+        TRY(borrow_fft_settings(&fs_p));
+    }
+    if (length > fs_p->max_width) {
+        if (fs_ == NULL) release_fft_settings(fs_p);
+        return C_KZG_BADARGS;
     }
-    CHECK(length <= fs_p->max_width);
 
     fr_t *a_pad, *b_pad, *a_fft, *b_fft;
     TRY(new_fr_array(&a_pad, length));
@@ -344,9 +347,7 @@ static C_KZG_RET poly_mul_fft(poly *out, const poly *a, const poly *b, FFTSettin
 
     fr_t *ab_fft = a_pad; // reuse the a_pad array
     fr_t *ab = b_pad;     // reuse the b_pad array
-    for (uint64_t i = 0; i < length; i++) {
-        fr_mul(&ab_fft[i], &a_fft[i], &b_fft[i]);
-    }
+    fr_mul_vec(ab_fft, a_fft, b_fft, length);
     TRY(fft_fr(ab, ab_fft, true, length, fs_p));
 
     // Copy result to output
@@ -358,12 +359,12 @@ static C_KZG_RET poly_mul_fft(poly *out, const poly *a, const poly *b, FFTSettin
         out->coeffs[i] = fr_zero;
     }
 
-    free(a_pad);
-    free(b_pad);
-    free(a_fft);
-    free(b_fft);
-    if (fs_p == &fs) {
-        free_fft_settings(fs_p);
+    c_kzg_free(a_pad);
+    c_kzg_free(b_pad);
+    c_kzg_free(a_fft);
+    c_kzg_free(b_fft);
+    if (fs_ == NULL) {
+        release_fft_settings(fs_p);
     }
 
     return C_KZG_OK;
@@ -408,11 +409,6 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
     uint64_t maxd = length - 1;
     uint64_t d = 0;
 
-    // Max space for multiplications is (2 * length - 1)
-    int scale = log2_pow2(next_power_of_two(2 * length - 1));
-    FFTSettings fs;
-    TRY(new_fft_settings(&fs, scale));
-
     // To store intermediate results
     TRY(new_poly(&tmp0, length));
     TRY(new_poly(&tmp1, length));
@@ -429,7 +425,7 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
 
         // b.c -> tmp0 (we're using out for c)
         tmp0.length = min_u64(d + 1, b->length + out->length - 1);
-        TRY(poly_mul_(&tmp0, b, out, &fs));
+        TRY(poly_mul_(&tmp0, b, out, NULL));
 
         // 2 - b.c -> tmp0
         for (int i = 0; i < tmp0.length; i++) {
@@ -440,7 +436,7 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
 
         // c.(2 - b.c) -> tmp1;
         tmp1.length = d + 1;
-        TRY(poly_mul_(&tmp1, out, &tmp0, &fs));
+        TRY(poly_mul_(&tmp1, out, &tmp0, NULL));
 
         // tmp1 -> c
         out->length = tmp1.length;
@@ -452,7 +448,6 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
 
     free_poly(&tmp0);
     free_poly(&tmp1);
-    free_fft_settings(&fs);
 
     return C_KZG_OK;
 }
@@ -464,7 +459,7 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
  * Calculate the (possibly truncated) product of two polynomials.
  *
  * This is just a wrapper around #poly_mul_direct and #poly_mul_fft that selects the faster based on the size of the
- * problem.
+ * problem, using the crossover in the active #KZGTuning profile.
  *
  * @param[in,out] out The result of the division - its size determines the number of coefficients returned
  * @param[in]     a   The muliplicand polynomial
@@ -475,8 +470,9 @@ C_KZG_RET poly_inverse(poly *out, poly *b) {
  * @retval C_CZK_ERROR   An internal error occurred
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
-C_KZG_RET poly_mul_(poly *out, const poly *a, const poly *b, FFTSettings *fs) {
-    if (a->length < 64 || b->length < 64 || out->length < 128) { // Tunable parameter
+C_KZG_RET poly_mul_(poly *out, const poly *a, const poly *b, const FFTSettings *fs) {
+    uint64_t min = kzg_tuning()->poly_mul_fft_min;
+    if (a->length < min || b->length < min || out->length < 2 * min) {
         return poly_mul_direct(out, a, b);
     } else {
         return poly_mul_fft(out, a, b, fs);
@@ -506,7 +502,8 @@ C_KZG_RET poly_mul(poly *out, const poly *a, const poly *b) {
  *
  * Returns the polynomial resulting from dividing @p dividend_ by @p divisor_.
  *
- * This is a wrapper around #poly_long_div and #poly_fast_div that chooses the fastest based on problem size.
+ * This is a wrapper around #poly_long_div and #poly_fast_div that chooses the fastest based on problem size, using the
+ * crossover in the active #KZGTuning profile.
  *
  * @remark @p out must be an uninitialised #poly. Space is allocated for it here, which
  * must be later reclaimed by calling #free_poly().
@@ -525,7 +522,7 @@ C_KZG_RET new_poly_div(poly *out, const poly *dividend_, const poly *divisor_) {
     poly divisor = poly_norm(divisor_);
 
     TRY(new_poly(out, poly_quotient_length(&dividend, &divisor)));
-    if (divisor.length >= dividend.length || divisor.length < 128) { // Tunable paramter
+    if (divisor.length >= dividend.length || divisor.length < kzg_tuning()->poly_div_fast_min) {
         return poly_long_div(out, &dividend, &divisor);
     } else {
         return poly_fast_div(out, &dividend, &divisor);
@@ -578,7 +575,7 @@ C_KZG_RET new_poly_with_coeffs(poly *out, const fr_t *coeffs, uint64_t length) {
  */
 void free_poly(poly *p) {
     if (p->coeffs != NULL) {
-        free(p->coeffs);
+        c_kzg_free(p->coeffs);
     }
 }
 
@@ -966,6 +963,45 @@ void poly_div_random(void) {
     }
 }
 
+void poly_div_in_arena(void) {
+    poly dividend, divisor, expected, actual;
+    Arena arena;
+    int dividend_length = 900, divisor_length = 300;
+
+    new_poly(&dividend, dividend_length);
+    new_poly(&divisor, divisor_length);
+    for (int i = 0; i < dividend_length; i++) {
+        dividend.coeffs[i] = rand_fr();
+    }
+    for (int i = 0; i < divisor_length; i++) {
+        divisor.coeffs[i] = rand_fr();
+    }
+    divisor.coeffs[divisor_length - 1] = fr_one;
+    TEST_CHECK(C_KZG_OK == new_poly_div(&expected, &dividend, &divisor));
+
+    // The same division with all of its working space, and its result, in an arena
+    TEST_CHECK(C_KZG_OK == new_arena(&arena, 1 << 20));
+    for (int rep = 0; rep < 2; rep++) {
+        arena_begin(&arena);
+        TEST_CHECK(C_KZG_OK == new_poly_div(&actual, &dividend, &divisor));
+        TEST_CHECK((byte *)actual.coeffs >= arena.base && (byte *)actual.coeffs < arena.base + arena.size);
+        TEST_CHECK(actual.length == expected.length);
+        for (int i = 0; i < expected.length; i++) {
+            TEST_CHECK(fr_equal(&expected.coeffs[i], &actual.coeffs[i]));
+        }
+        free_poly(&actual);
+        arena_end(&arena);
+        arena_reset(&arena);
+    }
+    TEST_CHECK(arena.peak > 0);
+    TEST_CHECK(arena.overflows == 0);
+
+    free_arena(&arena);
+    free_poly(&dividend);
+    free_poly(&divisor);
+    free_poly(&expected);
+}
+
 TEST_LIST = {
     {"POLY_TEST", title},
     {"poly_test_div", poly_test_div},
@@ -980,6 +1016,7 @@ TEST_LIST = {
     {"poly_inverse_simple_0", poly_inverse_simple_0},
     {"poly_inverse_simple_1", poly_inverse_simple_1},
     {"poly_mul_random", poly_mul_random},
+    {"poly_div_in_arena", poly_div_in_arena},
     {"poly_div_random", poly_div_random},
     {NULL, NULL} /* zero record marks the end of the list */
 };
@@ -22,10 +22,9 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+bench_result run_bench(int scale, int max_seconds) {
+    bench_t bench;
 
     uint64_t width = (uint64_t)1 << scale;
 
@@ -51,14 +50,13 @@ long run_bench(int scale, int max_seconds) {
         divisor.coeffs[divisor.length - 1] = fr_one;
     }
 
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
 
         assert(C_KZG_OK == new_poly_div(&q, &dividend, &divisor));
 
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+        bench_stop(&bench);
 
         free_poly(&q);
     }
@@ -66,12 +64,14 @@ long run_bench(int scale, int max_seconds) {
     free_poly(&dividend);
     free_poly(&divisor);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, 0);
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
 
+    argc = bench_init(argc, argv);
+
     switch (argc) {
     case 1:
         nsec = NSEC;
@@ -84,14 +84,14 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking Polynomial Division, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking Polynomial Division, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
     for (int scale = 6; scale <= 15; scale++) {
-        printf("new_poly_div/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_bench(scale, nsec), "new_poly_div/scale_%d", scale);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
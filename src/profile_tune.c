@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h> // atoi()
+#include <stdio.h>  // printf(), fopen()
+#include <unistd.h> // EXIT_SUCCESS/FAILURE
+#include "c_kzg.h"
+
+// Measure the crossovers between algorithms on this machine and write them as a profile for load_kzg_tuning(), either
+// to the named file or to standard output.
+int main(int argc, char *argv[]) {
+    int max_scale = 12;
+    KZGTuning defaults, t;
+    FILE *out = stdout;
+
+    if (argc > 3 || (argc > 1 && (max_scale = atoi(argv[1])) == 0)) {
+        printf("Usage: %s [largest log2 size to try, 4 to 16] [profile file]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (kzg_tune(&t, max_scale) != C_KZG_OK) {
+        fprintf(stderr, "Tuning failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    kzg_tuning_defaults(&defaults);
+    fprintf(stderr, "*** Crossovers measured up to size %d, defaults in brackets.\n", 1 << max_scale);
+    fprintf(stderr, "poly_mul_fft_min %lu (%lu)\n", t.poly_mul_fft_min, defaults.poly_mul_fft_min);
+    fprintf(stderr, "poly_div_fast_min %lu (%lu)\n", t.poly_div_fast_min, defaults.poly_div_fast_min);
+    fprintf(stderr, "msm_pippenger_min %lu (%lu)\n", t.msm_pippenger_min, defaults.msm_pippenger_min);
+    fprintf(stderr, "zero_poly_tree_min %lu (%lu)\n", t.zero_poly_tree_min, defaults.zero_poly_tree_min);
+
+    if (argc == 3 && (out = fopen(argv[2], "w")) == NULL) {
+        perror(argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    if (save_kzg_tuning(out, &t) != C_KZG_OK) {
+        fprintf(stderr, "Could not write the profile\n");
+        exit(EXIT_FAILURE);
+    }
+    if (out != stdout) fclose(out);
+
+    return EXIT_SUCCESS;
+}
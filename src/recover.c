@@ -28,44 +28,172 @@
 #define SCALE_FACTOR 5
 
 /**
- * Scale a polynomial in place.
+ * The state shared by every row of a batch recovery.
+ */
+typedef struct {
+    fr_t *reconstructed_data;          /**< The output rows */
+    const fr_t *samples;               /**< The input rows */
+    uint64_t len_samples;              /**< The length of each row */
+    uint64_t n_rows;                   /**< The number of rows */
+    uint64_t rows_per_task;            /**< The number of consecutive rows handled by each task */
+    const fr_t *zero_eval;             /**< The evaluations of the zero polynomial, zero at the missing indices */
+    const fr_t *inv_eval_scaled_zero;  /**< The inverses of the evaluations of the scaled zero polynomial */
+    fr_t shift;                        /**< The coset shift `1 / k`, where `k` is #SCALE_FACTOR */
+    fr_t *scratch;                     /**< Two rows of scratch space for each task */
+    const FFTSettings *fs;             /**< The FFT settings */
+    C_KZG_RET *ret;                    /**< The result of each task */
+} recover_job;
+
+/**
+ * Recover a single row, given the precomputed zero polynomial.
  *
- * Multiplies each coefficient by `1 / scale_factor ^ i`. Equivalent to creating a polynomial that evaluates at `x * k`
- * rather than `x`.
+ * @param[out] reconstructed_data The reconstructed row
+ * @param[in]  samples            The row of samples, whose values at the missing indices are ignored
+ * @param[in]  job                The shared state of the batch
+ * @param[in]  scratch            Space for two rows
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET recover_row(fr_t *reconstructed_data, const fr_t *samples, const recover_job *job, fr_t *scratch) {
+    uint64_t len_samples = job->len_samples;
+    fr_t *poly_evaluations_with_zero = scratch;
+    fr_t *poly_with_zero = scratch + len_samples;
+    fr_t *eval_scaled_poly_with_zero = scratch;
+    fr_t *scaled_reconstructed_poly = scratch + len_samples;
+
+    // Construct E * Z_r,I: the loop makes the evaluation polynomial
+    for (uint64_t i = 0; i < len_samples; i++) {
+        if (fr_is_zero(&job->zero_eval[i])) {
+            poly_evaluations_with_zero[i] = fr_zero;
+        } else {
+            fr_mul(&poly_evaluations_with_zero[i], &samples[i], &job->zero_eval[i]);
+        }
+    }
+    // Now inverse FFT so that poly_with_zero is (E * Z_r,I)(x) = (D * Z_r,I)(x)
+    TRY(fft_fr(poly_with_zero, poly_evaluations_with_zero, true, len_samples, job->fs));
+
+    // Polynomial division by convolution: Q3 = Q1 / Q2, where Q1 = (D * Z_r,I)(k * x) and Q2 = Z_r,I(k * x) is the
+    // same for every row. Scaling x -> k * x is the same as evaluating over the coset shifted by 1 / k.
+    TRY(fft_fr_coset(eval_scaled_poly_with_zero, poly_with_zero, false, &job->shift, len_samples, job->fs));
+    fr_t *eval_scaled_reconstructed_poly = eval_scaled_poly_with_zero;
+    fr_mul_vec(eval_scaled_reconstructed_poly, eval_scaled_poly_with_zero, job->inv_eval_scaled_zero, len_samples);
+
+    // The result of the division is D(k * x), and interpolating over the same coset takes k * x -> x
+    TRY(fft_fr_coset(scaled_reconstructed_poly, eval_scaled_reconstructed_poly, true, &job->shift, len_samples,
+                     job->fs));
+
+    // Finally we have D(x) which evaluates to our original data at the powers of roots of unity
+    fr_t *reconstructed_poly = scaled_reconstructed_poly; // Renaming
+
+    // The evaluation polynomial for D(x) is the reconstructed data:
+    TRY(fft_fr(reconstructed_data, reconstructed_poly, false, len_samples, job->fs));
+
+    // Check all is well
+    for (uint64_t i = 0; i < len_samples; i++) {
+        ASSERT(fr_is_zero(&job->zero_eval[i]) || fr_equal(&reconstructed_data[i], &samples[i]));
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Recover a run of consecutive rows, as one task of #recover_polys_from_samples.
  *
- * @param[out,in] p The polynomial coefficients to be scaled
- * @param[in] len_p Length of the polynomial coefficients
+ * @param[in,out] arg The #recover_job
+ * @param[in]     t   The index of the task
  */
-static void scale_poly(fr_t *p, uint64_t len_p) {
-    fr_t scale_factor, factor_power, inv_factor;
-    fr_from_uint64(&scale_factor, SCALE_FACTOR);
-    fr_inv(&inv_factor, &scale_factor);
-    factor_power = fr_one;
-
-    for (uint64_t i = 1; i < len_p; i++) {
-        fr_mul(&factor_power, &factor_power, &inv_factor);
-        fr_mul(&p[i], &p[i], &factor_power);
+static void recover_task(void *arg, uint64_t t) {
+    const recover_job *job = arg;
+    uint64_t start = t * job->rows_per_task;
+    uint64_t end = job->n_rows - start < job->rows_per_task ? job->n_rows : start + job->rows_per_task;
+    fr_t *scratch = job->scratch + t * 2 * job->len_samples;
+
+    job->ret[t] = C_KZG_OK;
+    for (uint64_t row = start; row < end && job->ret[t] == C_KZG_OK; row++) {
+        uint64_t offset = row * job->len_samples;
+        job->ret[t] = recover_row(job->reconstructed_data + offset, job->samples + offset, job, scratch);
     }
 }
 
 /**
- * Unscale a polynomial in place.
+ * Reconstruct many datasets that are all missing the same entries.
  *
- * Multiplies each coefficient by `scale_factor ^ i`. Equivalent to creating a polynomial that evaluates at `x / k`
- * rather than `x`.
+ * This gives the same results as calling #recover_poly_from_samples on each row, but the zero polynomial for the
+ * missing entries, and the evaluations of its scaled form that every row is divided by, are computed only once. Each
+ * row then costs four FFTs.
  *
- * @param[out,in] p The polynomial coefficients to be unscaled
- * @param[in] len_p Length of the polynomial coefficients
+ * @param[out] reconstructed_data The reconstructed rows, @p n_rows consecutive rows of length @p len_samples
+ * @param[in]  samples            The rows of data to be reconstructed, laid out as @p reconstructed_data. The values at
+ *                                the missing indices are ignored.
+ * @param[in]  len_samples        The length of each row, a power of two
+ * @param[in]  n_rows             The number of rows
+ * @param[in]  missing            The indices of the missing entries, in the range `[0, len_samples)`
+ * @param[in]  len_missing        The number of missing entries, at most half of @p len_samples
+ * @param[in]  fs                 The FFT settings previously initialised with #new_fft_settings
+ * @param[in]  pool               Optional thread pool, to build the zero polynomial and recover the rows in parallel,
+ *                                NULL to run serially
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
  */
-static void unscale_poly(fr_t *p, uint64_t len_p) {
-    fr_t scale_factor, factor_power;
-    fr_from_uint64(&scale_factor, SCALE_FACTOR);
-    factor_power = fr_one;
-
-    for (uint64_t i = 1; i < len_p; i++) {
-        fr_mul(&factor_power, &factor_power, &scale_factor);
-        fr_mul(&p[i], &p[i], &factor_power);
+C_KZG_RET recover_polys_from_samples(fr_t *reconstructed_data, const fr_t *samples, uint64_t len_samples,
+                                     uint64_t n_rows, const uint64_t *missing, uint64_t len_missing,
+                                     const FFTSettings *fs, const ThreadPool *pool) {
+    recover_job job;
+    uint64_t tasks;
+    fr_t *zero_eval, *inv_eval_scaled_zero, *eval_scaled_zero;
+    poly zero_poly;
+    C_KZG_RET ret = C_KZG_OK;
+
+    CHECK(is_power_of_two(len_samples));
+    CHECK(len_samples <= fs->max_width);
+    CHECK(len_missing <= len_samples / 2);
+    for (uint64_t i = 0; i < len_missing; i++) {
+        CHECK(missing[i] < len_samples);
+    }
+    if (n_rows == 0) return C_KZG_OK;
+
+    tasks = pool_threads(pool);
+    if (tasks > n_rows) tasks = n_rows;
+
+    TRY(new_fr_array(&zero_eval, len_samples));
+    TRY(new_fr_array(&inv_eval_scaled_zero, len_samples));
+    TRY(new_fr_array(&eval_scaled_zero, len_samples));
+    TRY(new_fr_array(&job.scratch, tasks * 2 * len_samples));
+    TRY(new_byte_array((byte **)&job.ret, tasks * sizeof *job.ret));
+
+    // Calculate `Z_r,I`, and then the evaluations of `Z_r,I(k * x)` that every row is divided by
+    zero_poly.length = len_samples;
+    zero_poly.coeffs = job.scratch;
+    TRY(zero_polynomial_via_multiplication_parallel(zero_eval, &zero_poly, len_samples, missing, len_missing, fs,
+                                                    pool));
+    fr_from_uint64(&job.shift, SCALE_FACTOR);
+    fr_inv(&job.shift, &job.shift);
+    TRY(fft_fr_coset(eval_scaled_zero, zero_poly.coeffs, false, &job.shift, len_samples, fs));
+    fr_batch_inv(inv_eval_scaled_zero, eval_scaled_zero, len_samples);
+
+    job.reconstructed_data = reconstructed_data;
+    job.samples = samples;
+    job.len_samples = len_samples;
+    job.n_rows = n_rows;
+    job.rows_per_task = (n_rows + tasks - 1) / tasks;
+    job.zero_eval = zero_eval;
+    job.inv_eval_scaled_zero = inv_eval_scaled_zero;
+    job.fs = fs;
+    pool_run(pool, recover_task, &job, tasks);
+    for (uint64_t t = 0; t < tasks && ret == C_KZG_OK; t++) {
+        ret = job.ret[t];
     }
+
+    c_kzg_free(zero_eval);
+    c_kzg_free(inv_eval_scaled_zero);
+    c_kzg_free(eval_scaled_zero);
+    c_kzg_free(job.scratch);
+    c_kzg_free(job.ret);
+
+    return ret;
 }
 
 /**
@@ -75,6 +203,8 @@ static void unscale_poly(fr_t *p, uint64_t len_p) {
  *
  * See https://ethresear.ch/t/reed-solomon-erasure-code-recovery-in-n-log-2-n-time-with-ffts/3039
  *
+ * @remark To recover several datasets that are missing the same entries, #recover_polys_from_samples is faster.
+ *
  * @param[out] reconstructed_data An attempted reconstruction of the original data
  * @param[in]  samples            The data to be reconstructed, with `fr_null` set for missing values
  * @param[in]  len_samples        The length of @p samples and @p reconstructed_data
@@ -85,96 +215,24 @@ static void unscale_poly(fr_t *p, uint64_t len_p) {
  * @retval C_CZK_MALLOC  Memory allocation failed
  */
 C_KZG_RET recover_poly_from_samples(fr_t *reconstructed_data, fr_t *samples, uint64_t len_samples, FFTSettings *fs) {
+    STAT_SCOPE(RECOVER_POLY_FROM_SAMPLES);
+    uint64_t *missing;
+    uint64_t len_missing = 0;
+    C_KZG_RET ret;
 
     CHECK(is_power_of_two(len_samples));
 
-    uint64_t *missing;
     TRY(new_uint64_array(&missing, len_samples));
-
-    uint64_t len_missing = 0;
     for (uint64_t i = 0; i < len_samples; i++) {
         if (fr_is_null(&samples[i])) {
             missing[len_missing++] = i;
         }
     }
 
-    // Make scratch areas, each of size len_samples. Cuts space required by 57%.
-    fr_t *scratch;
-    TRY(new_fr_array(&scratch, 3 * len_samples));
-    fr_t *scratch0 = scratch;
-    fr_t *scratch1 = scratch0 + len_samples;
-    fr_t *scratch2 = scratch1 + len_samples;
-
-    // Assign meaningful names to scratch spaces
-    fr_t *zero_eval = scratch0;
-    fr_t *poly_evaluations_with_zero = scratch2;
-    fr_t *poly_with_zero = scratch0;
-    fr_t *eval_scaled_poly_with_zero = scratch2;
-    fr_t *eval_scaled_zero_poly = scratch0;
-    fr_t *scaled_reconstructed_poly = scratch1;
-
-    poly zero_poly;
-    zero_poly.length = len_samples;
-    zero_poly.coeffs = scratch1;
-
-    // Calculate `Z_r,I`
-    TRY(zero_polynomial_via_multiplication(zero_eval, &zero_poly, len_samples, missing, len_missing, fs));
-
-    // Check all is well
-    for (uint64_t i = 0; i < len_samples; i++) {
-        ASSERT(fr_is_null(&samples[i]) == fr_is_zero(&zero_eval[i]));
-    }
-
-    // Construct E * Z_r,I: the loop makes the evaluation polynomial
-    for (uint64_t i = 0; i < len_samples; i++) {
-        if (fr_is_null(&samples[i])) {
-            poly_evaluations_with_zero[i] = fr_zero;
-        } else {
-            fr_mul(&poly_evaluations_with_zero[i], &samples[i], &zero_eval[i]);
-        }
-    }
-    // Now inverse FFT so that poly_with_zero is (E * Z_r,I)(x) = (D * Z_r,I)(x)
-    TRY(fft_fr(poly_with_zero, poly_evaluations_with_zero, true, len_samples, fs));
-
-    // x -> k * x
-    scale_poly(poly_with_zero, len_samples);
-    scale_poly(zero_poly.coeffs, zero_poly.length);
-
-    // Q1 = (D * Z_r,I)(k * x)
-    fr_t *scaled_poly_with_zero = poly_with_zero; // Renaming
-    // Q2 = Z_r,I(k * x)
-    fr_t *scaled_zero_poly = zero_poly.coeffs; // Renaming
-
-    // Polynomial division by convolution: Q3 = Q1 / Q2
-    TRY(fft_fr(eval_scaled_poly_with_zero, scaled_poly_with_zero, false, len_samples, fs));
-    TRY(fft_fr(eval_scaled_zero_poly, scaled_zero_poly, false, len_samples, fs));
-
-    fr_t *eval_scaled_reconstructed_poly = eval_scaled_poly_with_zero;
-    for (uint64_t i = 0; i < len_samples; i++) {
-        fr_div(&eval_scaled_reconstructed_poly[i], &eval_scaled_poly_with_zero[i], &eval_scaled_zero_poly[i]);
-    }
-
-    // The result of the division is D(k * x):
-    TRY(fft_fr(scaled_reconstructed_poly, eval_scaled_reconstructed_poly, true, len_samples, fs));
-
-    // k * x -> x
-    unscale_poly(scaled_reconstructed_poly, len_samples);
-
-    // Finally we have D(x) which evaluates to our original data at the powers of roots of unity
-    fr_t *reconstructed_poly = scaled_reconstructed_poly; // Renaming
-
-    // The evaluation polynomial for D(x) is the reconstructed data:
-    TRY(fft_fr(reconstructed_data, reconstructed_poly, false, len_samples, fs));
-
-    // Check all is well
-    for (uint64_t i = 0; i < len_samples; i++) {
-        ASSERT(fr_is_null(&samples[i]) || fr_equal(&reconstructed_data[i], &samples[i]));
-    }
-
-    free(scratch);
-    free(missing);
+    ret = recover_polys_from_samples(reconstructed_data, samples, len_samples, 1, missing, len_missing, fs, NULL);
+    c_kzg_free(missing);
 
-    return C_KZG_OK;
+    return ret;
 }
 
 #ifdef KZGTEST
@@ -294,10 +352,68 @@ void recover_random(void) {
     free_fft_settings(&fs);
 }
 
+void recover_batch(void) {
+    FFTSettings fs;
+    ThreadPool pool;
+    uint64_t rows = 5, width, len_missing = 0;
+    fr_t *poly, *data, *samples, *recovered;
+    uint64_t *missing;
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 8));
+    width = fs.max_width;
+    TEST_CHECK(C_KZG_OK == new_fr_array(&poly, width));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&data, rows * width));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&samples, rows * width));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&recovered, rows * width));
+    TEST_CHECK(C_KZG_OK == new_uint64_array(&missing, width));
+
+    for (uint64_t r = 0; r < rows; r++) {
+        for (uint64_t i = 0; i < width; i++) {
+            poly[i] = i < width / 2 ? rand_fr() : fr_zero;
+        }
+        TEST_CHECK(C_KZG_OK == fft_fr(data + r * width, poly, false, width, &fs));
+    }
+
+    // Every row is missing the same entries, whose values in the samples are ignored
+    random_missing(samples, data, width, width / 2 + 7);
+    for (uint64_t i = 0; i < width; i++) {
+        if (fr_is_null(&samples[i])) missing[len_missing++] = i;
+    }
+    for (uint64_t i = 0; i < rows * width; i++) {
+        samples[i] = fr_is_null(&samples[i % width]) ? rand_fr() : data[i];
+    }
+
+    for (unsigned int threads = 1; threads <= 3; threads += 2) {
+        TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, threads));
+        TEST_CHECK(C_KZG_OK ==
+                   recover_polys_from_samples(recovered, samples, width, rows, missing, len_missing, &fs, &pool));
+        for (uint64_t i = 0; i < rows * width; i++) {
+            TEST_CHECK(fr_equal(&data[i], &recovered[i]));
+            TEST_MSG("Mismatch with %u threads at row %lu, index %lu", threads, i / width, i % width);
+        }
+        free_thread_pool(&pool);
+    }
+
+    // Too many missing, or a missing index out of range
+    TEST_CHECK(C_KZG_BADARGS ==
+               recover_polys_from_samples(recovered, samples, width, rows, missing, width / 2 + 1, &fs, NULL));
+    missing[0] = width;
+    TEST_CHECK(C_KZG_BADARGS ==
+               recover_polys_from_samples(recovered, samples, width, rows, missing, len_missing, &fs, NULL));
+
+    free(poly);
+    free(data);
+    free(samples);
+    free(recovered);
+    free(missing);
+    free_fft_settings(&fs);
+}
+
 TEST_LIST = {
     {"RECOVER_TEST", title},
     {"recover_simple", recover_simple},
     {"recover_random", recover_random},
+    {"recover_batch", recover_batch},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
@@ -22,10 +22,9 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration.
+bench_result run_bench(int scale, int max_seconds) {
+    bench_t bench;
     FFTSettings fs;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
@@ -55,31 +54,168 @@ long run_bench(int scale, int max_seconds) {
     }
 
     fr_t *recovered = malloc(fs.max_width * sizeof(fr_t));
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
         assert(C_KZG_OK == recover_poly_from_samples(recovered, samples, fs.max_width, &fs));
-        clock_gettime(CLOCK_REALTIME, &t1);
+        bench_stop(&bench);
 
         // Verify the result is correct
         for (int i = 0; i < fs.max_width; i++) {
             assert(fr_equal(&data[i], &recovered[i]));
         }
+    }
+
+    free(recovered);
+    free(samples);
+    free(data);
+    free(poly);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, 1, ((uint64_t)1 << scale) * sizeof(fr_t));
+}
 
-        nits++;
-        total_time += tdiff(t0, t1);
+// Run the benchmark of recovering `rows` rows with a shared erasure pattern for `max_seconds` and return the timings per
+// row. If `pool` is non-NULL then the rows are recovered in parallel using it.
+bench_result run_batch_bench(int scale, int max_seconds, uint64_t rows, const ThreadPool *pool) {
+    bench_t bench;
+    FFTSettings fs;
+    uint64_t len_missing = 0;
+
+    assert(C_KZG_OK == new_fft_settings(&fs, scale));
+
+    // Each row is the extension of a different polynomial
+    fr_t *poly = malloc(fs.max_width * sizeof(fr_t));
+    fr_t *data = malloc(rows * fs.max_width * sizeof(fr_t));
+    for (uint64_t r = 0; r < rows; r++) {
+        for (int i = 0; i < fs.max_width; i++) {
+            poly[i] = i < fs.max_width / 2 ? rand_fr() : fr_zero;
+        }
+        assert(C_KZG_OK == fft_fr(data + r * fs.max_width, poly, false, fs.max_width, &fs));
+    }
+
+    // The same half of the points are missing from every row
+    bool *is_missing = calloc(fs.max_width, sizeof(bool));
+    uint64_t *missing = malloc(fs.max_width / 2 * sizeof(uint64_t));
+    while (len_missing < fs.max_width / 2) {
+        int j = rand() % fs.max_width;
+        if (!is_missing[j]) {
+            is_missing[j] = true;
+            missing[len_missing++] = j;
+        }
+    }
+
+    fr_t *recovered = malloc(rows * fs.max_width * sizeof(fr_t));
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        assert(C_KZG_OK == recover_polys_from_samples(recovered, data, fs.max_width, rows, missing, len_missing, &fs,
+                                                      pool));
+        bench_stop(&bench);
+
+        // Verify the result is correct
+        for (uint64_t i = 0; i < rows * fs.max_width; i++) {
+            assert(fr_equal(&data[i], &recovered[i]));
+        }
     }
 
     free(recovered);
+    free(missing);
+    free(is_missing);
+    free(data);
+    free(poly);
+    free_fft_settings(&fs);
+
+    return bench_end(&bench, rows, rows * ((uint64_t)1 << scale) * sizeof(fr_t));
+}
+
+// The samples, output and backing store of a streaming recovery, all kept in memory for the benchmark
+typedef struct {
+    const fr_t *samples;
+    fr_t *data;
+    fr_t *store;
+} stream_buffers;
+
+static C_KZG_RET copy_out(const fr_t *from, fr_t *out, uint64_t len) {
+    for (uint64_t i = 0; i < len; i++) out[i] = from[i];
+    return C_KZG_OK;
+}
+
+static C_KZG_RET read_samples(void *ctx, fr_t *out, uint64_t offset, uint64_t len) {
+    return copy_out(((stream_buffers *)ctx)->samples + offset, out, len);
+}
+
+static C_KZG_RET write_data(void *ctx, const fr_t *in, uint64_t offset, uint64_t len) {
+    return copy_out(in, ((stream_buffers *)ctx)->data + offset, len);
+}
+
+static C_KZG_RET read_store(void *ctx, fr_t *out, uint64_t offset, uint64_t len) {
+    return copy_out(((stream_buffers *)ctx)->store + offset, out, len);
+}
+
+static C_KZG_RET write_store(void *ctx, const fr_t *in, uint64_t offset, uint64_t len) {
+    return copy_out(in, ((stream_buffers *)ctx)->store + offset, len);
+}
+
+// Run the benchmark of streaming recovery with a memory budget of `budget` field elements for `max_seconds` and return
+// the timings per iteration.
+bench_result run_stream_bench(int scale, int max_seconds, uint64_t budget) {
+    bench_t bench;
+    FFTSettings fs;
+    stream_buffers bufs;
+    RecoverStream io = {read_samples, write_data, read_store, write_store, &bufs, budget};
+
+    assert(C_KZG_OK == new_fft_settings_lazy(&fs, scale));
+    uint64_t width = fs.max_width;
+
+    fr_t *poly = malloc(width * sizeof(fr_t));
+    for (uint64_t i = 0; i < width; i++) {
+        poly[i] = i < width / 2 ? rand_fr() : fr_zero;
+    }
+    fr_t *data = malloc(width * sizeof(fr_t));
+    assert(C_KZG_OK == fft_fr(data, poly, false, width, &fs));
+
+    // Randomly remove half of the points
+    fr_t *samples = malloc(width * sizeof(fr_t));
+    for (uint64_t i = 0; i < width; i++) {
+        samples[i] = data[i];
+    }
+    for (uint64_t i = 0; i < width / 2; i++) {
+        int j = rand() % width;
+        while (fr_is_null(&samples[j])) j = rand() % width;
+        samples[j] = fr_null;
+    }
+
+    bufs.samples = samples;
+    bufs.data = malloc(width * sizeof(fr_t));
+    bufs.store = malloc(3 * width * sizeof(fr_t));
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
+        assert(C_KZG_OK == recover_poly_from_samples_streaming(&io, width, &fs));
+        bench_stop(&bench);
+
+        // Verify the result is correct
+        for (uint64_t i = 0; i < width; i++) {
+            assert(fr_equal(&data[i], &bufs.data[i]));
+        }
+    }
+
+    free(bufs.store);
+    free(bufs.data);
     free(samples);
     free(data);
     free(poly);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, width * sizeof(fr_t));
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
     case 1:
@@ -93,14 +229,34 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking Recover From Samples, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    bench_note("*** Benchmarking Recover From Samples, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    for (int scale = 5; scale <= 15; scale++) {
+        bench_report(run_bench(scale, nsec), "recover/scale_%d", scale);
+    }
+
+    // Per row, for 32 rows sharing one erasure pattern
+    for (int scale = 5; scale <= 13; scale++) {
+        bench_report(run_batch_bench(scale, nsec, 32, NULL), "recover_batch_32/scale_%d", scale);
+    }
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 5; scale <= 13; scale++) {
+        bench_report(run_batch_bench(scale, nsec, 32, &pool), "recover_batch_32_threaded/scale_%d", scale);
+    }
+    free_thread_pool(&pool);
+
+    // Memory budgets of 2^10 and 2^14 field elements, with the backing store in memory too. The smaller budget
+    // supports widths of up to 2^14.
+    for (int scale = 5; scale <= 14; scale++) {
+        bench_report(run_stream_bench(scale, nsec, 1024), "recover_streaming_budget_1024/scale_%d", scale);
+    }
     for (int scale = 5; scale <= 15; scale++) {
-        printf("recover/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+        bench_report(run_stream_bench(scale, nsec, 16384), "recover_streaming_budget_16384/scale_%d", scale);
     }
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }
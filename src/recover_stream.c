@@ -0,0 +1,721 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ *  @file recover_stream.c
+ *
+ * Recover polynomials from samples with a bounded amount of memory.
+ *
+ * The algorithm is that of #recover_poly_from_samples, but every array the size of the data lives in a backing store
+ * supplied by the caller, and is visited a block at a time. The FFTs use the four-step decomposition: a width `n`
+ * transform is done as `n1` transforms of length `n2` down the columns of an `n2 x n1` matrix, a "twiddle" by powers
+ * of the `n`-th root of unity, and `n2` transforms of length `n1` along the rows.
+ *
+ * Doing the steps in that order leaves the output in transposed order, and doing them in the reverse order takes
+ * transposed input to natural output. So each round trip through coefficient form starts with the first kind and ends
+ * with the second, and nothing is ever explicitly transposed: the coefficients are only scaled, which is easily done in
+ * either order.
+ */
+
+#include "control.h"
+#include "c_kzg_alloc.h"
+#include "utility.h"
+
+/** As in recover.c: anything not 0 or a low-degree root of unity will do */
+#define SCALE_FACTOR 5
+
+/** The number of points multiplied together directly at each leaf when building zero polynomials */
+#define STREAM_ZERO_LEAF 64
+
+/** The regions of the backing store, each `n` field elements long */
+enum {
+    REGION_WORK,        /**< The data being transformed */
+    REGION_ZERO_EVAL,   /**< The evaluations of the zero polynomial */
+    REGION_SCALED_ZERO, /**< The evaluations of the scaled zero polynomial */
+};
+
+/**
+ * The state of a streaming recovery.
+ */
+typedef struct {
+    const RecoverStream *io; /**< The caller's callbacks */
+    const FFTSettings *fs;   /**< The FFT settings, used for transforms of length `n1` and `n2` */
+    uint64_t n;              /**< The width of the data */
+    uint64_t n1;             /**< The length of a row of the matrix */
+    uint64_t n2;             /**< The number of rows of the matrix */
+    fr_t root;               /**< A primitive `n`-th root of unity */
+    fr_t inv_root;           /**< Its inverse */
+    uint64_t len_block;      /**< The length of each block buffer */
+    fr_t *block;             /**< A block of data read from the store */
+    fr_t *block2;            /**< A second block, for point-wise operations between regions */
+    fr_t *vec;               /**< Two vectors of length `n1`, at least `n2`, for the individual FFTs */
+    uint64_t len_scan;       /**< The length of @p scan */
+    fr_t *scan;              /**< A block of samples being scanned for missing values */
+    uint64_t max_points;     /**< The number of roots the partial zero polynomials are built from at once */
+    fr_t *points;            /**< The roots of the partial zero polynomial being collected */
+    fr_t *zero_poly;         /**< Its coefficients, length `max_points + 1` */
+    uint64_t max_leaves;     /**< The number of leaves of the product tree for `max_points` roots */
+    poly *tree;              /**< Two levels of the product tree, `max_leaves` polynomials each */
+    fr_t *tree_coeffs;       /**< Their coefficients, `max_points + max_leaves` for each level */
+    uint64_t len_mul;        /**< The longest product in the tree, rounded up to a power of two */
+    fr_t *mul;               /**< Three vectors of length `len_mul`, for multiplying by FFTs */
+} stream_state;
+
+/**
+ * Read a run of a region of the backing store.
+ */
+static C_KZG_RET load(const stream_state *s, fr_t *out, int region, uint64_t offset, uint64_t len) {
+    return s->io->read_store(s->io->ctx, out, region * s->n + offset, len);
+}
+
+/**
+ * Write a run of a region of the backing store.
+ */
+static C_KZG_RET store(const stream_state *s, const fr_t *in, int region, uint64_t offset, uint64_t len) {
+    return s->io->write_store(s->io->ctx, in, region * s->n + offset, len);
+}
+
+/**
+ * Do the length `n1` FFTs along the rows held in `s->block`.
+ *
+ * @param[in] s       The recovery state
+ * @param[in] r0      The index of the first row in the block
+ * @param[in] rows    The number of rows in the block
+ * @param[in] inverse True for inverse FFTs
+ * @param[in] twiddle If true, afterwards multiply the element at row `r` and column `c` by `w^(r * c)`, where `w` is
+ *                    the `n`-th root of unity for the direction of the transform
+ * @retval C_CZK_OK    All is well
+ * @retval C_CZK_ERROR An FFT failed
+ */
+static C_KZG_RET fft_block_rows(const stream_state *s, uint64_t r0, uint64_t rows, bool inverse, bool twiddle) {
+    const fr_t *w = inverse ? &s->inv_root : &s->root;
+
+    for (uint64_t r = 0; r < rows; r++) {
+        fr_t *row = s->block + r * s->n1;
+        TRY(fft_fr(s->vec, row, inverse, s->n1, s->fs));
+        for (uint64_t c = 0; c < s->n1; c++) {
+            row[c] = s->vec[c];
+        }
+        if (twiddle) {
+            fr_t base;
+            fr_pow(&base, w, r0 + r);
+            fr_mul_powers_vec(row, row, &base, s->n1);
+        }
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * Do the length `n1` FFTs along each row of the work region, in place.
+ *
+ * @param[in] s       The recovery state
+ * @param[in] inverse True for inverse FFTs
+ * @param[in] twiddle As for #fft_block_rows
+ * @retval C_CZK_OK    All is well
+ * @retval C_CZK_ERROR A callback or an FFT failed
+ */
+static C_KZG_RET stream_rows(const stream_state *s, bool inverse, bool twiddle) {
+    uint64_t rows_per_block = s->len_block / s->n1;
+
+    for (uint64_t r0 = 0; r0 < s->n2; r0 += rows_per_block) {
+        uint64_t rows = min_u64(rows_per_block, s->n2 - r0);
+        TRY(load(s, s->block, REGION_WORK, r0 * s->n1, rows * s->n1));
+        TRY(fft_block_rows(s, r0, rows, inverse, twiddle));
+        TRY(store(s, s->block, REGION_WORK, r0 * s->n1, rows * s->n1));
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * Do the length `n2` FFTs down each column of a region of the store.
+ *
+ * Columns are processed in groups as wide as fit in a block: each row of the group is a contiguous run in the store.
+ *
+ * @param[in] s        The recovery state
+ * @param[in] from     The region to transform
+ * @param[in] to       The region for the results, which may be the same as @p from
+ * @param[in] multiply If true, multiply the results into the contents of @p to rather than overwriting them
+ * @param[in] inverse  True for inverse FFTs
+ * @param[in] twiddle  As for #fft_block_rows
+ * @retval C_CZK_OK    All is well
+ * @retval C_CZK_ERROR A callback or an FFT failed
+ */
+static C_KZG_RET stream_columns(const stream_state *s, int from, int to, bool multiply, bool inverse, bool twiddle) {
+    uint64_t width = min_u64(s->len_block / s->n2, s->n1);
+    fr_t *col_in = s->vec, *col_out = s->vec + s->n1;
+    const fr_t *w = inverse ? &s->inv_root : &s->root;
+
+    for (uint64_t c0 = 0; c0 < s->n1; c0 += width) {
+        uint64_t cols = min_u64(width, s->n1 - c0);
+        for (uint64_t r = 0; r < s->n2; r++) {
+            TRY(load(s, s->block + r * cols, from, r * s->n1 + c0, cols));
+            if (multiply) TRY(load(s, s->block2 + r * cols, to, r * s->n1 + c0, cols));
+        }
+        for (uint64_t c = 0; c < cols; c++) {
+            for (uint64_t r = 0; r < s->n2; r++) {
+                col_in[r] = s->block[r * cols + c];
+            }
+            TRY(fft_fr(col_out, col_in, inverse, s->n2, s->fs));
+            if (twiddle) {
+                fr_t base;
+                fr_pow(&base, w, c0 + c);
+                fr_mul_powers_vec(col_out, col_out, &base, s->n2);
+            }
+            for (uint64_t r = 0; r < s->n2; r++) {
+                if (multiply) {
+                    fr_mul(&s->block[r * cols + c], &col_out[r], &s->block2[r * cols + c]);
+                } else {
+                    s->block[r * cols + c] = col_out[r];
+                }
+            }
+        }
+        for (uint64_t r = 0; r < s->n2; r++) {
+            TRY(store(s, s->block + r * cols, to, r * s->n1 + c0, cols));
+        }
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * FFT a region of the store from natural order into transposed order in the work region.
+ *
+ * On return, the element with index `n2 * k1 + k2` is at position `k1 + n1 * k2`.
+ */
+static C_KZG_RET stream_fft_to_transposed(const stream_state *s, int from, bool inverse) {
+    TRY(stream_columns(s, from, REGION_WORK, false, inverse, true));
+    TRY(stream_rows(s, inverse, false));
+    return C_KZG_OK;
+}
+
+/**
+ * FFT the work region from transposed order, as left by #stream_fft_to_transposed, into natural order in a region
+ * of the store, overwriting it or multiplying into it as for #stream_columns.
+ */
+static C_KZG_RET stream_fft_to_natural(const stream_state *s, int to, bool multiply, bool inverse) {
+    TRY(stream_rows(s, inverse, true));
+    TRY(stream_columns(s, REGION_WORK, to, multiply, inverse, false));
+    return C_KZG_OK;
+}
+
+/**
+ * Multiply the coefficients in the work region, held in transposed order, by `factor^i` for the `i`-th coefficient.
+ */
+static C_KZG_RET stream_scale_transposed(const stream_state *s, const fr_t *factor) {
+    uint64_t rows_per_block = s->len_block / s->n1;
+    fr_t step;
+
+    // Along row `k2` the coefficients are `k2, k2 + n2, k2 + 2 * n2, ...`
+    fr_pow(&step, factor, s->n2);
+    for (uint64_t r0 = 0; r0 < s->n2; r0 += rows_per_block) {
+        uint64_t rows = min_u64(rows_per_block, s->n2 - r0);
+        TRY(load(s, s->block, REGION_WORK, r0 * s->n1, rows * s->n1));
+        for (uint64_t r = 0; r < rows; r++) {
+            fr_t *row = s->block + r * s->n1;
+            fr_t start;
+            fr_pow(&start, factor, r0 + r);
+            fr_mul_powers_vec(row, row, &step, s->n1);
+            fr_scale_vec(row, row, &start, s->n1);
+        }
+        TRY(store(s, s->block, REGION_WORK, r0 * s->n1, rows * s->n1));
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * Fill a region of the store with a constant.
+ */
+static C_KZG_RET stream_fill(const stream_state *s, int region, const fr_t *value) {
+    for (uint64_t i = 0; i < s->len_block; i++) {
+        s->block[i] = *value;
+    }
+    for (uint64_t i = 0; i < s->n; i += s->len_block) {
+        TRY(store(s, s->block, region, i, min_u64(s->len_block, s->n - i)));
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * Multiply two polynomials of the product tree by FFTs, using only the buffers in the state.
+ *
+ * @param[in]  s   The recovery state
+ * @param[out] out The product, whose length must be that of the full product
+ * @param[in]  a   The multiplicand
+ * @param[in]  b   The multiplier
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+static C_KZG_RET stream_poly_mul(const stream_state *s, poly *out, const poly *a, const poly *b) {
+    uint64_t len = next_power_of_two(out->length);
+    fr_t *pad = s->mul, *a_fft = s->mul + len, *b_fft = s->mul + 2 * len;
+
+    ASSERT(len <= s->len_mul);
+
+    for (uint64_t i = 0; i < len; i++) {
+        pad[i] = i < a->length ? a->coeffs[i] : fr_zero;
+    }
+    TRY(fft_fr(a_fft, pad, false, len, s->fs));
+    for (uint64_t i = 0; i < len; i++) {
+        pad[i] = i < b->length ? b->coeffs[i] : fr_zero;
+    }
+    TRY(fft_fr(b_fft, pad, false, len, s->fs));
+    fr_mul_vec(a_fft, a_fft, b_fft, len);
+    TRY(fft_fr(pad, a_fft, true, len, s->fs));
+
+    for (uint64_t i = 0; i < out->length; i++) {
+        out->coeffs[i] = pad[i];
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Calculate the coefficients of the polynomial whose roots are @p points, by a product tree.
+ *
+ * No memory is allocated: the tree is built in the buffers of the state.
+ *
+ * @param[in]  s      The recovery state
+ * @param[out] out    The coefficients of the monic polynomial, length @p len + 1
+ * @param[in]  points The roots, length @p len, at least one and at most `s->max_points`
+ * @param[in]  len    The number of roots
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
+ */
+static C_KZG_RET poly_from_roots(const stream_state *s, fr_t *out, const fr_t *points, uint64_t len) {
+    uint64_t count = (len + STREAM_ZERO_LEAF - 1) / STREAM_ZERO_LEAF, pos = 0;
+    poly *a = s->tree, *b = s->tree + s->max_leaves, *swap_p;
+    fr_t *coeffs_a = s->tree_coeffs, *coeffs_b = s->tree_coeffs + s->max_points + s->max_leaves, *swap_c;
+
+    ASSERT(count <= s->max_leaves);
+
+    // The leaves: multiply in each `(x - p)` directly
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t first = i * STREAM_ZERO_LEAF, m = min_u64(STREAM_ZERO_LEAF, len - first);
+        fr_t *c = coeffs_a + pos;
+        c[0] = fr_one;
+        for (uint64_t j = 0; j < m; j++) {
+            fr_t tmp;
+            c[j + 1] = c[j];
+            for (uint64_t k = j; k > 0; k--) {
+                fr_mul(&tmp, &c[k], &points[first + j]);
+                fr_sub(&c[k], &c[k - 1], &tmp);
+            }
+            fr_mul(&c[0], &c[0], &points[first + j]);
+            fr_negate(&c[0], &c[0]);
+        }
+        a[i].coeffs = c;
+        a[i].length = m + 1;
+        pos += m + 1;
+    }
+
+    // Multiply pairs together until one remains
+    while (count > 1) {
+        pos = 0;
+        for (uint64_t i = 0; i < (count + 1) / 2; i++) {
+            b[i].coeffs = coeffs_b + pos;
+            if (2 * i + 1 < count) {
+                b[i].length = a[2 * i].length + a[2 * i + 1].length - 1;
+                TRY(stream_poly_mul(s, &b[i], &a[2 * i], &a[2 * i + 1]));
+            } else {
+                b[i].length = a[2 * i].length;
+                for (uint64_t j = 0; j < b[i].length; j++) {
+                    b[i].coeffs[j] = a[2 * i].coeffs[j];
+                }
+            }
+            pos += b[i].length;
+        }
+        swap_p = a, a = b, b = swap_p;
+        swap_c = coeffs_a, coeffs_a = coeffs_b, coeffs_b = swap_c;
+        count = (count + 1) / 2;
+    }
+
+    for (uint64_t i = 0; i <= len; i++) {
+        out[i] = a[0].coeffs[i];
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Fold the roots collected so far into the evaluations of the zero polynomial.
+ *
+ * The partial zero polynomial is evaluated over the whole domain and multiplied in. It has so few coefficients that
+ * they are laid out in transposed order straight from memory, and its evaluations are never stored themselves.
+ *
+ * @param[in] s     The recovery state
+ * @param[in] count The number of roots in `s->points`
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET stream_flush_points(const stream_state *s, uint64_t count) {
+    uint64_t rows_per_block = s->len_block / s->n1;
+
+    if (count == 0) return C_KZG_OK;
+
+    TRY(poly_from_roots(s, s->zero_poly, s->points, count));
+    for (uint64_t r0 = 0; r0 < s->n2; r0 += rows_per_block) {
+        uint64_t rows = min_u64(rows_per_block, s->n2 - r0);
+        for (uint64_t r = 0; r < rows; r++) {
+            for (uint64_t c = 0; c < s->n1; c++) {
+                uint64_t i = c * s->n2 + r0 + r;
+                s->block[r * s->n1 + c] = i <= count ? s->zero_poly[i] : fr_zero;
+            }
+        }
+        TRY(fft_block_rows(s, r0, rows, false, true));
+        TRY(store(s, s->block, REGION_WORK, r0 * s->n1, rows * s->n1));
+    }
+    TRY(stream_columns(s, REGION_WORK, REGION_ZERO_EVAL, true, false, false));
+
+    return C_KZG_OK;
+}
+
+/**
+ * Run the recovery, given the allocated state.
+ *
+ * @param[in] s The recovery state
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS More than half of the samples are missing
+ * @retval C_CZK_ERROR   An internal error occurred, or a callback failed
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET stream_recover(const stream_state *s) {
+    const RecoverStream *io = s->io;
+    uint64_t len_missing = 0, count = 0;
+    fr_t scale_factor, inv_factor;
+
+    fr_from_uint64(&scale_factor, SCALE_FACTOR);
+    fr_inv(&inv_factor, &scale_factor);
+
+    // The zero polynomial's evaluations are the product of those of one partial for each `max_points` missing indices
+    TRY(stream_fill(s, REGION_ZERO_EVAL, &fr_one));
+    for (uint64_t i = 0; i < s->n; i += s->len_scan) {
+        uint64_t m = min_u64(s->len_scan, s->n - i);
+        TRY(io->read_samples(io->ctx, s->scan, i, m));
+        for (uint64_t j = 0; j < m; j++) {
+            if (!fr_is_null(&s->scan[j])) continue;
+            CHECK(++len_missing <= s->n / 2);
+            fr_pow(&s->points[count++], &s->root, i + j);
+            if (count == s->max_points) {
+                TRY(stream_flush_points(s, count));
+                count = 0;
+            }
+        }
+    }
+    TRY(stream_flush_points(s, count));
+
+    // Its degree is less than `n`, so its coefficients can be had back to evaluate Q2 = Z_r,I(k * x)
+    TRY(stream_fft_to_transposed(s, REGION_ZERO_EVAL, true));
+    TRY(stream_scale_transposed(s, &inv_factor));
+    TRY(stream_fft_to_natural(s, REGION_SCALED_ZERO, false, false));
+
+    // Construct E * Z_r,I, then inverse FFT to get (D * Z_r,I)(x) in transposed order
+    for (uint64_t i = 0; i < s->n; i += s->len_block) {
+        uint64_t m = min_u64(s->len_block, s->n - i);
+        TRY(io->read_samples(io->ctx, s->block, i, m));
+        TRY(load(s, s->block2, REGION_ZERO_EVAL, i, m));
+        for (uint64_t j = 0; j < m; j++) {
+            if (fr_is_zero(&s->block2[j])) {
+                s->block[j] = fr_zero;
+            } else {
+                fr_mul(&s->block[j], &s->block[j], &s->block2[j]);
+            }
+        }
+        TRY(store(s, s->block, REGION_WORK, i, m));
+    }
+    TRY(stream_fft_to_transposed(s, REGION_WORK, true));
+
+    // x -> k * x, and evaluate: Q1 = (D * Z_r,I)(k * x)
+    TRY(stream_scale_transposed(s, &inv_factor));
+    TRY(stream_fft_to_natural(s, REGION_WORK, false, false));
+
+    // Divide by Q2 = Z_r,I(k * x) point-wise, inverting each block of its evaluations together
+    for (uint64_t i = 0; i < s->n; i += s->len_block) {
+        uint64_t m = min_u64(s->len_block, s->n - i);
+        TRY(load(s, s->block, REGION_WORK, i, m));
+        TRY(load(s, s->block2, REGION_SCALED_ZERO, i, m));
+        fr_batch_inv(s->scan, s->block2, m);
+        fr_mul_vec(s->block, s->block, s->scan, m);
+        TRY(store(s, s->block, REGION_WORK, i, m));
+    }
+
+    // Back to coefficients, giving D(k * x); then k * x -> x and evaluate D(x)
+    TRY(stream_fft_to_transposed(s, REGION_WORK, true));
+    TRY(stream_scale_transposed(s, &scale_factor));
+    TRY(stream_fft_to_natural(s, REGION_WORK, false, false));
+
+    // Hand back the result, checking that it matches the samples that were present
+    for (uint64_t i = 0; i < s->n; i += s->len_block) {
+        uint64_t m = min_u64(s->len_block, s->n - i);
+        TRY(load(s, s->block, REGION_WORK, i, m));
+        TRY(io->read_samples(io->ctx, s->scan, i, m));
+        for (uint64_t j = 0; j < m; j++) {
+            ASSERT(fr_is_null(&s->scan[j]) || fr_equal(&s->block[j], &s->scan[j]));
+        }
+        TRY(io->write_data(io->ctx, s->block, i, m));
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Given a dataset with up to half the entries missing, reconstruct the original without holding it in memory.
+ *
+ * Gives the same result as #recover_poly_from_samples, but the samples are read in, and the reconstructed data
+ * written out, a block at a time through the callbacks in @p io. Intermediate results are kept in the caller's backing
+ * store of `3 * len_samples` field elements. All the memory used here, including for building the zero polynomial, is
+ * allocated at the start and is within `io->budget` field elements. The FFT settings' root tables are not counted:
+ * transforms are done of lengths up to the square root of @p len_samples for the data, and up to `io->budget / 16`
+ * for the zero polynomial.
+ *
+ * Each FFT takes two passes over the store, and a recovery about twenty in all. The zero polynomial is built in parts
+ * from `io->budget / 32` missing samples at a time, and each part costs two more passes, so a larger budget also means
+ * less work.
+ *
+ * @remark A callback that fails stops the recovery. As with internal failures, #C_KZG_MALLOC is passed back as it is,
+ * and any other error is reported as #C_KZG_ERROR.
+ *
+ * @param[in] io          The callbacks and memory budget. The budget must be at least 64 field elements, and
+ *                        @p len_samples at most `(io->budget / 8)^2`.
+ * @param[in] len_samples The length of the data, a power of two
+ * @param[in] fs          FFT settings with a maximum width of at least @p len_samples. Only transforms of lengths up to
+ *                        the square root of @p len_samples and `io->budget / 16` are done, so settings from
+ *                        #new_fft_settings_lazy avoid any tables of the full width.
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied, or more than half the samples are missing
+ * @retval C_CZK_ERROR   An internal error occurred, or a callback failed
+ * @retval C_CZK_MALLOC  Memory allocation failed, or a callback reported that it had
+ */
+C_KZG_RET recover_poly_from_samples_streaming(const RecoverStream *io, uint64_t len_samples, const FFTSettings *fs) {
+    STAT_SCOPE(RECOVER_POLY_FROM_SAMPLES_STREAMING);
+    stream_state s;
+    int scale;
+    C_KZG_RET ret;
+
+    CHECK(is_power_of_two(len_samples));
+    CHECK(len_samples <= fs->max_width);
+    CHECK(io->budget >= 64);
+
+    scale = log2_u64(len_samples);
+    s.io = io;
+    s.fs = fs;
+    s.n = len_samples;
+    s.n1 = (uint64_t)1 << (scale - scale / 2);
+    s.n2 = (uint64_t)1 << (scale / 2);
+
+    // Blocks take an eighth of the budget each, the FFT vectors up to another two, and the samples being scanned one
+    // more. What remains is for building the partial zero polynomials: the roots and the result, two levels of the
+    // product tree, and three vectors of up to twice the number of roots for multiplying, ten times the roots in all.
+    // Since no more than half the samples may be missing, there is no use in building from more roots than that.
+    s.len_block = io->budget / 8;
+    s.len_scan = io->budget / 8;
+    s.max_points = min_u64(io->budget / 32, max_u64(s.n / 2, 1));
+    s.max_leaves = (s.max_points + STREAM_ZERO_LEAF - 1) / STREAM_ZERO_LEAF;
+    s.len_mul = next_power_of_two(s.max_points + 1);
+    CHECK(s.n1 <= s.len_block);
+
+    fr_pow(&s.root, &fs->root_of_unity, fs->max_width / len_samples);
+    fr_inv(&s.inv_root, &s.root);
+
+    s.block = NULL;
+    s.block2 = NULL;
+    s.vec = NULL;
+    s.scan = NULL;
+    s.points = NULL;
+    s.zero_poly = NULL;
+    s.tree = NULL;
+    s.tree_coeffs = NULL;
+    s.mul = NULL;
+
+    ret = new_fr_array(&s.block, s.len_block);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.block2, s.len_block);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.vec, 2 * s.n1);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.scan, s.len_scan);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.points, s.max_points);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.zero_poly, s.max_points + 1);
+    if (ret == C_KZG_OK) ret = new_poly_array(&s.tree, 2 * s.max_leaves);
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.tree_coeffs, 2 * (s.max_points + s.max_leaves));
+    if (ret == C_KZG_OK) ret = new_fr_array(&s.mul, 3 * s.len_mul);
+    if (ret == C_KZG_OK) ret = stream_recover(&s);
+
+    c_kzg_free(s.block);
+    c_kzg_free(s.block2);
+    c_kzg_free(s.vec);
+    c_kzg_free(s.scan);
+    c_kzg_free(s.points);
+    c_kzg_free(s.zero_poly);
+    c_kzg_free(s.tree);
+    c_kzg_free(s.tree_coeffs);
+    c_kzg_free(s.mul);
+
+    return ret;
+}
+
+#ifdef KZGTEST
+
+#include "../inc/acutest.h"
+#include "test_util.h"
+
+// Everything held in memory, to check against the in-memory recovery
+typedef struct {
+    const fr_t *samples;
+    fr_t *data;
+    fr_t *store;
+    uint64_t fail_after; // Fail the store writes after this many, if non-zero
+    C_KZG_RET fail_with; // The error for the failed writes
+    uint64_t writes;
+} memory_stream;
+
+static C_KZG_RET read_samples(void *ctx, fr_t *out, uint64_t offset, uint64_t len) {
+    const memory_stream *m = ctx;
+    for (uint64_t i = 0; i < len; i++) out[i] = m->samples[offset + i];
+    return C_KZG_OK;
+}
+
+static C_KZG_RET write_data(void *ctx, const fr_t *in, uint64_t offset, uint64_t len) {
+    memory_stream *m = ctx;
+    for (uint64_t i = 0; i < len; i++) m->data[offset + i] = in[i];
+    return C_KZG_OK;
+}
+
+static C_KZG_RET read_store(void *ctx, fr_t *out, uint64_t offset, uint64_t len) {
+    const memory_stream *m = ctx;
+    for (uint64_t i = 0; i < len; i++) out[i] = m->store[offset + i];
+    return C_KZG_OK;
+}
+
+static C_KZG_RET write_store(void *ctx, const fr_t *in, uint64_t offset, uint64_t len) {
+    memory_stream *m = ctx;
+    if (m->fail_after && ++m->writes > m->fail_after) return m->fail_with;
+    for (uint64_t i = 0; i < len; i++) m->store[offset + i] = in[i];
+    return C_KZG_OK;
+}
+
+void recover_streaming_matches(void) {
+    FFTSettings fs;
+    memory_stream m;
+    RecoverStream io = {read_samples, write_data, read_store, write_store, &m, 0};
+    uint64_t budgets[] = {64, 256, 4096};
+    Arena arena;
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings_lazy(&fs, 12));
+    TEST_CHECK(C_KZG_OK == new_arena(&arena, 4096 * sizeof(fr_t) * 2));
+
+    for (int scale = 1; scale <= 10; scale++) {
+        uint64_t width = (uint64_t)1 << scale;
+        fr_t *poly, *data, *samples, *expected, *recovered, *backing;
+        TEST_CHECK(C_KZG_OK == new_fr_array(&poly, width));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&data, width));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&samples, width));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&expected, width));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&recovered, width));
+        TEST_CHECK(C_KZG_OK == new_fr_array(&backing, 3 * width));
+
+        for (uint64_t i = 0; i < width; i++) {
+            poly[i] = i < width / 2 ? rand_fr() : fr_zero;
+        }
+        TEST_CHECK(C_KZG_OK == fft_fr(data, poly, false, width, &fs));
+        for (uint64_t i = 0; i < width; i++) {
+            samples[i] = rand() % 2 ? fr_null : data[i];
+        }
+        // No more than half missing
+        for (uint64_t i = 0, missing = 0; i < width; i++) {
+            if (fr_is_null(&samples[i]) && ++missing > width / 2) samples[i] = data[i];
+        }
+        TEST_CHECK(C_KZG_OK == recover_poly_from_samples(expected, samples, width, &fs));
+
+        for (int b = 0; b < sizeof budgets / sizeof budgets[0]; b++) {
+            if (width > (budgets[b] / 8) * (budgets[b] / 8)) continue;
+            m.samples = samples, m.data = recovered, m.store = backing, m.fail_after = 0;
+            io.budget = budgets[b];
+
+            // Everything is allocated from the budget, allowing for the alignment of each allocation in the arena
+            arena_reset(&arena);
+            arena.peak = 0;
+            arena_begin(&arena);
+            TEST_CHECK(C_KZG_OK == recover_poly_from_samples_streaming(&io, width, &fs));
+            arena_end(&arena);
+            TEST_CHECK(arena.overflows == 0);
+            TEST_CHECK(arena.peak <= budgets[b] * sizeof(fr_t) + 16 * ARENA_ALIGN);
+            TEST_MSG("Used %zu bytes at width %lu with budget %lu", arena.peak, width, budgets[b]);
+
+            for (uint64_t i = 0; i < width; i++) {
+                TEST_CHECK(fr_equal(&expected[i], &recovered[i]));
+            }
+            TEST_MSG("Mismatch at width %lu with budget %lu", width, budgets[b]);
+        }
+
+        free(poly);
+        free(data);
+        free(samples);
+        free(expected);
+        free(recovered);
+        free(backing);
+    }
+
+    free_arena(&arena);
+    free_fft_settings(&fs);
+}
+
+void recover_streaming_fails(void) {
+    FFTSettings fs;
+    memory_stream m;
+    RecoverStream io = {read_samples, write_data, read_store, write_store, &m, 64};
+    fr_t samples[128], data[128], backing[3 * 128];
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 7));
+    for (int i = 0; i < 128; i++) {
+        fr_from_uint64(&samples[i], i);
+    }
+    m.samples = samples, m.data = data, m.store = backing, m.fail_after = 0;
+
+#ifndef DEBUG
+    // The width is too large for the budget
+    TEST_CHECK(C_KZG_BADARGS == recover_poly_from_samples_streaming(&io, 128, &fs));
+    io.budget = 32;
+    TEST_CHECK(C_KZG_BADARGS == recover_poly_from_samples_streaming(&io, 64, &fs));
+    io.budget = 256;
+    TEST_CHECK(C_KZG_BADARGS == recover_poly_from_samples_streaming(&io, 100, &fs));
+
+    // Too many missing
+    for (int i = 0; i < 65; i++) {
+        samples[i] = fr_null;
+    }
+    TEST_CHECK(C_KZG_BADARGS == recover_poly_from_samples_streaming(&io, 128, &fs));
+
+    // Failing callbacks
+    samples[0] = fr_zero;
+    m.fail_after = 5;
+    m.fail_with = C_KZG_BADARGS;
+    m.writes = 0;
+    TEST_CHECK(C_KZG_ERROR == recover_poly_from_samples_streaming(&io, 128, &fs));
+    m.fail_with = C_KZG_MALLOC;
+    m.writes = 0;
+    TEST_CHECK(C_KZG_MALLOC == recover_poly_from_samples_streaming(&io, 128, &fs));
+#endif
+
+    free_fft_settings(&fs);
+}
+
+TEST_LIST = {
+    {"RECOVER_STREAM_TEST", title},
+    {"recover_streaming_matches", recover_streaming_matches},
+    {"recover_streaming_fails", recover_streaming_fails},
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file stats.c
+ *
+ * Counting the expensive operations and timing the main calls.
+ *
+ * In a library built with `KZG_STATS` defined, the `STAT_` macros in control.h record G1 multiplications, field
+ * inversions, pairings, FFTs, multi-scalar multiplications and allocations, and time the main API calls. Read them
+ * with #kzg_stats, or have each timed call reported as it finishes to a function set with #kzg_set_stats_hook. In the
+ * default build the macros are empty, so there is no cost, and #kzg_stats reports nothing.
+ *
+ * The counters are shared by all threads and updated atomically.
+ */
+
+#include <string.h> // memset()
+#include <time.h>   // clock_gettime()
+#include "control.h"
+#include "c_kzg.h"
+
+/** The counters and timings, updated atomically. */
+static KZGStats stats;
+
+/** The function to be told of timed calls, or NULL. */
+static kzg_stats_hook hook = NULL;
+
+/** The context for #hook. */
+static void *hook_ctx = NULL;
+
+/** The names of the counters, in the order of #KZGStatCounter. */
+static const char *stat_names[KZG_STAT_COUNTERS] = {
+    "g1_mul",      "fr_inv", "pairings", "fft_fr", "fft_fr_points", "fft_g1", "fft_g1_points", "msm", "msm_points",
+    "alloc_count", "alloc_bytes"};
+
+/** The names of the timed calls, in the order of #KZGOp. */
+static const char *op_names[KZG_OP_COUNT] = {"fft_fr",
+                                             "fft_g1",
+                                             "g1_linear_combination",
+                                             "commit_to_poly",
+                                             "commit_to_evaluations",
+                                             "compute_proof_single",
+                                             "compute_proof_single_eval",
+                                             "compute_proof_multi",
+                                             "compute_proofs_at_points",
+                                             "check_proof_single",
+                                             "check_proof_single_batch",
+                                             "check_proof_multi",
+                                             "da_using_fk20_single",
+                                             "da_using_fk20_multi",
+                                             "da_using_fk20_multi_batch",
+                                             "recover_poly_from_samples",
+                                             "recover_poly_from_samples_streaming",
+                                             "das_extend_square"};
+
+/**
+ * Take a snapshot of the counters and timings.
+ *
+ * @param[out] out The statistics since the library was loaded or #kzg_stats_reset was last called
+ */
+void kzg_stats(KZGStats *out) {
+    const uint64_t *src = (const uint64_t *)&stats.counts;
+    uint64_t *dst = (uint64_t *)&out->counts;
+    size_t words = (sizeof *out - offsetof(KZGStats, counts)) / sizeof(uint64_t);
+
+    // After the flag, the statistics are all 64-bit counters
+    for (size_t i = 0; i < words; i++) {
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+    }
+#ifdef KZG_STATS
+    out->enabled = true;
+#else
+    out->enabled = false;
+#endif
+}
+
+/**
+ * Set all the counters and timings back to zero.
+ *
+ * @remark Calls in progress on other threads may be partly counted either side of the reset.
+ */
+void kzg_stats_reset(void) {
+    uint64_t *dst = (uint64_t *)&stats.counts;
+    size_t words = (sizeof stats - offsetof(KZGStats, counts)) / sizeof(uint64_t);
+
+    for (size_t i = 0; i < words; i++) {
+        __atomic_store_n(&dst[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Have each timed call reported as it finishes, for example to feed a metrics pipeline.
+ *
+ * The function is called on the thread that made the call, so it must be thread-safe if the library is used from more
+ * than one thread. It does nothing unless the library was built with `KZG_STATS`.
+ *
+ * @remark Set the hook before starting any work, since calls in progress may see the old or new hook.
+ *
+ * @param[in] fn  The function to call, or NULL to stop reporting
+ * @param[in] ctx Passed to @p fn
+ */
+void kzg_set_stats_hook(kzg_stats_hook fn, void *ctx) {
+    hook_ctx = ctx;
+    hook = fn;
+}
+
+/**
+ * The name of a counter, for reporting.
+ *
+ * @param[in] c The counter
+ * @return Its name in lower case, or NULL if @p c is out of range
+ */
+const char *kzg_stat_name(KZGStatCounter c) {
+    return c >= 0 && c < KZG_STAT_COUNTERS ? stat_names[c] : NULL;
+}
+
+/**
+ * The name of a timed call, for reporting.
+ *
+ * @param[in] op The call
+ * @return The name of the function, or NULL if @p op is out of range
+ */
+const char *kzg_op_name(KZGOp op) {
+    return op >= 0 && op < KZG_OP_COUNT ? op_names[op] : NULL;
+}
+
+/**
+ * The size class of @p n in the histograms of #KZGStats.
+ *
+ * @param[in] n A size
+ * @return `floor(log2(n))`, limited to the number of classes, or zero for zero
+ */
+static unsigned int size_class(uint64_t n) {
+    unsigned int c = 0;
+    while (n > 1 && c < KZG_STAT_SIZES - 1) {
+        n >>= 1;
+        c++;
+    }
+    return c;
+}
+
+/**
+ * Add to a counter, for the `STAT_COUNT` macro.
+ *
+ * @param[in] c The counter
+ * @param[in] n The amount to add
+ */
+void kzg_stat_count(KZGStatCounter c, uint64_t n) {
+    __atomic_fetch_add(&stats.counts[c], n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Count one FFT or multi-scalar multiplication of size @p n, for the `STAT_SIZED` macro.
+ *
+ * @param[in] c #KZG_STAT_FFT_FR, #KZG_STAT_FFT_G1 or #KZG_STAT_MSM. The size is added to the counter after it.
+ * @param[in] n The size
+ */
+void kzg_stat_sized(KZGStatCounter c, uint64_t n) {
+    uint64_t *sizes = c == KZG_STAT_FFT_FR ? stats.fft_fr_sizes : c == KZG_STAT_FFT_G1 ? stats.fft_g1_sizes
+                                                                                       : stats.msm_sizes;
+    __atomic_fetch_add(&stats.counts[c], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.counts[c + 1], n, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&sizes[size_class(n)], 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/**
+ * Start timing a call, for the `STAT_SCOPE` macro.
+ *
+ * @param[in] op The call
+ * @return The start of the call, to be passed to #kzg_stat_scope_end when it returns
+ */
+KZGStatScope kzg_stat_scope_begin(KZGOp op) {
+    KZGStatScope scope = {op, now_ns()};
+    return scope;
+}
+
+/**
+ * Finish timing a call, for the `STAT_SCOPE` macro, and tell the hook if one is set.
+ *
+ * @param[in] scope The start of the call from #kzg_stat_scope_begin
+ */
+void kzg_stat_scope_end(const KZGStatScope *scope) {
+    uint64_t ns = now_ns() - scope->start, max;
+    KZGOpStats *s = &stats.ops[scope->op];
+    kzg_stats_hook fn = hook;
+
+    __atomic_fetch_add(&s->calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->total_ns, ns, __ATOMIC_RELAXED);
+    max = __atomic_load_n(&s->max_ns, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&s->max_ns, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    if (fn != NULL) fn(scope->op, ns, hook_ctx);
+}
+
+#ifdef KZGTEST
+
+#include "../inc/acutest.h"
+#include "test_util.h"
+#include "c_kzg_alloc.h"
+
+void stat_names_complete(void) {
+    for (int c = 0; c < KZG_STAT_COUNTERS; c++) {
+        TEST_CHECK(kzg_stat_name(c) != NULL);
+    }
+    for (int op = 0; op < KZG_OP_COUNT; op++) {
+        TEST_CHECK(kzg_op_name(op) != NULL);
+    }
+    TEST_CHECK(kzg_stat_name(KZG_STAT_COUNTERS) == NULL);
+    TEST_CHECK(kzg_op_name(KZG_OP_COUNT) == NULL);
+    TEST_CHECK(strcmp(kzg_op_name(KZG_OP_DA_USING_FK20_MULTI), "da_using_fk20_multi") == 0);
+}
+
+#ifdef KZG_STATS
+
+static void count_hook(KZGOp op, uint64_t ns, void *ctx) {
+    uint64_t *calls = ctx;
+    calls[op]++;
+}
+
+void stats_count_operations(void) {
+    FFTSettings fs;
+    KZGStats s;
+    uint64_t calls[KZG_OP_COUNT] = {0};
+    fr_t data[16], out[16], inv;
+    g1_t p, points[4];
+    fr_t *x;
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 4));
+    for (int i = 0; i < 16; i++) {
+        data[i] = rand_fr();
+    }
+    for (int i = 0; i < 4; i++) {
+        points[i] = rand_g1();
+    }
+
+    kzg_stats_reset();
+    kzg_set_stats_hook(count_hook, calls);
+
+    TEST_CHECK(C_KZG_OK == fft_fr(out, data, false, 16, &fs));
+    TEST_CHECK(C_KZG_OK == fft_fr(out, data, false, 8, &fs));
+    fr_inv(&inv, &data[0]);
+    g1_mul(&p, &g1_generator, &data[0]);
+    TEST_CHECK(C_KZG_OK == g1_linear_combination(&p, points, data, 4));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&x, 10));
+    free(x);
+
+    kzg_set_stats_hook(NULL, NULL);
+    kzg_stats(&s);
+
+    TEST_CHECK(s.enabled);
+    TEST_CHECK(s.counts[KZG_STAT_FFT_FR] == 2);
+    TEST_CHECK(s.counts[KZG_STAT_FFT_FR_POINTS] == 24);
+    TEST_CHECK(s.fft_fr_sizes[4] == 1);
+    TEST_CHECK(s.fft_fr_sizes[3] == 1);
+    TEST_CHECK(s.counts[KZG_STAT_FR_INV] == 1);
+    TEST_CHECK(s.counts[KZG_STAT_MSM] == 1);
+    TEST_CHECK(s.counts[KZG_STAT_MSM_POINTS] == 4);
+    TEST_CHECK(s.msm_sizes[2] == 1);
+    TEST_CHECK(s.counts[KZG_STAT_G1_MUL] >= 1);
+    TEST_CHECK(s.counts[KZG_STAT_ALLOCS] == 1);
+    TEST_CHECK(s.counts[KZG_STAT_ALLOC_BYTES] == 10 * sizeof(fr_t));
+    TEST_CHECK(s.ops[KZG_OP_FFT_FR].calls == 2);
+    TEST_CHECK(s.ops[KZG_OP_FFT_FR].max_ns <= s.ops[KZG_OP_FFT_FR].total_ns);
+    TEST_CHECK(s.ops[KZG_OP_MSM].calls == 1);
+    TEST_CHECK(calls[KZG_OP_FFT_FR] == 2);
+    TEST_CHECK(calls[KZG_OP_MSM] == 1);
+
+    kzg_stats_reset();
+    kzg_stats(&s);
+    TEST_CHECK(s.counts[KZG_STAT_FFT_FR] == 0);
+    TEST_CHECK(s.ops[KZG_OP_FFT_FR].calls == 0);
+
+    free_fft_settings(&fs);
+}
+
+#else
+
+void stats_disabled(void) {
+    FFTSettings fs;
+    KZGStats s;
+    fr_t data[16], out[16];
+
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 4));
+    for (int i = 0; i < 16; i++) {
+        data[i] = rand_fr();
+    }
+    TEST_CHECK(C_KZG_OK == fft_fr(out, data, false, 16, &fs));
+
+    kzg_stats(&s);
+    TEST_CHECK(!s.enabled);
+    TEST_CHECK(s.counts[KZG_STAT_FFT_FR] == 0);
+    TEST_CHECK(s.ops[KZG_OP_FFT_FR].calls == 0);
+
+    free_fft_settings(&fs);
+}
+
+#endif // KZG_STATS
+
+TEST_LIST = {
+    {"STATS_TEST", title},
+    {"stat_names_complete", stat_names_complete},
+#ifdef KZG_STATS
+    {"stats_count_operations", stats_count_operations},
+#else
+    {"stats_disabled", stats_disabled},
+#endif
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
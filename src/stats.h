@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file stats.h
+ *
+ * Counters and timings of the expensive operations, for libraries built with `KZG_STATS` defined.
+ *
+ * This is separate from c_kzg.h, which includes it, so that the field and group wrappers can be counted too.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The operations that are counted.
+ */
+typedef enum {
+    KZG_STAT_G1_MUL,         /**< G1 scalar multiplications, with or without tables */
+    KZG_STAT_FR_INV,         /**< Field inversions, each batch inversion counting as one */
+    KZG_STAT_PAIRINGS,       /**< Pairings, two for each pairing check */
+    KZG_STAT_FFT_FR,         /**< Field FFTs */
+    KZG_STAT_FFT_FR_POINTS,  /**< The total size of the field FFTs */
+    KZG_STAT_FFT_G1,         /**< G1 FFTs */
+    KZG_STAT_FFT_G1_POINTS,  /**< The total size of the G1 FFTs */
+    KZG_STAT_MSM,            /**< Multi-scalar multiplications by #g1_linear_combination */
+    KZG_STAT_MSM_POINTS,     /**< The total number of points in the multi-scalar multiplications */
+    KZG_STAT_ALLOCS,         /**< Allocations, from the heap or an arena */
+    KZG_STAT_ALLOC_BYTES,    /**< The total size of the allocations in bytes */
+    KZG_STAT_COUNTERS        /**< The number of counters */
+} KZGStatCounter;
+
+/**
+ * The calls that are timed.
+ */
+typedef enum {
+    KZG_OP_FFT_FR,
+    KZG_OP_FFT_G1,
+    KZG_OP_MSM,
+    KZG_OP_COMMIT_TO_POLY,
+    KZG_OP_COMMIT_TO_EVALUATIONS,
+    KZG_OP_COMPUTE_PROOF_SINGLE,
+    KZG_OP_COMPUTE_PROOF_SINGLE_EVAL,
+    KZG_OP_COMPUTE_PROOF_MULTI,
+    KZG_OP_COMPUTE_PROOFS_AT_POINTS,
+    KZG_OP_CHECK_PROOF_SINGLE,
+    KZG_OP_CHECK_PROOF_SINGLE_BATCH,
+    KZG_OP_CHECK_PROOF_MULTI,
+    KZG_OP_DA_USING_FK20_SINGLE,
+    KZG_OP_DA_USING_FK20_MULTI,
+    KZG_OP_DA_USING_FK20_MULTI_BATCH,
+    KZG_OP_RECOVER_POLY_FROM_SAMPLES,
+    KZG_OP_RECOVER_POLY_FROM_SAMPLES_STREAMING,
+    KZG_OP_DAS_EXTEND_SQUARE,
+    KZG_OP_COUNT /**< The number of timed calls */
+} KZGOp;
+
+/** The number of size classes in the histograms of #KZGStats: sizes from `2^i` up to `2^(i + 1) - 1` are in class i. */
+#define KZG_STAT_SIZES 32
+
+/**
+ * The timings of one kind of call.
+ */
+typedef struct {
+    uint64_t calls;    /**< The number of calls */
+    uint64_t total_ns; /**< The total time, including any nested calls, summed over threads */
+    uint64_t max_ns;   /**< The longest call */
+} KZGOpStats;
+
+/**
+ * A snapshot of the counters and timings since the library was loaded or last reset.
+ */
+typedef struct {
+    bool enabled;                          /**< Whether the library was built with `KZG_STATS`; if not, all is zero */
+    uint64_t counts[KZG_STAT_COUNTERS];    /**< The counters, see #kzg_stat_name */
+    uint64_t fft_fr_sizes[KZG_STAT_SIZES]; /**< The field FFTs by size class */
+    uint64_t fft_g1_sizes[KZG_STAT_SIZES]; /**< The G1 FFTs by size class */
+    uint64_t msm_sizes[KZG_STAT_SIZES];    /**< The multi-scalar multiplications by size class */
+    KZGOpStats ops[KZG_OP_COUNT];          /**< The timings of the calls, see #kzg_op_name */
+} KZGStats;
+
+/**
+ * A function to be told of each timed call as it finishes, see #kzg_set_stats_hook.
+ *
+ * @param[in] op  The call
+ * @param[in] ns  How long it took in nanoseconds
+ * @param[in] ctx The context given to #kzg_set_stats_hook
+ */
+typedef void (*kzg_stats_hook)(KZGOp op, uint64_t ns, void *ctx);
+
+void kzg_stats(KZGStats *out);
+void kzg_stats_reset(void);
+void kzg_set_stats_hook(kzg_stats_hook hook, void *ctx);
+const char *kzg_stat_name(KZGStatCounter c);
+const char *kzg_op_name(KZGOp op);
+
+/**
+ * The start of a timed call, for the `STAT_SCOPE` macro.
+ */
+typedef struct {
+    KZGOp op;       /**< The call */
+    uint64_t start; /**< When it started, in nanoseconds */
+} KZGStatScope;
+
+void kzg_stat_count(KZGStatCounter c, uint64_t n);
+void kzg_stat_sized(KZGStatCounter c, uint64_t n);
+KZGStatScope kzg_stat_scope_begin(KZGOp op);
+void kzg_stat_scope_end(const KZGStatScope *scope);
+
+#endif // STATS_H
@@ -0,0 +1,334 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file thread_pool.c
+ *
+ * Running independent tasks in parallel.
+ *
+ * The library does not create threads of its own accord. Routines that can make use of parallelism take an optional
+ * #ThreadPool, which may either wrap the caller's own scheduler, or be the simple POSIX threads pool provided here.
+ */
+
+#include <pthread.h>
+#include <unistd.h> // sysconf()
+#include "control.h"
+#include "c_kzg_alloc.h"
+
+/** Set on threads that are currently executing pool tasks, so that nested calls run serially. */
+static __thread bool in_pool_task = false;
+
+/**
+ * Internal state of the POSIX threads pool created by #new_thread_pool.
+ */
+typedef struct {
+    pthread_mutex_t lock;       /**< Protects everything below */
+    pthread_mutex_t run_lock;   /**< Serialises concurrent callers of #thread_pool_run */
+    pthread_cond_t work_ready;  /**< Signalled when a new batch of tasks is available */
+    pthread_cond_t work_done;   /**< Signalled when the last task of a batch has completed */
+    pthread_t *workers;         /**< The worker threads */
+    unsigned int worker_count;  /**< The number of worker threads */
+    pool_task_t task;           /**< The current task function */
+    void *arg;                  /**< The current task argument */
+    uint64_t n;                 /**< The number of tasks in the current batch */
+    uint64_t next;              /**< The index of the next task to be started */
+    uint64_t pending;           /**< The number of tasks in the current batch not yet completed */
+    bool shutdown;              /**< Set to tell the workers to exit */
+} thread_pool_ctx;
+
+/**
+ * Claim and execute tasks from the current batch until there are none left to start.
+ *
+ * @remark Must be called with `ctx->lock` held, and returns with it held.
+ *
+ * @param[in,out] ctx The pool state
+ */
+static void thread_pool_work(thread_pool_ctx *ctx) {
+    while (ctx->next < ctx->n) {
+        uint64_t i = ctx->next++;
+        pool_task_t task = ctx->task;
+        void *arg = ctx->arg;
+        pthread_mutex_unlock(&ctx->lock);
+        task(arg, i);
+        pthread_mutex_lock(&ctx->lock);
+        if (--ctx->pending == 0) {
+            pthread_cond_signal(&ctx->work_done);
+        }
+    }
+}
+
+/**
+ * The main loop of a worker thread.
+ *
+ * @param[in] arg The pool state
+ * @return Always NULL
+ */
+static void *thread_pool_worker(void *arg) {
+    thread_pool_ctx *ctx = arg;
+    in_pool_task = true;
+    pthread_mutex_lock(&ctx->lock);
+    while (true) {
+        while (!ctx->shutdown && ctx->next >= ctx->n) {
+            pthread_cond_wait(&ctx->work_ready, &ctx->lock);
+        }
+        if (ctx->shutdown) break;
+        thread_pool_work(ctx);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    return NULL;
+}
+
+/**
+ * The `run` implementation for pools created by #new_thread_pool.
+ *
+ * The calling thread takes part in running the tasks.
+ *
+ * @param[in] ctx_ The pool state
+ * @param[in] task The task to run
+ * @param[in] arg  Argument passed to each invocation of @p task
+ * @param[in] n    The number of tasks
+ */
+static void thread_pool_run(void *ctx_, pool_task_t task, void *arg, uint64_t n) {
+    thread_pool_ctx *ctx = ctx_;
+
+    pthread_mutex_lock(&ctx->run_lock);
+    pthread_mutex_lock(&ctx->lock);
+    ctx->task = task;
+    ctx->arg = arg;
+    ctx->n = n;
+    ctx->next = 0;
+    ctx->pending = n;
+    pthread_cond_broadcast(&ctx->work_ready);
+
+    in_pool_task = true;
+    thread_pool_work(ctx);
+    in_pool_task = false;
+
+    while (ctx->pending > 0) {
+        pthread_cond_wait(&ctx->work_done, &ctx->lock);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+    pthread_mutex_unlock(&ctx->run_lock);
+}
+
+/**
+ * Run `task(arg, i)` for each `i` in `[0, n)`, in parallel if a thread pool is available.
+ *
+ * Returns when all the tasks have completed. Tasks must be independent of each other, and may be run in any order.
+ *
+ * @remark When called from within a task that is already running on a pool, the tasks are run serially on the
+ * current thread. This means that parallel routines can safely be composed without deadlocking or oversubscribing the
+ * pool.
+ *
+ * @param[in] pool A thread pool, or NULL to run the tasks serially on the current thread
+ * @param[in] task The task to run
+ * @param[in] arg  Argument passed to each invocation of @p task
+ * @param[in] n    The number of tasks
+ */
+void pool_run(const ThreadPool *pool, pool_task_t task, void *arg, uint64_t n) {
+    if (pool == NULL || pool->threads <= 1 || n <= 1 || in_pool_task) {
+        for (uint64_t i = 0; i < n; i++) {
+            task(arg, i);
+        }
+    } else {
+        pool->run(pool->ctx, task, arg, n);
+    }
+}
+
+/**
+ * The number of threads that work should be divided between.
+ *
+ * @param[in] pool A thread pool, or NULL
+ * @return The number of threads in @p pool, or one if it is NULL or we are already running on a pool thread
+ */
+unsigned int pool_threads(const ThreadPool *pool) {
+    return (pool == NULL || pool->threads == 0 || in_pool_task) ? 1 : pool->threads;
+}
+
+/**
+ * Initialise a thread pool using POSIX threads.
+ *
+ * The thread that calls #pool_run takes part in the work, so `threads - 1` worker threads are started here.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates resources that need to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_thread_pool.
+ *
+ * @param[out] pool    The new thread pool
+ * @param[in]  threads The total number of threads to use, or zero to use the number of online processors
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   Threads could not be created
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET new_thread_pool(ThreadPool *pool, unsigned int threads) {
+    thread_pool_ctx *ctx;
+    C_KZG_RET ret;
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? cpus : 1;
+    }
+
+    // Allocate everything before initialising the locks, so that a failure has only memory to release
+    TRY(new_byte_array((byte **)&ctx, sizeof *ctx));
+    ret = new_byte_array((byte **)&ctx->workers, (threads - 1) * sizeof *ctx->workers);
+    if (ret != C_KZG_OK) {
+        c_kzg_free(ctx);
+        return ret;
+    }
+    ctx->worker_count = 0;
+    ctx->n = ctx->next = ctx->pending = 0;
+    ctx->shutdown = false;
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_mutex_init(&ctx->run_lock, NULL);
+    pthread_cond_init(&ctx->work_ready, NULL);
+    pthread_cond_init(&ctx->work_done, NULL);
+
+    pool->run = thread_pool_run;
+    pool->ctx = ctx;
+    pool->threads = threads;
+
+    for (unsigned int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&ctx->workers[i], NULL, thread_pool_worker, ctx) != 0) {
+            free_thread_pool(pool);
+            return C_KZG_ERROR;
+        }
+        ctx->worker_count++;
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Stop the threads and free the resources of a pool previously created by #new_thread_pool.
+ *
+ * @remark This must not be used on pools that wrap the caller's own scheduler.
+ *
+ * @param pool The thread pool to be freed
+ */
+void free_thread_pool(ThreadPool *pool) {
+    thread_pool_ctx *ctx = pool->ctx;
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->shutdown = true;
+    pthread_cond_broadcast(&ctx->work_ready);
+    pthread_mutex_unlock(&ctx->lock);
+    for (unsigned int i = 0; i < ctx->worker_count; i++) {
+        pthread_join(ctx->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&ctx->lock);
+    pthread_mutex_destroy(&ctx->run_lock);
+    pthread_cond_destroy(&ctx->work_ready);
+    pthread_cond_destroy(&ctx->work_done);
+    free(ctx->workers);
+    free(ctx);
+    pool->ctx = NULL;
+    pool->threads = 0;
+}
+
+#ifdef KZGTEST
+
+#include "../inc/acutest.h"
+#include "test_util.h"
+
+#define TASK_COUNT 1000
+
+typedef struct {
+    const ThreadPool *pool;
+    uint64_t counts[TASK_COUNT];
+    uint64_t nested[TASK_COUNT];
+} test_tasks;
+
+static void count_task(void *arg, uint64_t i) {
+    test_tasks *t = arg;
+    t->counts[i]++;
+}
+
+static void nested_inner_task(void *arg, uint64_t i) {
+    uint64_t *total = arg;
+    *total += i;
+}
+
+static void nested_task(void *arg, uint64_t i) {
+    test_tasks *t = arg;
+    uint64_t total = 0;
+    pool_run(t->pool, nested_inner_task, &total, 10);
+    t->nested[i] = total;
+}
+
+void serial_pool_works(void) {
+    test_tasks t = {NULL, {0}, {0}};
+    pool_run(NULL, count_task, &t, TASK_COUNT);
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TEST_CHECK(1 == t.counts[i]);
+    }
+    TEST_CHECK(1 == pool_threads(NULL));
+}
+
+void thread_pool_runs_each_task_once(void) {
+    ThreadPool pool;
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 4));
+    TEST_CHECK(4 == pool_threads(&pool));
+
+    test_tasks t = {&pool, {0}, {0}};
+    for (int rep = 0; rep < 100; rep++) {
+        pool_run(&pool, count_task, &t, TASK_COUNT);
+    }
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TEST_CHECK(100 == t.counts[i]);
+        TEST_MSG("Task %d ran %lu times", i, t.counts[i]);
+    }
+
+    free_thread_pool(&pool);
+}
+
+void thread_pool_nested_runs_serially(void) {
+    ThreadPool pool;
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+
+    test_tasks t = {&pool, {0}, {0}};
+    pool_run(&pool, nested_task, &t, TASK_COUNT);
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TEST_CHECK(45 == t.nested[i]);
+    }
+
+    free_thread_pool(&pool);
+}
+
+void thread_pool_default_size(void) {
+    ThreadPool pool;
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 0));
+    TEST_CHECK(pool.threads >= 1);
+
+    test_tasks t = {&pool, {0}, {0}};
+    pool_run(&pool, count_task, &t, TASK_COUNT);
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TEST_CHECK(1 == t.counts[i]);
+    }
+
+    free_thread_pool(&pool);
+}
+
+TEST_LIST = {
+    {"THREAD_POOL_TEST", title},
+    {"serial_pool_works", serial_pool_works},
+    {"thread_pool_runs_each_task_once", thread_pool_runs_each_task_once},
+    {"thread_pool_nested_runs_serially", thread_pool_nested_runs_serially},
+    {"thread_pool_default_size", thread_pool_default_size},
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
@@ -0,0 +1,561 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file trusted_setup.c
+ *
+ * Loading the trusted setup from files.
+ *
+ * Trusted setups are distributed as text files of compressed points. Decompressing and subgroup checking them is slow
+ * for large setups, so #load_trusted_setup can spread the work over a thread pool, and the decoded points can be saved
+ * with #save_kzg_settings to a cache file that #load_kzg_settings maps straight back into memory.
+ */
+
+#include <inttypes.h> // SCNu64
+#include <string.h>   // memcmp(), memcpy(), memset()
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/stat.h> // fstat()
+#include "control.h"
+#include "c_kzg_alloc.h"
+#include "utility.h"
+
+/**
+ * Read @p len bytes in hexadecimal from a file, skipping any leading whitespace.
+ *
+ * @param[out] out The bytes read
+ * @param[in]  len The number of bytes to read, which is twice the number of hex digits
+ * @param[in]  in  The file to read from
+ * @retval true  All is well
+ * @retval false The file ended, or contained something other than hex digits
+ */
+static bool read_hex(byte *out, size_t len, FILE *in) {
+    int c;
+
+    do {
+        c = getc(in);
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+
+    for (size_t i = 0; i < 2 * len; i++, c = getc(in)) {
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        if (i % 2 == 0) out[i / 2] = v << 4;
+        else out[i / 2] |= v;
+    }
+    if (c != EOF) ungetc(c, in);
+
+    return true;
+}
+
+/**
+ * The shared state for decoding the points of a trusted setup in parallel.
+ */
+typedef struct {
+    const byte *g1_bytes; /**< The compressed G1 points */
+    const byte *g2_bytes; /**< The compressed G2 points */
+    g1_t *g1;             /**< The decoded G1 points */
+    g2_t *g2;             /**< The decoded G2 points */
+    uint64_t g1_len;      /**< The number of G1 points */
+    uint64_t g2_len;      /**< The number of G2 points */
+    uint64_t per_task;    /**< The number of points decoded by each task, G1 points first then G2 */
+    bool *ok;             /**< Whether all of each task's points were valid */
+} decode_job;
+
+/**
+ * Decompress and subgroup check a range of points, as one task of #load_trusted_setup.
+ *
+ * @param[in,out] arg The #decode_job
+ * @param[in]     t   The index of the task
+ */
+static void decode_task(void *arg, uint64_t t) {
+    const decode_job *job = arg;
+    uint64_t total = job->g1_len + job->g2_len, start = t * job->per_task;
+    uint64_t end = start + job->per_task < total ? start + job->per_task : total;
+    bool ok = true;
+
+    for (uint64_t i = start; i < end && ok; i++) {
+        if (i < job->g1_len) {
+            ok = g1_decompress(&job->g1[i], job->g1_bytes + 48 * i);
+        } else {
+            uint64_t j = i - job->g1_len;
+            ok = g2_decompress(&job->g2[j], job->g2_bytes + 96 * j);
+        }
+    }
+    job->ok[t] = ok;
+}
+
+/**
+ * Initialise a KZGSettings structure from a trusted setup file.
+ *
+ * The file is text: the number of G1 points, then the number of G2 points, then each G1 point in 48-byte compressed
+ * form as 96 hex digits, then each G2 point in 96-byte compressed form as 192 hex digits, all separated by whitespace.
+ * This is the layout used by the published ceremony outputs. The points must be the powers `[s^i]` of the secret, in
+ * order.
+ *
+ * Every point is checked to be on the curve and in the right subgroup. If @p pool is not NULL then the checks are
+ * divided between its threads.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates memory that needs to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_kzg_settings.
+ *
+ * @param[out] ks   The new settings
+ * @param[in]  in   The trusted setup file
+ * @param[in]  fs   A previously initialised FFTSettings structure, no larger than the number of G1 points
+ * @param[in]  pool A thread pool for decoding the points, or NULL. This is not stored in @p ks.
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not a valid trusted setup, or is too small
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET load_trusted_setup(KZGSettings *ks, FILE *in, const FFTSettings *fs, const ThreadPool *pool) {
+    uint64_t g1_len, g2_len, tasks, total;
+    byte *g1_bytes, *g2_bytes;
+    decode_job job;
+    bool ok = true;
+
+    CHECK(fscanf(in, "%" SCNu64 " %" SCNu64, &g1_len, &g2_len) == 2);
+    CHECK(g1_len >= fs->max_width);
+    CHECK(g2_len >= 2);
+
+    // Reading the text is quick, so do it all up front and parallelise only the decoding
+    TRY(new_byte_array(&g1_bytes, 48 * g1_len));
+    TRY(new_byte_array(&g2_bytes, 96 * g2_len));
+    for (uint64_t i = 0; i < g1_len && ok; i++) {
+        ok = read_hex(g1_bytes + 48 * i, 48, in);
+    }
+    for (uint64_t i = 0; i < g2_len && ok; i++) {
+        ok = read_hex(g2_bytes + 96 * i, 96, in);
+    }
+    if (!ok) {
+        c_kzg_free(g1_bytes);
+        c_kzg_free(g2_bytes);
+        return C_KZG_BADARGS;
+    }
+
+    total = g1_len + g2_len;
+    tasks = pool_threads(pool) < total ? pool_threads(pool) : total;
+    job.g1_bytes = g1_bytes;
+    job.g2_bytes = g2_bytes;
+    job.g1_len = g1_len;
+    job.g2_len = g2_len;
+    job.per_task = (total + tasks - 1) / tasks;
+    TRY(new_g1_array(&job.g1, g1_len));
+    TRY(new_g2_array(&job.g2, g2_len));
+    TRY(new_byte_array((byte **)&job.ok, tasks * sizeof *job.ok));
+
+    pool_run(pool, decode_task, &job, tasks);
+    for (uint64_t t = 0; t < tasks; t++) {
+        ok = ok && job.ok[t];
+    }
+
+    c_kzg_free(g1_bytes);
+    c_kzg_free(g2_bytes);
+    c_kzg_free(job.ok);
+    if (!ok) {
+        c_kzg_free(job.g1);
+        c_kzg_free(job.g2);
+        return C_KZG_BADARGS;
+    }
+
+    ks->fs = fs;
+    ks->secret_g1 = job.g1;
+    ks->secret_g1_affine = NULL;
+    ks->secret_g2 = job.g2;
+    ks->length = g1_len;
+    ks->g2_length = g2_len;
+    ks->secret_g1_table = NULL;
+    ks->wbits = 0;
+    ks->secret_lagrange = NULL;
+    ks->lagrange_length = 0;
+    ks->pool = NULL;
+    ks->workspace = NULL;
+    ks->mapping = NULL;
+    ks->mapping_len = 0;
+
+    return C_KZG_OK;
+}
+
+/** The current version of the format written by #save_kzg_settings. */
+#define KZG_SETTINGS_FILE_VERSION 1
+
+/** Identifies files written by #save_kzg_settings. */
+static const byte kzg_settings_file_magic[8] = {'C', 'K', 'Z', 'G', 'S', 'E', 'T', 'P'};
+
+/** Written natively so that files from machines of a different byte order are rejected. */
+#define KZG_SETTINGS_FILE_BYTE_ORDER 0x01020304
+
+/**
+ * The header at the start of every file written by #save_kzg_settings.
+ *
+ * The G1 points follow immediately after, then the G2 points, then any Lagrange-form G1 points in affine form. The
+ * header is 64 bytes so that the points are aligned for mapping.
+ */
+typedef struct {
+    byte magic[8];       /**< #kzg_settings_file_magic */
+    uint32_t version;    /**< #KZG_SETTINGS_FILE_VERSION */
+    uint32_t byte_order; /**< #KZG_SETTINGS_FILE_BYTE_ORDER */
+    uint32_t g1_size;    /**< `sizeof(g1_affine_t)` if `affine` is set, otherwise `sizeof(g1_t)` */
+    uint32_t g2_size;    /**< `sizeof(g2_t)` */
+    uint64_t length;     /**< The number of G1 points */
+    uint64_t g2_length;  /**< The number of G2 points */
+    uint32_t affine;     /**< 1 if the G1 points are stored in affine form, see #kzg_settings_to_affine */
+    byte reserved[4];    /**< Zero */
+    uint64_t lagrange;   /**< The number of Lagrange-form G1 points, see #kzg_settings_lagrange, or zero */
+    byte reserved2[8];   /**< Zero */
+} kzg_settings_file_header;
+
+/**
+ * Save the decoded trusted setup to a file, for loading with #load_kzg_settings.
+ *
+ * The points are written in their raw in-memory form, so the file is specific to the byte order and the build of the
+ * library that wrote it. Settings stored in affine form are saved that way, and load in affine form. Lagrange-form
+ * secrets are saved along with the rest.
+ *
+ * @param[in] out The file to write to
+ * @param[in] ks  The settings to be saved
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   The file could not be written
+ */
+C_KZG_RET save_kzg_settings(FILE *out, const KZGSettings *ks) {
+    kzg_settings_file_header header;
+
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, kzg_settings_file_magic, sizeof header.magic);
+    header.version = KZG_SETTINGS_FILE_VERSION;
+    header.byte_order = KZG_SETTINGS_FILE_BYTE_ORDER;
+    header.g1_size = ks->secret_g1_affine != NULL ? sizeof(g1_affine_t) : sizeof(g1_t);
+    header.g2_size = sizeof(g2_t);
+    header.length = ks->length;
+    header.g2_length = ks->g2_length;
+    header.affine = ks->secret_g1_affine != NULL;
+    header.lagrange = ks->lagrange_length;
+
+    if (fwrite(&header, sizeof header, 1, out) != 1) return C_KZG_ERROR;
+    if (ks->secret_g1_affine != NULL) {
+        if (fwrite(ks->secret_g1_affine, sizeof(g1_affine_t), ks->length, out) != ks->length) return C_KZG_ERROR;
+    } else {
+        if (fwrite(ks->secret_g1, sizeof(g1_t), ks->length, out) != ks->length) return C_KZG_ERROR;
+    }
+    if (fwrite(ks->secret_g2, sizeof(g2_t), ks->g2_length, out) != ks->g2_length) return C_KZG_ERROR;
+    if (fwrite(ks->secret_lagrange, sizeof(g1_affine_t), ks->lagrange_length, out) != ks->lagrange_length) {
+        return C_KZG_ERROR;
+    }
+    if (fflush(out) != 0) return C_KZG_ERROR;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Initialise a KZGSettings structure from a file written by #save_kzg_settings.
+ *
+ * The file is mapped into memory read-only and the points are used in place. No decoding or checking is done, so
+ * this takes next to no time, and processes on the same host share the page cache.
+ *
+ * @remark The points are not checked, so the file must be as trustworthy as the library itself. It must not be
+ * modified while the settings are in use, but may be closed once this returns.
+ *
+ * @remark As with all functions prefixed `new_`, this allocates resources that need to be reclaimed by calling the
+ * corresponding `free_` function. In this case, #free_kzg_settings.
+ *
+ * @param[out] ks The new settings
+ * @param[in]  in The file to read from
+ * @param[in]  fs A previously initialised FFTSettings structure, no larger than the number of G1 points
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not valid, too small, or not compatible with this build of the library
+ * @retval C_CZK_ERROR   The file could not be mapped
+ */
+C_KZG_RET load_kzg_settings(KZGSettings *ks, FILE *in, const FFTSettings *fs) {
+    const kzg_settings_file_header *header;
+    struct stat st;
+    size_t g1_size;
+    uint64_t body;
+    byte *map;
+    bool ok;
+
+    if (fstat(fileno(in), &st) != 0) return C_KZG_ERROR;
+    CHECK((uint64_t)st.st_size >= sizeof *header);
+    body = (uint64_t)st.st_size - sizeof *header;
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(in), 0);
+    if (map == MAP_FAILED) return C_KZG_ERROR;
+    header = (const kzg_settings_file_header *)map;
+    g1_size = header->affine ? sizeof(g1_affine_t) : sizeof(g1_t);
+
+    ok = memcmp(header->magic, kzg_settings_file_magic, sizeof header->magic) == 0 &&
+         header->version == KZG_SETTINGS_FILE_VERSION && header->byte_order == KZG_SETTINGS_FILE_BYTE_ORDER &&
+         header->affine <= 1 && header->g1_size == g1_size && header->g2_size == sizeof(g2_t) &&
+         header->length >= fs->max_width && header->g2_length >= 2 && header->lagrange <= header->length &&
+         is_power_of_two(header->lagrange) &&
+         // Bound the counts by the file first, so that the sizes cannot overflow
+         header->length <= body / g1_size && header->g2_length <= body / sizeof(g2_t) &&
+         header->lagrange <= body / sizeof(g1_affine_t) &&
+         (uint64_t)st.st_size == sizeof *header + header->length * g1_size + header->g2_length * sizeof(g2_t) +
+                                     header->lagrange * sizeof(g1_affine_t);
+    if (!ok) {
+        munmap(map, st.st_size);
+        return C_KZG_BADARGS;
+    }
+
+    ks->fs = fs;
+    if (header->affine) {
+        ks->secret_g1 = NULL;
+        ks->secret_g1_affine = (g1_affine_t *)(map + sizeof *header);
+    } else {
+        ks->secret_g1 = (g1_t *)(map + sizeof *header);
+        ks->secret_g1_affine = NULL;
+    }
+    ks->secret_g2 = (g2_t *)(map + sizeof *header + header->length * g1_size);
+    ks->length = header->length;
+    ks->g2_length = header->g2_length;
+    ks->secret_g1_table = NULL;
+    ks->wbits = 0;
+    ks->secret_lagrange = NULL;
+    if (header->lagrange > 0) {
+        ks->secret_lagrange = (g1_affine_t *)((byte *)ks->secret_g2 + header->g2_length * sizeof(g2_t));
+    }
+    ks->lagrange_length = header->lagrange;
+    ks->pool = NULL;
+    ks->workspace = NULL;
+    ks->mapping = map;
+    ks->mapping_len = st.st_size;
+
+    return C_KZG_OK;
+}
+
+#ifdef KZGTEST
+
+#include <unistd.h> // ftruncate()
+#include "../inc/acutest.h"
+#include "test_util.h"
+
+#define SETUP_LEN 64
+
+// Write a trusted setup file in the standard text format
+static FILE *write_setup_file(const g1_t *s1, uint64_t g1_len, const g2_t *s2, uint64_t g2_len) {
+    FILE *file = tmpfile();
+    byte c1[48], c2[96];
+
+    fprintf(file, "%" PRIu64 "\n%" PRIu64 "\n", g1_len, g2_len);
+    for (uint64_t i = 0; i < g1_len; i++) {
+        g1_compress(c1, &s1[i]);
+        for (int j = 0; j < 48; j++) fprintf(file, "%02x", c1[j]);
+        fprintf(file, "\n");
+    }
+    for (uint64_t i = 0; i < g2_len; i++) {
+        g2_compress(c2, &s2[i]);
+        for (int j = 0; j < 96; j++) fprintf(file, "%02X", c2[j]);
+        fprintf(file, "\n");
+    }
+    rewind(file);
+    return file;
+}
+
+void load_trusted_setup_works(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    ThreadPool pool;
+    g1_t s1[SETUP_LEN];
+    g2_t s2[SETUP_LEN];
+    uint64_t g2_len = 17;
+    FILE *file;
+
+    generate_trusted_setup(s1, s2, &secret, SETUP_LEN);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 5));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+
+    // Serially, and in parallel
+    const ThreadPool *pools[] = {NULL, &pool};
+    for (int p = 0; p < 2; p++) {
+        file = write_setup_file(s1, SETUP_LEN, s2, g2_len);
+        TEST_CHECK(C_KZG_OK == load_trusted_setup(&ks, file, &fs, pools[p]));
+        fclose(file);
+
+        TEST_CHECK(SETUP_LEN == ks.length);
+        TEST_CHECK(g2_len == ks.g2_length);
+        for (int i = 0; i < SETUP_LEN; i++) {
+            TEST_CHECK(g1_equal(&s1[i], &ks.secret_g1[i]));
+        }
+        for (int i = 0; i < g2_len; i++) {
+            TEST_CHECK(g2_equal(&s2[i], &ks.secret_g2[i]));
+        }
+        free_kzg_settings(&ks);
+    }
+
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+}
+
+void load_trusted_setup_rejects_bad_files(void) {
+    FFTSettings fs;
+    KZGSettings ks;
+    g1_t s1[SETUP_LEN];
+    g2_t s2[SETUP_LEN];
+    FILE *file;
+
+    generate_trusted_setup(s1, s2, &secret, SETUP_LEN);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 5));
+
+    // Too few G1 points for the FFT settings
+    file = write_setup_file(s1, 16, s2, 2);
+    TEST_CHECK(C_KZG_BADARGS == load_trusted_setup(&ks, file, &fs, NULL));
+    fclose(file);
+
+    // Too few G2 points
+    file = write_setup_file(s1, SETUP_LEN, s2, 1);
+    TEST_CHECK(C_KZG_BADARGS == load_trusted_setup(&ks, file, &fs, NULL));
+    fclose(file);
+
+    // The file ends early
+    file = write_setup_file(s1, SETUP_LEN, s2, 2);
+    TEST_CHECK(0 == fseek(file, 0, SEEK_SET));
+    TEST_CHECK(fprintf(file, "%d\n%d", SETUP_LEN, 3) > 0);
+    rewind(file);
+    TEST_CHECK(C_KZG_BADARGS == load_trusted_setup(&ks, file, &fs, NULL));
+    fclose(file);
+
+    // An invalid point: clear the compression flag of the last G1 point
+    file = write_setup_file(s1, SETUP_LEN, s2, 2);
+    fseek(file, 0, SEEK_END);
+    TEST_CHECK(0 == fseek(file, ftell(file) - 2 * (2 * 96 + 1) - (2 * 48 + 1), SEEK_SET));
+    TEST_CHECK(fputc('0', file) != EOF);
+    rewind(file);
+    TEST_CHECK(C_KZG_BADARGS == load_trusted_setup(&ks, file, &fs, NULL));
+    fclose(file);
+
+    // Not hex at all
+    file = tmpfile();
+    fprintf(file, "%d 2\nxyz\n", SETUP_LEN);
+    rewind(file);
+    TEST_CHECK(C_KZG_BADARGS == load_trusted_setup(&ks, file, &fs, NULL));
+    fclose(file);
+
+    free_fft_settings(&fs);
+}
+
+void kzg_settings_save_load(void) {
+    FFTSettings fs;
+    KZGSettings ks, loaded, affine;
+    kzg_settings_file_header header;
+    g1_t s1[SETUP_LEN];
+    g2_t s2[SETUP_LEN];
+    FILE *setup, *cache;
+    g1_t commitment, proof;
+    fr_t x, y;
+    poly p;
+    bool result;
+
+    generate_trusted_setup(s1, s2, &secret, SETUP_LEN);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 5));
+    setup = write_setup_file(s1, SETUP_LEN, s2, 5);
+    TEST_CHECK(C_KZG_OK == load_trusted_setup(&ks, setup, &fs, NULL));
+    fclose(setup);
+
+    cache = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_settings(cache, &ks));
+    TEST_CHECK(C_KZG_OK == load_kzg_settings(&loaded, cache, &fs));
+    fclose(cache);
+
+    TEST_CHECK(ks.length == loaded.length);
+    TEST_CHECK(ks.g2_length == loaded.g2_length);
+    for (int i = 0; i < ks.length; i++) {
+        TEST_CHECK(g1_equal(&ks.secret_g1[i], &loaded.secret_g1[i]));
+    }
+    for (int i = 0; i < ks.g2_length; i++) {
+        TEST_CHECK(g2_equal(&ks.secret_g2[i], &loaded.secret_g2[i]));
+    }
+
+    // The mapped settings work, including with tables, which are not mapped
+    TEST_CHECK(C_KZG_OK == kzg_settings_precompute(&loaded, 4));
+    TEST_CHECK(C_KZG_OK == new_poly(&p, 32));
+    for (int i = 0; i < p.length; i++) {
+        p.coeffs[i] = rand_fr();
+    }
+    x = rand_fr();
+    eval_poly(&y, &p, &x);
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&commitment, &p, &loaded));
+    TEST_CHECK(C_KZG_OK == compute_proof_single(&proof, &p, &x, &loaded));
+    TEST_CHECK(C_KZG_OK == check_proof_single(&result, &commitment, &proof, &x, &y, &loaded));
+    TEST_CHECK(result);
+
+    // With only five G2 points, multi proofs are limited to four points
+    TEST_CHECK(C_KZG_BADARGS == check_proof_multi(&result, &commitment, &proof, &x, &y, 8, &loaded));
+
+    // Files that are not settings, or are truncated
+    cache = tmpfile();
+    fprintf(cache, "not a cache file");
+    fflush(cache);
+    TEST_CHECK(C_KZG_BADARGS == load_kzg_settings(&loaded, cache, &fs));
+    fclose(cache);
+    cache = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_settings(cache, &ks));
+    TEST_CHECK(0 == ftruncate(fileno(cache), sizeof(kzg_settings_file_header) + sizeof(g1_t)));
+    TEST_CHECK(C_KZG_BADARGS == load_kzg_settings(&loaded, cache, &fs));
+    fclose(cache);
+
+    // A count so large that the size of the points wraps round to the size of the file
+    cache = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_settings(cache, &ks));
+    rewind(cache);
+    TEST_CHECK(1 == fread(&header, sizeof header, 1, cache));
+    header.length += (uint64_t)1 << (64 - __builtin_ctzll(header.g1_size));
+    rewind(cache);
+    TEST_CHECK(1 == fwrite(&header, sizeof header, 1, cache));
+    fflush(cache);
+    TEST_CHECK(C_KZG_BADARGS == load_kzg_settings(&loaded, cache, &fs));
+    fclose(cache);
+
+    // Affine settings are saved and loaded as affine
+    TEST_CHECK(C_KZG_OK == kzg_settings_to_affine(&ks));
+    cache = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_settings(cache, &ks));
+    TEST_CHECK(C_KZG_OK == load_kzg_settings(&affine, cache, &fs));
+    fclose(cache);
+    TEST_CHECK(affine.secret_g1 == NULL && affine.secret_g1_affine != NULL);
+    TEST_CHECK(C_KZG_OK == commit_to_poly(&proof, &p, &affine));
+    TEST_CHECK(g1_equal(&commitment, &proof));
+    TEST_CHECK(g2_equal(&ks.secret_g2[ks.g2_length - 1], &affine.secret_g2[affine.g2_length - 1]));
+
+    // Lagrange-form secrets are saved and loaded with the rest, and can be recomputed for mapped settings
+    free_kzg_settings(&affine);
+    TEST_CHECK(C_KZG_OK == kzg_settings_lagrange(&ks, 16));
+    cache = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_settings(cache, &ks));
+    TEST_CHECK(C_KZG_OK == load_kzg_settings(&affine, cache, &fs));
+    fclose(cache);
+    TEST_CHECK(16 == affine.lagrange_length);
+    for (int i = 0; i < 16; i++) {
+        TEST_CHECK(0 == memcmp(&ks.secret_lagrange[i], &affine.secret_lagrange[i], sizeof(g1_affine_t)));
+    }
+    TEST_CHECK(C_KZG_OK == kzg_settings_lagrange(&affine, 32));
+    TEST_CHECK(32 == affine.lagrange_length);
+
+    free_poly(&p);
+    free_kzg_settings(&ks);
+    free_kzg_settings(&loaded);
+    free_kzg_settings(&affine);
+    free_fft_settings(&fs);
+}
+
+TEST_LIST = {
+    {"TRUSTED_SETUP_TEST", title},
+    {"load_trusted_setup_works", load_trusted_setup_works},
+    {"load_trusted_setup_rejects_bad_files", load_trusted_setup_rejects_bad_files},
+    {"kzg_settings_save_load", kzg_settings_save_load},
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
@@ -0,0 +1,644 @@
+/*
+ * Copyright 2021 Benjamin Edgington
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file tuning.c
+ *
+ * Measuring, saving and loading the crossover points between algorithms.
+ *
+ * Where the library has a choice of algorithms, such as direct and FFT-based polynomial multiplication, it switches
+ * between them at sizes given by the active #KZGTuning profile. The defaults suit a typical x86 host. #kzg_tune
+ * measures the crossovers on the running machine, and the result can be saved with #save_kzg_tuning so that later
+ * runs need only #load_kzg_tuning and #kzg_set_tuning at startup. The `profile_tune` program does the measuring and
+ * saving from the command line.
+ */
+
+#include <inttypes.h> // PRIu64, SCNu64
+#include <string.h>   // strcmp()
+#include <time.h>     // clock_gettime()
+#include "control.h"
+#include "c_kzg_alloc.h"
+#include "utility.h"
+
+/** The initialiser for the default profile, see #kzg_tuning_defaults. */
+#define DEFAULT_TUNING                                                                                                 \
+    { .poly_mul_fft_min = 64, .poly_div_fast_min = 128, .msm_pippenger_min = 8, .zero_poly_tree_min = 64 }
+
+/** The default profile. */
+static const KZGTuning default_tuning = DEFAULT_TUNING;
+
+/** The active profile. */
+static KZGTuning active_tuning = DEFAULT_TUNING;
+
+/** Identifies files written by #save_kzg_tuning. */
+static const char tuning_file_magic[] = "c-kzg-tuning";
+
+/** The shortest time in nanoseconds over which each candidate algorithm is timed by #kzg_tune. */
+#define TUNE_SAMPLE_NS 2000000
+
+/** The log base 2 of the largest size that #kzg_tune tries for the polynomial crossovers. */
+#define TUNE_MAX_SCALE 16
+
+/** The smallest size tried for the polynomial multiplication and division crossovers. */
+#define TUNE_POLY_MIN 8
+
+/** The fewest points tried for the multi-scalar multiplication crossover, since Blst fails for 0 or 1. */
+#define TUNE_MSM_MIN 2
+
+/** The most points tried for the multi-scalar multiplication crossover. */
+#define TUNE_MSM_MAX 128
+
+/** The fewest missing indices tried for the zero polynomial crossover. */
+#define TUNE_ZERO_POLY_MIN 16
+
+/** The most missing indices tried for the zero polynomial crossover, since multiplying out directly is quadratic. */
+#define TUNE_ZERO_POLY_MAX 1024
+
+/**
+ * Get the default profile, which the library uses until #kzg_set_tuning is called.
+ *
+ * @param[out] t The default profile
+ */
+void kzg_tuning_defaults(KZGTuning *t) {
+    *t = default_tuning;
+}
+
+/**
+ * Get the profile that the library is currently using.
+ *
+ * @return The active profile
+ */
+const KZGTuning *kzg_tuning(void) {
+    return &active_tuning;
+}
+
+/**
+ * Make a profile the one the library uses for all its choices of algorithm.
+ *
+ * @remark The profile is shared by all threads, so this should be called at startup, before the library is used
+ * elsewhere.
+ *
+ * @param[in] t The profile to use
+ */
+void kzg_set_tuning(const KZGTuning *t) {
+    active_tuning = *t;
+    if (active_tuning.msm_pippenger_min < 2) active_tuning.msm_pippenger_min = 2;
+    g1_set_pippenger_min(active_tuning.msm_pippenger_min);
+}
+
+/**
+ * The current time in nanoseconds, for timing the candidates in #kzg_tune.
+ *
+ * @return The time on a monotonic clock
+ */
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/**
+ * The state for timing one of the library's operations under a trial profile.
+ */
+typedef struct {
+    const KZGTuning *trial; /**< The profile under which the operation is run */
+    poly a;                 /**< The first operand, where there is one */
+    poly b;                 /**< The second operand, where there is one */
+    poly out;               /**< Space for the output, where needed */
+    const g1_t *points;     /**< Points for linear combinations */
+    uint64_t *missing;      /**< Indices for zero polynomials */
+    fr_t *zero_eval;        /**< Space for the evaluations of zero polynomials */
+    const FFTSettings *fs;  /**< Settings for zero polynomials */
+} tune_case;
+
+/** An operation timed by #time_per_op. */
+typedef C_KZG_RET (*tune_op)(const tune_case *c);
+
+/**
+ * Multiply the operands, as timed for the crossover of #poly_mul.
+ *
+ * @param[in] c The operands and space for the product
+ * @return The result of the multiplication
+ */
+static C_KZG_RET tune_poly_mul(const tune_case *c) {
+    poly out = c->out;
+    return poly_mul(&out, &c->a, &c->b);
+}
+
+/**
+ * Divide the operands, as timed for the crossover of #new_poly_div.
+ *
+ * @param[in] c The dividend and divisor
+ * @return The result of the division
+ */
+static C_KZG_RET tune_poly_div(const tune_case *c) {
+    poly q;
+    TRY(new_poly_div(&q, &c->a, &c->b));
+    free_poly(&q);
+    return C_KZG_OK;
+}
+
+/**
+ * Compute a linear combination, as timed for the crossover of #g1_linear_combination.
+ *
+ * @param[in] c The points and, in `a`, the coefficients
+ * @return The result of #g1_linear_combination
+ */
+static C_KZG_RET tune_msm(const tune_case *c) {
+    g1_t out;
+    return g1_linear_combination(&out, c->points, c->a.coeffs, c->a.length);
+}
+
+/**
+ * Build a zero polynomial, as timed for the crossover of #zero_polynomial_via_multiplication.
+ *
+ * @param[in] c The missing indices, in `a` their number, and in `out` space for the polynomial
+ * @return The result of building the polynomial
+ */
+static C_KZG_RET tune_zero_poly(const tune_case *c) {
+    poly out = c->out;
+    return zero_polynomial_via_multiplication(c->zero_eval, &out, out.length, c->missing, c->a.length, c->fs);
+}
+
+/**
+ * Time an operation under the trial profile in @p c.
+ *
+ * The operation is repeated, doubling the count each time, until the repeats take at least #TUNE_SAMPLE_NS.
+ *
+ * @param[out] out The time per operation in nanoseconds
+ * @param[in]  op  The operation
+ * @param[in]  c   Its operands and the trial profile
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET time_per_op(uint64_t *out, tune_op op, const tune_case *c) {
+    uint64_t reps = 1, start, elapsed;
+
+    kzg_set_tuning(c->trial);
+    while (true) {
+        start = now_ns();
+        for (uint64_t i = 0; i < reps; i++) {
+            TRY(op(c));
+        }
+        elapsed = now_ns() - start;
+        if (elapsed >= TUNE_SAMPLE_NS) break;
+        reps *= 2;
+    }
+    *out = elapsed / reps;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Find the size from which the second of two algorithms is faster, scanning the powers of two.
+ *
+ * @param[out]    out     The smallest size tried at which the `fast` profile beat the `slow` one, or `2 * max`
+ * @param[in,out] c       The case, whose `trial` is set here and whose operands are set up by @p setup for each size
+ * @param[in]     op      The operation to time
+ * @param[in]     setup   Sets up the operands of @p c for a size
+ * @param[in]     slow    The profile that selects the algorithm for small sizes
+ * @param[in]     fast    The profile that selects the algorithm for large sizes
+ * @param[in]     min     The smallest size to try, a power of two
+ * @param[in]     max     The largest size to try, a power of two
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET find_crossover(uint64_t *out, tune_case *c, tune_op op, C_KZG_RET (*setup)(tune_case *, uint64_t),
+                                const KZGTuning *slow, const KZGTuning *fast, uint64_t min, uint64_t max) {
+    uint64_t t_slow, t_fast;
+
+    *out = 2 * max;
+    for (uint64_t n = min; n <= max; n *= 2) {
+        TRY(setup(c, n));
+        c->trial = slow;
+        TRY(time_per_op(&t_slow, op, c));
+        c->trial = fast;
+        TRY(time_per_op(&t_fast, op, c));
+        if (t_fast < t_slow) {
+            *out = n;
+            break;
+        }
+    }
+
+    return C_KZG_OK;
+}
+
+/**
+ * Fill a polynomial with pseudo-random coefficients, none of them zero.
+ *
+ * @param[in,out] p    The polynomial, already allocated
+ * @param[in]     seed Varies the coefficients
+ */
+static void fill_poly(poly *p, uint64_t seed) {
+    for (uint64_t i = 0; i < p->length; i++) {
+        fr_from_uint64(&p->coeffs[i], (seed + i) * 0x9e3779b97f4a7c15ULL | 1);
+    }
+}
+
+/**
+ * Free the operands of a tuning case, ready for the next size.
+ *
+ * @param[in,out] c The case
+ */
+static void free_tune_case(tune_case *c) {
+    free_poly(&c->a);
+    free_poly(&c->b);
+    free_poly(&c->out);
+    c_kzg_free(c->missing);
+    c_kzg_free(c->zero_eval);
+    c->missing = NULL;
+    c->zero_eval = NULL;
+}
+
+/**
+ * Set up two factors of length @p n and space for their product.
+ *
+ * @param[in,out] c The case
+ * @param[in]     n The length of the factors
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET setup_poly_mul(tune_case *c, uint64_t n) {
+    free_tune_case(c);
+    TRY(new_poly(&c->a, n));
+    TRY(new_poly(&c->b, n));
+    TRY(new_poly(&c->out, 2 * n));
+    fill_poly(&c->a, 1);
+    fill_poly(&c->b, n);
+    return C_KZG_OK;
+}
+
+/**
+ * Set up a divisor of length @p n and a dividend twice as long.
+ *
+ * @param[in,out] c The case
+ * @param[in]     n The length of the divisor
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET setup_poly_div(tune_case *c, uint64_t n) {
+    free_tune_case(c);
+    TRY(new_poly(&c->a, 2 * n));
+    TRY(new_poly(&c->b, n));
+    TRY(new_poly(&c->out, 0));
+    fill_poly(&c->a, 1);
+    fill_poly(&c->b, n);
+    return C_KZG_OK;
+}
+
+/**
+ * Set up @p n coefficients for a linear combination of the first @p n of `c->points`.
+ *
+ * @param[in,out] c The case
+ * @param[in]     n The number of points
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET setup_msm(tune_case *c, uint64_t n) {
+    free_tune_case(c);
+    TRY(new_poly(&c->a, n));
+    TRY(new_poly(&c->b, 0));
+    TRY(new_poly(&c->out, 0));
+    fill_poly(&c->a, 1);
+    return C_KZG_OK;
+}
+
+/**
+ * Set up @p n missing indices spread over a domain four times as large, for building a zero polynomial.
+ *
+ * @param[in,out] c The case
+ * @param[in]     n The number of missing indices
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET setup_zero_poly(tune_case *c, uint64_t n) {
+    free_tune_case(c);
+    TRY(new_poly(&c->a, 0));
+    TRY(new_poly(&c->b, 0));
+    TRY(new_poly(&c->out, 4 * n));
+    TRY(new_uint64_array(&c->missing, n));
+    TRY(new_fr_array(&c->zero_eval, 4 * n));
+    c->a.length = n; // The number of missing indices
+    for (uint64_t i = 0; i < n; i++) {
+        c->missing[i] = 4 * i + (i % 3);
+    }
+    return C_KZG_OK;
+}
+
+/**
+ * Measure the crossovers between algorithms on the running machine.
+ *
+ * Each choice is timed both ways around at successive powers of two, through the library's own dispatch, and the
+ * crossover is the first size at which the algorithm for large problems wins. This takes a few seconds; the result is
+ * best saved with #save_kzg_tuning and loaded at startup.
+ *
+ * @remark This changes the active profile while it runs, restoring it afterwards, so nothing else may use the library
+ * meanwhile. The new profile is not made active: pass it to #kzg_set_tuning for that.
+ *
+ * @param[out] out       The measured profile
+ * @param[in]  max_scale The log base 2 of the largest size tried for the polynomial crossovers, from 4 to
+ *                       #TUNE_MAX_SCALE
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET kzg_tune(KZGTuning *out, unsigned int max_scale) {
+    KZGTuning saved = active_tuning, slow, fast;
+    uint64_t max = (uint64_t)1 << max_scale, max_points = TUNE_MSM_MAX;
+    FFTSettings fs;
+    tune_case c;
+    g1_t *points;
+    C_KZG_RET ret;
+
+    CHECK(max_scale >= 4 && max_scale <= TUNE_MAX_SCALE);
+
+    TRY(new_fft_settings(&fs, max_scale + 2));
+    TRY(new_g1_array(&points, max_points));
+    points[0] = g1_generator;
+    for (uint64_t i = 1; i < max_points; i++) {
+        g1_add_or_dbl(&points[i], &points[i - 1], &g1_generator);
+    }
+    c.points = points;
+    c.fs = &fs;
+    c.missing = NULL;
+    c.zero_eval = NULL;
+    ret = new_poly(&c.a, 0);
+    if (ret == C_KZG_OK) ret = new_poly(&c.b, 0);
+    if (ret == C_KZG_OK) ret = new_poly(&c.out, 0);
+
+    *out = saved;
+    slow = fast = saved;
+    slow.poly_mul_fft_min = UINT64_MAX / 2;
+    fast.poly_mul_fft_min = 1;
+    if (ret == C_KZG_OK) ret = find_crossover(&out->poly_mul_fft_min, &c, tune_poly_mul, setup_poly_mul, &slow, &fast,
+                                              TUNE_POLY_MIN, max);
+
+    slow = fast = saved;
+    slow.poly_div_fast_min = UINT64_MAX;
+    fast.poly_div_fast_min = 1;
+    if (ret == C_KZG_OK) ret = find_crossover(&out->poly_div_fast_min, &c, tune_poly_div, setup_poly_div, &slow, &fast,
+                                              TUNE_POLY_MIN, max / 2);
+
+    slow = fast = saved;
+    slow.msm_pippenger_min = UINT64_MAX;
+    fast.msm_pippenger_min = 2;
+    if (ret == C_KZG_OK) ret = find_crossover(&out->msm_pippenger_min, &c, tune_msm, setup_msm, &slow, &fast,
+                                              TUNE_MSM_MIN, max_points);
+
+    slow = fast = saved;
+    slow.zero_poly_tree_min = UINT64_MAX;
+    fast.zero_poly_tree_min = 0;
+    if (ret == C_KZG_OK) ret = find_crossover(&out->zero_poly_tree_min, &c, tune_zero_poly, setup_zero_poly, &slow,
+                                              &fast, TUNE_ZERO_POLY_MIN, min_u64(max, TUNE_ZERO_POLY_MAX));
+
+    kzg_set_tuning(&saved);
+    free_tune_case(&c);
+    c_kzg_free(points);
+    free_fft_settings(&fs);
+
+    return ret;
+}
+
+/**
+ * Save a profile to a file, for loading with #load_kzg_tuning.
+ *
+ * The file is text, with a line naming the format and then one `name value` line for each crossover.
+ *
+ * @param[in] out The file to write to
+ * @param[in] t   The profile to be saved
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_ERROR   The file could not be written
+ */
+C_KZG_RET save_kzg_tuning(FILE *out, const KZGTuning *t) {
+    int ok = fprintf(out, "%s\n", tuning_file_magic) > 0 &&
+             fprintf(out, "poly_mul_fft_min %" PRIu64 "\n", t->poly_mul_fft_min) > 0 &&
+             fprintf(out, "poly_div_fast_min %" PRIu64 "\n", t->poly_div_fast_min) > 0 &&
+             fprintf(out, "msm_pippenger_min %" PRIu64 "\n", t->msm_pippenger_min) > 0 &&
+             fprintf(out, "zero_poly_tree_min %" PRIu64 "\n", t->zero_poly_tree_min) > 0;
+    if (!ok || fflush(out) != 0) return C_KZG_ERROR;
+
+    return C_KZG_OK;
+}
+
+/**
+ * Whether a crossover could have been found by #kzg_tune, as for #find_crossover.
+ *
+ * @param[in] x   The crossover
+ * @param[in] min The smallest size tried
+ * @param[in] max The largest size tried, beyond which the crossover is `2 * max`
+ * @return True if @p x is in the range
+ */
+static bool crossover_in_range(uint64_t x, uint64_t min, uint64_t max) {
+    return x >= min && x <= 2 * max;
+}
+
+/**
+ * Load a profile from a file written by #save_kzg_tuning.
+ *
+ * Crossovers missing from the file keep their default values, and unknown names are ignored, so that profiles remain
+ * usable across versions of the library. The profile is not made active: pass it to #kzg_set_tuning for that.
+ *
+ * Every crossover must be in the range that #kzg_tune searches, so that a corrupt file cannot make the library choose
+ * absurdly.
+ *
+ * @param[out] t  The loaded profile
+ * @param[in]  in The file to read from
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS The file is not a valid profile, or a crossover is out of range
+ */
+C_KZG_RET load_kzg_tuning(KZGTuning *t, FILE *in) {
+    char name[64];
+    uint64_t value;
+    int n;
+
+    CHECK(fscanf(in, "%63s", name) == 1 && strcmp(name, tuning_file_magic) == 0);
+
+    *t = default_tuning;
+    while ((n = fscanf(in, "%63s %" SCNu64, name, &value)) == 2) {
+        if (strcmp(name, "poly_mul_fft_min") == 0) {
+            t->poly_mul_fft_min = value;
+        } else if (strcmp(name, "poly_div_fast_min") == 0) {
+            t->poly_div_fast_min = value;
+        } else if (strcmp(name, "msm_pippenger_min") == 0) {
+            t->msm_pippenger_min = value;
+        } else if (strcmp(name, "zero_poly_tree_min") == 0) {
+            t->zero_poly_tree_min = value;
+        }
+    }
+    CHECK(n == EOF);
+    CHECK(crossover_in_range(t->poly_mul_fft_min, TUNE_POLY_MIN, (uint64_t)1 << TUNE_MAX_SCALE));
+    CHECK(crossover_in_range(t->poly_div_fast_min, TUNE_POLY_MIN, (uint64_t)1 << (TUNE_MAX_SCALE - 1)));
+    CHECK(crossover_in_range(t->msm_pippenger_min, TUNE_MSM_MIN, TUNE_MSM_MAX));
+    CHECK(crossover_in_range(t->zero_poly_tree_min, TUNE_ZERO_POLY_MIN, TUNE_ZERO_POLY_MAX));
+
+    return C_KZG_OK;
+}
+
+#ifdef KZGTEST
+
+#include "../inc/acutest.h"
+#include "test_util.h"
+
+void tuning_defaults(void) {
+    KZGTuning t;
+
+    kzg_tuning_defaults(&t);
+    TEST_CHECK(64 == t.poly_mul_fft_min);
+    TEST_CHECK(128 == t.poly_div_fast_min);
+    TEST_CHECK(8 == t.msm_pippenger_min);
+    TEST_CHECK(64 == t.zero_poly_tree_min);
+    TEST_CHECK(0 == memcmp(&t, kzg_tuning(), sizeof t));
+}
+
+void tuning_save_load(void) {
+    KZGTuning t, loaded;
+    FILE *file;
+
+    t.poly_mul_fft_min = 32;
+    t.poly_div_fast_min = 256;
+    t.msm_pippenger_min = 4;
+    t.zero_poly_tree_min = 1024;
+    file = tmpfile();
+    TEST_CHECK(C_KZG_OK == save_kzg_tuning(file, &t));
+    rewind(file);
+    TEST_CHECK(C_KZG_OK == load_kzg_tuning(&loaded, file));
+    fclose(file);
+    TEST_CHECK(0 == memcmp(&t, &loaded, sizeof t));
+
+    // Missing entries take their defaults, and unknown ones are ignored
+    file = tmpfile();
+    fprintf(file, "c-kzg-tuning\nsomething_new 5\npoly_div_fast_min 16\n");
+    rewind(file);
+    TEST_CHECK(C_KZG_OK == load_kzg_tuning(&loaded, file));
+    fclose(file);
+    kzg_tuning_defaults(&t);
+    t.poly_div_fast_min = 16;
+    TEST_CHECK(0 == memcmp(&t, &loaded, sizeof t));
+
+#ifndef DEBUG
+    // Files that are not profiles, are corrupt, or would break the library
+    const char *bad[] = {"",
+                         "poly_mul_fft_min 4\n",
+                         "c-kzg-tuning\npoly_mul_fft_min x\n",
+                         "c-kzg-tuning\nmsm_pippenger_min 1\n",
+                         "c-kzg-tuning\nmsm_pippenger_min 100000\n",
+                         "c-kzg-tuning\npoly_mul_fft_min 0\n",
+                         "c-kzg-tuning\npoly_mul_fft_min 18446744073709551615\n",
+                         "c-kzg-tuning\npoly_div_fast_min 1\n",
+                         "c-kzg-tuning\nzero_poly_tree_min 0\n",
+                         "c-kzg-tuning\nzero_poly_tree_min 4096\n"};
+    for (int i = 0; i < sizeof bad / sizeof bad[0]; i++) {
+        file = tmpfile();
+        fprintf(file, "%s", bad[i]);
+        rewind(file);
+        TEST_CHECK(C_KZG_BADARGS == load_kzg_tuning(&loaded, file));
+        TEST_MSG("Accepted bad file %d", i);
+        fclose(file);
+    }
+#endif
+}
+
+void tuned_results_unchanged(void) {
+    KZGTuning saved = *kzg_tuning(), t;
+    FFTSettings fs;
+    poly a, b, product[2], quotient[2], zero[2];
+    fr_t zero_eval[256];
+    g1_t points[16], msm[2];
+    uint64_t missing[100];
+
+    // The same results with every algorithm forced on, and every one forced off
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 9));
+    TEST_CHECK(C_KZG_OK == new_poly(&a, 200));
+    TEST_CHECK(C_KZG_OK == new_poly(&b, 150));
+    for (int i = 0; i < a.length; i++) {
+        a.coeffs[i] = rand_fr();
+    }
+    for (int i = 0; i < b.length; i++) {
+        b.coeffs[i] = rand_fr();
+    }
+    for (int i = 0; i < 16; i++) {
+        points[i] = rand_g1();
+    }
+    for (int i = 0; i < 100; i++) {
+        missing[i] = 2 * i + 1;
+    }
+    for (int forced = 0; forced < 2; forced++) {
+        t.poly_mul_fft_min = forced ? 1 : UINT64_MAX / 2;
+        t.poly_div_fast_min = forced ? 1 : UINT64_MAX;
+        t.msm_pippenger_min = forced ? 2 : UINT64_MAX;
+        t.zero_poly_tree_min = forced ? 0 : UINT64_MAX;
+        kzg_set_tuning(&t);
+        TEST_CHECK(C_KZG_OK == new_poly(&product[forced], a.length + b.length - 1));
+        TEST_CHECK(C_KZG_OK == poly_mul_(&product[forced], &a, &b, &fs));
+        TEST_CHECK(C_KZG_OK == new_poly_div(&quotient[forced], &a, &b));
+        TEST_CHECK(C_KZG_OK == g1_linear_combination(&msm[forced], points, a.coeffs, 16));
+        TEST_CHECK(C_KZG_OK == new_poly(&zero[forced], 256));
+        TEST_CHECK(C_KZG_OK == zero_polynomial_via_multiplication(zero_eval, &zero[forced], 256, missing, 100, &fs));
+    }
+    kzg_set_tuning(&saved);
+
+    TEST_CHECK(quotient[0].length == quotient[1].length);
+    TEST_CHECK(zero[0].length == zero[1].length);
+    for (int i = 0; i < product[0].length; i++) {
+        TEST_CHECK(fr_equal(&product[0].coeffs[i], &product[1].coeffs[i]));
+    }
+    for (int i = 0; i < quotient[0].length; i++) {
+        TEST_CHECK(fr_equal(&quotient[0].coeffs[i], &quotient[1].coeffs[i]));
+    }
+    for (int i = 0; i < zero[0].length; i++) {
+        TEST_CHECK(fr_equal(&zero[0].coeffs[i], &zero[1].coeffs[i]));
+    }
+    TEST_CHECK(g1_equal(&msm[0], &msm[1]));
+
+    for (int i = 0; i < 2; i++) {
+        free_poly(&product[i]);
+        free_poly(&quotient[i]);
+        free_poly(&zero[i]);
+    }
+    free_poly(&a);
+    free_poly(&b);
+    free_fft_settings(&fs);
+}
+
+void tune_measures_profile(void) {
+    KZGTuning before = *kzg_tuning(), t;
+
+    TEST_CHECK(C_KZG_OK == kzg_tune(&t, 6));
+    TEST_CHECK(0 == memcmp(&before, kzg_tuning(), sizeof before));
+    TEST_CHECK(t.poly_mul_fft_min >= 8 && t.poly_mul_fft_min <= 128);
+    TEST_CHECK(t.poly_div_fast_min >= 8 && t.poly_div_fast_min <= 64);
+    TEST_CHECK(t.msm_pippenger_min >= 2 && t.msm_pippenger_min <= 256);
+    TEST_CHECK(t.zero_poly_tree_min >= 16 && t.zero_poly_tree_min <= 128);
+
+#ifndef DEBUG
+    TEST_CHECK(C_KZG_BADARGS == kzg_tune(&t, 3));
+    TEST_CHECK(C_KZG_BADARGS == kzg_tune(&t, 17));
+#endif
+}
+
+TEST_LIST = {
+    {"TUNING_TEST", title},
+    {"tuning_defaults", tuning_defaults},
+    {"tuning_save_load", tuning_save_load},
+    {"tuned_results_unchanged", tuned_results_unchanged},
+    {"tune_measures_profile", tune_measures_profile},
+    {NULL, NULL} /* zero record marks the end of the list */
+};
+
+#endif // KZGTEST
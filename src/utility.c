@@ -121,9 +121,145 @@ uint32_t reverse_bits_limited(uint32_t n, uint32_t value) {
     return reverse_bits(value) >> unused_bit_len;
 }
 
+/**
+ * The largest tile, in bytes, that #reverse_bit_order permutes in a buffer (a tunable parameter).
+ *
+ * Two such buffers are used, and should fit comfortably in the L1 cache.
+ */
+#define REVERSE_BIT_ORDER_TILE_BYTES 16384
+
+/**
+ * The smallest array, in bytes, that #reverse_bit_order permutes a tile at a time (a tunable parameter).
+ *
+ * Below this the array fits in the L2 cache and element-by-element swaps are as quick.
+ */
+#define REVERSE_BIT_ORDER_BLOCKED_MIN_BYTES (1 << 18)
+
+/**
+ * Reorder an array in reverse bit order by swapping pairs of elements.
+ *
+ * @param[in,out] v    The array
+ * @param[in]     size The size in bytes of an element, a constant where the caller is specialised for a type
+ * @param[in]     n    The length of the array, a power of two less than 2^32
+ */
+static inline void reverse_bit_order_swaps(byte *v, size_t size, uint64_t n) {
+    byte tmp[size];
+    int unused_bit_len = 32 - log2_pow2(n);
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t r = reverse_bits(i) >> unused_bit_len;
+        if (r > i) {
+            // Swap the two elements
+            memcpy(tmp, v + (i * size), size);
+            memcpy(v + (i * size), v + (r * size), size);
+            memcpy(v + (r * size), tmp, size);
+        }
+    }
+}
+
+/**
+ * Copy tile @p mid of an array into a buffer, permuted into the order it takes in the reordered array.
+ *
+ * Writing an index of `b` bits as `(hi, mid, lo)`, where `hi` and `lo` have `t` bits, its reversal is
+ * `(rev(lo), rev(mid), rev(hi))`. Tile `mid` is the `2^t` rows of `2^t` adjacent elements sharing the middle bits, and
+ * element `(hi, lo)` goes to position `(rev(lo), rev(hi))` of the buffer, ready to be written to tile `rev(mid)`.
+ *
+ * @param[out] buf  The buffer, of `2^(2t)` elements
+ * @param[in]  v    The array
+ * @param[in]  size The size in bytes of an element
+ * @param[in]  mid  The middle bits of the tile
+ * @param[in]  t    The number of bits in `hi` and `lo`
+ * @param[in]  b    The number of bits in an index
+ * @param[in]  rev  The reversals of all `t`-bit numbers
+ */
+static inline void reverse_bit_order_load(byte *buf, const byte *v, size_t size, uint64_t mid, int t, int b,
+                                          const uint32_t *rev) {
+    uint64_t width = (uint64_t)1 << t;
+    for (uint64_t hi = 0; hi < width; hi++) {
+        const byte *row = v + ((hi << (b - t)) | (mid << t)) * size;
+        for (uint64_t lo = 0; lo < width; lo++) {
+            memcpy(buf + ((rev[lo] << t) | rev[hi]) * size, row + lo * size, size);
+        }
+    }
+}
+
+/**
+ * Write a buffer filled by #reverse_bit_order_load to tile @p mid of the array, a row at a time.
+ *
+ * @param[out] v    The array
+ * @param[in]  buf  The buffer
+ * @param[in]  size The size in bytes of an element
+ * @param[in]  mid  The middle bits of the tile
+ * @param[in]  t    The number of bits in `hi` and `lo`
+ * @param[in]  b    The number of bits in an index
+ */
+static inline void reverse_bit_order_store(byte *v, const byte *buf, size_t size, uint64_t mid, int t, int b) {
+    uint64_t width = (uint64_t)1 << t;
+    for (uint64_t hi = 0; hi < width; hi++) {
+        memcpy(v + ((hi << (b - t)) | (mid << t)) * size, buf + (hi << t) * size, width * size);
+    }
+}
+
+/**
+ * Reorder an array in reverse bit order a tile at a time.
+ *
+ * Each tile, and the one its elements are bound for, is permuted through small buffers, so that every access to the
+ * array itself is to a run of `2^t` adjacent elements. This keeps the number of pages and cache lines in use small,
+ * however large the array.
+ *
+ * @param[in,out] v    The array
+ * @param[in]     size The size in bytes of an element, a constant where the caller is specialised for a type
+ * @param[in]     n    The length of the array, a power of two less than 2^32
+ * @param[in]     t    The number of bits in the row and column of a tile, with `2t` no more than `log2(n)`
+ */
+static inline void reverse_bit_order_tiles(byte *v, size_t size, uint64_t n, int t) {
+    byte buf_a[REVERSE_BIT_ORDER_TILE_BYTES], buf_b[REVERSE_BIT_ORDER_TILE_BYTES];
+    uint32_t rev[1 << 8];
+    int b = log2_pow2(n), mid_bits = b - 2 * t;
+
+    for (uint32_t i = 0; i < (1 << t); i++) {
+        rev[i] = reverse_bits(i) >> (32 - t);
+    }
+    for (uint64_t mid = 0; mid < (uint64_t)1 << mid_bits; mid++) {
+        uint64_t r = mid_bits == 0 ? 0 : reverse_bits(mid) >> (32 - mid_bits);
+        if (r < mid) continue;
+        reverse_bit_order_load(buf_a, v, size, mid, t, b, rev);
+        if (r != mid) {
+            reverse_bit_order_load(buf_b, v, size, r, t, b, rev);
+            reverse_bit_order_store(v, buf_b, size, mid, t, b);
+        }
+        reverse_bit_order_store(v, buf_a, size, r, t, b);
+    }
+}
+
+/**
+ * Reorder an array of elements of a given size in reverse bit order, choosing the method by size.
+ *
+ * @param[in,out] v    The array
+ * @param[in]     size The size in bytes of an element, a constant where the caller is specialised for a type
+ * @param[in]     n    The length of the array, a power of two less than 2^32
+ */
+static inline void reverse_bit_order_sized(byte *v, size_t size, uint64_t n) {
+    int t = 0;
+
+    // The largest tiles that fit in the buffers and in the array
+    while (t < 8 && ((size_t)1 << (2 * t + 2)) * size <= REVERSE_BIT_ORDER_TILE_BYTES &&
+           ((uint64_t)1 << (2 * t + 2)) <= n) {
+        t++;
+    }
+
+    if (n * size >= REVERSE_BIT_ORDER_BLOCKED_MIN_BYTES && t >= 2) {
+        reverse_bit_order_tiles(v, size, n, t);
+    } else {
+        reverse_bit_order_swaps(v, size, n);
+    }
+}
+
 /**
  * Reorder an array in reverse bit order of its indices.
  *
+ * Large arrays are permuted a tile at a time, which makes far better use of the caches and TLB than swapping scattered
+ * pairs. The common element types, #fr_t and #g1_t, have their own copies of the code with the element size fixed.
+ *
  * @remark Operates in-place on the array.
  * @remark Can handle arrays of any type: provide the element size in @p size.
  *
@@ -138,17 +274,12 @@ C_KZG_RET reverse_bit_order(void *values, size_t size, uint64_t n) {
     CHECK(is_power_of_two(n));
 
     // Pointer arithmetic on `void *` is naughty, so cast to something definite
-    byte *v = values;
-    byte tmp[size];
-    int unused_bit_len = 32 - log2_pow2(n);
-    for (uint32_t i = 0; i < n; i++) {
-        uint32_t r = reverse_bits(i) >> unused_bit_len;
-        if (r > i) {
-            // Swap the two elements
-            memcpy(tmp, v + (i * size), size);
-            memcpy(v + (i * size), v + (r * size), size);
-            memcpy(v + (r * size), tmp, size);
-        }
+    if (size == sizeof(fr_t)) {
+        reverse_bit_order_sized(values, sizeof(fr_t), n);
+    } else if (size == sizeof(g1_t)) {
+        reverse_bit_order_sized(values, sizeof(g1_t), n);
+    } else {
+        reverse_bit_order_sized(values, size, n);
     }
 
     return C_KZG_OK;
@@ -281,6 +412,32 @@ void test_reverse_bit_order_fr(void) {
     TEST_CHECK(true == fr_equal(&b[n - 1], &a[n - 1]));
 }
 
+void test_reverse_bit_order_tiled(void) {
+    // Large enough to be permuted in tiles, for the specialised sizes and another
+    size_t sizes[] = {sizeof(fr_t), sizeof(g1_t), 24};
+    int scales[] = {13, 12, 15};
+
+    for (int k = 0; k < 3; k++) {
+        size_t size = sizes[k];
+        uint32_t n = 1 << scales[k];
+        byte *a;
+
+        TEST_CHECK(C_KZG_OK == new_byte_array(&a, n * size));
+        for (uint32_t i = 0; i < n; i++) {
+            memset(a + i * size, 0, size);
+            memcpy(a + i * size + size - sizeof i, &i, sizeof i);
+        }
+        TEST_CHECK(C_KZG_OK == reverse_bit_order(a, size, n));
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t expected = reverse_bits(i) >> (32 - scales[k]), actual;
+            memcpy(&actual, a + i * size + size - sizeof actual, sizeof actual);
+            TEST_CHECK(expected == actual);
+            TEST_MSG("Element size %zu, index %u: expected %u, got %u", size, i, expected, actual);
+        }
+        free(a);
+    }
+}
+
 void test_reverse_bit_order_fr_large(void) {
     int size = 22, n = 1 << size;
     fr_t *a, *b;
@@ -319,6 +476,7 @@ TEST_LIST = {
     {"test_reverse_bit_order_g1", test_reverse_bit_order_g1},
     {"test_reverse_bit_order_fr", test_reverse_bit_order_fr},
     {"test_reverse_bit_order_fr_large", test_reverse_bit_order_fr_large},
+    {"test_reverse_bit_order_tiled", test_reverse_bit_order_tiled},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
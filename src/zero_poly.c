@@ -38,18 +38,25 @@
  * @param[in]  fs          The FFT settings previously initialised with #new_fft_settings
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_MALLOC  Memory allocation failed building the roots for lazy settings
  */
 C_KZG_RET do_zero_poly_mul_partial(poly *dst, const uint64_t *indices, uint64_t len_indices, uint64_t stride,
                                           const FFTSettings *fs) {
+    const fr_t *roots;
+    uint64_t roots_stride;
 
     CHECK(len_indices > 0);
     CHECK(dst->length >= len_indices + 1);
+    CHECK(stride > 0);
 
-    fr_negate(&dst->coeffs[0], &fs->expanded_roots_of_unity[indices[0] * stride]);
+    // The stride is relative to `max_width`, so look up the roots for the domain it implies
+    TRY(fft_roots(&roots, &roots_stride, fs->max_width / stride, fs));
+
+    fr_negate(&dst->coeffs[0], &roots[indices[0] * roots_stride]);
 
     for (uint64_t i = 1; i < len_indices; i++) {
         fr_t neg_di;
-        fr_negate(&neg_di, &fs->expanded_roots_of_unity[indices[i] * stride]);
+        fr_negate(&neg_di, &roots[indices[i] * roots_stride]);
         dst->coeffs[i] = neg_di;
         fr_add(&dst->coeffs[i], &dst->coeffs[i], &dst->coeffs[i - 1]);
         for (uint64_t j = i - 1; j > 0; j--) {
@@ -142,12 +149,265 @@ C_KZG_RET reduce_partials(poly *out, uint64_t len_out, fr_t *scratch, uint64_t l
     return C_KZG_OK;
 }
 
+/**
+ * The state shared by the tasks that build and reduce the partial products of a zero polynomial.
+ */
+typedef struct {
+    const uint64_t *missing_indices; /**< The indices at which the zero polynomial must vanish */
+    uint64_t len_missing;            /**< The number of missing indices */
+    uint64_t missing_per_partial;    /**< The number of missing indices multiplied directly into each leaf */
+    uint64_t domain_stride;          /**< The stride through the roots of unity of @p fs */
+    uint64_t length;                 /**< The size of the domain of evaluation */
+    uint64_t n;                      /**< The longest product that is computed, a power of two */
+    uint64_t reduction_factor;       /**< The number of polynomials multiplied together at each node of the tree */
+    const poly *in;                  /**< The polynomials of the current level */
+    uint64_t in_count;               /**< The number of polynomials in @p in */
+    poly *out;                       /**< The polynomials of the next level */
+    uint64_t items;                  /**< The number of polynomials to be made for the next level */
+    uint64_t items_per_task;         /**< The number of consecutive items handled by each task */
+    fr_t *work;                      /**< The space holding the coefficients of all the polynomials */
+    fr_t *scratch;                   /**< Scratch space of `3 * n` for each task */
+    const FFTSettings *fs;           /**< The FFT settings */
+    C_KZG_RET *ret;                  /**< The result of each task */
+} zero_poly_job;
+
+/**
+ * Build a run of the leaves of the tree directly from the missing indices, as one task.
+ *
+ * @param[in,out] arg The #zero_poly_job
+ * @param[in]     t   The index of the task
+ */
+static void zero_poly_leaf_task(void *arg, uint64_t t) {
+    const zero_poly_job *job = arg;
+    uint64_t end = min_u64((t + 1) * job->items_per_task, job->items);
+    uint64_t degree_of_partial = job->missing_per_partial + 1;
+
+    job->ret[t] = C_KZG_OK;
+    for (uint64_t i = t * job->items_per_task; i < end && job->ret[t] == C_KZG_OK; i++) {
+        uint64_t offset = i * job->missing_per_partial;
+        job->out[i].coeffs = job->work + i * degree_of_partial;
+        job->out[i].length = degree_of_partial;
+        job->ret[t] = do_zero_poly_mul_partial(&job->out[i], &job->missing_indices[offset],
+                                               min_u64(job->missing_per_partial, job->len_missing - offset),
+                                               job->domain_stride, job->fs);
+    }
+}
+
+/**
+ * Multiply together a run of groups of polynomials from one level of the tree, as one task.
+ *
+ * Each product overwrites its factors in the working space, which is laid out so that the space from the first factor
+ * of a group up to the first factor of the next is always enough to hold the product. So the groups are independent.
+ *
+ * @param[in,out] arg The #zero_poly_job
+ * @param[in]     t   The index of the task
+ */
+static void zero_poly_reduce_task(void *arg, uint64_t t) {
+    const zero_poly_job *job = arg;
+    uint64_t end = min_u64((t + 1) * job->items_per_task, job->items);
+    fr_t *scratch = job->scratch + t * 3 * job->n;
+
+    job->ret[t] = C_KZG_OK;
+    for (uint64_t i = t * job->items_per_task; i < end && job->ret[t] == C_KZG_OK; i++) {
+        uint64_t start = i * job->reduction_factor;
+        uint64_t partials_num = min_u64(job->reduction_factor, job->in_count - start);
+        uint64_t out_degree = 0;
+        for (uint64_t j = start; j < start + partials_num; j++) {
+            out_degree += job->in[j].length - 1;
+        }
+        job->out[i].coeffs = job->in[start].coeffs;
+        if (partials_num > 1) {
+            job->ret[t] = reduce_partials(&job->out[i], next_power_of_two(out_degree + 1), scratch, 3 * job->n,
+                                          &job->in[start], partials_num, job->fs);
+        } else {
+            job->out[i].length = job->in[start].length;
+        }
+    }
+}
+
+/**
+ * Run @p job->items items of a zero polynomial job, split into contiguous runs over the threads of @p pool.
+ *
+ * @param[in,out] job  The job, whose `items` is set, and which has space for a result per thread
+ * @param[in]     task The task that handles a run of items
+ * @param[in]     pool Optional thread pool, NULL to run serially
+ * @return The first failure of any task, or C_KZG_OK
+ */
+static C_KZG_RET zero_poly_run(zero_poly_job *job, pool_task_t task, const ThreadPool *pool) {
+    uint64_t tasks = min_u64(pool_threads(pool), job->items);
+    C_KZG_RET ret = C_KZG_OK;
+
+    job->items_per_task = (job->items + tasks - 1) / tasks;
+    tasks = (job->items + job->items_per_task - 1) / job->items_per_task;
+    pool_run(pool, task, job, tasks);
+    for (uint64_t t = 0; t < tasks && ret == C_KZG_OK; t++) {
+        ret = job->ret[t];
+    }
+    return ret;
+}
+
+/**
+ * Estimate the number of field multiplications needed to build a zero polynomial with the given parameters.
+ *
+ * The leaves cost about half their degree per missing index, and each level of the tree costs `reduction_factor + 1`
+ * FFTs per node plus the point-wise products.
+ *
+ * @param[in] len_missing       The number of missing indices, more than `degree_of_partial - 1`
+ * @param[in] length            The size of the domain of evaluation
+ * @param[in] degree_of_partial The length of the leaves, a power of two
+ * @param[in] reduction_factor  The number of polynomials multiplied at each node, a power of two
+ * @return The estimated cost
+ */
+static uint64_t zero_poly_cost(uint64_t len_missing, uint64_t length, uint64_t degree_of_partial,
+                               uint64_t reduction_factor) {
+    uint64_t count = (len_missing + degree_of_partial - 2) / (degree_of_partial - 1);
+    uint64_t n = min_u64(next_power_of_two(count * degree_of_partial), length);
+    uint64_t size = degree_of_partial;
+    uint64_t cost = len_missing * degree_of_partial / 2;
+
+    while (count > 1) {
+        uint64_t nodes = (count + reduction_factor - 1) / reduction_factor;
+        uint64_t m = min_u64(min_u64(reduction_factor * size, n), length);
+        cost += nodes * ((reduction_factor + 1) * (m / 2) * log2_u64(m) + reduction_factor * m);
+        count = nodes;
+        size = m;
+    }
+    return cost;
+}
+
+/**
+ * Choose the tunable parameters of #zero_polynomial_via_multiplication_parallel for a given problem size.
+ *
+ * Sets of missing indices smaller than the crossover in the active #KZGTuning profile are multiplied out directly.
+ * Larger ones take the combination with the lowest estimated cost by #zero_poly_cost.
+ *
+ * @param[out] degree_of_partial The length of the leaves of the tree, a power of two
+ * @param[out] reduction_factor  The number of polynomials multiplied together at each node, a power of two
+ * @param[in]  len_missing       The number of missing indices
+ * @param[in]  length            The size of the domain of evaluation
+ */
+static void zero_poly_parameters(uint64_t *degree_of_partial, uint64_t *reduction_factor, uint64_t len_missing,
+                                 uint64_t length) {
+    uint64_t best = UINT64_MAX;
+
+    *degree_of_partial = 64;
+    *reduction_factor = 4;
+    if (len_missing < kzg_tuning()->zero_poly_tree_min) {
+        // A single leaf, multiplied out directly
+        if (len_missing >= 64) *degree_of_partial = next_power_of_two(len_missing + 1);
+        return;
+    }
+    for (uint64_t d = 16; d <= 256; d *= 2) {
+        for (uint64_t k = 2; k <= 16; k *= 2) {
+            uint64_t cost = zero_poly_cost(len_missing, length, d, k);
+            if (cost < best) {
+                best = cost;
+                *degree_of_partial = d;
+                *reduction_factor = k;
+            }
+        }
+    }
+}
+
+/**
+ * Build a zero polynomial as a subproduct tree with explicit tuning parameters.
+ *
+ * The leaves are the products of `degree_of_partial - 1` of the factors `(x - r^i)`, made by direct multiplication.
+ * Each level above multiplies groups of @p reduction_factor polynomials by convolution, until one remains. The leaves,
+ * and the products at each level, are shared out between the threads of @p pool.
+ *
+ * @param[out] zero_eval As #zero_polynomial_via_multiplication
+ * @param[out] zero_poly As #zero_polynomial_via_multiplication
+ * @param[in]  length    Size of the domain of evaluation (number of powers of `r`)
+ * @param[in]  missing_indices Array length @p len_missing containing the indices of the missing coefficients
+ * @param[in]  len_missing     Length of @p missing_indices, at least one and less than @p length
+ * @param[in]  degree_of_partial The length of the leaves of the tree, a power of two greater than one
+ * @param[in]  reduction_factor  The number of polynomials multiplied together at each node, a power of two greater than
+ *                               one
+ * @param[in]  fs        The FFT settings previously initialised with #new_fft_settings
+ * @param[in]  pool      Optional thread pool, NULL to run serially
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+static C_KZG_RET zero_poly_tree(fr_t *zero_eval, poly *zero_poly, uint64_t length, const uint64_t *missing_indices,
+                                uint64_t len_missing, uint64_t degree_of_partial, uint64_t reduction_factor,
+                                const FFTSettings *fs, const ThreadPool *pool) {
+    zero_poly_job job;
+    poly *partials, *swap;
+    uint64_t partial_count, tasks;
+    C_KZG_RET ret;
+
+    CHECK(degree_of_partial > 1 && is_power_of_two(degree_of_partial));
+    CHECK(reduction_factor > 1 && is_power_of_two(reduction_factor));
+
+    job.missing_indices = missing_indices;
+    job.len_missing = len_missing;
+    job.missing_per_partial = degree_of_partial - 1;
+    job.domain_stride = fs->max_width / length;
+    job.length = length;
+    job.reduction_factor = reduction_factor;
+    job.fs = fs;
+
+    if (len_missing <= job.missing_per_partial) {
+        TRY(do_zero_poly_mul_partial(zero_poly, missing_indices, len_missing, job.domain_stride, fs));
+        TRY(fft_fr(zero_eval, zero_poly->coeffs, false, length, fs));
+        return C_KZG_OK;
+    }
+
+    partial_count = (len_missing + job.missing_per_partial - 1) / job.missing_per_partial;
+    job.n = min_u64(next_power_of_two(partial_count * degree_of_partial), length);
+    tasks = min_u64(pool_threads(pool), partial_count);
+
+    // Work space for the coefficients of the partials, which are reduced in place. The leaves are `degree_of_partial`
+    // apart, and the products at each level `reduction_factor` times further apart than the level below, so that
+    // rounding the number of leaves up to a power of two leaves room for every product. Each level of the tree reads
+    // from one array of polys and writes to the other.
+    TRY(new_fr_array(&job.work, next_power_of_two(partial_count) * degree_of_partial));
+    TRY(new_poly_array(&partials, 2 * partial_count));
+    TRY(new_fr_array(&job.scratch, tasks * 3 * job.n));
+    TRY(new_byte_array((byte **)&job.ret, tasks * sizeof *job.ret));
+
+    // Build the leaves from the missing indices
+    job.out = partials;
+    job.items = partial_count;
+    ret = zero_poly_run(&job, zero_poly_leaf_task, pool);
+
+    // Reduce all the partials to a single polynomial, a level at a time
+    job.in = partials;
+    job.in_count = partial_count;
+    job.out = partials + partial_count;
+    while (ret == C_KZG_OK && job.in_count > 1) {
+        job.items = (job.in_count + reduction_factor - 1) / reduction_factor;
+        ret = zero_poly_run(&job, zero_poly_reduce_task, pool);
+        swap = (poly *)job.in;
+        job.in = job.out;
+        job.in_count = job.items;
+        job.out = swap;
+    }
+
+    // Process final output
+    if (ret == C_KZG_OK) ret = pad_p(zero_poly->coeffs, length, &job.in[0]);
+    if (ret == C_KZG_OK) ret = fft_fr(zero_eval, zero_poly->coeffs, false, length, fs);
+    zero_poly->length = job.in[0].length;
+
+    c_kzg_free(job.work);
+    c_kzg_free(partials);
+    c_kzg_free(job.scratch);
+    c_kzg_free(job.ret);
+    return ret;
+}
+
 /**
  * Calculate the minimal polynomial that evaluates to zero for powers of roots of unity that correspond to missing
- * indices.
+ * indices, spreading the work over a thread pool.
  *
  * This is done simply by multiplying together `(x - r^i)` for all the `i` that are missing indices, using a combination
- * of direct multiplication (#do_zero_poly_mul_partial) and iterated multiplication via convolution (#reduce_partials).
+ * of direct multiplication (#do_zero_poly_mul_partial) and iterated multiplication via convolution (#reduce_partials)
+ * arranged as a subproduct tree. The size of its leaves and the number of children per node are chosen from
+ * @p len_missing and @p length. The products within each level of the tree are independent, and are divided between
+ * the threads of @p pool.
  *
  * Also calculates the FFT (the "evaluation polynomial").
  *
@@ -162,16 +422,17 @@ C_KZG_RET reduce_partials(poly *out, uint64_t len_out, fr_t *scratch, uint64_t l
  * @param[in]  missing_indices Array length @p len_missing containing the indices of the missing coefficients
  * @param[in]  len_missing     Length of @p missing_indices
  * @param[in]  fs        The FFT settings previously initialised with #new_fft_settings
+ * @param[in]  pool      Optional thread pool, NULL to run serially
  * @retval C_CZK_OK      All is well
  * @retval C_CZK_BADARGS Invalid parameters were supplied
  * @retval C_CZK_ERROR   An internal error occurred
  * @retval C_CZK_MALLOC  Memory allocation failed
- *
- * @todo What is the performance impact of tuning `degree_of_partial` and `reduction factor`?
  */
-C_KZG_RET zero_polynomial_via_multiplication(fr_t *zero_eval, poly *zero_poly, uint64_t length,
-                                             const uint64_t *missing_indices, uint64_t len_missing,
-                                             const FFTSettings *fs) {
+C_KZG_RET zero_polynomial_via_multiplication_parallel(fr_t *zero_eval, poly *zero_poly, uint64_t length,
+                                                      const uint64_t *missing_indices, uint64_t len_missing,
+                                                      const FFTSettings *fs, const ThreadPool *pool) {
+    uint64_t degree_of_partial, reduction_factor;
+
     if (len_missing == 0) {
         zero_poly->length = 0;
         for (uint64_t i = 0; i < length; i++) {
@@ -184,75 +445,35 @@ C_KZG_RET zero_polynomial_via_multiplication(fr_t *zero_eval, poly *zero_poly, u
     CHECK(length <= fs->max_width);
     CHECK(is_power_of_two(length));
 
-    uint64_t degree_of_partial = 64; // Tunable parameter. Must be a power of two.
-    uint64_t missing_per_partial = degree_of_partial - 1;
-    uint64_t domain_stride = fs->max_width / length;
-    uint64_t partial_count = (len_missing + missing_per_partial - 1) / missing_per_partial;
-    uint64_t n = min_u64(next_power_of_two(partial_count * degree_of_partial), length);
-
-    if (len_missing <= missing_per_partial) {
-
-        TRY(do_zero_poly_mul_partial(zero_poly, missing_indices, len_missing, domain_stride, fs));
-        TRY(fft_fr(zero_eval, zero_poly->coeffs, false, length, fs));
-
-    } else {
-
-        // Work space for building and reducing the partials
-        fr_t *work;
-        TRY(new_fr_array(&work, next_power_of_two(partial_count * degree_of_partial)));
-
-        // Build the partials from the missing indices
-
-        // Just allocate pointers here since we're re-using `work` for the partial processing
-        // Combining partials can be done mostly in-place, using a scratchpad.
-        poly *partials;
-        TRY(new_poly_array(&partials, partial_count));
-        uint64_t offset = 0, out_offset = 0, max = len_missing;
-        for (int i = 0; i < partial_count; i++) {
-            uint64_t end = min_u64(offset + missing_per_partial, max);
-            partials[i].coeffs = &work[out_offset];
-            partials[i].length = degree_of_partial;
-            TRY(do_zero_poly_mul_partial(&partials[i], &missing_indices[offset], end - offset, domain_stride, fs));
-            offset += missing_per_partial;
-            out_offset += degree_of_partial;
-        }
-        // Adjust the length of the last partial
-        partials[partial_count - 1].length = 1 + len_missing - (partial_count - 1) * missing_per_partial;
-
-        // Reduce all the partials to a single polynomial
-        int reduction_factor = 4; // must be a power of 2 (for sake of the FFTs in reduce_partials)
-        fr_t *scratch;
-        TRY(new_fr_array(&scratch, n * 3));
-        while (partial_count > 1) {
-            uint64_t reduced_count = (partial_count + reduction_factor - 1) / reduction_factor;
-            uint64_t partial_size = next_power_of_two(partials[0].length);
-            for (uint64_t i = 0; i < reduced_count; i++) {
-                uint64_t start = i * reduction_factor;
-                uint64_t out_end = min_u64((start + reduction_factor) * partial_size, n);
-                uint64_t reduced_len = min_u64(out_end - start * partial_size, length);
-                uint64_t partials_num = min_u64(reduction_factor, partial_count - start);
-                partials[i].coeffs = work + start * partial_size;
-                if (partials_num > 1) {
-                    TRY(reduce_partials(&partials[i], reduced_len, scratch, n * 3, &partials[start], partials_num, fs));
-                } else {
-                    partials[i].length = partials[start].length;
-                }
-            }
-            partial_count = reduced_count;
-        }
-
-        // Process final output
-        TRY(pad_p(zero_poly->coeffs, length, &partials[0]));
-        TRY(fft_fr(zero_eval, zero_poly->coeffs, false, length, fs));
-
-        zero_poly->length = partials[0].length;
-
-        free(work);
-        free(partials);
-        free(scratch);
-    }
+    zero_poly_parameters(&degree_of_partial, &reduction_factor, len_missing, length);
+    return zero_poly_tree(zero_eval, zero_poly, length, missing_indices, len_missing, degree_of_partial,
+                          reduction_factor, fs, pool);
+}
 
-    return C_KZG_OK;
+/**
+ * Calculate the minimal polynomial that evaluates to zero for powers of roots of unity that correspond to missing
+ * indices.
+ *
+ * This is #zero_polynomial_via_multiplication_parallel run serially on the calling thread.
+ *
+ * @param[out] zero_eval The "evaluation polynomial": the coefficients are the values of @p zero_poly for each power of
+ *                       `r`. Space required is @p length.
+ * @param[out] zero_poly The zero polynomial. On return the length will be set to `len_missing + 1` and the remaining
+ *                       coefficients set to zero.  Space required is @p length.
+ * @param[in]  length    Size of the domain of evaluation (number of powers of `r`)
+ * @param[in]  missing_indices Array length @p len_missing containing the indices of the missing coefficients
+ * @param[in]  len_missing     Length of @p missing_indices
+ * @param[in]  fs        The FFT settings previously initialised with #new_fft_settings
+ * @retval C_CZK_OK      All is well
+ * @retval C_CZK_BADARGS Invalid parameters were supplied
+ * @retval C_CZK_ERROR   An internal error occurred
+ * @retval C_CZK_MALLOC  Memory allocation failed
+ */
+C_KZG_RET zero_polynomial_via_multiplication(fr_t *zero_eval, poly *zero_poly, uint64_t length,
+                                             const uint64_t *missing_indices, uint64_t len_missing,
+                                             const FFTSettings *fs) {
+    return zero_polynomial_via_multiplication_parallel(zero_eval, zero_poly, length, missing_indices, len_missing, fs,
+                                                       NULL);
 }
 
 #ifdef KZGTEST
@@ -640,6 +861,63 @@ void zero_poly_252(void) {
     free_fft_settings(&fs);
 }
 
+// Every shape of tree, run serially or in parallel, gives the same zero polynomial
+void zero_poly_tree_shapes(void) {
+    FFTSettings fs;
+    ThreadPool pool;
+    uint64_t *missing, len_missing = 0;
+    fr_t *expected_eval, *zero_eval;
+    poly expected_poly, zero_poly;
+    uint64_t degrees[] = {2, 4, 16, 64}, factors[] = {2, 4, 8};
+
+    srand(42);
+    TEST_CHECK(C_KZG_OK == new_fft_settings(&fs, 10));
+    TEST_CHECK(C_KZG_OK == new_thread_pool(&pool, 3));
+    TEST_CHECK(C_KZG_OK == new_uint64_array(&missing, fs.max_width));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&expected_eval, fs.max_width));
+    TEST_CHECK(C_KZG_OK == new_fr_array(&zero_eval, fs.max_width));
+    TEST_CHECK(C_KZG_OK == new_poly(&expected_poly, fs.max_width));
+    TEST_CHECK(C_KZG_OK == new_poly(&zero_poly, fs.max_width));
+
+    for (int i = 0; i < fs.max_width; i++) {
+        if (rand() % 2) missing[len_missing++] = i;
+    }
+    TEST_CHECK(C_KZG_OK == zero_polynomial_via_multiplication(expected_eval, &expected_poly, fs.max_width, missing,
+                                                              len_missing, &fs));
+    TEST_CHECK(len_missing + 1 == expected_poly.length);
+
+    for (int d = 0; d < sizeof degrees / sizeof degrees[0]; d++) {
+        for (int k = 0; k < sizeof factors / sizeof factors[0]; k++) {
+            for (int threaded = 0; threaded <= 1; threaded++) {
+                zero_poly.length = fs.max_width;
+                bool ok = C_KZG_OK == zero_poly_tree(zero_eval, &zero_poly, fs.max_width, missing, len_missing,
+                                                     degrees[d], factors[k], &fs, threaded ? &pool : NULL);
+                ok = ok && expected_poly.length == zero_poly.length;
+                for (uint64_t i = 0; ok && i < fs.max_width; i++) {
+                    ok = fr_equal(&expected_poly.coeffs[i], &zero_poly.coeffs[i]) &&
+                         fr_equal(&expected_eval[i], &zero_eval[i]);
+                }
+                TEST_CHECK(ok);
+                TEST_MSG("Mismatch for degree %lu, factor %lu, threaded %d", degrees[d], factors[k], threaded);
+            }
+        }
+    }
+
+    // The parameters must both be powers of two
+    TEST_CHECK(C_KZG_BADARGS ==
+               zero_poly_tree(zero_eval, &zero_poly, fs.max_width, missing, len_missing, 1, 4, &fs, NULL));
+    TEST_CHECK(C_KZG_BADARGS ==
+               zero_poly_tree(zero_eval, &zero_poly, fs.max_width, missing, len_missing, 64, 3, &fs, NULL));
+
+    free(missing);
+    free(expected_eval);
+    free(zero_eval);
+    free_poly(&expected_poly);
+    free_poly(&zero_poly);
+    free_thread_pool(&pool);
+    free_fft_settings(&fs);
+}
+
 TEST_LIST = {
     {"ZERO_POLY_TEST", title},
     {"test_reduce_partials", test_reduce_partials},
@@ -649,6 +927,7 @@ TEST_LIST = {
     {"zero_poly_random", zero_poly_random},
     {"zero_poly_all_but_one", zero_poly_all_but_one},
     {"zero_poly_252", zero_poly_252},
+    {"zero_poly_tree_shapes", zero_poly_tree_shapes},
     {NULL, NULL} /* zero record marks the end of the list */
 };
 
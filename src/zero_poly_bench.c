@@ -22,10 +22,10 @@
 #include "test_util.h"
 #include "c_kzg.h"
 
-// Run the benchmark for `max_seconds` and return the time per iteration in nanoseconds.
-long run_bench(int scale, int max_seconds) {
-    timespec_t t0, t1;
-    unsigned long total_time = 0, nits = 0;
+// Run the benchmark for `max_seconds` and return the timings per iteration. If `pool` is non-NULL then
+// the subproduct tree is built in parallel using it.
+bench_result run_bench(int scale, int max_seconds, const ThreadPool *pool) {
+    bench_t bench;
     FFTSettings fs;
 
     assert(C_KZG_OK == new_fft_settings(&fs, scale));
@@ -42,14 +42,13 @@ long run_bench(int scale, int max_seconds) {
     poly zero_poly_p;
     zero_poly_p.coeffs = zero_poly;
     zero_poly_p.length = fs.max_width;
-    while (total_time < max_seconds * NANO) {
-        clock_gettime(CLOCK_REALTIME, &t0);
+    bench_begin(&bench, max_seconds);
+    while (bench_more(&bench)) {
+        bench_start(&bench);
         // Half missing leaves enough FFT computation space
-        assert(C_KZG_OK == zero_polynomial_via_multiplication(zero_eval, &zero_poly_p, fs.max_width, missing,
-                                                              fs.max_width / 2, &fs));
-        clock_gettime(CLOCK_REALTIME, &t1);
-        nits++;
-        total_time += tdiff(t0, t1);
+        assert(C_KZG_OK == zero_polynomial_via_multiplication_parallel(zero_eval, &zero_poly_p, fs.max_width, missing,
+                                                                       fs.max_width / 2, &fs, pool));
+        bench_stop(&bench);
     }
 
     free_poly(&zero_poly_p);
@@ -57,11 +56,14 @@ long run_bench(int scale, int max_seconds) {
     free(missing);
     free_fft_settings(&fs);
 
-    return total_time / nits;
+    return bench_end(&bench, 1, 0);
 }
 
 int main(int argc, char *argv[]) {
     int nsec = 0;
+    ThreadPool pool;
+
+    argc = bench_init(argc, argv);
 
     switch (argc) {
     case 1:
@@ -75,14 +77,21 @@ int main(int argc, char *argv[]) {
     };
 
     if (nsec == 0) {
-        printf("Usage: %s [test time in seconds > 0]\n", argv[0]);
+        printf("Usage: %s [test time in seconds > 0] " BENCH_OPTIONS "\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    printf("*** Benchmarking Zero Polynomial, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
-    for (int scale = 5; scale <= 15; scale++) {
-        printf("zero_poly/scale_%d %lu ns/op\n", scale, run_bench(scale, nsec));
+    bench_note("*** Benchmarking Zero Polynomial, %d second%s per test.\n", nsec, nsec == 1 ? "" : "s");
+    for (int scale = 5; scale <= 16; scale++) {
+        bench_report(run_bench(scale, nsec, NULL), "zero_poly/scale_%d", scale);
+    }
+
+    assert(C_KZG_OK == new_thread_pool(&pool, bench_threads()));
+    bench_note("*** Using %u threads.\n", pool.threads);
+    for (int scale = 5; scale <= 16; scale++) {
+        bench_report(run_bench(scale, nsec, &pool), "zero_poly_threaded/scale_%d", scale);
     }
+    free_thread_pool(&pool);
 
-    return EXIT_SUCCESS;
+    return bench_exit();
 }